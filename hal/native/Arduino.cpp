@@ -0,0 +1,520 @@
+/**
+ * Arduino.cpp (native)
+ * 主機端 Arduino 核心替身實現
+ */
+
+#include "Arduino.h"
+#include "NativeSim.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdarg>
+#include <thread>
+#include <vector>
+
+namespace {
+
+struct PinState {
+    uint8_t mode = INPUT;
+    int level = LOW;
+    uint32_t duty = 0;
+    uint8_t dutyBits = 8;
+    int ledcChannel = -1;
+    uint32_t writeCount = 0;
+
+    void (*isr)(void) = nullptr;
+    void (*isrArg)(void*) = nullptr;
+    void* arg = nullptr;
+    int isrMode = 0;
+
+    std::vector<std::function<void(uint8_t, int)>> listeners;
+};
+
+struct LedcChannel {
+    uint32_t freq = 0;
+    uint8_t bits = 8;
+    uint32_t duty = 0;
+};
+
+const int LEDC_CHANNELS = 16;
+
+PinState pins[NATIVE_NUM_PINS];
+LedcChannel ledc[LEDC_CHANNELS];
+
+std::atomic<uint64_t> virtualMicros(0);
+bool realTime = false;
+std::chrono::steady_clock::time_point realTimeStart = std::chrono::steady_clock::now();
+
+uint32_t i2cBytesByAddress[128];
+uint64_t i2cBusy = 0;
+uint32_t i2cClockHz[2] = {100000, 100000};
+
+bool exitFlag = false;
+int exitStatus = 0;
+
+bool validPin(uint8_t pin) {
+    return pin < NATIVE_NUM_PINS;
+}
+
+void dispatchInterrupt(PinState& p, int oldLevel, int newLevel) {
+    if (!p.isr && !p.isrArg) return;
+
+    bool fire = false;
+    switch (p.isrMode) {
+        case CHANGE:  fire = oldLevel != newLevel; break;
+        case RISING:  fire = oldLevel == LOW && newLevel == HIGH; break;
+        case FALLING: fire = oldLevel == HIGH && newLevel == LOW; break;
+        case ONLOW:   fire = newLevel == LOW; break;
+        case ONHIGH:  fire = newLevel == HIGH; break;
+        default: break;
+    }
+
+    if (!fire) return;
+    if (p.isrArg) {
+        p.isrArg(p.arg);
+    } else {
+        p.isr();
+    }
+}
+
+} // namespace
+
+// ---- 時間 ----
+
+unsigned long micros() {
+    return (unsigned long)(uint32_t)NativeSim::nowMicros();
+}
+
+unsigned long millis() {
+    return (unsigned long)(uint32_t)(NativeSim::nowMicros() / 1000);
+}
+
+void delay(uint32_t ms) {
+    // 與 ESP32 相同，delay() 會讓出 CPU 給其他任務
+    NativeSim::sleepMicros((uint64_t)ms * 1000);
+}
+
+void delayMicroseconds(uint32_t us) {
+    // 忙等待：推進時鐘但不切換任務
+    if (realTime) {
+        std::this_thread::sleep_for(std::chrono::microseconds(us));
+    } else {
+        NativeSim::advanceMicros(us);
+    }
+}
+
+void yield() {
+    taskYIELD();
+}
+
+// ---- GPIO ----
+
+void pinMode(uint8_t pin, uint8_t mode) {
+    if (!validPin(pin)) return;
+    PinState& p = pins[pin];
+    p.mode = mode;
+    if (mode == INPUT_PULLUP) {
+        p.level = HIGH;
+    } else if (mode == INPUT_PULLDOWN) {
+        p.level = LOW;
+    }
+}
+
+void digitalWrite(uint8_t pin, uint8_t val) {
+    if (!validPin(pin)) return;
+    PinState& p = pins[pin];
+    p.level = val ? HIGH : LOW;
+    p.writeCount++;
+}
+
+int digitalRead(uint8_t pin) {
+    if (!validPin(pin)) return LOW;
+    return pins[pin].level;
+}
+
+void analogWrite(uint8_t pin, int value) {
+    if (!validPin(pin)) return;
+    PinState& p = pins[pin];
+    p.duty = (uint32_t)constrain(value, 0, 255);
+    p.dutyBits = 8;
+    p.writeCount++;
+}
+
+int analogRead(uint8_t pin) {
+    (void)pin;
+    return 0;
+}
+
+// ---- LEDC ----
+
+uint32_t ledcSetup(uint8_t channel, uint32_t freq, uint8_t resolution_bits) {
+    if (channel >= LEDC_CHANNELS || resolution_bits == 0 || resolution_bits > 20) return 0;
+    ledc[channel].freq = freq;
+    ledc[channel].bits = resolution_bits;
+    ledc[channel].duty = 0;
+    return freq;
+}
+
+void ledcAttachPin(uint8_t pin, uint8_t channel) {
+    if (!validPin(pin) || channel >= LEDC_CHANNELS) return;
+    pins[pin].ledcChannel = channel;
+    pins[pin].dutyBits = ledc[channel].bits;
+    pins[pin].duty = ledc[channel].duty;
+}
+
+void ledcDetachPin(uint8_t pin) {
+    if (!validPin(pin)) return;
+    pins[pin].ledcChannel = -1;
+}
+
+void ledcWrite(uint8_t channel, uint32_t duty) {
+    if (channel >= LEDC_CHANNELS) return;
+    LedcChannel& c = ledc[channel];
+    uint32_t maxDuty = 1UL << c.bits;
+    c.duty = duty > maxDuty ? maxDuty : duty;
+
+    for (int i = 0; i < NATIVE_NUM_PINS; i++) {
+        if (pins[i].ledcChannel == channel) {
+            pins[i].duty = c.duty;
+            pins[i].dutyBits = c.bits;
+            pins[i].writeCount++;
+        }
+    }
+}
+
+uint32_t ledcRead(uint8_t channel) {
+    return channel < LEDC_CHANNELS ? ledc[channel].duty : 0;
+}
+
+// ---- 外部中斷 ----
+
+void attachInterrupt(uint8_t pin, void (*isr)(void), int mode) {
+    if (!validPin(pin)) return;
+    pins[pin].isr = isr;
+    pins[pin].isrArg = nullptr;
+    pins[pin].arg = nullptr;
+    pins[pin].isrMode = mode;
+}
+
+void attachInterruptArg(uint8_t pin, void (*isr)(void*), void* arg, int mode) {
+    if (!validPin(pin)) return;
+    pins[pin].isr = nullptr;
+    pins[pin].isrArg = isr;
+    pins[pin].arg = arg;
+    pins[pin].isrMode = mode;
+}
+
+void detachInterrupt(uint8_t pin) {
+    if (!validPin(pin)) return;
+    pins[pin].isr = nullptr;
+    pins[pin].isrArg = nullptr;
+    pins[pin].arg = nullptr;
+}
+
+void noInterrupts() {}
+void interrupts() {}
+
+// ---- 雜項 ----
+
+long random(long howbig) {
+    if (howbig <= 0) return 0;
+    return std::rand() % howbig;
+}
+
+long random(long howsmall, long howbig) {
+    if (howsmall >= howbig) return howsmall;
+    return random(howbig - howsmall) + howsmall;
+}
+
+void randomSeed(unsigned long seed) {
+    std::srand((unsigned int)seed);
+}
+
+long map(long x, long in_min, long in_max, long out_min, long out_max) {
+    if (in_max == in_min) return out_min;
+    return (x - in_min) * (out_max - out_min) / (in_max - in_min) + out_min;
+}
+
+// ---- ESP ----
+
+EspClass ESP;
+
+uint32_t EspClass::getCycleCount() {
+    static const std::chrono::steady_clock::time_point hostStart = std::chrono::steady_clock::now();
+    uint64_t hostNanos = (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - hostStart).count();
+
+    // 實時模式下 micros() 已是主機時間，不重複計入
+    uint64_t cycles = hostNanos * NATIVE_CPU_FREQ_MHZ / 1000;
+    if (!NativeSim::isRealTime()) {
+        cycles += NativeSim::nowMicros() * NATIVE_CPU_FREQ_MHZ;
+    }
+    return (uint32_t)cycles;
+}
+
+// ---- Serial ----
+
+HardwareSerial Serial;
+
+size_t Print::write(const uint8_t* buffer, size_t size) {
+    size_t n = 0;
+    while (size--) n += write(*buffer++);
+    return n;
+}
+
+size_t Print::write(const char* str) {
+    if (!str) return 0;
+    return write((const uint8_t*)str, strlen(str));
+}
+
+size_t Print::print(const char* str) { return write(str); }
+size_t Print::print(const String& str) { return write(str.c_str()); }
+size_t Print::print(char c) { return write((uint8_t)c); }
+size_t Print::print(unsigned char value, int base) { return printNumber(value, base, false); }
+size_t Print::print(unsigned int value, int base) { return printNumber(value, base, false); }
+size_t Print::print(unsigned long value, int base) { return printNumber(value, base, false); }
+size_t Print::print(unsigned long long value, int base) { return printNumber(value, base, false); }
+size_t Print::print(int value, int base) { return print((long long)value, base); }
+size_t Print::print(long value, int base) { return print((long long)value, base); }
+
+size_t Print::print(long long value, int base) {
+    if (base == DEC && value < 0) {
+        return printNumber((unsigned long long)(-(value + 1)) + 1, base, true);
+    }
+    return printNumber((unsigned long long)value, base, false);
+}
+
+size_t Print::print(double value, int digits) {
+    char buffer[64];
+    if (std::isnan(value)) return print("nan");
+    if (std::isinf(value)) return print("inf");
+    snprintf(buffer, sizeof(buffer), "%.*f", digits, value);
+    return print(buffer);
+}
+
+size_t Print::println() {
+    return write((const uint8_t*)"\r\n", 2);
+}
+
+size_t Print::printf(const char* format, ...) {
+    char buffer[256];
+    va_list args;
+    va_start(args, format);
+    int len = vsnprintf(buffer, sizeof(buffer), format, args);
+    va_end(args);
+    if (len < 0) return 0;
+    return write((const uint8_t*)buffer, std::min((size_t)len, sizeof(buffer) - 1));
+}
+
+size_t Print::printNumber(unsigned long long value, int base, bool negative) {
+    char buffer[72];
+    char* p = &buffer[sizeof(buffer) - 1];
+    *p = '\0';
+    if (base < 2) base = 10;
+    do {
+        int digit = (int)(value % base);
+        *--p = (char)(digit < 10 ? '0' + digit : 'A' + digit - 10);
+        value /= base;
+    } while (value);
+    if (negative) *--p = '-';
+    return write(p);
+}
+
+HardwareSerial::HardwareSerial() : txBytes(0) {}
+
+void HardwareSerial::begin(unsigned long baud) {
+    (void)baud;
+}
+
+void HardwareSerial::flush() {
+    fflush(stdout);
+}
+
+int HardwareSerial::available() {
+    return (int)rxBuffer.size();
+}
+
+int HardwareSerial::peek() {
+    return rxBuffer.empty() ? -1 : (uint8_t)rxBuffer[0];
+}
+
+int HardwareSerial::read() {
+    if (rxBuffer.empty()) return -1;
+    uint8_t c = (uint8_t)rxBuffer[0];
+    rxBuffer.erase(0, 1);
+    return c;
+}
+
+size_t HardwareSerial::readBytes(uint8_t* buffer, size_t length) {
+    size_t n = std::min(length, rxBuffer.size());
+    memcpy(buffer, rxBuffer.data(), n);
+    rxBuffer.erase(0, n);
+    return n;
+}
+
+String HardwareSerial::readString() {
+    String result(rxBuffer);
+    rxBuffer.clear();
+    return result;
+}
+
+String HardwareSerial::readStringUntil(char terminator) {
+    size_t pos = rxBuffer.find(terminator);
+    std::string line = rxBuffer.substr(0, pos);
+    rxBuffer.erase(0, pos == std::string::npos ? std::string::npos : pos + 1);
+    return String(line);
+}
+
+size_t HardwareSerial::write(uint8_t c) {
+    fputc(c, stdout);
+    txBytes++;
+    return 1;
+}
+
+size_t HardwareSerial::write(const uint8_t* buffer, size_t size) {
+    fwrite(buffer, 1, size, stdout);
+    txBytes += size;
+    return size;
+}
+
+void HardwareSerial::hostInject(const char* data, size_t length) {
+    rxBuffer.append(data, length);
+}
+
+// ---- 模擬器控制 ----
+
+namespace NativeSim {
+
+uint64_t nowMicros() {
+    if (realTime) {
+        return (uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - realTimeStart).count();
+    }
+    return virtualMicros.load(std::memory_order_relaxed);
+}
+
+void advanceMicros(uint64_t us) {
+    if (!realTime) {
+        virtualMicros.fetch_add(us, std::memory_order_relaxed);
+    }
+}
+
+void setRealTime(bool enable) {
+    if (enable && !realTime) {
+        // 從目前的虛擬時間接續，避免時間倒退
+        realTimeStart = std::chrono::steady_clock::now() -
+                        std::chrono::microseconds(virtualMicros.load());
+    } else if (!enable && realTime) {
+        virtualMicros.store(nowMicros());
+    }
+    realTime = enable;
+}
+
+bool isRealTime() {
+    return realTime;
+}
+
+void setInputLevel(uint8_t pin, int level) {
+    if (!validPin(pin)) return;
+    PinState& p = pins[pin];
+    int oldLevel = p.level;
+    p.level = level ? HIGH : LOW;
+    if (p.level != oldLevel) {
+        for (auto& listener : p.listeners) listener(pin, p.level);
+    }
+    dispatchInterrupt(p, oldLevel, p.level);
+}
+
+int pinLevel(uint8_t pin) {
+    return validPin(pin) ? pins[pin].level : LOW;
+}
+
+uint32_t pinDuty(uint8_t pin) {
+    return validPin(pin) ? pins[pin].duty : 0;
+}
+
+uint8_t pinDutyBits(uint8_t pin) {
+    return validPin(pin) ? pins[pin].dutyBits : 0;
+}
+
+double pinDutyFraction(uint8_t pin) {
+    if (!validPin(pin)) return 0.0;
+    const PinState& p = pins[pin];
+    double full = p.ledcChannel >= 0 ? (double)(1UL << p.dutyBits) : 255.0;
+    double fraction = p.duty / full;
+    return fraction > 1.0 ? 1.0 : fraction;
+}
+
+uint32_t ledcFrequency(uint8_t channel) {
+    return channel < LEDC_CHANNELS ? ledc[channel].freq : 0;
+}
+
+uint32_t pinWriteCount(uint8_t pin) {
+    return validPin(pin) ? pins[pin].writeCount : 0;
+}
+
+bool hasInterrupt(uint8_t pin) {
+    return validPin(pin) && (pins[pin].isr || pins[pin].isrArg);
+}
+
+void addPinListener(uint8_t pin, std::function<void(uint8_t pin, int level)> listener) {
+    if (validPin(pin)) pins[pin].listeners.push_back(std::move(listener));
+}
+
+void i2cTransfer(uint8_t address, size_t bytes, uint8_t bus) {
+    bus = bus ? 1 : 0;
+    // 每個位元組 8 個資料位元 + 1 個 ACK，另加 START/STOP 約 2 個位元時間
+    uint64_t bits = (uint64_t)(bytes + 1) * 9 + 2;
+    uint64_t us = bits * 1000000ULL / (i2cClockHz[bus] ? i2cClockHz[bus] : 100000);
+    i2cBytesByAddress[address & 0x7F] += (uint32_t)(bytes + 1);
+    i2cBusy += us;
+
+    // 與 ESP32 的 I2C 驅動相同：傳輸期間呼叫端阻塞，其他任務可以執行，但每個匯流排一次只給一個任務
+    static SemaphoreHandle_t busLock[2] = {xSemaphoreCreateMutex(), xSemaphoreCreateMutex()};
+    xSemaphoreTake(busLock[bus], portMAX_DELAY);
+    sleepMicros(us);
+    xSemaphoreGive(busLock[bus]);
+}
+
+uint32_t i2cBytes(uint8_t address) {
+    return i2cBytesByAddress[address & 0x7F];
+}
+
+uint64_t i2cBusyMicros() {
+    return i2cBusy;
+}
+
+void setI2CClock(uint32_t hz, uint8_t bus) {
+    i2cClockHz[bus ? 1 : 0] = hz;
+}
+
+uint32_t i2cClock(uint8_t bus) {
+    return i2cClockHz[bus ? 1 : 0];
+}
+
+void requestExit(int code) {
+    exitFlag = true;
+    exitStatus = code;
+}
+
+bool exitRequested() {
+    return exitFlag;
+}
+
+int exitCode() {
+    return exitStatus;
+}
+
+void reset() {
+    for (int i = 0; i < NATIVE_NUM_PINS; i++) pins[i] = PinState();
+    for (int i = 0; i < LEDC_CHANNELS; i++) ledc[i] = LedcChannel();
+    for (int i = 0; i < 128; i++) i2cBytesByAddress[i] = 0;
+    i2cBusy = 0;
+    i2cClockHz[0] = i2cClockHz[1] = 100000;
+    virtualMicros.store(0);
+    realTime = false;
+    exitFlag = false;
+    exitStatus = 0;
+}
+
+} // namespace NativeSim
@@ -0,0 +1,24 @@
+/**
+ * Esp.h (native)
+ * ESP 全域物件的主機端替身 (只提供專案用到的週期計數與晶片資訊)
+ *
+ * getCycleCount() 以 240 MHz 換算：虛擬時間 (含 delay 與 I2C 等阻塞) 加上主機實際執行時間，
+ * 因此量測結果同時反映模擬的匯流排等待與程式碼本身的成本
+ */
+
+#ifndef NATIVE_ESP_H
+#define NATIVE_ESP_H
+
+#include <cstdint>
+
+#define NATIVE_CPU_FREQ_MHZ 240
+
+class EspClass {
+public:
+    uint32_t getCycleCount();
+    uint32_t getCpuFreqMHz() { return NATIVE_CPU_FREQ_MHZ; }
+};
+
+extern EspClass ESP;
+
+#endif // NATIVE_ESP_H
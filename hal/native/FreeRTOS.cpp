@@ -0,0 +1,381 @@
+/**
+ * FreeRTOS.cpp (native)
+ * 協作式、以虛擬時間驅動的 FreeRTOS 任務排程替身
+ *
+ * - 每個任務是一個 std::thread，但任一時刻只有持有執行權的任務在跑
+ * - 任務在阻塞 API 中讓出執行權；排程器選出可執行且優先權最高的任務，
+ *   同優先權依讓出順序輪流；沒有可執行任務時把虛擬時鐘推進到最早的喚醒時間
+ * - 給出號誌/通知時若喚醒了更高優先權的任務，會立即切換 (模擬搶佔)
+ */
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "NativeSim.h"
+
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+struct NativeTask {
+    std::string name;
+    UBaseType_t priority;
+    BaseType_t core;
+    TaskFunction_t entry;
+    void* arg;
+
+    std::condition_variable cv;
+    uint64_t wakeUs;                 // 阻塞期限，UINT64_MAX 表示不限
+    std::function<bool()> ready;     // 阻塞條件，nullptr 表示只等時間
+    uint64_t seq;                    // 讓出順序，用於同優先權輪流
+    bool deleted;
+    uint32_t notifyCount;
+};
+
+struct NativeSemaphore {
+    uint32_t count;
+    uint32_t maxCount;
+};
+
+namespace {
+
+const uint64_t FOREVER = UINT64_MAX;
+
+// 刻意不釋放，避免程式結束時仍在等待的任務執行緒存取已解構的物件
+std::mutex& schedLock() {
+    static std::mutex* m = new std::mutex();
+    return *m;
+}
+
+std::vector<NativeTask*>& taskList() {
+    static std::vector<NativeTask*>* v = new std::vector<NativeTask*>();
+    return *v;
+}
+
+NativeTask* current = nullptr;
+uint64_t seqCounter = 0;
+
+NativeTask* newTask(const char* name, UBaseType_t priority, BaseType_t core) {
+    NativeTask* t = new NativeTask();
+    t->name = name ? name : "";
+    t->priority = priority;
+    t->core = core;
+    t->entry = nullptr;
+    t->arg = nullptr;
+    t->wakeUs = 0;
+    t->seq = ++seqCounter;
+    t->deleted = false;
+    t->notifyCount = 0;
+    taskList().push_back(t);
+    return t;
+}
+
+// 第一次使用時把呼叫端執行緒 (Arduino 的 loopTask) 登記為任務
+NativeTask* self() {
+    if (!current) {
+        current = newTask("loopTask", 1, 1);
+    }
+    return current;
+}
+
+bool runnable(NativeTask* t, uint64_t now) {
+    if (t->deleted) return false;
+    if (t->ready && t->ready()) return true;
+    return now >= t->wakeUs;
+}
+
+// 持有鎖時呼叫：交出執行權，直到本任務再次被選中
+void schedule(std::unique_lock<std::mutex>& lk) {
+    NativeTask* me = current;
+
+    while (true) {
+        uint64_t now = NativeSim::nowMicros();
+        NativeTask* best = nullptr;
+        for (NativeTask* t : taskList()) {
+            if (!runnable(t, now)) continue;
+            if (!best || t->priority > best->priority ||
+                (t->priority == best->priority && t->seq < best->seq)) {
+                best = t;
+            }
+        }
+
+        if (best) {
+            if (best != me) {
+                current = best;
+                best->cv.notify_one();
+                me->cv.wait(lk, [me] { return current == me; });
+            }
+            return;
+        }
+
+        uint64_t next = FOREVER;
+        for (NativeTask* t : taskList()) {
+            if (!t->deleted && t->wakeUs < next) next = t->wakeUs;
+        }
+        if (next == FOREVER) {
+            fprintf(stderr, "[native] deadlock: all tasks are blocked forever\n");
+            fflush(stdout);
+            std::_Exit(3);
+        }
+
+        if (NativeSim::isRealTime()) {
+            std::this_thread::sleep_for(std::chrono::microseconds(next - now));
+        } else {
+            NativeSim::advanceMicros(next - now);
+        }
+    }
+}
+
+void blockUntil(std::unique_lock<std::mutex>& lk, uint64_t wakeUs, std::function<bool()> ready) {
+    NativeTask* me = self();
+    me->wakeUs = wakeUs;
+    me->ready = ready;
+    me->seq = ++seqCounter;
+    schedule(lk);
+    me->wakeUs = 0;
+    me->ready = nullptr;
+}
+
+// 若有更高優先權的任務可執行則立即切換
+void preemptIfNeeded(std::unique_lock<std::mutex>& lk) {
+    NativeTask* me = self();
+    uint64_t now = NativeSim::nowMicros();
+    for (NativeTask* t : taskList()) {
+        if (t != me && t->priority > me->priority && runnable(t, now)) {
+            blockUntil(lk, 0, nullptr);
+            return;
+        }
+    }
+}
+
+uint64_t deadlineFor(TickType_t ticks) {
+    if (ticks == portMAX_DELAY) return FOREVER;
+    return NativeSim::nowMicros() + (uint64_t)ticks * 1000ULL;
+}
+
+void taskTrampoline(NativeTask* t) {
+    {
+        std::unique_lock<std::mutex> lk(schedLock());
+        t->cv.wait(lk, [t] { return current == t; });
+    }
+    t->entry(t->arg);
+
+    // FreeRTOS 任務不可返回；視同刪除自己
+    vTaskDelete(nullptr);
+}
+
+} // namespace
+
+// ---- 任務 ----
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t pvTaskCode, const char* pcName, uint32_t usStackDepth,
+                                   void* pvParameters, UBaseType_t uxPriority, TaskHandle_t* pvCreatedTask,
+                                   BaseType_t xCoreID) {
+    (void)usStackDepth;
+    std::unique_lock<std::mutex> lk(schedLock());
+    self();
+
+    NativeTask* t = newTask(pcName, uxPriority, xCoreID);
+    t->entry = pvTaskCode;
+    t->arg = pvParameters;
+    if (pvCreatedTask) *pvCreatedTask = t;
+
+    std::thread(taskTrampoline, t).detach();
+    preemptIfNeeded(lk);
+    return pdPASS;
+}
+
+BaseType_t xTaskCreate(TaskFunction_t pvTaskCode, const char* pcName, uint32_t usStackDepth,
+                       void* pvParameters, UBaseType_t uxPriority, TaskHandle_t* pvCreatedTask) {
+    return xTaskCreatePinnedToCore(pvTaskCode, pcName, usStackDepth, pvParameters, uxPriority,
+                                   pvCreatedTask, tskNO_AFFINITY);
+}
+
+void vTaskDelete(TaskHandle_t xTask) {
+    std::unique_lock<std::mutex> lk(schedLock());
+    NativeTask* me = self();
+    NativeTask* target = xTask ? xTask : me;
+    target->deleted = true;
+    if (target == me) {
+        schedule(lk);
+        // 不會再被選中
+    }
+}
+
+void vTaskDelay(TickType_t xTicksToDelay) {
+    std::unique_lock<std::mutex> lk(schedLock());
+    blockUntil(lk, deadlineFor(xTicksToDelay), nullptr);
+}
+
+BaseType_t xTaskDelayUntil(TickType_t* pxPreviousWakeTime, TickType_t xTimeIncrement) {
+    std::unique_lock<std::mutex> lk(schedLock());
+    TickType_t wakeTick = *pxPreviousWakeTime + xTimeIncrement;
+    *pxPreviousWakeTime = wakeTick;
+
+    uint64_t wakeUs = (uint64_t)wakeTick * 1000ULL;
+    if (wakeUs <= NativeSim::nowMicros()) {
+        // 已錯過喚醒時間，與 FreeRTOS 相同直接返回
+        blockUntil(lk, 0, nullptr);
+        return pdFALSE;
+    }
+    blockUntil(lk, wakeUs, nullptr);
+    return pdTRUE;
+}
+
+void vTaskDelayUntil(TickType_t* pxPreviousWakeTime, TickType_t xTimeIncrement) {
+    xTaskDelayUntil(pxPreviousWakeTime, xTimeIncrement);
+}
+
+TickType_t xTaskGetTickCount() {
+    return (TickType_t)(NativeSim::nowMicros() / 1000ULL);
+}
+
+TickType_t xTaskGetTickCountFromISR() {
+    return xTaskGetTickCount();
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle() {
+    std::unique_lock<std::mutex> lk(schedLock());
+    return self();
+}
+
+void taskYIELD() {
+    std::unique_lock<std::mutex> lk(schedLock());
+    blockUntil(lk, 0, nullptr);
+}
+
+UBaseType_t uxTaskPriorityGet(TaskHandle_t xTask) {
+    std::unique_lock<std::mutex> lk(schedLock());
+    return (xTask ? xTask : self())->priority;
+}
+
+void vTaskPrioritySet(TaskHandle_t xTask, UBaseType_t uxNewPriority) {
+    std::unique_lock<std::mutex> lk(schedLock());
+    (xTask ? xTask : self())->priority = uxNewPriority;
+    preemptIfNeeded(lk);
+}
+
+UBaseType_t uxTaskGetStackHighWaterMark(TaskHandle_t xTask) {
+    (void)xTask;
+    return 0;
+}
+
+BaseType_t xPortGetCoreID() {
+    std::unique_lock<std::mutex> lk(schedLock());
+    BaseType_t core = self()->core;
+    return core == tskNO_AFFINITY ? 0 : core;
+}
+
+// ---- 任務通知 ----
+
+BaseType_t xTaskNotifyGive(TaskHandle_t xTaskToNotify) {
+    std::unique_lock<std::mutex> lk(schedLock());
+    xTaskToNotify->notifyCount++;
+    preemptIfNeeded(lk);
+    return pdPASS;
+}
+
+void vTaskNotifyGiveFromISR(TaskHandle_t xTaskToNotify, BaseType_t* pxHigherPriorityTaskWoken) {
+    std::unique_lock<std::mutex> lk(schedLock());
+    xTaskToNotify->notifyCount++;
+    if (pxHigherPriorityTaskWoken && xTaskToNotify->priority > self()->priority) {
+        *pxHigherPriorityTaskWoken = pdTRUE;
+    }
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t xClearCountOnExit, TickType_t xTicksToWait) {
+    std::unique_lock<std::mutex> lk(schedLock());
+    NativeTask* me = self();
+    if (me->notifyCount == 0 && xTicksToWait > 0) {
+        blockUntil(lk, deadlineFor(xTicksToWait), [me] { return me->notifyCount > 0; });
+    }
+    uint32_t value = me->notifyCount;
+    if (value > 0) {
+        me->notifyCount = xClearCountOnExit ? 0 : value - 1;
+    }
+    return value;
+}
+
+// ---- 號誌 ----
+
+SemaphoreHandle_t xSemaphoreCreateMutex() {
+    return new NativeSemaphore{1, 1};
+}
+
+SemaphoreHandle_t xSemaphoreCreateBinary() {
+    return new NativeSemaphore{0, 1};
+}
+
+SemaphoreHandle_t xSemaphoreCreateCounting(UBaseType_t uxMaxCount, UBaseType_t uxInitialCount) {
+    return new NativeSemaphore{uxInitialCount, uxMaxCount};
+}
+
+void vSemaphoreDelete(SemaphoreHandle_t xSemaphore) {
+    delete xSemaphore;
+}
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t xSemaphore, TickType_t xTicksToWait) {
+    std::unique_lock<std::mutex> lk(schedLock());
+    if (xSemaphore->count == 0 && xTicksToWait > 0) {
+        blockUntil(lk, deadlineFor(xTicksToWait), [xSemaphore] { return xSemaphore->count > 0; });
+    }
+    if (xSemaphore->count == 0) {
+        return pdFALSE;
+    }
+    xSemaphore->count--;
+    return pdTRUE;
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t xSemaphore) {
+    std::unique_lock<std::mutex> lk(schedLock());
+    if (xSemaphore->count >= xSemaphore->maxCount) {
+        return pdFALSE;
+    }
+    xSemaphore->count++;
+    preemptIfNeeded(lk);
+    return pdTRUE;
+}
+
+BaseType_t xSemaphoreGiveFromISR(SemaphoreHandle_t xSemaphore, BaseType_t* pxHigherPriorityTaskWoken) {
+    std::unique_lock<std::mutex> lk(schedLock());
+    if (xSemaphore->count >= xSemaphore->maxCount) {
+        return pdFALSE;
+    }
+    xSemaphore->count++;
+    if (pxHigherPriorityTaskWoken) {
+        *pxHigherPriorityTaskWoken = pdTRUE;
+    }
+    return pdTRUE;
+}
+
+UBaseType_t uxSemaphoreGetCount(SemaphoreHandle_t xSemaphore) {
+    std::unique_lock<std::mutex> lk(schedLock());
+    return xSemaphore->count;
+}
+
+// ---- 模擬器：delay() 與 esp_timer 走排程器 ----
+
+namespace NativeSim {
+
+void sleepMicros(uint64_t us) {
+    std::unique_lock<std::mutex> lk(schedLock());
+    blockUntil(lk, nowMicros() + us, nullptr);
+}
+
+uint32_t notifyTakeUntil(uint64_t deadlineUs) {
+    std::unique_lock<std::mutex> lk(schedLock());
+    NativeTask* me = self();
+    if (me->notifyCount == 0) {
+        blockUntil(lk, deadlineUs, [me] { return me->notifyCount > 0; });
+    }
+    uint32_t value = me->notifyCount;
+    me->notifyCount = 0;
+    return value;
+}
+
+} // namespace NativeSim
@@ -0,0 +1,81 @@
+/**
+ * HardwareSerial.h (native)
+ * Serial 的主機端替身：輸出寫到 stdout，輸入由 NativeSim::serialInject() 注入
+ */
+
+#ifndef NATIVE_HARDWARE_SERIAL_H
+#define NATIVE_HARDWARE_SERIAL_H
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include "WString.h"
+
+#define DEC 10
+#define HEX 16
+#define OCT 8
+#define BIN 2
+
+class Print {
+public:
+    virtual size_t write(uint8_t c) = 0;
+    virtual size_t write(const uint8_t* buffer, size_t size);
+    size_t write(const char* str);
+
+    size_t print(const char* str);
+    size_t print(const String& str);
+    size_t print(char c);
+    size_t print(unsigned char value, int base = DEC);
+    size_t print(int value, int base = DEC);
+    size_t print(unsigned int value, int base = DEC);
+    size_t print(long value, int base = DEC);
+    size_t print(unsigned long value, int base = DEC);
+    size_t print(long long value, int base = DEC);
+    size_t print(unsigned long long value, int base = DEC);
+    size_t print(double value, int digits = 2);
+
+    size_t println();
+    template <typename T> size_t println(const T& value) { size_t n = print(value); return n + println(); }
+    template <typename T> size_t println(const T& value, int format) { size_t n = print(value, format); return n + println(); }
+
+    size_t printf(const char* format, ...) __attribute__((format(printf, 2, 3)));
+
+    virtual ~Print() {}
+
+private:
+    size_t printNumber(unsigned long long value, int base, bool negative);
+};
+
+class HardwareSerial : public Print {
+private:
+    std::string rxBuffer;
+    size_t txBytes;
+
+public:
+    HardwareSerial();
+
+    void begin(unsigned long baud);
+    void end() {}
+    void flush();
+    operator bool() const { return true; }
+
+    int available();
+    int peek();
+    int read();
+    size_t readBytes(uint8_t* buffer, size_t length);
+    String readString();
+    String readStringUntil(char terminator);
+    void setTimeout(unsigned long) {}
+
+    using Print::write;
+    size_t write(uint8_t c) override;
+    size_t write(const uint8_t* buffer, size_t size) override;
+
+    // 主機端：注入接收資料、查詢已送出的位元組數
+    void hostInject(const char* data, size_t length);
+    size_t hostTxBytes() const { return txBytes; }
+};
+
+extern HardwareSerial Serial;
+
+#endif // NATIVE_HARDWARE_SERIAL_H
@@ -0,0 +1,572 @@
+/**
+ * MPU6050.cpp (native)
+ * MPU6050 主機端替身實現
+ */
+
+#include "MPU6050_6Axis_MotionApps20.h"
+#include <Arduino.h>
+#include "NativeSim.h"
+#include "Wire.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <random>
+
+namespace {
+
+NativeSim::ImuState simState = {};
+std::function<void(uint64_t, NativeSim::ImuState&)> simModel;
+float accelBias[3] = {0.0f, 0.0f, 0.0f};
+float gyroBias[3] = {0.0f, 0.0f, 0.0f};
+float accelSigma = 0.0f;
+float gyroSigma = 0.0f;
+uint8_t intPin = NativeSim::NO_PIN;
+std::mt19937 rng(6050);
+
+// 偏移暫存器單位：加速度為 ±16g 刻度，陀螺儀為 ±1000dps 刻度
+const float ACCEL_OFFSET_LSB_PER_G = 2048.0f;
+const float GYRO_OFFSET_LSB_PER_DPS = 32.8f;
+
+NativeSim::ImuState stateAt(uint64_t sampleMicros) {
+    NativeSim::ImuState s = simState;
+    if (simModel) {
+        simModel(sampleMicros, s);
+    }
+    return s;
+}
+
+// DMP 姿態定義：pitch 與 yaw 為右手座標轉角的相反數，roll 相同
+Quaternion quaternionFor(const NativeSim::ImuState& s) {
+    float psi = -s.yaw * 0.5f, theta = -s.pitch * 0.5f, phi = s.roll * 0.5f;
+    float cy = cosf(psi), sy = sinf(psi);
+    float cp = cosf(theta), sp = sinf(theta);
+    float cr = cosf(phi), sr = sinf(phi);
+    return Quaternion(
+        cr * cp * cy + sr * sp * sy,
+        sr * cp * cy - cr * sp * sy,
+        cr * sp * cy + sr * cp * sy,
+        cr * cp * sy - sr * sp * cy);
+}
+
+void gravityFor(const Quaternion& q, float g[3]) {
+    g[0] = 2.0f * (q.x * q.z - q.w * q.y);
+    g[1] = 2.0f * (q.w * q.x + q.y * q.z);
+    g[2] = q.w * q.w - q.x * q.x - q.y * q.y + q.z * q.z;
+}
+
+// 尤拉角變化率轉換為機體角速度 (deg/s)
+void bodyRatesFor(const NativeSim::ImuState& s, float rates[3]) {
+    float theta = -s.pitch, phi = s.roll;
+    float thetaDot = -s.pitchRate, psiDot = -s.yawRate, phiDot = s.rollRate;
+    float p = phiDot - psiDot * sinf(theta);
+    float q = thetaDot * cosf(phi) + psiDot * cosf(theta) * sinf(phi);
+    float r = -thetaDot * sinf(phi) + psiDot * cosf(theta) * cosf(phi);
+    rates[0] = p * 57.2957795f;
+    rates[1] = q * 57.2957795f;
+    rates[2] = r * 57.2957795f;
+}
+
+int16_t saturate16(float v) {
+    if (v > 32767.0f) return 32767;
+    if (v < -32768.0f) return -32768;
+    return (int16_t)lrintf(v);
+}
+
+float gaussian(float sigma) {
+    if (sigma <= 0.0f) return 0.0f;
+    std::normal_distribution<float> dist(0.0f, sigma);
+    return dist(rng);
+}
+
+void putInt32(uint8_t* p, int32_t v) {
+    p[0] = (uint8_t)(v >> 24);
+    p[1] = (uint8_t)(v >> 16);
+    p[2] = (uint8_t)(v >> 8);
+    p[3] = (uint8_t)v;
+}
+
+int16_t getInt16(const uint8_t* p) {
+    return (int16_t)((p[0] << 8) | p[1]);
+}
+
+} // namespace
+
+MPU6050::MPU6050(uint8_t address)
+    : devAddr(address),
+      dmpEnabled(false),
+      dmpInitialized(false),
+      gyroRange(MPU6050_GYRO_FS_250),
+      accelRange(MPU6050_ACCEL_FS_2),
+      dlpfMode(MPU6050_DLPF_BW_256),
+      rateDivider(0),
+      intStatus(0),
+      intEnabled(0),
+      fifoHead(0),
+      fifoCount(0),
+      nextPacketMicros(0),
+      intTimer(nullptr)
+{
+    memset(accelOffset, 0, sizeof(accelOffset));
+    memset(gyroOffset, 0, sizeof(gyroOffset));
+    memset(fifo, 0, sizeof(fifo));
+}
+
+void MPU6050::initialize() {
+    Wire.hostAttachDevice(devAddr);
+    gyroRange = MPU6050_GYRO_FS_250;
+    accelRange = MPU6050_ACCEL_FS_2;
+    NativeSim::i2cTransfer(devAddr, 8);
+}
+
+bool MPU6050::testConnection() {
+    return getDeviceID() == 0x34;
+}
+
+uint8_t MPU6050::getDeviceID() {
+    NativeSim::i2cTransfer(devAddr, 1);
+    NativeSim::i2cTransfer(devAddr, 1);
+    return Wire.hostHasDevice(devAddr) ? 0x34 : 0;
+}
+
+// ---- 設定 ----
+
+void MPU6050::setRate(uint8_t rate) { rateDivider = rate; NativeSim::i2cTransfer(devAddr, 2); restartIntTimer(); }
+uint8_t MPU6050::getRate() { return rateDivider; }
+void MPU6050::setDLPFMode(uint8_t mode) { dlpfMode = mode; NativeSim::i2cTransfer(devAddr, 2); restartIntTimer(); }
+uint8_t MPU6050::getDLPFMode() { return dlpfMode; }
+void MPU6050::setFullScaleGyroRange(uint8_t range) { gyroRange = range & 0x03; NativeSim::i2cTransfer(devAddr, 2); }
+uint8_t MPU6050::getFullScaleGyroRange() { return gyroRange; }
+void MPU6050::setFullScaleAccelRange(uint8_t range) { accelRange = range & 0x03; NativeSim::i2cTransfer(devAddr, 2); }
+uint8_t MPU6050::getFullScaleAccelRange() { return accelRange; }
+void MPU6050::setIntEnabled(uint8_t enabled) { intEnabled = enabled; NativeSim::i2cTransfer(devAddr, 2); restartIntTimer(); }
+uint8_t MPU6050::getIntEnabled() { return intEnabled; }
+
+void MPU6050::setIntDataReadyEnabled(bool enabled) {
+    if (enabled) {
+        intEnabled |= (1 << MPU6050_INTERRUPT_DATA_RDY_BIT);
+    } else {
+        intEnabled &= ~(1 << MPU6050_INTERRUPT_DATA_RDY_BIT);
+    }
+    NativeSim::i2cTransfer(devAddr, 2);
+    restartIntTimer();
+}
+
+uint8_t MPU6050::getIntStatus() {
+    produce();
+    NativeSim::i2cTransfer(devAddr, 1);
+    NativeSim::i2cTransfer(devAddr, 1);
+    uint8_t status = intStatus;
+    intStatus = 0;  // 讀取後清除
+    return status;
+}
+
+// ---- 原始數據 ----
+
+void MPU6050::sampleRaw(uint64_t sampleMicros, int16_t accel[3], int16_t gyro[3]) {
+    NativeSim::ImuState s = stateAt(sampleMicros);
+    Quaternion q = quaternionFor(s);
+
+    float g[3];
+    gravityFor(q, g);
+    float accelLsb = 16384.0f / (float)(1 << accelRange);
+    for (int i = 0; i < 3; i++) {
+        float measured = g[i] + s.linearAccel[i] + accelBias[i] +
+                         accelOffset[i] / ACCEL_OFFSET_LSB_PER_G + gaussian(accelSigma);
+        accel[i] = saturate16(measured * accelLsb);
+    }
+
+    float rates[3];
+    bodyRatesFor(s, rates);
+    float gyroLsb = 131.0f / (float)(1 << gyroRange);
+    for (int i = 0; i < 3; i++) {
+        float measured = rates[i] + gyroBias[i] + gyroOffset[i] / GYRO_OFFSET_LSB_PER_DPS + gaussian(gyroSigma);
+        gyro[i] = saturate16(measured * gyroLsb);
+    }
+}
+
+void MPU6050::getMotion6(int16_t* ax, int16_t* ay, int16_t* az, int16_t* gx, int16_t* gy, int16_t* gz) {
+    // 一次突發讀取 ACCEL_XOUT_H..GYRO_ZOUT_L 共 14 個位元組
+    NativeSim::i2cTransfer(devAddr, 1);
+    NativeSim::i2cTransfer(devAddr, 14);
+    int16_t accel[3], gyro[3];
+    sampleRaw(NativeSim::nowMicros(), accel, gyro);
+    *ax = accel[0]; *ay = accel[1]; *az = accel[2];
+    *gx = gyro[0]; *gy = gyro[1]; *gz = gyro[2];
+}
+
+void MPU6050::getAcceleration(int16_t* x, int16_t* y, int16_t* z) {
+    NativeSim::i2cTransfer(devAddr, 1);
+    NativeSim::i2cTransfer(devAddr, 6);
+    int16_t accel[3], gyro[3];
+    sampleRaw(NativeSim::nowMicros(), accel, gyro);
+    *x = accel[0]; *y = accel[1]; *z = accel[2];
+}
+
+void MPU6050::getRotation(int16_t* x, int16_t* y, int16_t* z) {
+    NativeSim::i2cTransfer(devAddr, 1);
+    NativeSim::i2cTransfer(devAddr, 6);
+    int16_t accel[3], gyro[3];
+    sampleRaw(NativeSim::nowMicros(), accel, gyro);
+    *x = gyro[0]; *y = gyro[1]; *z = gyro[2];
+}
+
+int16_t MPU6050::getTemperature() {
+    NativeSim::i2cTransfer(devAddr, 1);
+    NativeSim::i2cTransfer(devAddr, 2);
+    return saturate16((25.0f - 36.53f) * 340.0f);
+}
+
+// ---- 偏移暫存器 ----
+
+int16_t MPU6050::getXAccelOffset() { return accelOffset[0]; }
+int16_t MPU6050::getYAccelOffset() { return accelOffset[1]; }
+int16_t MPU6050::getZAccelOffset() { return accelOffset[2]; }
+void MPU6050::setXAccelOffset(int16_t offset) { accelOffset[0] = offset; NativeSim::i2cTransfer(devAddr, 3); }
+void MPU6050::setYAccelOffset(int16_t offset) { accelOffset[1] = offset; NativeSim::i2cTransfer(devAddr, 3); }
+void MPU6050::setZAccelOffset(int16_t offset) { accelOffset[2] = offset; NativeSim::i2cTransfer(devAddr, 3); }
+int16_t MPU6050::getXGyroOffset() { return gyroOffset[0]; }
+int16_t MPU6050::getYGyroOffset() { return gyroOffset[1]; }
+int16_t MPU6050::getZGyroOffset() { return gyroOffset[2]; }
+void MPU6050::setXGyroOffset(int16_t offset) { gyroOffset[0] = offset; NativeSim::i2cTransfer(devAddr, 3); }
+void MPU6050::setYGyroOffset(int16_t offset) { gyroOffset[1] = offset; NativeSim::i2cTransfer(devAddr, 3); }
+void MPU6050::setZGyroOffset(int16_t offset) { gyroOffset[2] = offset; NativeSim::i2cTransfer(devAddr, 3); }
+
+void MPU6050::CalibrateAccel(uint8_t loops) {
+    // 目標：X/Y 為 0，Z 為 +1g；每輪約讀取 100 筆樣本
+    int16_t accel[3], gyro[3];
+    for (uint8_t l = 0; l < loops; l++) {
+        sampleRaw(NativeSim::nowMicros(), accel, gyro);
+        float accelLsb = 16384.0f / (float)(1 << accelRange);
+        float target[3] = {0.0f, 0.0f, 1.0f};
+        for (int i = 0; i < 3; i++) {
+            float error = accel[i] / accelLsb - target[i];
+            accelOffset[i] = saturate16(accelOffset[i] - error * ACCEL_OFFSET_LSB_PER_G);
+        }
+        NativeSim::i2cTransfer(devAddr, 100 * 6);
+        NativeSim::advanceMicros(100000);
+    }
+}
+
+void MPU6050::CalibrateGyro(uint8_t loops) {
+    int16_t accel[3], gyro[3];
+    for (uint8_t l = 0; l < loops; l++) {
+        sampleRaw(NativeSim::nowMicros(), accel, gyro);
+        float gyroLsb = 131.0f / (float)(1 << gyroRange);
+        for (int i = 0; i < 3; i++) {
+            float error = gyro[i] / gyroLsb;
+            gyroOffset[i] = saturate16(gyroOffset[i] - error * GYRO_OFFSET_LSB_PER_DPS);
+        }
+        NativeSim::i2cTransfer(devAddr, 100 * 6);
+        NativeSim::advanceMicros(100000);
+    }
+}
+
+void MPU6050::PrintActiveOffsets() {
+    printf("\t\t\tX Accel  Y Accel  Z Accel   X Gyro   Y Gyro   Z Gyro\n//OFFSETS   ");
+    printf("%6d,  %6d,  %6d,  %6d,  %6d,  %6d\n",
+           accelOffset[0], accelOffset[1], accelOffset[2], gyroOffset[0], gyroOffset[1], gyroOffset[2]);
+}
+
+// ---- FIFO ----
+
+uint32_t MPU6050::samplePeriodMicros() const {
+    // DLPF 關閉 (0 或 7) 時陀螺儀輸出率為 8 kHz，否則為 1 kHz
+    uint32_t baseMicros = (dlpfMode == 0 || dlpfMode == 7) ? 125u : 1000u;
+    return baseMicros * (1u + rateDivider);
+}
+
+uint32_t MPU6050::dmpPeriodMicros() const {
+    // 取樣率 = 1kHz / (1 + rateDivider)，DMP 再以除數 2 輸出封包
+    return 2000u * (1u + rateDivider);
+}
+
+void MPU6050::pushPacket(uint64_t sampleMicros) {
+    NativeSim::ImuState s = stateAt(sampleMicros);
+    Quaternion q = quaternionFor(s);
+    int16_t accel[3], gyro[3];
+    sampleRaw(sampleMicros, accel, gyro);
+
+    uint8_t packet[MPU6050_DMP_PACKET_SIZE];
+    memset(packet, 0, sizeof(packet));
+    putInt32(&packet[0], (int32_t)lrintf(q.w * 1073741824.0f));
+    putInt32(&packet[4], (int32_t)lrintf(q.x * 1073741824.0f));
+    putInt32(&packet[8], (int32_t)lrintf(q.y * 1073741824.0f));
+    putInt32(&packet[12], (int32_t)lrintf(q.z * 1073741824.0f));
+    for (int i = 0; i < 3; i++) {
+        putInt32(&packet[16 + i * 4], (int32_t)gyro[i] << 16);
+        putInt32(&packet[28 + i * 4], (int32_t)accel[i] << 16);
+    }
+
+    for (int i = 0; i < MPU6050_DMP_PACKET_SIZE; i++) {
+        if (fifoCount == MPU6050_FIFO_SIZE) {
+            // 與晶片相同：FIFO 滿時覆寫最舊的位元組
+            fifoHead = (fifoHead + 1) % MPU6050_FIFO_SIZE;
+            fifoCount--;
+            intStatus |= (1 << MPU6050_INTERRUPT_FIFO_OFLOW_BIT);
+        }
+        fifo[(fifoHead + fifoCount) % MPU6050_FIFO_SIZE] = packet[i];
+        fifoCount++;
+    }
+    intStatus |= (1 << MPU6050_INTERRUPT_DMP_INT_BIT) | (1 << MPU6050_INTERRUPT_DATA_RDY_BIT);
+}
+
+void MPU6050::produce() {
+    if (!dmpEnabled) return;
+
+    uint64_t now = NativeSim::nowMicros();
+    uint32_t period = dmpPeriodMicros();
+    if (nextPacketMicros + (uint64_t)period * 32 < now) {
+        // 長時間未讀取：FIFO 只容得下約 24 個封包，跳過更早的部分
+        uint64_t skipped = (now - nextPacketMicros) / period - 32;
+        nextPacketMicros += skipped * period;
+        intStatus |= (1 << MPU6050_INTERRUPT_FIFO_OFLOW_BIT);
+    }
+    while (nextPacketMicros <= now) {
+        pushPacket(nextPacketMicros);
+        nextPacketMicros += period;
+    }
+}
+
+uint16_t MPU6050::getFIFOCount() {
+    produce();
+    NativeSim::i2cTransfer(devAddr, 1);
+    NativeSim::i2cTransfer(devAddr, 2);
+    return fifoCount;
+}
+
+void MPU6050::getFIFOBytes(uint8_t* data, uint8_t length) {
+    NativeSim::i2cTransfer(devAddr, 1);
+    NativeSim::i2cTransfer(devAddr, length);
+    for (uint8_t i = 0; i < length; i++) {
+        if (fifoCount == 0) {
+            data[i] = 0;
+            continue;
+        }
+        data[i] = fifo[fifoHead];
+        fifoHead = (fifoHead + 1) % MPU6050_FIFO_SIZE;
+        fifoCount--;
+    }
+}
+
+void MPU6050::resetFIFO() {
+    NativeSim::i2cTransfer(devAddr, 2);
+    fifoHead = 0;
+    fifoCount = 0;
+    nextPacketMicros = NativeSim::nowMicros() + dmpPeriodMicros();
+    restartIntTimer();
+}
+
+// ---- INT 腳位 ----
+
+// 以與封包相同的週期啟動計時器，讓 INT 脈衝與封包寫入 FIFO 的時間一致；
+// DMP 停用時若啟用了數據就緒中斷，則以取樣週期觸發
+void MPU6050::restartIntTimer() {
+    bool dataReadyInt = intEnabled & (1 << MPU6050_INTERRUPT_DATA_RDY_BIT);
+    if (intPin == NativeSim::NO_PIN || (!dmpEnabled && !dataReadyInt)) {
+        if (intTimer && esp_timer_is_active(intTimer)) {
+            esp_timer_stop(intTimer);
+        }
+        return;
+    }
+    if (!intTimer) {
+        esp_timer_create_args_t args = {};
+        args.callback = intTimerCallback;
+        args.arg = this;
+        args.name = "mpu6050_int";
+        esp_timer_create(&args, &intTimer);
+    }
+    if (esp_timer_is_active(intTimer)) {
+        esp_timer_stop(intTimer);
+    }
+    esp_timer_start_periodic(intTimer, dmpEnabled ? dmpPeriodMicros() : samplePeriodMicros());
+}
+
+void MPU6050::intTimerCallback(void* arg) {
+    MPU6050* self = static_cast<MPU6050*>(arg);
+    self->produce();
+    uint8_t mask = (1 << MPU6050_INTERRUPT_DMP_INT_BIT) | (1 << MPU6050_INTERRUPT_DATA_RDY_BIT);
+    if ((self->intEnabled & mask) && intPin != NativeSim::NO_PIN) {
+        // 實際晶片預設輸出 50us 的高電位脈衝，這裡只需要上升緣
+        NativeSim::setInputLevel(intPin, HIGH);
+        NativeSim::setInputLevel(intPin, LOW);
+    }
+}
+
+void MPU6050::setFIFOEnabled(bool enabled) {
+    (void)enabled;
+    NativeSim::i2cTransfer(devAddr, 2);
+}
+
+// ---- DMP ----
+
+uint8_t MPU6050::dmpInitialize() {
+    // 實際的 MotionApps 2.0 會上傳約 1.9 KB 韌體並設定 ±2000dps、200Hz 取樣
+    NativeSim::i2cTransfer(devAddr, 1929);
+    gyroRange = MPU6050_GYRO_FS_2000;
+    accelRange = MPU6050_ACCEL_FS_2;
+    rateDivider = 4;
+    dlpfMode = MPU6050_DLPF_BW_42;
+    intEnabled = (1 << MPU6050_INTERRUPT_FIFO_OFLOW_BIT) | (1 << MPU6050_INTERRUPT_DMP_INT_BIT);
+    dmpInitialized = true;
+    resetFIFO();
+    return 0;
+}
+
+void MPU6050::setDMPEnabled(bool enabled) {
+    NativeSim::i2cTransfer(devAddr, 2);
+    bool wasEnabled = dmpEnabled;
+    dmpEnabled = enabled && dmpInitialized;
+    if (dmpEnabled && !wasEnabled) {
+        resetFIFO();
+    } else if (!dmpEnabled && wasEnabled) {
+        restartIntTimer();
+    }
+}
+
+bool MPU6050::getDMPEnabled() {
+    return dmpEnabled;
+}
+
+uint16_t MPU6050::dmpGetFIFOPacketSize() {
+    return MPU6050_DMP_PACKET_SIZE;
+}
+
+uint8_t MPU6050::dmpGetCurrentFIFOPacket(uint8_t* data) {
+    uint16_t count = getFIFOCount();
+    if (count < MPU6050_DMP_PACKET_SIZE) {
+        return 0;
+    }
+
+    if (count % MPU6050_DMP_PACKET_SIZE != 0) {
+        // 封包邊界已遺失 (溢位)，重置 FIFO
+        resetFIFO();
+        return 0;
+    }
+
+    // 丟棄較舊的封包，只保留最新一個
+    uint8_t discard[32];
+    while (count > MPU6050_DMP_PACKET_SIZE) {
+        uint16_t n = count - MPU6050_DMP_PACKET_SIZE;
+        uint8_t chunk = n > sizeof(discard) ? sizeof(discard) : (uint8_t)n;
+        getFIFOBytes(discard, chunk);
+        count -= chunk;
+    }
+    getFIFOBytes(data, MPU6050_DMP_PACKET_SIZE);
+    return 1;
+}
+
+uint8_t MPU6050::dmpGetQuaternion(int16_t* data, const uint8_t* packet) {
+    if (!packet) return 1;
+    data[0] = getInt16(&packet[0]);
+    data[1] = getInt16(&packet[4]);
+    data[2] = getInt16(&packet[8]);
+    data[3] = getInt16(&packet[12]);
+    return 0;
+}
+
+uint8_t MPU6050::dmpGetQuaternion(Quaternion* q, const uint8_t* packet) {
+    int16_t qI[4] = {0, 0, 0, 0};
+    uint8_t status = dmpGetQuaternion(qI, packet);
+    if (status == 0) {
+        q->w = (float)qI[0] / 16384.0f;
+        q->x = (float)qI[1] / 16384.0f;
+        q->y = (float)qI[2] / 16384.0f;
+        q->z = (float)qI[3] / 16384.0f;
+    }
+    return status;
+}
+
+uint8_t MPU6050::dmpGetAccel(int16_t* data, const uint8_t* packet) {
+    if (!packet) return 1;
+    data[0] = getInt16(&packet[28]);
+    data[1] = getInt16(&packet[32]);
+    data[2] = getInt16(&packet[36]);
+    return 0;
+}
+
+uint8_t MPU6050::dmpGetAccel(VectorInt16* v, const uint8_t* packet) {
+    int16_t a[3] = {0, 0, 0};
+    uint8_t status = dmpGetAccel(a, packet);
+    v->x = a[0];
+    v->y = a[1];
+    v->z = a[2];
+    return status;
+}
+
+uint8_t MPU6050::dmpGetGyro(int16_t* data, const uint8_t* packet) {
+    if (!packet) return 1;
+    data[0] = getInt16(&packet[16]);
+    data[1] = getInt16(&packet[20]);
+    data[2] = getInt16(&packet[24]);
+    return 0;
+}
+
+uint8_t MPU6050::dmpGetGyro(VectorInt16* v, const uint8_t* packet) {
+    int16_t g[3] = {0, 0, 0};
+    uint8_t status = dmpGetGyro(g, packet);
+    v->x = g[0];
+    v->y = g[1];
+    v->z = g[2];
+    return status;
+}
+
+uint8_t MPU6050::dmpGetGravity(VectorFloat* v, Quaternion* q) {
+    v->x = 2 * (q->x * q->z - q->w * q->y);
+    v->y = 2 * (q->w * q->x + q->y * q->z);
+    v->z = q->w * q->w - q->x * q->x - q->y * q->y + q->z * q->z;
+    return 0;
+}
+
+uint8_t MPU6050::dmpGetYawPitchRoll(float* data, Quaternion* q, VectorFloat* gravity) {
+    // 與 MotionApps 2.0 相同的公式
+    data[0] = atan2f(2 * q->x * q->y - 2 * q->w * q->z, 2 * q->w * q->w + 2 * q->x * q->x - 1);
+    data[1] = atan2f(gravity->x, sqrtf(gravity->y * gravity->y + gravity->z * gravity->z));
+    data[2] = atan2f(gravity->y, gravity->z);
+    if (gravity->z < 0) {
+        if (data[1] > 0) {
+            data[1] = (float)M_PI - data[1];
+        } else {
+            data[1] = -(float)M_PI - data[1];
+        }
+    }
+    return 0;
+}
+
+// ---- 模擬器控制 ----
+
+namespace NativeSim {
+
+void setImuState(const ImuState& state) {
+    simState = state;
+}
+
+ImuState imuState() {
+    return simState;
+}
+
+void setImuModel(std::function<void(uint64_t nowUs, ImuState& state)> model) {
+    simModel = model;
+}
+
+void setImuBias(const float accelBiasG[3], const float gyroBiasDps[3]) {
+    for (int i = 0; i < 3; i++) {
+        accelBias[i] = accelBiasG ? accelBiasG[i] : 0.0f;
+        gyroBias[i] = gyroBiasDps ? gyroBiasDps[i] : 0.0f;
+    }
+}
+
+void setImuNoise(float accelSigmaG, float gyroSigmaDps) {
+    accelSigma = accelSigmaG;
+    gyroSigma = gyroSigmaDps;
+}
+
+void setImuIntPin(uint8_t pin) {
+    intPin = pin;
+}
+
+uint8_t imuIntPin() {
+    return intPin;
+}
+
+} // namespace NativeSim
@@ -0,0 +1,144 @@
+/**
+ * MPU6050_6Axis_MotionApps20.h (native)
+ * I2Cdevlib MPU6050 (含 MotionApps 2.0 DMP) 的主機端替身
+ *
+ * 功能概述:
+ * - 依 NativeSim 設定的真實姿態產生原始加速度/陀螺儀數據與 DMP 封包
+ * - DMP 封包 (42 位元組，佈局與 MotionApps 2.0 相同) 依虛擬時間以固定速率寫入 1 KB FIFO，
+ *   FIFO 滿時與實際晶片一樣覆寫最舊資料並設置溢位旗標
+ * - 以 NativeSim::setImuIntPin() 接上 INT 腳位後，每個 DMP 封包寫入 FIFO 時會在該腳位產生上升緣；
+ *   DMP 停用且啟用數據就緒中斷時，改為每個取樣 (依 DLPF 與取樣率除數) 產生一次
+ * - 偏移暫存器與 CalibrateAccel()/CalibrateGyro() 會抵消 NativeSim 設定的零偏
+ * - 每次讀取都以 NativeSim::i2cTransfer() 計入匯流排時間
+ */
+
+#ifndef NATIVE_MPU6050_6AXIS_MOTIONAPPS20_H
+#define NATIVE_MPU6050_6AXIS_MOTIONAPPS20_H
+
+#include <cstdint>
+#include "helper_3dmath.h"
+#include "esp_timer.h"
+
+#define MPU6050_DEFAULT_ADDRESS 0x68
+
+#define MPU6050_GYRO_FS_250 0x00
+#define MPU6050_GYRO_FS_500 0x01
+#define MPU6050_GYRO_FS_1000 0x02
+#define MPU6050_GYRO_FS_2000 0x03
+
+#define MPU6050_ACCEL_FS_2 0x00
+#define MPU6050_ACCEL_FS_4 0x01
+#define MPU6050_ACCEL_FS_8 0x02
+#define MPU6050_ACCEL_FS_16 0x03
+
+#define MPU6050_DLPF_BW_256 0x00
+#define MPU6050_DLPF_BW_188 0x01
+#define MPU6050_DLPF_BW_98 0x02
+#define MPU6050_DLPF_BW_42 0x03
+#define MPU6050_DLPF_BW_20 0x04
+#define MPU6050_DLPF_BW_10 0x05
+#define MPU6050_DLPF_BW_5 0x06
+
+#define MPU6050_INTERRUPT_FIFO_OFLOW_BIT 4
+#define MPU6050_INTERRUPT_DMP_INT_BIT 1
+#define MPU6050_INTERRUPT_DATA_RDY_BIT 0
+
+#define MPU6050_FIFO_SIZE 1024
+#define MPU6050_DMP_PACKET_SIZE 42
+
+class MPU6050 {
+private:
+    uint8_t devAddr;
+    bool dmpEnabled;
+    bool dmpInitialized;
+    uint8_t gyroRange;
+    uint8_t accelRange;
+    uint8_t dlpfMode;
+    uint8_t rateDivider;
+    uint8_t intStatus;
+    uint8_t intEnabled;
+
+    int16_t accelOffset[3];
+    int16_t gyroOffset[3];
+
+    uint8_t fifo[MPU6050_FIFO_SIZE];
+    uint16_t fifoHead;
+    uint16_t fifoCount;
+    uint64_t nextPacketMicros;
+    esp_timer_handle_t intTimer;
+
+    void produce();
+    void restartIntTimer();
+    static void intTimerCallback(void* arg);
+    void pushPacket(uint64_t sampleMicros);
+    void sampleRaw(uint64_t sampleMicros, int16_t accel[3], int16_t gyro[3]);
+    uint32_t dmpPeriodMicros() const;
+    uint32_t samplePeriodMicros() const;
+
+public:
+    MPU6050(uint8_t address = MPU6050_DEFAULT_ADDRESS);
+
+    void initialize();
+    bool testConnection();
+    uint8_t getDeviceID();
+
+    // 設定
+    void setRate(uint8_t rate);
+    uint8_t getRate();
+    void setDLPFMode(uint8_t mode);
+    uint8_t getDLPFMode();
+    void setFullScaleGyroRange(uint8_t range);
+    uint8_t getFullScaleGyroRange();
+    void setFullScaleAccelRange(uint8_t range);
+    uint8_t getFullScaleAccelRange();
+    void setIntEnabled(uint8_t enabled);
+    uint8_t getIntEnabled();
+    void setIntDataReadyEnabled(bool enabled);
+    uint8_t getIntStatus();
+
+    // 原始數據
+    void getMotion6(int16_t* ax, int16_t* ay, int16_t* az, int16_t* gx, int16_t* gy, int16_t* gz);
+    void getAcceleration(int16_t* x, int16_t* y, int16_t* z);
+    void getRotation(int16_t* x, int16_t* y, int16_t* z);
+    int16_t getTemperature();
+
+    // 偏移暫存器
+    int16_t getXAccelOffset();
+    int16_t getYAccelOffset();
+    int16_t getZAccelOffset();
+    void setXAccelOffset(int16_t offset);
+    void setYAccelOffset(int16_t offset);
+    void setZAccelOffset(int16_t offset);
+    int16_t getXGyroOffset();
+    int16_t getYGyroOffset();
+    int16_t getZGyroOffset();
+    void setXGyroOffset(int16_t offset);
+    void setYGyroOffset(int16_t offset);
+    void setZGyroOffset(int16_t offset);
+    void CalibrateAccel(uint8_t loops = 15);
+    void CalibrateGyro(uint8_t loops = 15);
+    void PrintActiveOffsets();
+
+    // FIFO
+    uint16_t getFIFOCount();
+    void getFIFOBytes(uint8_t* data, uint8_t length);
+    void resetFIFO();
+    void setFIFOEnabled(bool enabled);
+
+    // DMP (MotionApps 2.0)
+    uint8_t dmpInitialize();
+    void setDMPEnabled(bool enabled);
+    bool getDMPEnabled();
+    uint16_t dmpGetFIFOPacketSize();
+    uint8_t dmpGetCurrentFIFOPacket(uint8_t* data);
+    uint8_t dmpGetQuaternion(int16_t* data, const uint8_t* packet = 0);
+    uint8_t dmpGetQuaternion(Quaternion* q, const uint8_t* packet = 0);
+    uint8_t dmpGetAccel(int16_t* data, const uint8_t* packet = 0);
+    uint8_t dmpGetAccel(VectorInt16* v, const uint8_t* packet = 0);
+    uint8_t dmpGetGyro(int16_t* data, const uint8_t* packet = 0);
+    uint8_t dmpGetGyro(VectorInt16* v, const uint8_t* packet = 0);
+    uint8_t dmpGetGravity(VectorFloat* v, Quaternion* q);
+    uint8_t dmpGetYawPitchRoll(float* data, Quaternion* q, VectorFloat* gravity);
+};
+
+#endif // NATIVE_MPU6050_6AXIS_MOTIONAPPS20_H
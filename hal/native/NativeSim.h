@@ -0,0 +1,132 @@
+/**
+ * NativeSim.h
+ * 主機端模擬器控制介面
+ *
+ * 功能概述:
+ * - 虛擬時鐘：millis()/micros() 由模擬器推進，delay() 不會真的睡眠，
+ *   因此控制迴路可以比實時更快地執行；需要時可切換為實時模式
+ * - GPIO：查詢輸出位準與 PWM 佔空比，注入輸入位準（會觸發已掛載的中斷）
+ * - I2C：累計每個位址的傳輸位元組數，並依時脈換算成匯流排佔用時間
+ * - 程式流程：要求 native_main 結束主循環
+ */
+
+#ifndef NATIVE_SIM_H
+#define NATIVE_SIM_H
+
+#include <cstdint>
+#include <cstddef>
+#include <functional>
+
+namespace NativeSim {
+
+/** 表示未連接的腳位 */
+const uint8_t NO_PIN = 0xFF;
+
+// ---- 時鐘 ----
+
+/** 目前虛擬時間 (us) */
+uint64_t nowMicros();
+
+/** 推進虛擬時間 (實時模式下無作用) */
+void advanceMicros(uint64_t us);
+
+/** 目前任務睡眠指定時間，期間其他 FreeRTOS 任務可以執行 (delay() 使用) */
+void sleepMicros(uint64_t us);
+
+/** 目前任務等待任務通知，直到收到通知或虛擬時間到達 deadlineUs；回傳並清除通知計數 */
+uint32_t notifyTakeUntil(uint64_t deadlineUs);
+
+/** 切換實時模式：true 時 micros() 取系統單調時鐘，delay() 真的睡眠 */
+void setRealTime(bool realTime);
+bool isRealTime();
+
+// ---- GPIO ----
+
+/** 注入輸入腳位位準，若位準改變且有掛載中斷則同步呼叫 ISR */
+void setInputLevel(uint8_t pin, int level);
+
+/** 讀取腳位目前位準 (輸出腳位為最後一次 digitalWrite 的值) */
+int pinLevel(uint8_t pin);
+
+/** 讀取腳位目前 PWM 佔空比與解析度 (analogWrite 視為 8 位元) */
+uint32_t pinDuty(uint8_t pin);
+uint8_t pinDutyBits(uint8_t pin);
+
+/** 腳位目前的佔空比 (0.0 ~ 1.0)：analogWrite 以 255 為滿，LEDC 以 2^bits 為滿 */
+double pinDutyFraction(uint8_t pin);
+
+/** 讀取 LEDC 通道頻率 (Hz)，未設定時為 0 */
+uint32_t ledcFrequency(uint8_t channel);
+
+/** 腳位寫入次數 (digitalWrite/analogWrite/ledcWrite 皆計入) */
+uint32_t pinWriteCount(uint8_t pin);
+
+/** 腳位是否已掛載中斷 */
+bool hasInterrupt(uint8_t pin);
+
+/** 登記腳位位準變化的監聽者 (供 PCNT 等周邊替身使用)，位準改變時在 setInputLevel 中同步呼叫 */
+void addPinListener(uint8_t pin, std::function<void(uint8_t pin, int level)> listener);
+
+// ---- I2C ----
+
+/**
+ * 記錄一次 I2C 傳輸；呼叫端依該匯流排目前的時脈阻塞對應的時間，期間其他任務可執行
+ * @param bus 控制器編號 (0 = Wire, 1 = Wire1)，兩個控制器各自佔用，互不阻塞
+ */
+void i2cTransfer(uint8_t address, size_t bytes, uint8_t bus = 0);
+
+/** 指定位址累計傳輸的位元組數 (含位址位元組) */
+uint32_t i2cBytes(uint8_t address);
+
+/** 全部位址累計的匯流排佔用時間 (us) */
+uint64_t i2cBusyMicros();
+
+void setI2CClock(uint32_t hz, uint8_t bus = 0);
+uint32_t i2cClock(uint8_t bus = 0);
+
+// ---- MPU6050 ----
+
+/**
+ * MPU6050 替身所模擬的真實姿態
+ * 角度定義與 DMP 的 dmpGetYawPitchRoll() 相同 (弧度)，角速度為對應的尤拉角變化率 (rad/s)
+ */
+struct ImuState {
+    float yaw;
+    float pitch;
+    float roll;
+    float yawRate;
+    float pitchRate;
+    float rollRate;
+    float linearAccel[3];   // 除重力以外的線加速度 (g)，感測器座標
+};
+
+/** 設定目前姿態 (未設定模型時使用) */
+void setImuState(const ImuState& state);
+ImuState imuState();
+
+/** 設定動態模型：每次產生取樣時以取樣時間 (us) 呼叫，由模型填入當下姿態 */
+void setImuModel(std::function<void(uint64_t nowUs, ImuState& state)> model);
+
+/** 設定感測器零偏：加速度 (g) 與陀螺儀 (deg/s)，校準會以偏移暫存器抵消 */
+void setImuBias(const float accelBiasG[3], const float gyroBiasDps[3]);
+
+/** 設定原始數據的白雜訊標準差：加速度 (g) 與陀螺儀 (deg/s) */
+void setImuNoise(float accelSigmaG, float gyroSigmaDps);
+
+/** 設定 MPU6050 INT 接到的輸入腳位 (NO_PIN 表示未連接)，需在 DMP 啟用前設定 */
+void setImuIntPin(uint8_t pin);
+uint8_t imuIntPin();
+
+// ---- 程式流程 ----
+
+/** 要求 native_main 在本次 loop() 返回後結束 */
+void requestExit(int code = 0);
+bool exitRequested();
+int exitCode();
+
+/** 重設所有模擬狀態 (時鐘、腳位、I2C 計數) */
+void reset();
+
+} // namespace NativeSim
+
+#endif // NATIVE_SIM_H
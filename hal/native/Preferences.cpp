@@ -0,0 +1,149 @@
+/**
+ * Preferences.cpp (native)
+ * NVS Preferences 主機端替身實現
+ */
+
+#include "Preferences.h"
+
+#include <cstring>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace {
+
+typedef std::map<std::string, std::vector<uint8_t>> Namespace;
+
+std::map<std::string, Namespace>& storage() {
+    static std::map<std::string, Namespace> nvs;
+    return nvs;
+}
+
+uint32_t readCount = 0;
+uint32_t writeCount = 0;
+
+} // namespace
+
+Preferences::Preferences() : opened(false), readOnly(false) {}
+
+Preferences::~Preferences() {
+    end();
+}
+
+bool Preferences::begin(const char* name, bool ro) {
+    if (!name) return false;
+    ns = name;
+    opened = true;
+    readOnly = ro;
+    return true;
+}
+
+void Preferences::end() {
+    opened = false;
+}
+
+bool Preferences::clear() {
+    if (!opened || readOnly) return false;
+    storage()[ns.c_str()].clear();
+    writeCount++;
+    return true;
+}
+
+bool Preferences::remove(const char* key) {
+    if (!opened || readOnly || !key) return false;
+    writeCount++;
+    return storage()[ns.c_str()].erase(key) > 0;
+}
+
+bool Preferences::isKey(const char* key) {
+    if (!opened || !key) return false;
+    readCount++;
+    Namespace& space = storage()[ns.c_str()];
+    return space.find(key) != space.end();
+}
+
+bool Preferences::getRaw(const char* key, void* value, size_t len) {
+    if (!opened || !key) return false;
+    readCount++;
+    Namespace& space = storage()[ns.c_str()];
+    Namespace::iterator it = space.find(key);
+    if (it == space.end() || it->second.size() != len) return false;
+    memcpy(value, it->second.data(), len);
+    return true;
+}
+
+size_t Preferences::putRaw(const char* key, const void* value, size_t len) {
+    if (!opened || readOnly || !key) return 0;
+    writeCount++;
+    const uint8_t* bytes = (const uint8_t*)value;
+    storage()[ns.c_str()][key].assign(bytes, bytes + len);
+    return len;
+}
+
+size_t Preferences::putBool(const char* key, bool value) { uint8_t v = value ? 1 : 0; return putRaw(key, &v, 1); }
+size_t Preferences::putShort(const char* key, int16_t value) { return putRaw(key, &value, sizeof(value)); }
+size_t Preferences::putUShort(const char* key, uint16_t value) { return putRaw(key, &value, sizeof(value)); }
+size_t Preferences::putInt(const char* key, int32_t value) { return putRaw(key, &value, sizeof(value)); }
+size_t Preferences::putUInt(const char* key, uint32_t value) { return putRaw(key, &value, sizeof(value)); }
+size_t Preferences::putFloat(const char* key, float value) { return putRaw(key, &value, sizeof(value)); }
+size_t Preferences::putBytes(const char* key, const void* value, size_t len) { return putRaw(key, value, len); }
+
+bool Preferences::getBool(const char* key, bool defaultValue) {
+    uint8_t v;
+    return getRaw(key, &v, 1) ? v != 0 : defaultValue;
+}
+
+int16_t Preferences::getShort(const char* key, int16_t defaultValue) {
+    int16_t v;
+    return getRaw(key, &v, sizeof(v)) ? v : defaultValue;
+}
+
+uint16_t Preferences::getUShort(const char* key, uint16_t defaultValue) {
+    uint16_t v;
+    return getRaw(key, &v, sizeof(v)) ? v : defaultValue;
+}
+
+int32_t Preferences::getInt(const char* key, int32_t defaultValue) {
+    int32_t v;
+    return getRaw(key, &v, sizeof(v)) ? v : defaultValue;
+}
+
+uint32_t Preferences::getUInt(const char* key, uint32_t defaultValue) {
+    uint32_t v;
+    return getRaw(key, &v, sizeof(v)) ? v : defaultValue;
+}
+
+float Preferences::getFloat(const char* key, float defaultValue) {
+    float v;
+    return getRaw(key, &v, sizeof(v)) ? v : defaultValue;
+}
+
+size_t Preferences::getBytesLength(const char* key) {
+    if (!opened || !key) return 0;
+    readCount++;
+    Namespace& space = storage()[ns.c_str()];
+    Namespace::iterator it = space.find(key);
+    return it == space.end() ? 0 : it->second.size();
+}
+
+size_t Preferences::getBytes(const char* key, void* buf, size_t maxLen) {
+    if (!opened || !key || !buf) return 0;
+    readCount++;
+    Namespace& space = storage()[ns.c_str()];
+    Namespace::iterator it = space.find(key);
+    if (it == space.end() || it->second.size() > maxLen) return 0;
+    memcpy(buf, it->second.data(), it->second.size());
+    return it->second.size();
+}
+
+uint32_t Preferences::hostReadCount() {
+    return readCount;
+}
+
+uint32_t Preferences::hostWriteCount() {
+    return writeCount;
+}
+
+void Preferences::hostErase() {
+    storage().clear();
+}
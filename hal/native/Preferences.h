@@ -0,0 +1,59 @@
+/**
+ * Preferences.h (native)
+ * NVS Preferences 的主機端替身，資料保存在行程內的記憶體中
+ *
+ * 同一命名空間在不同 Preferences 物件之間共享，模擬 NVS 的持久性；
+ * hostReadCount()/hostWriteCount() 可用來確認熱路徑是否觸及快閃記憶體。
+ */
+
+#ifndef NATIVE_PREFERENCES_H
+#define NATIVE_PREFERENCES_H
+
+#include <cstdint>
+#include <cstddef>
+#include "WString.h"
+
+class Preferences {
+private:
+    String ns;
+    bool opened;
+    bool readOnly;
+
+    bool getRaw(const char* key, void* value, size_t len);
+    size_t putRaw(const char* key, const void* value, size_t len);
+
+public:
+    Preferences();
+    ~Preferences();
+
+    bool begin(const char* name, bool readOnly = false);
+    void end();
+
+    bool clear();
+    bool remove(const char* key);
+    bool isKey(const char* key);
+
+    size_t putBool(const char* key, bool value);
+    size_t putShort(const char* key, int16_t value);
+    size_t putUShort(const char* key, uint16_t value);
+    size_t putInt(const char* key, int32_t value);
+    size_t putUInt(const char* key, uint32_t value);
+    size_t putFloat(const char* key, float value);
+    size_t putBytes(const char* key, const void* value, size_t len);
+
+    bool getBool(const char* key, bool defaultValue = false);
+    int16_t getShort(const char* key, int16_t defaultValue = 0);
+    uint16_t getUShort(const char* key, uint16_t defaultValue = 0);
+    int32_t getInt(const char* key, int32_t defaultValue = 0);
+    uint32_t getUInt(const char* key, uint32_t defaultValue = 0);
+    float getFloat(const char* key, float defaultValue = 0.0f);
+    size_t getBytesLength(const char* key);
+    size_t getBytes(const char* key, void* buf, size_t maxLen);
+
+    // 主機端：累計的 NVS 讀寫次數 (所有命名空間)
+    static uint32_t hostReadCount();
+    static uint32_t hostWriteCount();
+    static void hostErase();
+};
+
+#endif // NATIVE_PREFERENCES_H
@@ -0,0 +1,278 @@
+/**
+ * U8g2lib.cpp (native)
+ * 記憶體內 SH1106 顯示裝置實現
+ */
+
+#include "U8g2lib.h"
+#include "Wire.h"
+#include "NativeSim.h"
+
+#include <cstdlib>
+#include <cstring>
+
+const u8g2_cb_t u8g2_cb_r0 = {0};
+
+// [0] 字元寬度 (含 1 像素間距), [1] 基線以上高度
+const uint8_t u8g2_font_ncenB08_tr[] = {7, 8};
+const uint8_t u8g2_font_ncenB10_tr[] = {9, 10};
+const uint8_t u8g2_font_ncenB14_tr[] = {12, 14};
+const uint8_t u8g2_font_5x7_tr[] = {5, 7};
+const uint8_t u8g2_font_6x10_tr[] = {6, 9};
+
+namespace {
+
+// SH1106 I2C：每筆資料傳輸最多 32 位元組 (含 1 個控制位元組)
+const size_t I2C_CHUNK_DATA = 31;
+
+// 未呼叫 setBusClock() 時 U8g2 使用的 SH1106 時脈
+const uint32_t DEFAULT_BUS_CLOCK = 400000;
+
+} // namespace
+
+U8G2_SH1106_128X64_NONAME_F_HW_I2C::U8G2_SH1106_128X64_NONAME_F_HW_I2C(
+    const u8g2_cb_t* rotation, uint8_t reset, uint8_t clock, uint8_t data)
+    : busNum(0),
+      font(u8g2_font_ncenB08_tr),
+      drawColor(1),
+      i2cAddress(0x3C << 1),
+      busClock(0),
+      powerSave(false),
+      bytesSent(0),
+      transfers(0)
+{
+    u8x8.display = this;
+    (void)rotation;
+    (void)reset;
+    (void)clock;
+    (void)data;
+    memset(buffer, 0, sizeof(buffer));
+    memset(displayRam, 0, sizeof(displayRam));
+}
+
+bool U8G2_SH1106_128X64_NONAME_F_HW_I2C::begin() {
+    // 與實際 U8g2 相同，begin() 會啟動 Wire (已啟動時沿用原本的腳位)
+    TwoWire& wire = busNum ? Wire1 : Wire;
+    if (!wire.hostStarted()) {
+        wire.begin();
+    }
+    wire.hostAttachDevice(i2cAddress >> 1);
+
+    // 初始化指令序列約 25 個位元組
+    startTransfer();
+    NativeSim::i2cTransfer(i2cAddress >> 1, 26, busNum);
+    bytesSent += 26;
+    transfers++;
+
+    clearBuffer();
+    clearDisplay();
+    return true;
+}
+
+void U8G2_SH1106_128X64_NONAME_F_HW_I2C::clearBuffer() {
+    memset(buffer, 0, sizeof(buffer));
+}
+
+void U8G2_SH1106_128X64_NONAME_F_HW_I2C::sendBuffer() {
+    transmitTiles(0, 0, TILE_WIDTH, TILE_HEIGHT);
+}
+
+void U8G2_SH1106_128X64_NONAME_F_HW_I2C::clearDisplay() {
+    clearBuffer();
+    sendBuffer();
+}
+
+void U8G2_SH1106_128X64_NONAME_F_HW_I2C::updateDisplayArea(uint8_t tx, uint8_t ty, uint8_t tw, uint8_t th) {
+    if (tx >= TILE_WIDTH || ty >= TILE_HEIGHT) return;
+    if (tx + tw > TILE_WIDTH) tw = TILE_WIDTH - tx;
+    if (ty + th > TILE_HEIGHT) th = TILE_HEIGHT - ty;
+    transmitTiles(tx, ty, tw, th);
+}
+
+void U8G2_SH1106_128X64_NONAME_F_HW_I2C::transmitTiles(uint8_t tx, uint8_t ty, uint8_t tw, uint8_t th) {
+    for (uint8_t row = ty; row < ty + th; row++) {
+        transmitRow(tx, row, tw, &buffer[(size_t)row * WIDTH + (size_t)tx * 8]);
+    }
+}
+
+void U8G2_SH1106_128X64_NONAME_F_HW_I2C::transmitRow(uint8_t tx, uint8_t ty, uint8_t tw, const uint8_t* tiles) {
+    uint8_t address = i2cAddress >> 1;
+
+    // 設定 page 與欄位位址：控制位元組 + 3 個指令
+    startTransfer();
+    NativeSim::i2cTransfer(address, 4, busNum);
+    bytesSent += 4;
+    transfers++;
+
+    size_t remaining = (size_t)tw * 8;
+    memcpy(&displayRam[(size_t)ty * WIDTH + (size_t)tx * 8], tiles, remaining);
+
+    while (remaining > 0) {
+        size_t chunk = remaining < I2C_CHUNK_DATA ? remaining : I2C_CHUNK_DATA;
+        NativeSim::i2cTransfer(address, chunk + 1, busNum);
+        bytesSent += (uint32_t)(chunk + 1);
+        transfers++;
+        remaining -= chunk;
+    }
+}
+
+void U8G2_SH1106_128X64_NONAME_F_HW_I2C::startTransfer() {
+    // u8x8_byte_arduino_hw_i2c 在每次 START 前都會重設時脈
+    (busNum ? Wire1 : Wire).setClock(busClock ? busClock : DEFAULT_BUS_CLOCK);
+}
+
+void u8x8_DrawTile(u8x8_t* u8x8, uint8_t x, uint8_t y, uint8_t cnt, uint8_t* tile_ptr) {
+    typedef U8G2_SH1106_128X64_NONAME_F_HW_I2C Display;
+    if (x >= Display::TILE_WIDTH || y >= Display::TILE_HEIGHT || cnt == 0) return;
+    if (x + cnt > Display::TILE_WIDTH) cnt = Display::TILE_WIDTH - x;
+    u8x8->display->transmitRow(x, y, cnt, tile_ptr);
+}
+
+// ---- 繪圖 ----
+
+void U8G2_SH1106_128X64_NONAME_F_HW_I2C::drawPixel(u8g2_int_t x, u8g2_int_t y) {
+    if (x < 0 || x >= WIDTH || y < 0 || y >= HEIGHT) return;
+    uint8_t& b = buffer[(y / 8) * WIDTH + x];
+    uint8_t mask = (uint8_t)(1 << (y & 7));
+    switch (drawColor) {
+        case 0: b &= (uint8_t)~mask; break;
+        case 2: b ^= mask; break;
+        default: b |= mask; break;
+    }
+}
+
+void U8G2_SH1106_128X64_NONAME_F_HW_I2C::drawHLine(u8g2_int_t x, u8g2_int_t y, u8g2_int_t w) {
+    for (u8g2_int_t i = 0; i < w; i++) drawPixel(x + i, y);
+}
+
+void U8G2_SH1106_128X64_NONAME_F_HW_I2C::drawVLine(u8g2_int_t x, u8g2_int_t y, u8g2_int_t h) {
+    for (u8g2_int_t i = 0; i < h; i++) drawPixel(x, y + i);
+}
+
+void U8G2_SH1106_128X64_NONAME_F_HW_I2C::drawLine(u8g2_int_t x1, u8g2_int_t y1, u8g2_int_t x2, u8g2_int_t y2) {
+    int dx = abs(x2 - x1), sx = x1 < x2 ? 1 : -1;
+    int dy = -abs(y2 - y1), sy = y1 < y2 ? 1 : -1;
+    int err = dx + dy;
+    int x = x1, y = y1;
+    while (true) {
+        drawPixel(x, y);
+        if (x == x2 && y == y2) break;
+        int e2 = 2 * err;
+        if (e2 >= dy) { err += dy; x += sx; }
+        if (e2 <= dx) { err += dx; y += sy; }
+    }
+}
+
+void U8G2_SH1106_128X64_NONAME_F_HW_I2C::drawFrame(u8g2_int_t x, u8g2_int_t y, u8g2_int_t w, u8g2_int_t h) {
+    if (w <= 0 || h <= 0) return;
+    drawHLine(x, y, w);
+    drawHLine(x, y + h - 1, w);
+    drawVLine(x, y, h);
+    drawVLine(x + w - 1, y, h);
+}
+
+void U8G2_SH1106_128X64_NONAME_F_HW_I2C::drawBox(u8g2_int_t x, u8g2_int_t y, u8g2_int_t w, u8g2_int_t h) {
+    for (u8g2_int_t i = 0; i < h; i++) drawHLine(x, y + i, w);
+}
+
+void U8G2_SH1106_128X64_NONAME_F_HW_I2C::drawCircleSection(int x, int y, int x0, int y0, uint8_t option) {
+    if (option & U8G2_DRAW_UPPER_RIGHT) { drawPixel(x0 + x, y0 - y); drawPixel(x0 + y, y0 - x); }
+    if (option & U8G2_DRAW_UPPER_LEFT)  { drawPixel(x0 - x, y0 - y); drawPixel(x0 - y, y0 - x); }
+    if (option & U8G2_DRAW_LOWER_RIGHT) { drawPixel(x0 + x, y0 + y); drawPixel(x0 + y, y0 + x); }
+    if (option & U8G2_DRAW_LOWER_LEFT)  { drawPixel(x0 - x, y0 + y); drawPixel(x0 - y, y0 + x); }
+}
+
+void U8G2_SH1106_128X64_NONAME_F_HW_I2C::drawCircle(u8g2_int_t x0, u8g2_int_t y0, u8g2_int_t rad, uint8_t option) {
+    int x = 0, y = rad, f = 1 - rad;
+    while (x <= y) {
+        drawCircleSection(x, y, x0, y0, option);
+        x++;
+        if (f < 0) {
+            f += 2 * x + 1;
+        } else {
+            y--;
+            f += 2 * (x - y) + 1;
+        }
+    }
+}
+
+void U8G2_SH1106_128X64_NONAME_F_HW_I2C::drawDisc(u8g2_int_t x0, u8g2_int_t y0, u8g2_int_t rad, uint8_t option) {
+    for (int r = 0; r <= rad; r++) drawCircle(x0, y0, r, option);
+}
+
+void U8G2_SH1106_128X64_NONAME_F_HW_I2C::drawTriangle(int16_t x0, int16_t y0, int16_t x1, int16_t y1, int16_t x2, int16_t y2) {
+    int minX = x0 < x1 ? (x0 < x2 ? x0 : x2) : (x1 < x2 ? x1 : x2);
+    int maxX = x0 > x1 ? (x0 > x2 ? x0 : x2) : (x1 > x2 ? x1 : x2);
+    int minY = y0 < y1 ? (y0 < y2 ? y0 : y2) : (y1 < y2 ? y1 : y2);
+    int maxY = y0 > y1 ? (y0 > y2 ? y0 : y2) : (y1 > y2 ? y1 : y2);
+
+    for (int y = minY; y <= maxY; y++) {
+        for (int x = minX; x <= maxX; x++) {
+            long w0 = (long)(x1 - x0) * (y - y0) - (long)(y1 - y0) * (x - x0);
+            long w1 = (long)(x2 - x1) * (y - y1) - (long)(y2 - y1) * (x - x1);
+            long w2 = (long)(x0 - x2) * (y - y2) - (long)(y0 - y2) * (x - x2);
+            if ((w0 >= 0 && w1 >= 0 && w2 >= 0) || (w0 <= 0 && w1 <= 0 && w2 <= 0)) {
+                drawPixel(x, y);
+            }
+        }
+    }
+}
+
+void U8G2_SH1106_128X64_NONAME_F_HW_I2C::drawXBM(u8g2_int_t x, u8g2_int_t y, u8g2_int_t w, u8g2_int_t h, const uint8_t* bitmap) {
+    int bytesPerRow = (w + 7) / 8;
+    for (int j = 0; j < h; j++) {
+        for (int i = 0; i < w; i++) {
+            if (bitmap[j * bytesPerRow + i / 8] & (1 << (i & 7))) {
+                drawPixel(x + i, y + j);
+            }
+        }
+    }
+}
+
+// ---- 文字 ----
+
+void U8G2_SH1106_128X64_NONAME_F_HW_I2C::drawGlyph(int x, int y, char c) {
+    if (c == ' ') return;
+
+    // 示意字形：由字元碼決定每一欄的點陣，保證不同字元畫出不同圖樣
+    int width = font[0] - 1;
+    int height = font[1];
+    uint32_t seed = (uint8_t)c * 2654435761u;
+    for (int col = 0; col < width; col++) {
+        seed ^= seed << 13;
+        seed ^= seed >> 17;
+        seed ^= seed << 5;
+        uint32_t bits = seed | 1u;
+        for (int row = 0; row < height; row++) {
+            if (bits & (1u << (row % 32))) {
+                drawPixel(x + col, y - height + row);
+            }
+        }
+    }
+}
+
+u8g2_int_t U8G2_SH1106_128X64_NONAME_F_HW_I2C::drawStr(u8g2_int_t x, u8g2_int_t y, const char* s) {
+    if (!s) return 0;
+    int cx = x;
+    for (const char* p = s; *p; p++) {
+        drawGlyph(cx, y, *p);
+        cx += font[0];
+    }
+    return (u8g2_int_t)(cx - x);
+}
+
+u8g2_uint_t U8G2_SH1106_128X64_NONAME_F_HW_I2C::getStrWidth(const char* s) const {
+    return s ? (u8g2_uint_t)(strlen(s) * font[0]) : 0;
+}
+
+int8_t U8G2_SH1106_128X64_NONAME_F_HW_I2C::getAscent() const {
+    return (int8_t)font[1];
+}
+
+int8_t U8G2_SH1106_128X64_NONAME_F_HW_I2C::getMaxCharHeight() const {
+    return (int8_t)(font[1] + 2);
+}
+
+bool U8G2_SH1106_128X64_NONAME_F_HW_I2C::hostPixel(int x, int y) const {
+    if (x < 0 || x >= WIDTH || y < 0 || y >= HEIGHT) return false;
+    return (displayRam[(y / 8) * WIDTH + x] >> (y & 7)) & 1;
+}
@@ -0,0 +1,151 @@
+/**
+ * U8g2lib.h (native)
+ * U8G2_SH1106_128X64_NONAME_F_HW_I2C 的主機端替身 (記憶體內顯示裝置)
+ *
+ * 功能概述:
+ * - 與 U8g2 全緩衝模式相同的 1 KB 幀緩衝區佈局 (8 個 page，每個 tile 8x8 像素)
+ * - 實作專案使用到的繪圖 API；文字以固定寬度的示意字形繪出，寬度與高度依字體而定
+ * - 與實際函式庫相同，本標頭會引入 Arduino.h
+ * - sendBuffer()/updateDisplayArea() 把緩衝區複製到模擬的顯示器 RAM，
+ *   並以 SH1106 的 I2C 傳輸格式計算位元組數與匯流排時間
+ * - u8x8_DrawTile() 從呼叫端提供的 tile 資料直接傳送，不經過幀緩衝區
+ * - 與實際 U8g2 相同，每次傳輸開始時把 Wire 時脈設為 setBusClock() 的值 (未設定時為 SH1106 的 400 kHz)
+ * - U8G2_SH1106_128X64_NONAME_F_2ND_HW_I2C 改用第二個控制器 (Wire1)
+ */
+
+#ifndef NATIVE_U8G2LIB_H
+#define NATIVE_U8G2LIB_H
+
+#include <Arduino.h>
+#include <cstdint>
+#include <cstddef>
+
+#define U8X8_PIN_NONE 255
+#define U8G2_DRAW_UPPER_RIGHT 0x01
+#define U8G2_DRAW_UPPER_LEFT 0x02
+#define U8G2_DRAW_LOWER_LEFT 0x04
+#define U8G2_DRAW_LOWER_RIGHT 0x08
+#define U8G2_DRAW_ALL (U8G2_DRAW_UPPER_RIGHT | U8G2_DRAW_UPPER_LEFT | U8G2_DRAW_LOWER_RIGHT | U8G2_DRAW_LOWER_LEFT)
+
+typedef int16_t u8g2_int_t;
+typedef uint16_t u8g2_uint_t;
+
+// 旋轉參數 (替身只支援 R0)
+struct u8g2_cb_t {
+    uint8_t rotation;
+};
+extern const u8g2_cb_t u8g2_cb_r0;
+#define U8G2_R0 (&u8g2_cb_r0)
+
+// 字體描述：[0] 字元寬度 (含間距), [1] 基線以上高度
+extern const uint8_t u8g2_font_ncenB08_tr[];
+extern const uint8_t u8g2_font_ncenB10_tr[];
+extern const uint8_t u8g2_font_ncenB14_tr[];
+extern const uint8_t u8g2_font_5x7_tr[];
+extern const uint8_t u8g2_font_6x10_tr[];
+
+class U8G2_SH1106_128X64_NONAME_F_HW_I2C;
+
+// U8x8 顯示裝置層 (替身只保留指回顯示器的指標)
+struct u8x8_t {
+    U8G2_SH1106_128X64_NONAME_F_HW_I2C* display;
+};
+
+/**
+ * 傳送同一 page 內連續 cnt 個 tile (每個 8 位元組，與幀緩衝區相同的垂直位元組格式)
+ */
+void u8x8_DrawTile(u8x8_t* u8x8, uint8_t x, uint8_t y, uint8_t cnt, uint8_t* tile_ptr);
+
+class U8G2_SH1106_128X64_NONAME_F_HW_I2C {
+public:
+    static const int WIDTH = 128;
+    static const int HEIGHT = 64;
+    static const int TILE_WIDTH = WIDTH / 8;
+    static const int TILE_HEIGHT = HEIGHT / 8;
+    static const size_t BUFFER_SIZE = WIDTH * HEIGHT / 8;
+
+protected:
+    uint8_t busNum;     // 0 = Wire, 1 = Wire1
+
+private:
+    uint8_t buffer[BUFFER_SIZE];
+    uint8_t displayRam[BUFFER_SIZE];
+    const uint8_t* font;
+    uint8_t drawColor;
+    uint8_t i2cAddress;
+    uint32_t busClock;
+    bool powerSave;
+
+    u8x8_t u8x8;
+    uint32_t bytesSent;
+    uint32_t transfers;
+
+    void transmitTiles(uint8_t tx, uint8_t ty, uint8_t tw, uint8_t th);
+    void transmitRow(uint8_t tx, uint8_t ty, uint8_t tw, const uint8_t* tiles);
+    void startTransfer();
+    friend void u8x8_DrawTile(u8x8_t* u8x8, uint8_t x, uint8_t y, uint8_t cnt, uint8_t* tile_ptr);
+    void drawGlyph(int x, int y, char c);
+    void drawCircleSection(int x, int y, int x0, int y0, uint8_t option);
+
+public:
+    U8G2_SH1106_128X64_NONAME_F_HW_I2C(const u8g2_cb_t* rotation, uint8_t reset = U8X8_PIN_NONE,
+                                       uint8_t clock = U8X8_PIN_NONE, uint8_t data = U8X8_PIN_NONE);
+
+    bool begin();
+    void setI2CAddress(uint8_t adr) { i2cAddress = adr; }
+    void setBusClock(uint32_t clockSpeed) { busClock = clockSpeed; }
+    void setPowerSave(uint8_t is_enable) { powerSave = is_enable != 0; }
+    void setContrast(uint8_t value) { (void)value; }
+
+    // 緩衝區
+    void clearBuffer();
+    void sendBuffer();
+    void clearDisplay();
+    void updateDisplay() { sendBuffer(); }
+    void updateDisplayArea(uint8_t tx, uint8_t ty, uint8_t tw, uint8_t th);
+    uint8_t* getBufferPtr() { return buffer; }
+    uint8_t getBufferTileWidth() const { return TILE_WIDTH; }
+    uint8_t getBufferTileHeight() const { return TILE_HEIGHT; }
+    u8g2_uint_t getDisplayWidth() const { return WIDTH; }
+    u8g2_uint_t getDisplayHeight() const { return HEIGHT; }
+    u8x8_t* getU8x8() { return &u8x8; }
+
+    // 繪圖
+    void setDrawColor(uint8_t color) { drawColor = color; }
+    uint8_t getDrawColor() const { return drawColor; }
+    void drawPixel(u8g2_int_t x, u8g2_int_t y);
+    void drawHLine(u8g2_int_t x, u8g2_int_t y, u8g2_int_t w);
+    void drawVLine(u8g2_int_t x, u8g2_int_t y, u8g2_int_t h);
+    void drawLine(u8g2_int_t x1, u8g2_int_t y1, u8g2_int_t x2, u8g2_int_t y2);
+    void drawFrame(u8g2_int_t x, u8g2_int_t y, u8g2_int_t w, u8g2_int_t h);
+    void drawBox(u8g2_int_t x, u8g2_int_t y, u8g2_int_t w, u8g2_int_t h);
+    void drawCircle(u8g2_int_t x0, u8g2_int_t y0, u8g2_int_t rad, uint8_t option = U8G2_DRAW_ALL);
+    void drawDisc(u8g2_int_t x0, u8g2_int_t y0, u8g2_int_t rad, uint8_t option = U8G2_DRAW_ALL);
+    void drawTriangle(int16_t x0, int16_t y0, int16_t x1, int16_t y1, int16_t x2, int16_t y2);
+    void drawXBM(u8g2_int_t x, u8g2_int_t y, u8g2_int_t w, u8g2_int_t h, const uint8_t* bitmap);
+
+    // 文字
+    void setFont(const uint8_t* f) { font = f; }
+    u8g2_int_t drawStr(u8g2_int_t x, u8g2_int_t y, const char* s);
+    u8g2_uint_t getStrWidth(const char* s) const;
+    int8_t getAscent() const;
+    int8_t getMaxCharHeight() const;
+
+    // 主機端：檢視顯示器 RAM 與傳輸統計
+    const uint8_t* hostDisplayRam() const { return displayRam; }
+    bool hostPixel(int x, int y) const;
+    uint32_t hostBytesSent() const { return bytesSent; }
+    uint32_t hostTransfers() const { return transfers; }
+    void hostResetCounters() { bytesSent = 0; transfers = 0; }
+};
+
+class U8G2_SH1106_128X64_NONAME_F_2ND_HW_I2C : public U8G2_SH1106_128X64_NONAME_F_HW_I2C {
+public:
+    U8G2_SH1106_128X64_NONAME_F_2ND_HW_I2C(const u8g2_cb_t* rotation, uint8_t reset = U8X8_PIN_NONE,
+                                           uint8_t clock = U8X8_PIN_NONE, uint8_t data = U8X8_PIN_NONE)
+        : U8G2_SH1106_128X64_NONAME_F_HW_I2C(rotation, reset, clock, data) {
+        busNum = 1;
+    }
+};
+
+#endif // NATIVE_U8G2LIB_H
@@ -0,0 +1,86 @@
+/**
+ * WString.h (native)
+ * Arduino String 的主機端替身，以 std::string 實作
+ */
+
+#ifndef NATIVE_WSTRING_H
+#define NATIVE_WSTRING_H
+
+#include <string>
+#include <cstdlib>
+#include <cctype>
+
+class String {
+private:
+    std::string s;
+
+public:
+    String() {}
+    String(const char* str) : s(str ? str : "") {}
+    String(const std::string& str) : s(str) {}
+    String(char c) : s(1, c) {}
+    String(int value) : s(std::to_string(value)) {}
+    String(unsigned int value) : s(std::to_string(value)) {}
+    String(long value) : s(std::to_string(value)) {}
+    String(unsigned long value) : s(std::to_string(value)) {}
+    String(double value, unsigned int decimals = 2) {
+        char buffer[48];
+        snprintf(buffer, sizeof(buffer), "%.*f", (int)decimals, value);
+        s = buffer;
+    }
+
+    const char* c_str() const { return s.c_str(); }
+    unsigned int length() const { return (unsigned int)s.length(); }
+    char charAt(unsigned int index) const { return index < s.length() ? s[index] : 0; }
+    char operator[](unsigned int index) const { return charAt(index); }
+
+    bool operator==(const String& rhs) const { return s == rhs.s; }
+    bool operator==(const char* rhs) const { return s == (rhs ? rhs : ""); }
+    bool operator!=(const String& rhs) const { return s != rhs.s; }
+    bool operator!=(const char* rhs) const { return !(*this == rhs); }
+    bool equals(const String& rhs) const { return s == rhs.s; }
+
+    String& operator+=(const String& rhs) { s += rhs.s; return *this; }
+    String& operator+=(const char* rhs) { if (rhs) s += rhs; return *this; }
+    String& operator+=(char c) { s += c; return *this; }
+    friend String operator+(const String& lhs, const String& rhs) { return String(lhs.s + rhs.s); }
+    friend String operator+(const String& lhs, const char* rhs) { return String(lhs.s + (rhs ? rhs : "")); }
+    friend String operator+(const char* lhs, const String& rhs) { return String((lhs ? lhs : "") + rhs.s); }
+
+    bool startsWith(const String& prefix) const { return s.compare(0, prefix.s.length(), prefix.s) == 0; }
+    bool endsWith(const String& suffix) const {
+        return s.length() >= suffix.s.length() &&
+               s.compare(s.length() - suffix.s.length(), suffix.s.length(), suffix.s) == 0;
+    }
+    int indexOf(char c, unsigned int from = 0) const {
+        size_t pos = s.find(c, from);
+        return pos == std::string::npos ? -1 : (int)pos;
+    }
+    int indexOf(const String& str, unsigned int from = 0) const {
+        size_t pos = s.find(str.s, from);
+        return pos == std::string::npos ? -1 : (int)pos;
+    }
+    String substring(unsigned int from) const { return from < s.length() ? String(s.substr(from)) : String(); }
+    String substring(unsigned int from, unsigned int to) const {
+        if (from > to) std::swap(from, to);
+        if (from >= s.length()) return String();
+        return String(s.substr(from, to - from));
+    }
+    void trim() {
+        size_t first = s.find_first_not_of(" \t\r\n");
+        if (first == std::string::npos) { s.clear(); return; }
+        size_t last = s.find_last_not_of(" \t\r\n");
+        s = s.substr(first, last - first + 1);
+    }
+    void toLowerCase() {
+        for (char& c : s) c = (char)std::tolower((unsigned char)c);
+    }
+    void toUpperCase() {
+        for (char& c : s) c = (char)std::toupper((unsigned char)c);
+    }
+    long toInt() const { return std::strtol(s.c_str(), nullptr, 10); }
+    float toFloat() const { return std::strtof(s.c_str(), nullptr); }
+    double toDouble() const { return std::strtod(s.c_str(), nullptr); }
+};
+
+#endif // NATIVE_WSTRING_H
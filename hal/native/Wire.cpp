@@ -0,0 +1,107 @@
+/**
+ * Wire.cpp (native)
+ * I2C 主控端替身實現
+ */
+
+#include "Wire.h"
+#include "NativeSim.h"
+
+TwoWire Wire(0);
+TwoWire Wire1(1);
+
+TwoWire::TwoWire(uint8_t bus)
+    : busNum(bus),
+      started(false),
+      clockHz(100000),
+      txAddress(0),
+      txLength(0),
+      rxLength(0)
+{
+    for (int i = 0; i < 128; i++) {
+        devices[i] = false;
+    }
+}
+
+bool TwoWire::begin(int sda, int scl, uint32_t frequency) {
+    (void)sda;
+    (void)scl;
+    started = true;
+    if (frequency > 0) {
+        setClock(frequency);
+    } else {
+        NativeSim::setI2CClock(clockHz, busNum);
+    }
+    return true;
+}
+
+bool TwoWire::end() {
+    started = false;
+    return true;
+}
+
+bool TwoWire::setClock(uint32_t frequency) {
+    clockHz = frequency;
+    NativeSim::setI2CClock(frequency, busNum);
+    return true;
+}
+
+void TwoWire::beginTransmission(uint8_t address) {
+    txAddress = address;
+    txLength = 0;
+}
+
+uint8_t TwoWire::endTransmission(bool sendStop) {
+    (void)sendStop;
+    NativeSim::i2cTransfer(txAddress, txLength, busNum);
+    txLength = 0;
+    return devices[txAddress & 0x7F] ? 0 : 2;
+}
+
+size_t TwoWire::write(uint8_t data) {
+    (void)data;
+    txLength++;
+    return 1;
+}
+
+size_t TwoWire::write(const uint8_t* data, size_t quantity) {
+    (void)data;
+    txLength += quantity;
+    return quantity;
+}
+
+uint8_t TwoWire::requestFrom(uint8_t address, uint8_t quantity, bool sendStop) {
+    (void)sendStop;
+    if (!devices[address & 0x7F]) {
+        rxLength = 0;
+        return 0;
+    }
+    NativeSim::i2cTransfer(address, quantity, busNum);
+    rxLength = quantity;
+    return quantity;
+}
+
+int TwoWire::available() {
+    return (int)rxLength;
+}
+
+int TwoWire::read() {
+    if (rxLength == 0) return -1;
+    rxLength--;
+    return 0;
+}
+
+int TwoWire::peek() {
+    return rxLength ? 0 : -1;
+}
+
+void TwoWire::hostAttachDevice(uint8_t address) {
+    devices[address & 0x7F] = true;
+}
+
+void TwoWire::hostDetachDevice(uint8_t address) {
+    devices[address & 0x7F] = false;
+}
+
+bool TwoWire::hostHasDevice(uint8_t address) const {
+    return devices[address & 0x7F];
+}
@@ -0,0 +1,53 @@
+/**
+ * Wire.h (native)
+ * I2C 主控端替身：只記錄傳輸量並依匯流排時脈推進虛擬時間
+ *
+ * 裝置以 hostAttachDevice() 宣告存在；不存在的位址 endTransmission() 回傳 2 (NACK)。
+ * 讀取資料一律為 0，需要實際資料的裝置 (MPU6050、SH1106) 由各自的替身類別模擬。
+ */
+
+#ifndef NATIVE_WIRE_H
+#define NATIVE_WIRE_H
+
+#include <cstdint>
+#include <cstddef>
+
+class TwoWire {
+private:
+    uint8_t busNum;
+    bool started;
+    uint32_t clockHz;
+    uint8_t txAddress;
+    size_t txLength;
+    size_t rxLength;
+    bool devices[128];
+
+public:
+    explicit TwoWire(uint8_t bus);
+
+    bool begin(int sda = -1, int scl = -1, uint32_t frequency = 0);
+    bool end();
+    bool setClock(uint32_t frequency);
+    uint32_t getClock() const { return clockHz; }
+
+    void beginTransmission(uint8_t address);
+    uint8_t endTransmission(bool sendStop = true);
+    size_t write(uint8_t data);
+    size_t write(const uint8_t* data, size_t quantity);
+
+    uint8_t requestFrom(uint8_t address, uint8_t quantity, bool sendStop = true);
+    int available();
+    int read();
+    int peek();
+
+    // 主機端：宣告/移除裝置、查詢狀態
+    void hostAttachDevice(uint8_t address);
+    void hostDetachDevice(uint8_t address);
+    bool hostHasDevice(uint8_t address) const;
+    bool hostStarted() const { return started; }
+};
+
+extern TwoWire Wire;
+extern TwoWire Wire1;
+
+#endif // NATIVE_WIRE_H
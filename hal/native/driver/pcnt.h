@@ -0,0 +1,90 @@
+/**
+ * driver/pcnt.h (native)
+ * ESP-IDF 4.4 舊版脈衝計數器 (PCNT) 驅動的主機端替身
+ *
+ * 只實作編碼器用到的 API。計數由 NativeSim::setInputLevel 注入的腳位邊緣驅動：
+ * 脈衝腳位的上升/下降沿依控制腳位位準決定加、減或不計，到達上下限時歸零並觸發事件。
+ * 毛刺濾波器只記錄設定值，模擬的邊緣本身不含雜訊。
+ */
+
+#ifndef NATIVE_DRIVER_PCNT_H
+#define NATIVE_DRIVER_PCNT_H
+
+#include <cstdint>
+#include "esp_err.h"
+
+#define PCNT_PIN_NOT_USED (-1)
+
+typedef enum {
+    PCNT_UNIT_0,
+    PCNT_UNIT_1,
+    PCNT_UNIT_2,
+    PCNT_UNIT_3,
+    PCNT_UNIT_MAX,   // ESP32-S3 有 4 個計數單元
+} pcnt_unit_t;
+
+typedef enum {
+    PCNT_CHANNEL_0,
+    PCNT_CHANNEL_1,
+    PCNT_CHANNEL_MAX,
+} pcnt_channel_t;
+
+typedef enum {
+    PCNT_COUNT_DIS = 0,
+    PCNT_COUNT_INC,
+    PCNT_COUNT_DEC,
+    PCNT_COUNT_MAX,
+} pcnt_count_mode_t;
+
+typedef enum {
+    PCNT_MODE_KEEP = 0,
+    PCNT_MODE_REVERSE,
+    PCNT_MODE_DISABLE,
+    PCNT_MODE_MAX,
+} pcnt_ctrl_mode_t;
+
+typedef enum {
+    PCNT_EVT_THRES_1 = 0x04,
+    PCNT_EVT_THRES_0 = 0x08,
+    PCNT_EVT_L_LIM = 0x10,
+    PCNT_EVT_H_LIM = 0x20,
+    PCNT_EVT_ZERO = 0x40,
+    PCNT_EVT_MAX,
+} pcnt_evt_type_t;
+
+typedef struct {
+    int pulse_gpio_num;
+    int ctrl_gpio_num;
+    pcnt_ctrl_mode_t lctrl_mode;
+    pcnt_ctrl_mode_t hctrl_mode;
+    pcnt_count_mode_t pos_mode;
+    pcnt_count_mode_t neg_mode;
+    int16_t counter_h_lim;
+    int16_t counter_l_lim;
+    pcnt_unit_t unit;
+    pcnt_channel_t channel;
+} pcnt_config_t;
+
+typedef void (*pcnt_isr_handler_t)(void* arg);
+
+esp_err_t pcnt_unit_config(const pcnt_config_t* pcnt_config);
+esp_err_t pcnt_get_counter_value(pcnt_unit_t unit, int16_t* count);
+esp_err_t pcnt_counter_pause(pcnt_unit_t unit);
+esp_err_t pcnt_counter_resume(pcnt_unit_t unit);
+esp_err_t pcnt_counter_clear(pcnt_unit_t unit);
+
+esp_err_t pcnt_set_filter_value(pcnt_unit_t unit, uint16_t filter_val);
+esp_err_t pcnt_get_filter_value(pcnt_unit_t unit, uint16_t* filter_val);
+esp_err_t pcnt_filter_enable(pcnt_unit_t unit);
+esp_err_t pcnt_filter_disable(pcnt_unit_t unit);
+
+esp_err_t pcnt_event_enable(pcnt_unit_t unit, pcnt_evt_type_t evt_type);
+esp_err_t pcnt_event_disable(pcnt_unit_t unit, pcnt_evt_type_t evt_type);
+esp_err_t pcnt_get_event_status(pcnt_unit_t unit, uint32_t* status);
+
+esp_err_t pcnt_isr_service_install(int intr_alloc_flags);
+void pcnt_isr_service_uninstall(void);
+esp_err_t pcnt_isr_handler_add(pcnt_unit_t unit, pcnt_isr_handler_t isr_handler, void* args);
+esp_err_t pcnt_isr_handler_remove(pcnt_unit_t unit);
+
+#endif // NATIVE_DRIVER_PCNT_H
@@ -0,0 +1,138 @@
+/**
+ * esp_timer.cpp (native)
+ * esp_timer 主機端替身實現：由一個優先權 22 的任務依虛擬時間派發回呼
+ */
+
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "NativeSim.h"
+
+#include <vector>
+
+struct esp_timer {
+    esp_timer_cb_t callback;
+    void* arg;
+    const char* name;
+    bool skipUnhandled;
+    bool active;
+    uint64_t period;     // 0 表示單次
+    uint64_t alarm;      // 下次觸發時間 (us)
+};
+
+namespace {
+
+const UBaseType_t ESP_TIMER_TASK_PRIORITY = 22;
+
+std::vector<esp_timer*>& timers() {
+    static std::vector<esp_timer*>* v = new std::vector<esp_timer*>();
+    return *v;
+}
+
+TaskHandle_t timerTask = nullptr;
+
+void timerTaskEntry(void*) {
+    while (true) {
+        esp_timer* next = nullptr;
+        for (esp_timer* t : timers()) {
+            if (t->active && (!next || t->alarm < next->alarm)) next = t;
+        }
+
+        if (!next) {
+            NativeSim::notifyTakeUntil(UINT64_MAX);
+            continue;
+        }
+
+        if (NativeSim::nowMicros() < next->alarm) {
+            // 等到觸發時間，或有新的計時器啟動時提早醒來重新計算
+            NativeSim::notifyTakeUntil(next->alarm);
+            continue;
+        }
+
+        if (next->period > 0) {
+            next->alarm += next->period;
+            if (next->skipUnhandled && next->alarm <= NativeSim::nowMicros()) {
+                uint64_t missed = (NativeSim::nowMicros() - next->alarm) / next->period + 1;
+                next->alarm += missed * next->period;
+            }
+        } else {
+            next->active = false;
+        }
+        next->callback(next->arg);
+    }
+}
+
+void kickTimerTask() {
+    if (!timerTask) {
+        xTaskCreatePinnedToCore(timerTaskEntry, "esp_timer", 4096, nullptr,
+                                ESP_TIMER_TASK_PRIORITY, &timerTask, 0);
+    } else {
+        xTaskNotifyGive(timerTask);
+    }
+}
+
+} // namespace
+
+esp_err_t esp_timer_create(const esp_timer_create_args_t* create_args, esp_timer_handle_t* out_handle) {
+    if (!create_args || !create_args->callback || !out_handle) return ESP_ERR_INVALID_ARG;
+    esp_timer* t = new esp_timer();
+    t->callback = create_args->callback;
+    t->arg = create_args->arg;
+    t->name = create_args->name;
+    t->skipUnhandled = create_args->skip_unhandled_events;
+    t->active = false;
+    t->period = 0;
+    t->alarm = 0;
+    timers().push_back(t);
+    *out_handle = t;
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_start_once(esp_timer_handle_t timer, uint64_t timeout_us) {
+    if (!timer) return ESP_ERR_INVALID_ARG;
+    if (timer->active) return ESP_ERR_INVALID_STATE;
+    timer->period = 0;
+    timer->alarm = NativeSim::nowMicros() + timeout_us;
+    timer->active = true;
+    kickTimerTask();
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_start_periodic(esp_timer_handle_t timer, uint64_t period) {
+    if (!timer || period == 0) return ESP_ERR_INVALID_ARG;
+    if (timer->active) return ESP_ERR_INVALID_STATE;
+    timer->period = period;
+    timer->alarm = NativeSim::nowMicros() + period;
+    timer->active = true;
+    kickTimerTask();
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_stop(esp_timer_handle_t timer) {
+    if (!timer) return ESP_ERR_INVALID_ARG;
+    if (!timer->active) return ESP_ERR_INVALID_STATE;
+    timer->active = false;
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_delete(esp_timer_handle_t timer) {
+    if (!timer) return ESP_ERR_INVALID_ARG;
+    if (timer->active) return ESP_ERR_INVALID_STATE;
+    std::vector<esp_timer*>& v = timers();
+    for (size_t i = 0; i < v.size(); i++) {
+        if (v[i] == timer) {
+            v.erase(v.begin() + i);
+            break;
+        }
+    }
+    delete timer;
+    return ESP_OK;
+}
+
+bool esp_timer_is_active(esp_timer_handle_t timer) {
+    return timer && timer->active;
+}
+
+int64_t esp_timer_get_time() {
+    return (int64_t)NativeSim::nowMicros();
+}
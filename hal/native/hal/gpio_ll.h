@@ -0,0 +1,37 @@
+/**
+ * hal/gpio_ll.h (native)
+ * ESP-IDF GPIO 低階暫存器存取的主機端替身
+ *
+ * 只實作 FastPin 用到的 gpio_ll_set_level()/gpio_ll_get_level()，轉給 digitalWrite()/digitalRead()，
+ * 讓模擬器照常記錄腳位位準與寫入次數。
+ */
+
+#ifndef NATIVE_HAL_GPIO_LL_H
+#define NATIVE_HAL_GPIO_LL_H
+
+#include <cstdint>
+#include "Arduino.h"
+
+typedef enum {
+    GPIO_NUM_NC = -1,
+    GPIO_NUM_MAX = 49
+} gpio_num_t;
+
+// 暫存器區塊：主機端沒有內容，只保留 &GPIO 的寫法
+typedef struct {
+    uint32_t unused;
+} gpio_dev_t;
+
+inline gpio_dev_t GPIO;
+
+static inline void gpio_ll_set_level(gpio_dev_t* hw, gpio_num_t gpio_num, uint32_t level) {
+    (void)hw;
+    digitalWrite((uint8_t)gpio_num, level ? HIGH : LOW);
+}
+
+static inline int gpio_ll_get_level(gpio_dev_t* hw, gpio_num_t gpio_num) {
+    (void)hw;
+    return digitalRead((uint8_t)gpio_num);
+}
+
+#endif // NATIVE_HAL_GPIO_LL_H
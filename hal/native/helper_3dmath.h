@@ -0,0 +1,76 @@
+/**
+ * helper_3dmath.h (native)
+ * I2Cdevlib 3D 數學輔助型別的主機端版本 (介面與原函式庫相同)
+ */
+
+#ifndef NATIVE_HELPER_3DMATH_H
+#define NATIVE_HELPER_3DMATH_H
+
+#include <cmath>
+#include <cstdint>
+
+class Quaternion {
+public:
+    float w, x, y, z;
+
+    Quaternion() : w(1.0f), x(0.0f), y(0.0f), z(0.0f) {}
+    Quaternion(float nw, float nx, float ny, float nz) : w(nw), x(nx), y(ny), z(nz) {}
+
+    Quaternion getProduct(Quaternion q) const {
+        return Quaternion(
+            w * q.w - x * q.x - y * q.y - z * q.z,
+            w * q.x + x * q.w + y * q.z - z * q.y,
+            w * q.y - x * q.z + y * q.w + z * q.x,
+            w * q.z + x * q.y - y * q.x + z * q.w);
+    }
+
+    Quaternion getConjugate() const { return Quaternion(w, -x, -y, -z); }
+    float getMagnitude() const { return sqrtf(w * w + x * x + y * y + z * z); }
+
+    void normalize() {
+        float m = getMagnitude();
+        if (m > 0.0f) { w /= m; x /= m; y /= m; z /= m; }
+    }
+
+    Quaternion getNormalized() const {
+        Quaternion r(w, x, y, z);
+        r.normalize();
+        return r;
+    }
+};
+
+class VectorInt16 {
+public:
+    int16_t x, y, z;
+
+    VectorInt16() : x(0), y(0), z(0) {}
+    VectorInt16(int16_t nx, int16_t ny, int16_t nz) : x(nx), y(ny), z(nz) {}
+
+    float getMagnitude() const { return sqrtf((float)x * x + (float)y * y + (float)z * z); }
+};
+
+class VectorFloat {
+public:
+    float x, y, z;
+
+    VectorFloat() : x(0.0f), y(0.0f), z(0.0f) {}
+    VectorFloat(float nx, float ny, float nz) : x(nx), y(ny), z(nz) {}
+
+    float getMagnitude() const { return sqrtf(x * x + y * y + z * z); }
+
+    void normalize() {
+        float m = getMagnitude();
+        if (m > 0.0f) { x /= m; y /= m; z /= m; }
+    }
+
+    void rotate(Quaternion* q) {
+        Quaternion p(0, x, y, z);
+        p = q->getProduct(p);
+        p = p.getProduct(q->getConjugate());
+        x = p.x;
+        y = p.y;
+        z = p.z;
+    }
+};
+
+#endif // NATIVE_HELPER_3DMATH_H
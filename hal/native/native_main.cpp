@@ -0,0 +1,43 @@
+/**
+ * native_main.cpp
+ * 主機端程式入口：與 Arduino 核心相同，先呼叫 setup() 再重複呼叫 loop()
+ *
+ * 命令列參數:
+ *   --realtime     以實際時間執行 (預設為虛擬時間，可比實時更快)
+ *   --seconds N    虛擬時間超過 N 秒後結束 (預設不限)
+ */
+
+#include <Arduino.h>
+#include "NativeSim.h"
+
+#include <cstdlib>
+#include <cstring>
+
+int main(int argc, char** argv) {
+    uint64_t limitMicros = 0;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--realtime") == 0) {
+            NativeSim::setRealTime(true);
+        } else if (strcmp(argv[i], "--seconds") == 0 && i + 1 < argc) {
+            limitMicros = (uint64_t)(atof(argv[++i]) * 1000000.0);
+        }
+    }
+
+    setup();
+
+    while (!NativeSim::exitRequested()) {
+        uint64_t before = NativeSim::nowMicros();
+        loop();
+        if (NativeSim::nowMicros() == before) {
+            // loop() 沒有推進時間 (沒有 delay 或 I2C)：視為空轉 10us，讓其他任務有機會執行
+            NativeSim::sleepMicros(10);
+        }
+        if (limitMicros > 0 && NativeSim::nowMicros() >= limitMicros) {
+            break;
+        }
+    }
+
+    Serial.flush();
+    return NativeSim::exitCode();
+}
@@ -0,0 +1,206 @@
+/**
+ * pcnt.cpp (native)
+ * 脈衝計數器替身實現
+ */
+
+#include "driver/pcnt.h"
+#include "Arduino.h"
+#include "NativeSim.h"
+
+namespace {
+
+struct PcntChannel {
+    bool configured = false;
+    int pulsePin = PCNT_PIN_NOT_USED;
+    int ctrlPin = PCNT_PIN_NOT_USED;
+    pcnt_ctrl_mode_t lctrlMode = PCNT_MODE_KEEP;
+    pcnt_ctrl_mode_t hctrlMode = PCNT_MODE_KEEP;
+    pcnt_count_mode_t posMode = PCNT_COUNT_DIS;
+    pcnt_count_mode_t negMode = PCNT_COUNT_DIS;
+};
+
+struct PcntUnit {
+    PcntChannel channels[PCNT_CHANNEL_MAX];
+    int16_t count = 0;
+    int16_t hLim = 0;
+    int16_t lLim = 0;
+    bool paused = false;
+    uint16_t filterValue = 0;
+    bool filterEnabled = false;
+    uint32_t eventMask = 0;
+    uint32_t eventStatus = 0;
+    pcnt_isr_handler_t handler = nullptr;
+    void* handlerArg = nullptr;
+};
+
+PcntUnit units[PCNT_UNIT_MAX];
+bool serviceInstalled = false;
+bool pinListened[NATIVE_NUM_PINS];
+
+bool validUnit(pcnt_unit_t unit) {
+    return unit >= PCNT_UNIT_0 && unit < PCNT_UNIT_MAX;
+}
+
+void raiseEvent(PcntUnit& u, uint32_t evt) {
+    u.eventStatus = evt;
+    if ((u.eventMask & evt) && serviceInstalled && u.handler) {
+        u.handler(u.handlerArg);
+    }
+}
+
+void countEdge(PcntUnit& u, const PcntChannel& ch, int level) {
+    pcnt_count_mode_t mode = level == HIGH ? ch.posMode : ch.negMode;
+    if (mode == PCNT_COUNT_DIS) return;
+
+    int step = mode == PCNT_COUNT_INC ? 1 : -1;
+    if (ch.ctrlPin != PCNT_PIN_NOT_USED) {
+        pcnt_ctrl_mode_t ctrl = NativeSim::pinLevel(ch.ctrlPin) == HIGH ? ch.hctrlMode : ch.lctrlMode;
+        if (ctrl == PCNT_MODE_DISABLE) return;
+        if (ctrl == PCNT_MODE_REVERSE) step = -step;
+    }
+
+    // 與硬體相同：到達上下限時計數器歸零
+    u.count += step;
+    if (u.hLim > 0 && u.count >= u.hLim) {
+        u.count = 0;
+        raiseEvent(u, PCNT_EVT_H_LIM);
+    } else if (u.lLim < 0 && u.count <= u.lLim) {
+        u.count = 0;
+        raiseEvent(u, PCNT_EVT_L_LIM);
+    }
+}
+
+void onPinChange(uint8_t pin, int level) {
+    for (auto& u : units) {
+        if (u.paused) continue;
+        for (auto& ch : u.channels) {
+            if (ch.configured && ch.pulsePin == pin) countEdge(u, ch, level);
+        }
+    }
+}
+
+} // namespace
+
+esp_err_t pcnt_unit_config(const pcnt_config_t* config) {
+    if (!config || !validUnit(config->unit) ||
+        config->channel < PCNT_CHANNEL_0 || config->channel >= PCNT_CHANNEL_MAX) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (config->counter_h_lim < 0 || config->counter_l_lim > 0) return ESP_ERR_INVALID_ARG;
+
+    PcntUnit& u = units[config->unit];
+    PcntChannel& ch = u.channels[config->channel];
+    ch.configured = true;
+    ch.pulsePin = config->pulse_gpio_num;
+    ch.ctrlPin = config->ctrl_gpio_num;
+    ch.lctrlMode = config->lctrl_mode;
+    ch.hctrlMode = config->hctrl_mode;
+    ch.posMode = config->pos_mode;
+    ch.negMode = config->neg_mode;
+    u.hLim = config->counter_h_lim;
+    u.lLim = config->counter_l_lim;
+
+    int pin = config->pulse_gpio_num;
+    if (pin >= 0 && pin < NATIVE_NUM_PINS && !pinListened[pin]) {
+        pinListened[pin] = true;
+        NativeSim::addPinListener((uint8_t)pin, onPinChange);
+    }
+    return ESP_OK;
+}
+
+esp_err_t pcnt_get_counter_value(pcnt_unit_t unit, int16_t* count) {
+    if (!validUnit(unit) || !count) return ESP_ERR_INVALID_ARG;
+    *count = units[unit].count;
+    return ESP_OK;
+}
+
+esp_err_t pcnt_counter_pause(pcnt_unit_t unit) {
+    if (!validUnit(unit)) return ESP_ERR_INVALID_ARG;
+    units[unit].paused = true;
+    return ESP_OK;
+}
+
+esp_err_t pcnt_counter_resume(pcnt_unit_t unit) {
+    if (!validUnit(unit)) return ESP_ERR_INVALID_ARG;
+    units[unit].paused = false;
+    return ESP_OK;
+}
+
+esp_err_t pcnt_counter_clear(pcnt_unit_t unit) {
+    if (!validUnit(unit)) return ESP_ERR_INVALID_ARG;
+    units[unit].count = 0;
+    return ESP_OK;
+}
+
+esp_err_t pcnt_set_filter_value(pcnt_unit_t unit, uint16_t filter_val) {
+    // 濾波寬度為 10 位元的 APB 時脈週期數
+    if (!validUnit(unit) || filter_val > 1023) return ESP_ERR_INVALID_ARG;
+    units[unit].filterValue = filter_val;
+    return ESP_OK;
+}
+
+esp_err_t pcnt_get_filter_value(pcnt_unit_t unit, uint16_t* filter_val) {
+    if (!validUnit(unit) || !filter_val) return ESP_ERR_INVALID_ARG;
+    *filter_val = units[unit].filterValue;
+    return ESP_OK;
+}
+
+esp_err_t pcnt_filter_enable(pcnt_unit_t unit) {
+    if (!validUnit(unit)) return ESP_ERR_INVALID_ARG;
+    units[unit].filterEnabled = true;
+    return ESP_OK;
+}
+
+esp_err_t pcnt_filter_disable(pcnt_unit_t unit) {
+    if (!validUnit(unit)) return ESP_ERR_INVALID_ARG;
+    units[unit].filterEnabled = false;
+    return ESP_OK;
+}
+
+esp_err_t pcnt_event_enable(pcnt_unit_t unit, pcnt_evt_type_t evt_type) {
+    if (!validUnit(unit)) return ESP_ERR_INVALID_ARG;
+    units[unit].eventMask |= evt_type;
+    return ESP_OK;
+}
+
+esp_err_t pcnt_event_disable(pcnt_unit_t unit, pcnt_evt_type_t evt_type) {
+    if (!validUnit(unit)) return ESP_ERR_INVALID_ARG;
+    units[unit].eventMask &= ~(uint32_t)evt_type;
+    return ESP_OK;
+}
+
+esp_err_t pcnt_get_event_status(pcnt_unit_t unit, uint32_t* status) {
+    if (!validUnit(unit) || !status) return ESP_ERR_INVALID_ARG;
+    *status = units[unit].eventStatus;
+    return ESP_OK;
+}
+
+esp_err_t pcnt_isr_service_install(int intr_alloc_flags) {
+    (void)intr_alloc_flags;
+    if (serviceInstalled) return ESP_ERR_INVALID_STATE;
+    serviceInstalled = true;
+    return ESP_OK;
+}
+
+void pcnt_isr_service_uninstall(void) {
+    serviceInstalled = false;
+    for (auto& u : units) {
+        u.handler = nullptr;
+        u.handlerArg = nullptr;
+    }
+}
+
+esp_err_t pcnt_isr_handler_add(pcnt_unit_t unit, pcnt_isr_handler_t isr_handler, void* args) {
+    if (!validUnit(unit)) return ESP_ERR_INVALID_ARG;
+    if (!serviceInstalled) return ESP_ERR_INVALID_STATE;
+    units[unit].handler = isr_handler;
+    units[unit].handlerArg = args;
+    return ESP_OK;
+}
+
+esp_err_t pcnt_isr_handler_remove(pcnt_unit_t unit) {
+    if (!validUnit(unit)) return ESP_ERR_INVALID_ARG;
+    units[unit].handler = nullptr;
+    units[unit].handlerArg = nullptr;
+    return ESP_OK;
+}
@@ -1,37 +1,116 @@
 #ifndef PINS_H
 #define PINS_H
 
-// I2C 介面腳位
-#define I2C_SDA 5
-#define I2C_SCL 6
+#include <stdint.h>
+#include "FastGpio.h"
+
+// I2C 裝置位址
 #define I2C_OLED_ADDR 0x3C
 #define I2C_MPU_ADDR 0x68
 
+// OLED
+#define OLED_WIDTH 128      // OLED 顯示器寬度，常見值為 128 像素
+#define OLED_HEIGHT 64      // OLED 顯示器高度，常見值為 32 或 64 像
 
-// 馬達 1 控制腳位
-#define MOTOR1_PWM 7
-#define MOTOR1_AIN1 15
-#define MOTOR1_AIN2 16
-#define MOTOR1_ENA 12
-#define MOTOR1_ENB 11
+// 未連接的腳位
+constexpr int8_t PIN_NONE = -1;
 
-// 馬達 2 控制腳位
-#define MOTOR2_PWM 17
-#define MOTOR2_AIN1 18
-#define MOTOR2_AIN2 8
-#define MOTOR2_ENA 2
-#define MOTOR2_ENB 1
+/**
+ * 一個輪子的馬達驅動 (TB6612) 與編碼器腳位
+ */
+struct WheelPins {
+    int8_t pwm;
+    int8_t in1;
+    int8_t in2;
+    int8_t encoderA;
+    int8_t encoderB;
+};
 
-// 馬達共用控制腳位
-#define MOTOR_STBY 9
+/**
+ * 電路板腳位配置
+ */
+struct BoardProfile {
+    const char* name;
+    int8_t i2cSda;               // I2C 介面 (Wire)：MPU6050 與 OLED
+    int8_t i2cScl;
+    int8_t i2c2Sda;              // 第二個 I2C 介面 (Wire1)：以 -DOLED_USE_SECOND_I2C=1 建置時 OLED 改接這兩個腳位
+    int8_t i2c2Scl;
+    WheelPins wheels[2];         // [0] 馬達 1 (左), [1] 馬達 2 (右)
+    int8_t motorStby;            // 兩個馬達共用的 STBY
+    int8_t mpuInt;               // MPU6050 INT，PIN_NONE 表示只能輪詢
+    int8_t bootButton;           // BOOT 按鈕 (換頁、啟動馬達)
+    int8_t calibrateButton;      // IMU 校準按鈕，PIN_NONE 表示只能以串口命令 "IMU:CAL" 校準
+    int8_t ws2812;               // WS2812 燈珠 DI
+};
 
-// OLED 
-#define OLED_WIDTH 128      // OLED 顯示器寬度，常見值為 128 像素
-#define OLED_HEIGHT 64      // OLED 顯示器高度，常見值為 32 或 64 像
-// MPU (慣性測量單元) 腳位
-#define MPU_INT 18
+// 原始接線。MPU6050 的 INT 與馬達 2 的 IN1 同為 GPIO18，原本假設的校準按鈕 GPIO1 是馬達 2 的編碼器 B，
+// 兩者都不能使用，視為未連接
+constexpr BoardProfile BOARD_REV_A = {
+    "rev-a",
+    5, 6,
+    13, 14,
+    {
+        {7, 15, 16, 12, 11},
+        {17, 18, 8, 2, 1},
+    },
+    9,
+    PIN_NONE,
+    0,
+    PIN_NONE,
+    48
+};
+
+// 原始接線，但 MPU6050 的 INT 改接空閒的 GPIO4 (native_balance_sim 模擬的接法)
+constexpr BoardProfile BOARD_REV_A_INT4 = {
+    "rev-a-int4",
+    5, 6,
+    13, 14,
+    {
+        {7, 15, 16, 12, 11},
+        {17, 18, 8, 2, 1},
+    },
+    9,
+    4,
+    0,
+    PIN_NONE,
+    48
+};
+
+// 使用的腳位配置，以 build_flags 的 -DBOARD_PROFILE=<名稱> 切換
+#ifndef BOARD_PROFILE
+#define BOARD_PROFILE BOARD_REV_A
+#endif
+
+static constexpr const BoardProfile& BOARD = BOARD_PROFILE;
+
+// 腳位檢查 (C++11 constexpr，只能以遞迴取代迴圈)
+// 可用的 GPIO 與 FastPin/PinnedMotor 共用 gpioUsable() 的規則
+constexpr bool boardPinUsable(int pin) {
+    return pin == PIN_NONE || gpioUsable(pin);
+}
+
+constexpr bool boardPinsUsable(const int8_t* pins, int count) {
+    return count == 0 || (boardPinUsable(pins[0]) && boardPinsUsable(pins + 1, count - 1));
+}
+
+constexpr bool boardPinListed(const int8_t* pins, int count, int8_t pin) {
+    return count > 0 && (pins[0] == pin || boardPinListed(pins + 1, count - 1, pin));
+}
+
+constexpr bool boardPinsUnique(const int8_t* pins, int count) {
+    return count == 0 ||
+           ((pins[0] == PIN_NONE || !boardPinListed(pins + 1, count - 1, pins[0])) &&
+            boardPinsUnique(pins + 1, count - 1));
+}
+
+static constexpr int8_t BOARD_PINS[] = {
+    BOARD.i2cSda, BOARD.i2cScl, BOARD.i2c2Sda, BOARD.i2c2Scl,
+    BOARD.wheels[0].pwm, BOARD.wheels[0].in1, BOARD.wheels[0].in2, BOARD.wheels[0].encoderA, BOARD.wheels[0].encoderB,
+    BOARD.wheels[1].pwm, BOARD.wheels[1].in1, BOARD.wheels[1].in2, BOARD.wheels[1].encoderA, BOARD.wheels[1].encoderB,
+    BOARD.motorStby, BOARD.mpuInt, BOARD.bootButton, BOARD.calibrateButton, BOARD.ws2812
+};
 
-// WS2812 燈珠 
-#define WS2812_DI 48 
+static_assert(boardPinsUsable(BOARD_PINS, sizeof(BOARD_PINS)), "board profile uses a GPIO that is missing or wired to flash");
+static_assert(boardPinsUnique(BOARD_PINS, sizeof(BOARD_PINS)), "board profile assigns the same GPIO to two signals");
 
 #endif // PINS_H
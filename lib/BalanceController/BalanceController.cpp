@@ -0,0 +1,568 @@
+/**
+ * BalanceController.cpp
+ * 串級平衡控制器實現
+ */
+
+#include "BalanceController.h"
+
+// 預設頻率：內環 1 kHz，外環與 DMP 輸出頻率相同
+static const uint32_t DEFAULT_OUTER_RATE_HZ = 100;
+static const uint32_t DEFAULT_INNER_RATE_HZ = 1000;
+
+// 任務與計時器索引
+static const int OUTER = 0;
+static const int INNER = 1;
+
+// 建構函數
+BalanceController::BalanceController(IMU* imu, Motor* leftMotor, Motor* rightMotor,
+                                     Encoder* leftEncoder, Encoder* rightEncoder)
+    : imu(imu),
+      leftMotor(leftMotor),
+      rightMotor(rightMotor),
+      leftEncoder(leftEncoder),
+      rightEncoder(rightEncoder),
+      gainsSeq(0),
+      outerGainsSeq(0),
+      innerGainsSeq(0),
+      outerRateHz(DEFAULT_OUTER_RATE_HZ),
+      innerRateHz(DEFAULT_INNER_RATE_HZ),
+      targetPitch(0.0f),
+      fallAngle(45.0f * DEG_TO_RAD),
+      velocityLimit(300.0f),
+      enabled(false),
+      fallen(false),
+      leftWheel(leftMotor, leftEncoder),
+      rightWheel(rightMotor, rightEncoder),
+      mixer(300.0f),
+      turnSetpoint(0.0f),
+      trackTarget(0.0f),
+      trackKp(5.0f),
+      lastSampleMicros(0),
+      sampleDriven(false),
+      setpointSeq(0),
+      appliedSeq(0),
+      pitch(0.0f),
+      telemetry(nullptr),
+      telemetrySeq(0),
+      profiler(nullptr),
+      outerStage(-1),
+      innerStage(-1),
+      imuStage(-1),
+      encoderStage(-1)
+{
+    gains.angleKp = 1200.0f;
+    gains.angleKi = 6000.0f;
+    gains.angleKd = 20.0f;
+    gains.speedKp = 3.0f;
+    gains.speedKi = 30.0f;
+    pendingGains = gains;
+    portMUX_TYPE unlocked = portMUX_INITIALIZER_UNLOCKED;
+    gainsMux = unlocked;
+
+    // 角度環的誤差定義為 俯仰角 - 平衡點，與 PID 的 設定值 - 量測值 相反
+    anglePid.setDirection(PID_REVERSE);
+    anglePid.setTunings(gains.angleKp, gains.angleKi, gains.angleKd);
+    anglePid.setOutputLimits(-velocityLimit, velocityLimit);
+    leftWheel.setTunings(gains.speedKp, gains.speedKi);
+    rightWheel.setTunings(gains.speedKp, gains.speedKi);
+
+    // 平衡所需的輪速優先於轉向
+    mixer.setTurnPriority(false);
+
+    taskHandles[OUTER] = taskHandles[INNER] = nullptr;
+    timers[OUTER] = timers[INNER] = nullptr;
+
+    resetState();
+    resetStats();
+}
+
+// 析構函數
+BalanceController::~BalanceController() {
+    stop();
+    for (int i = 0; i < 2; i++) {
+        if (timers[i]) {
+            esp_timer_delete(timers[i]);
+        }
+        if (taskHandles[i]) {
+            vTaskDelete(taskHandles[i]);
+        }
+    }
+}
+
+// 設定控制頻率
+void BalanceController::setRates(uint32_t outerHz, uint32_t innerHz) {
+    outerRateHz = max(outerHz, (uint32_t)1);
+    innerRateHz = max(innerHz, (uint32_t)1);
+
+    // 執行中則以新週期重新啟動計時器
+    uint32_t rates[2] = {outerRateHz, innerRateHz};
+    for (int i = 0; i < 2; i++) {
+        if (timers[i] && esp_timer_is_active(timers[i])) {
+            esp_timer_stop(timers[i]);
+            esp_timer_start_periodic(timers[i], 1000000UL / rates[i]);
+        }
+    }
+    lastOuterMicros = 0;
+    lastInnerMicros = 0;
+}
+
+// 設定控制增益
+void BalanceController::setGains(const BalanceGains& newGains) {
+    gains = newGains;
+    anglePid.setTunings(gains.angleKp, gains.angleKi, gains.angleKd);
+    leftWheel.setTunings(gains.speedKp, gains.speedKi);
+    rightWheel.setTunings(gains.speedKp, gains.speedKi);
+    anglePid.reset();
+    leftWheel.reset();
+    rightWheel.reset();
+
+    // 取代尚未套用的 retune()
+    portENTER_CRITICAL(&gainsMux);
+    pendingGains = gains;
+    gainsSeq = gainsSeq + 1;
+    outerGainsSeq = gainsSeq;
+    innerGainsSeq = gainsSeq;
+    portEXIT_CRITICAL(&gainsMux);
+}
+
+// 執行中調整增益
+void BalanceController::retune(const BalanceGains& newGains) {
+    gains = newGains;
+    portENTER_CRITICAL(&gainsMux);
+    pendingGains = newGains;
+    gainsSeq = gainsSeq + 1;
+    portEXIT_CRITICAL(&gainsMux);
+}
+
+// 取出尚未套用的增益 (控制任務呼叫)
+bool BalanceController::takeGains(uint32_t& appliedGainsSeq, BalanceGains& out) {
+    if (gainsSeq == appliedGainsSeq) {
+        return false;
+    }
+    portENTER_CRITICAL(&gainsMux);
+    out = pendingGains;
+    appliedGainsSeq = gainsSeq;
+    portEXIT_CRITICAL(&gainsMux);
+    return true;
+}
+
+// 獲取控制增益
+BalanceGains BalanceController::getGains() const {
+    return gains;
+}
+
+// 設定平衡點俯仰角
+void BalanceController::setTargetPitch(float pitch) {
+    targetPitch = pitch;
+}
+
+// 獲取平衡點俯仰角
+float BalanceController::getTargetPitch() const {
+    return targetPitch;
+}
+
+// 設定倒下判定門檻
+void BalanceController::setFallAngle(float angle) {
+    fallAngle = angle;
+}
+
+// 獲取倒下判定門檻
+float BalanceController::getFallAngle() const {
+    return fallAngle;
+}
+
+// 設定輪速設定值上限
+void BalanceController::setVelocityLimit(float rpm) {
+    velocityLimit = rpm;
+    anglePid.setOutputLimits(-rpm, rpm);
+    mixer.setMaxWheelSpeed(rpm);
+}
+
+// 獲取輪速設定值上限
+float BalanceController::getVelocityLimit() const {
+    return velocityLimit;
+}
+
+// 設定轉向量
+void BalanceController::setTurnSetpoint(float rpm) {
+    turnSetpoint = rpm;
+}
+
+// 獲取轉向量
+float BalanceController::getTurnSetpoint() const {
+    return turnSetpoint;
+}
+
+// 設定直線保持增益
+void BalanceController::setTrackGain(float kp) {
+    trackKp = kp > 0 ? kp : 0.0f;
+}
+
+// 獲取直線保持增益
+float BalanceController::getTrackGain() const {
+    return trackKp;
+}
+
+// 建立控制任務並啟動週期計時器
+bool BalanceController::start(UBaseType_t priority, BaseType_t core) {
+    static const char* taskNames[2] = {"BalanceOuter", "BalanceInner"};
+    static const char* timerNames[2] = {"balance_outer", "balance_inner"};
+    TaskFunction_t entries[2] = {outerTaskEntry, innerTaskEntry};
+    UBaseType_t priorities[2] = {priority > 1 ? priority - 1 : 1, priority};
+    uint32_t rates[2] = {outerRateHz, innerRateHz};
+
+    // 需在建立任務前決定，外環任務建立後可能立即開始執行
+    sampleDriven = imu->isInterruptMode();
+
+    for (int i = 0; i < 2; i++) {
+        if (!taskHandles[i]) {
+            if (xTaskCreatePinnedToCore(entries[i], taskNames[i], 4096, this, priorities[i],
+                                        &taskHandles[i], core) != pdPASS) {
+                taskHandles[i] = nullptr;
+                return false;
+            }
+        }
+
+        if (!timers[i]) {
+            esp_timer_create_args_t args = {};
+            args.callback = timerCallback;
+            args.arg = &taskHandles[i];
+            args.dispatch_method = ESP_TIMER_TASK;
+            args.name = timerNames[i];
+            if (esp_timer_create(&args, &timers[i]) != ESP_OK) {
+                timers[i] = nullptr;
+                return false;
+            }
+        }
+    }
+
+    lastOuterMicros = 0;
+    lastInnerMicros = 0;
+    for (int i = sampleDriven ? INNER : OUTER; i < 2; i++) {
+        if (!esp_timer_is_active(timers[i]) &&
+            esp_timer_start_periodic(timers[i], 1000000UL / rates[i]) != ESP_OK) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// 停止週期計時器
+void BalanceController::stop() {
+    for (int i = 0; i < 2; i++) {
+        if (timers[i] && esp_timer_is_active(timers[i])) {
+            esp_timer_stop(timers[i]);
+        }
+    }
+    stopOutput();
+}
+
+// 計時器回呼 (esp_timer 任務)：喚醒對應的控制任務
+void BalanceController::timerCallback(void* arg) {
+    TaskHandle_t task = *static_cast<TaskHandle_t*>(arg);
+    if (task) {
+        xTaskNotifyGive(task);
+    }
+}
+
+// 外環任務
+void BalanceController::outerTaskEntry(void* arg) {
+    BalanceController* self = static_cast<BalanceController*>(arg);
+
+    while (1) {
+        if (self->sampleDriven) {
+            // 由 IMU 數據就緒中斷驅動；超過兩個週期沒有數據時仍執行一次以便偵測異常
+            TickType_t timeout = pdMS_TO_TICKS(2000 / self->outerRateHz) + 1;
+            if (!self->imu->waitForData(timeout)) {
+                self->stats.outer.missed++;
+            }
+        } else {
+            // 通知計數大於 1 表示上一週期尚未執行完就又觸發
+            uint32_t pending = ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+            if (pending > 1) {
+                self->stats.outer.missed += pending - 1;
+            }
+        }
+        self->runOuterLoop();
+    }
+}
+
+// 內環任務
+void BalanceController::innerTaskEntry(void* arg) {
+    BalanceController* self = static_cast<BalanceController*>(arg);
+
+    while (1) {
+        uint32_t pending = ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        if (pending > 1) {
+            self->stats.inner.missed += pending - 1;
+        }
+        self->runInnerLoop();
+    }
+}
+
+// 記錄一次執行的抖動與執行時間
+void BalanceController::recordTick(LoopStats& loop, uint32_t start, uint32_t& lastStart, uint32_t periodMicros) {
+    if (lastStart != 0) {
+        int32_t jitter = (int32_t)(start - lastStart) - (int32_t)periodMicros;
+        uint32_t absJitter = jitter < 0 ? -jitter : jitter;
+        if (absJitter > loop.maxJitterMicros) {
+            loop.maxJitterMicros = absJitter;
+        }
+    }
+    lastStart = start;
+
+    uint32_t exec = micros() - start;
+    loop.ticks++;
+    loop.lastExecMicros = exec;
+    if (exec > loop.maxExecMicros) {
+        loop.maxExecMicros = exec;
+    }
+    if (exec > periodMicros) {
+        loop.overruns++;
+    }
+}
+
+// 外環：俯仰角 → 輪速設定值
+void BalanceController::runOuterLoop() {
+    ProfilerScope outerSpan(profiler, outerStage);
+    uint32_t start = micros();
+
+    BalanceGains tuned;
+    if (takeGains(outerGainsSeq, tuned)) {
+        anglePid.setTunings(tuned.angleKp, tuned.angleKi, tuned.angleKd);
+    }
+
+    // 以取樣時間戳判斷是否有新數據 (其他任務也可能先讀走同一筆)
+    {
+        ProfilerScope imuSpan(profiler, imuStage);
+        imu->update();
+    }
+    uint32_t sample = imu->getSampleMicros();
+    if (sample == lastSampleMicros) {
+        stats.imuMisses++;
+        recordTick(stats.outer, start, lastOuterMicros, 1000000UL / outerRateHz);
+        return;
+    }
+
+    // 以實際取樣間隔積分，避免漏拍時積分量偏差
+    float dt = 1.0f / outerRateHz;
+    if (lastSampleMicros != 0) {
+        dt = min((sample - lastSampleMicros) * 1e-6f, 4.0f / outerRateHz);
+    }
+    lastSampleMicros = sample;
+
+    pitch = imu->getPitch();
+    float error = pitch - targetPitch;
+
+    if (fabs(error) > fallAngle) {
+        // 倒下：停止輸出，直到重新啟用
+        if (!fallen) {
+            fallen = true;
+            velocitySetpoint = 0.0f;
+            anglePid.reset();
+        }
+    } else if (enabled && !fallen) {
+        // 微分項直接使用陀螺儀角速度，比相鄰兩次角度相減乾淨
+        velocitySetpoint = anglePid.computeWithRate(targetPitch, pitch, imu->getPitchRate(), dt);
+        setpointSampleMicros = sample;
+        setpointSeq = setpointSeq + 1;
+    }
+
+    recordTick(stats.outer, start, lastOuterMicros, 1000000UL / outerRateHz);
+}
+
+// 內環：輪速 → PWM
+void BalanceController::runInnerLoop() {
+    ProfilerScope innerSpan(profiler, innerStage);
+    uint32_t start = micros();
+
+    BalanceGains tuned;
+    if (takeGains(innerGainsSeq, tuned)) {
+        leftWheel.setTunings(tuned.speedKp, tuned.speedKi);
+        rightWheel.setTunings(tuned.speedKp, tuned.speedKi);
+    }
+
+    {
+        ProfilerScope encoderSpan(profiler, encoderStage);
+        leftEncoder->update();
+        rightEncoder->update();
+    }
+
+    EncoderSnapshot left = leftEncoder->getSnapshot();
+    EncoderSnapshot right = rightEncoder->getSnapshot();
+    wheelVelocity = (left.velocity + right.velocity) * 0.5f;
+    wheelPosition = (float)((left.positionRad + right.positionRad) * 0.5);
+
+    if (!enabled || fallen) {
+        stopOutput();
+    } else {
+        float dt = 1.0f / innerRateHz;
+
+        // 直線保持：目標位置差依轉向量前進，實際位置差的偏差以比例修正轉向量
+        float turn = turnSetpoint;
+        float halfDifference = (float)((left.positionRad - right.positionRad) * 0.5);
+        trackTarget += turn * (TWO_PI / 60.0f) * dt;
+        turn += trackKp * (trackTarget - halfDifference) * (60.0f / TWO_PI);
+
+        WheelSetpoints setpoints = mixer.mix(velocitySetpoint, turn);
+        leftWheel.setSetpoint(setpoints.left);
+        rightWheel.setSetpoint(setpoints.right);
+        output = (leftWheel.update(dt) + rightWheel.update(dt)) / 2;
+
+        // 延遲：新設定值第一次寫到馬達時，距其 IMU 取樣的時間
+        uint32_t seq = setpointSeq;
+        if (seq != appliedSeq) {
+            appliedSeq = seq;
+            uint32_t latency = micros() - setpointSampleMicros;
+            stats.lastLatencyMicros = latency;
+            if (latency > stats.maxLatencyMicros) {
+                stats.maxLatencyMicros = latency;
+            }
+        }
+    }
+
+    // 遙測：每個內環週期一筆，緩衝區滿時丟棄，不等待遙測任務
+    if (telemetry) {
+        TelemetrySample sample;
+        sample.seq = telemetrySeq++;
+        sample.timestamp = start;
+        sample.targetRpm = velocitySetpoint;
+        sample.currentRpm = wheelVelocity;
+        sample.output = (int16_t)output;
+        sample.pitch = pitch * RAD_TO_DEG;
+        telemetry->push(sample);
+    }
+
+    recordTick(stats.inner, start, lastInnerMicros, 1000000UL / innerRateHz);
+}
+
+// 設定遙測緩衝區
+void BalanceController::setTelemetry(TelemetryRing* ring) {
+    telemetry = ring;
+}
+
+// 設定效能量測器
+void BalanceController::setProfiler(Profiler* p) {
+    if (p) {
+        outerStage = p->registerStage("balance.outer");
+        innerStage = p->registerStage("balance.inner");
+        imuStage = p->registerStage("imu.update");
+        encoderStage = p->registerStage("encoder.update");
+    }
+    profiler = p;
+}
+
+// 停止兩輪輸出並清除輪速環積分 (數值不變時不重複寫入馬達)
+void BalanceController::stopOutput() {
+    leftWheel.stop();
+    rightWheel.stop();
+    output = 0;
+}
+
+// 清除控制狀態
+void BalanceController::resetState() {
+    anglePid.reset();
+    leftWheel.reset();
+    rightWheel.reset();
+    trackTarget = (float)((leftEncoder->getSnapshot().positionRad - rightEncoder->getSnapshot().positionRad) * 0.5);
+    velocitySetpoint = 0.0f;
+    wheelVelocity = 0.0f;
+    wheelPosition = 0.0f;
+    output = 0;
+    appliedSeq = setpointSeq;
+    lastOuterMicros = 0;
+    lastInnerMicros = 0;
+}
+
+// 啟用或停用馬達輸出
+void BalanceController::setEnabled(bool enable) {
+    if (enable && !enabled) {
+        resetState();
+        fallen = false;
+    }
+    enabled = enable;
+}
+
+// 檢查馬達輸出是否啟用
+bool BalanceController::isEnabled() const {
+    return enabled;
+}
+
+// 檢查是否已倒下
+bool BalanceController::isFallen() const {
+    return fallen;
+}
+
+// 獲取輪速設定值
+float BalanceController::getVelocitySetpoint() const {
+    return velocitySetpoint;
+}
+
+// 獲取兩輪平均速度
+float BalanceController::getWheelVelocity() const {
+    return wheelVelocity;
+}
+
+// 獲取兩輪平均位置
+float BalanceController::getWheelPosition() const {
+    return wheelPosition;
+}
+
+// 獲取內環輸出
+int BalanceController::getOutput() const {
+    return output;
+}
+
+// 獲取左輪控制器
+const WheelController& BalanceController::getLeftWheel() const {
+    return leftWheel;
+}
+
+// 獲取右輪控制器
+const WheelController& BalanceController::getRightWheel() const {
+    return rightWheel;
+}
+
+// 獲取內環頻率
+uint32_t BalanceController::getInnerRate() const {
+    return innerRateHz;
+}
+
+// 獲取實際外環頻率
+uint32_t BalanceController::getOuterRate() const {
+    return outerRateHz;
+}
+
+// 獲取執行統計
+BalanceStats BalanceController::getStats() const {
+    return stats;
+}
+
+// 清除執行統計
+void BalanceController::resetStats() {
+    memset(&stats, 0, sizeof(stats));
+}
+
+// 以 Teleplot 格式輸出
+void BalanceController::teleplotOutput() const {
+    Serial.print(">balance_setpoint_rpm:");
+    Serial.println(velocitySetpoint);
+    Serial.print(">balance_wheel_rpm:");
+    Serial.println(wheelVelocity);
+    Serial.print(">balance_wheel_position_rad:");
+    Serial.println(wheelPosition);
+    Serial.print(">balance_output:");
+    Serial.println(output);
+    Serial.print(">balance_left_rpm:");
+    Serial.println(leftWheel.getVelocity());
+    Serial.print(">balance_right_rpm:");
+    Serial.println(rightWheel.getVelocity());
+    Serial.print(">balance_inner_exec_max_us:");
+    Serial.println(stats.inner.maxExecMicros);
+    Serial.print(">balance_inner_jitter_max_us:");
+    Serial.println(stats.inner.maxJitterMicros);
+    Serial.print(">balance_outer_exec_max_us:");
+    Serial.println(stats.outer.maxExecMicros);
+    Serial.print(">balance_latency_us:");
+    Serial.println(stats.lastLatencyMicros);
+}
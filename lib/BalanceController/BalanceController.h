@@ -0,0 +1,363 @@
+/**
+ * BalanceController.h
+ * 串級平衡控制器：外環角度控制 + 內環輪速控制
+ *
+ * 功能概述:
+ * - 外環：俯仰角誤差 → 輪速設定值 (RPM)，微分項直接使用 IMU 的俯仰角速度
+ * - 內環：外環的前進速度與轉向設定值經 DriveMixer 混合後，左右輪各自以帶方向的 PI 控制輪速 (WheelController)，
+ *   兩輪的差異由各自的積分項補償；另以兩輪累計位置差的比例回授修正轉向量，速度誤差不會累積成航向偏差
+ * - 兩個環各自由 esp_timer 週期性喚醒一個任務，頻率可分別設定；
+ *   內環任務優先權較高，外環讀取 IMU 時的 I2C 阻塞不會延誤內環
+ * - IMU 啟用數據就緒中斷時，外環改由每筆 IMU 取樣觸發，積分以取樣時間戳計算實際間隔
+ * - 記錄每個環的執行時間、週期抖動、漏拍次數，以及 IMU 取樣到馬達輸出的延遲
+ * - 傾角超過倒下門檻時自動停止馬達，需重新啟用才會恢復
+ * - 可選擇在每個內環週期將設定值、輪速、輸出與俯仰角推入遙測緩衝區 (不加鎖)
+ */
+
+#ifndef BALANCE_CONTROLLER_H
+#define BALANCE_CONTROLLER_H
+
+#include <Arduino.h>
+#include <esp_timer.h>
+#include "IMU.h"
+#include "motor.h"
+#include "encoder.h"
+#include "TelemetryWriter.h"
+#include "Profiler.h"
+#include "Pid.h"
+#include "DiffDrive.h"
+
+/**
+ * 控制增益
+ * 正負號與安裝方向有關：前傾時 getPitch() 為正、輪子向前轉時編碼器速度為正
+ */
+struct BalanceGains {
+    float angleKp;   // RPM / rad
+    float angleKi;   // RPM / (rad·s)
+    float angleKd;   // RPM / (rad/s)
+    float speedKp;   // PWM / RPM
+    float speedKi;   // PWM / (RPM·s)
+};
+
+/**
+ * 單一控制環的執行統計 (單位 us)
+ */
+struct LoopStats {
+    uint32_t ticks;              // 執行次數
+    uint32_t missed;             // 任務來不及執行而被合併的週期數
+    uint32_t overruns;           // 單次執行時間超過週期的次數
+    uint32_t lastExecMicros;     // 最近一次執行時間
+    uint32_t maxExecMicros;      // 最長執行時間
+    uint32_t maxJitterMicros;    // 實際間隔與設定週期的最大偏差
+};
+
+/**
+ * 控制器執行統計
+ * 由控制任務寫入，讀取時不加鎖，僅供診斷使用
+ */
+struct BalanceStats {
+    LoopStats outer;
+    LoopStats inner;
+    uint32_t lastLatencyMicros;  // 最近一次 IMU 取樣到對應馬達輸出的延遲 (us)
+    uint32_t maxLatencyMicros;   // 最大延遲 (us)
+    uint32_t imuMisses;          // 外環執行時 IMU 沒有新數據的次數
+};
+
+class BalanceController {
+private:
+    IMU* imu;
+    Motor* leftMotor;
+    Motor* rightMotor;
+    Encoder* leftEncoder;
+    Encoder* rightEncoder;
+
+    BalanceGains gains;
+
+    // 執行中修改的增益：retune() 寫入並遞增序號，兩個控制任務各自在下一次執行開始時套用
+    portMUX_TYPE gainsMux;
+    BalanceGains pendingGains;
+    volatile uint32_t gainsSeq;
+    uint32_t outerGainsSeq;
+    uint32_t innerGainsSeq;
+
+    // 頻率設定
+    uint32_t outerRateHz;
+    uint32_t innerRateHz;
+
+    // 設定值與限制
+    float targetPitch;           // 平衡點俯仰角 (rad)
+    float fallAngle;             // 倒下判定門檻 (rad)
+    float velocityLimit;         // 輪速設定值上限 (RPM)
+
+    // 控制狀態
+    volatile bool enabled;
+    volatile bool fallen;
+    Pid<float> anglePid;         // 俯仰角 → 輪速設定值 (反向：前傾時輪子向前)
+    WheelController leftWheel;   // 左輪速 → PWM
+    WheelController rightWheel;  // 右輪速 → PWM
+    DriveMixer mixer;            // 前進 + 轉向 → 兩輪設定值 (前進優先)
+    volatile float turnSetpoint; // 轉向量 (RPM，正值向右轉)
+    float trackTarget;           // 兩輪位置差之半的目標值 (rad)，隨轉向量積分
+    float trackKp;               // 位置差 → 轉向修正 (1/s)
+    volatile float velocitySetpoint;
+    float wheelVelocity;
+    float wheelPosition;         // 兩輪平均累計角度 (rad)
+    int output;                  // 兩輪輸出的平均
+    uint32_t lastSampleMicros;   // 外環上次使用的 IMU 取樣時間
+    bool sampleDriven;           // 外環由 IMU 數據就緒中斷觸發
+
+    // 延遲量測：外環發布設定值時附上取樣時間與序號，內環第一次使用時計算延遲
+    volatile uint32_t setpointSampleMicros;
+    volatile uint32_t setpointSeq;
+    uint32_t appliedSeq;
+
+    uint32_t lastOuterMicros;
+    uint32_t lastInnerMicros;
+
+    volatile float pitch;        // 外環最近一次讀到的俯仰角 (rad)
+
+    // 遙測：內環為唯一的生產者
+    TelemetryRing* telemetry;
+    uint32_t telemetrySeq;
+
+    // 效能量測 (可選)：外環、內環與其中的 IMU/編碼器讀取
+    Profiler* profiler;
+    int outerStage;
+    int innerStage;
+    int imuStage;
+    int encoderStage;
+
+    BalanceStats stats;
+
+    // 任務與計時器：[0] 外環, [1] 內環
+    TaskHandle_t taskHandles[2];
+    esp_timer_handle_t timers[2];
+
+    bool takeGains(uint32_t& appliedGainsSeq, BalanceGains& out);
+    void stopOutput();
+    void resetState();
+    static void recordTick(LoopStats& loop, uint32_t start, uint32_t& lastStart, uint32_t periodMicros);
+
+    static void timerCallback(void* arg);
+    static void outerTaskEntry(void* arg);
+    static void innerTaskEntry(void* arg);
+
+public:
+    /**
+     * 建構函數
+     * @param imu IMU 物件 (控制器會呼叫其 update())
+     * @param leftMotor 左馬達
+     * @param rightMotor 右馬達
+     * @param leftEncoder 左編碼器
+     * @param rightEncoder 右編碼器
+     */
+    BalanceController(IMU* imu, Motor* leftMotor, Motor* rightMotor,
+                      Encoder* leftEncoder, Encoder* rightEncoder);
+
+    /**
+     * 析構函數
+     */
+    ~BalanceController();
+
+    /**
+     * 設定控制頻率，執行中呼叫會立即套用
+     * @param outerHz 角度環頻率
+     * @param innerHz 輪速環頻率
+     */
+    void setRates(uint32_t outerHz, uint32_t innerHz);
+
+    /**
+     * 設定控制增益，並清除積分項
+     * 直接修改 PID 狀態，只應在控制任務沒有執行時呼叫 (start() 之前或 stop() 之後)
+     * @param newGains 增益
+     */
+    void setGains(const BalanceGains& newGains);
+
+    /**
+     * 執行中調整增益：交給控制任務在下一次執行開始時套用，不清除積分項
+     * 可由其他任務呼叫
+     * @param newGains 增益
+     */
+    void retune(const BalanceGains& newGains);
+
+    /**
+     * 獲取控制增益
+     * @return 目前增益
+     */
+    BalanceGains getGains() const;
+
+    /**
+     * 設定平衡點俯仰角（補償重心偏移）
+     * @param pitch 俯仰角（弧度）
+     */
+    void setTargetPitch(float pitch);
+
+    /**
+     * 獲取平衡點俯仰角（弧度）
+     */
+    float getTargetPitch() const;
+
+    /**
+     * 設定倒下判定門檻
+     * @param angle 與平衡點的最大偏差（弧度）
+     */
+    void setFallAngle(float angle);
+
+    /**
+     * 獲取倒下判定門檻（弧度）
+     */
+    float getFallAngle() const;
+
+    /**
+     * 設定輪速設定值上限
+     * @param rpm 上限（RPM）
+     */
+    void setVelocityLimit(float rpm);
+
+    /**
+     * 獲取輪速設定值上限（RPM）
+     */
+    float getVelocityLimit() const;
+
+    /**
+     * 設定轉向量，平衡所需的前進速度優先，剩餘的輪速餘量才用於轉向
+     * @param rpm 兩輪速度差的一半 (RPM，正值向右轉)
+     */
+    void setTurnSetpoint(float rpm);
+
+    /**
+     * 獲取轉向量
+     * @return 轉向量 (RPM)
+     */
+    float getTurnSetpoint() const;
+
+    /**
+     * 設定直線保持增益：兩輪累計位置差偏離目標時的轉向修正
+     * @param kp 每秒修正的比例 (1/s)，0 表示停用
+     */
+    void setTrackGain(float kp);
+
+    /**
+     * 獲取直線保持增益 (1/s)
+     */
+    float getTrackGain() const;
+
+    /**
+     * 建立兩個控制任務並啟動週期計時器
+     * 外環任務的優先權為 priority - 1；若 IMU 已啟用中斷模式，外環改為等待 IMU 數據，
+     * 此時外環頻率應設為 DMP 輸出頻率 (只用於統計與逾時判斷)
+     * @param priority 內環任務優先權
+     * @param core 執行的核心
+     * @return 成功返回true
+     */
+    bool start(UBaseType_t priority = 5, BaseType_t core = 1);
+
+    /**
+     * 停止週期計時器並停止馬達輸出（任務保留，可再次 start()）
+     */
+    void stop();
+
+    /**
+     * 執行一次外環：讀取 IMU 並更新輪速設定值
+     * 由外環任務呼叫；不使用 start() 時也可由呼叫端以固定頻率直接呼叫
+     */
+    void runOuterLoop();
+
+    /**
+     * 執行一次內環：讀取編碼器並更新馬達輸出
+     * 由內環任務呼叫；不使用 start() 時也可由呼叫端以固定頻率直接呼叫
+     */
+    void runInnerLoop();
+
+    /**
+     * 啟用或停用馬達輸出
+     * 啟用時會清除積分項與倒下狀態
+     * @param enable true 表示啟用
+     */
+    void setEnabled(bool enable);
+
+    /**
+     * 檢查馬達輸出是否啟用
+     * @return 啟用返回true
+     */
+    bool isEnabled() const;
+
+    /**
+     * 檢查是否因傾角過大而停止
+     * @return 已倒下返回true
+     */
+    bool isFallen() const;
+
+    /**
+     * 獲取外環輸出的輪速設定值
+     * @return 輪速設定值（RPM）
+     */
+    float getVelocitySetpoint() const;
+
+    /**
+     * 獲取兩輪平均速度（帶方向）
+     * @return 輪速（RPM）
+     */
+    float getWheelVelocity() const;
+
+    /**
+     * 獲取兩輪平均累計位置（帶方向，由編碼器累計，不受速度計算重設）
+     * @return 輪子轉過的角度（弧度）
+     */
+    float getWheelPosition() const;
+
+    /**
+     * 獲取內環輸出
+     * @return 兩輪 PWM 輸出的平均 (-255 到 255)
+     */
+    int getOutput() const;
+
+    /**
+     * 獲取單輪控制器 (讀取各輪的設定值、速度與輸出)
+     */
+    const WheelController& getLeftWheel() const;
+    const WheelController& getRightWheel() const;
+
+    /**
+     * 獲取內環頻率
+     * @return 頻率（Hz）
+     */
+    uint32_t getInnerRate() const;
+
+    /**
+     * 獲取外環頻率
+     * @return 頻率（Hz）
+     */
+    uint32_t getOuterRate() const;
+
+    /**
+     * 獲取執行統計
+     * @return 統計數據副本
+     */
+    BalanceStats getStats() const;
+
+    /**
+     * 清除執行統計
+     */
+    void resetStats();
+
+    /**
+     * 設定遙測緩衝區，之後每個內環週期推入一筆取樣
+     * @param ring 緩衝區 (nullptr 表示停止推入)；讀出端需在其他任務呼叫 TelemetryWriter::poll()
+     */
+    void setTelemetry(TelemetryRing* ring);
+
+    /**
+     * 設定效能量測器，登記 balance.outer、balance.inner、imu.update、encoder.update 四個階段
+     * 應在 start() 之前呼叫
+     * @param profiler 量測器 (nullptr 表示停止量測)
+     */
+    void setProfiler(Profiler* profiler);
+
+    /**
+     * 以 Teleplot 格式輸出控制狀態與統計
+     */
+    void teleplotOutput() const;
+};
+
+#endif // BALANCE_CONTROLLER_H
@@ -0,0 +1,409 @@
+/**
+ * ConfigStore.cpp
+ * 設定儲存實現
+ */
+
+#include "ConfigStore.h"
+#include <Preferences.h>
+#include <stddef.h>
+
+// blob 識別碼 ("RCFG")
+static const uint32_t CONFIG_MAGIC = 0x47464352;
+
+// 讀取緩衝區大小：較新版本的 blob 只要不超過此大小都能辨識出版本
+static const size_t MAX_BLOB_SIZE = 256;
+
+/**
+ * blob 標頭，之後緊接 RobotConfig
+ */
+struct ConfigHeader {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t size;               // RobotConfig 的位元組數
+    uint32_t crc;                // version、size 與設定內容的 CRC-32
+};
+
+static_assert(sizeof(ConfigHeader) + sizeof(RobotConfig) <= MAX_BLOB_SIZE, "config blob exceeds read buffer");
+
+// 欄位型別
+enum ConfigFieldType {
+    CONFIG_FIELD_INT16,
+    CONFIG_FIELD_INT32,
+    CONFIG_FIELD_UINT8,
+    CONFIG_FIELD_FLOAT
+};
+
+// 依名稱存取的欄位，數值必須在 [minValue, maxValue] 之間
+struct ConfigField {
+    const char* name;
+    uint16_t offset;
+    ConfigFieldType type;
+    float minValue;
+    float maxValue;
+};
+
+#define CONFIG_FIELD(name, member, type, min, max) {name, (uint16_t)offsetof(RobotConfig, member), type, min, max}
+
+static const ConfigField FIELDS[] = {
+    CONFIG_FIELD("imu.ax", imu.accelOffset[0], CONFIG_FIELD_INT16, -32768, 32767),
+    CONFIG_FIELD("imu.ay", imu.accelOffset[1], CONFIG_FIELD_INT16, -32768, 32767),
+    CONFIG_FIELD("imu.az", imu.accelOffset[2], CONFIG_FIELD_INT16, -32768, 32767),
+    CONFIG_FIELD("imu.gx", imu.gyroOffset[0], CONFIG_FIELD_INT16, -32768, 32767),
+    CONFIG_FIELD("imu.gy", imu.gyroOffset[1], CONFIG_FIELD_INT16, -32768, 32767),
+    CONFIG_FIELD("imu.gz", imu.gyroOffset[2], CONFIG_FIELD_INT16, -32768, 32767),
+    CONFIG_FIELD("imu.calibrated", imu.calibrated, CONFIG_FIELD_UINT8, 0, 1),
+    CONFIG_FIELD("imu.mode", imu.mode, CONFIG_FIELD_UINT8, 0, 2),          // ImuMode
+    CONFIG_FIELD("imu.alpha", imu.filterAlpha, CONFIG_FIELD_FLOAT, 0, 1),
+    CONFIG_FIELD("imu.mahony_ki", imu.mahonyKi, CONFIG_FIELD_FLOAT, 0, 10),
+    CONFIG_FIELD("bal.angle_kp", balance.angleKp, CONFIG_FIELD_FLOAT, -100000, 100000),
+    CONFIG_FIELD("bal.angle_ki", balance.angleKi, CONFIG_FIELD_FLOAT, -1000000, 1000000),
+    CONFIG_FIELD("bal.angle_kd", balance.angleKd, CONFIG_FIELD_FLOAT, -10000, 10000),
+    CONFIG_FIELD("bal.speed_kp", balance.speedKp, CONFIG_FIELD_FLOAT, -1000, 1000),
+    CONFIG_FIELD("bal.speed_ki", balance.speedKi, CONFIG_FIELD_FLOAT, -10000, 10000),
+    CONFIG_FIELD("bal.target_pitch", balance.targetPitch, CONFIG_FIELD_FLOAT, -0.5f, 0.5f),  // 約 ±28.6°
+    CONFIG_FIELD("bal.fall_angle", balance.fallAngle, CONFIG_FIELD_FLOAT, 0.05f, 1.5f),      // 約 3° ~ 86°
+    CONFIG_FIELD("bal.velocity_limit", balance.velocityLimit, CONFIG_FIELD_FLOAT, 1, 2000),
+    CONFIG_FIELD("bal.track_kp", balance.trackKp, CONFIG_FIELD_FLOAT, 0, 100),
+    CONFIG_FIELD("enc1.ppr", encoders[0].pulsesPerRev, CONFIG_FIELD_INT32, 1, 100000),
+    CONFIG_FIELD("enc1.inverted", encoders[0].inverted, CONFIG_FIELD_UINT8, 0, 1),
+    CONFIG_FIELD("enc2.ppr", encoders[1].pulsesPerRev, CONFIG_FIELD_INT32, 1, 100000),
+    CONFIG_FIELD("enc2.inverted", encoders[1].inverted, CONFIG_FIELD_UINT8, 0, 1),
+};
+
+static const int FIELD_COUNT = sizeof(FIELDS) / sizeof(FIELDS[0]);
+
+// 讀取欄位數值
+static double readField(const RobotConfig& config, const ConfigField& field) {
+    const uint8_t* data = (const uint8_t*)&config + field.offset;
+    switch (field.type) {
+        case CONFIG_FIELD_INT16: {
+            int16_t v;
+            memcpy(&v, data, sizeof(v));
+            return v;
+        }
+        case CONFIG_FIELD_INT32: {
+            int32_t v;
+            memcpy(&v, data, sizeof(v));
+            return v;
+        }
+        case CONFIG_FIELD_UINT8:
+            return *data;
+        case CONFIG_FIELD_FLOAT: {
+            float v;
+            memcpy(&v, data, sizeof(v));
+            return v;
+        }
+    }
+    return 0;
+}
+
+// 寫入欄位數值 (呼叫前已檢查範圍)
+static void writeField(RobotConfig& config, const ConfigField& field, double value) {
+    uint8_t* data = (uint8_t*)&config + field.offset;
+    switch (field.type) {
+        case CONFIG_FIELD_INT16: {
+            int16_t v = (int16_t)lround(value);
+            memcpy(data, &v, sizeof(v));
+            break;
+        }
+        case CONFIG_FIELD_INT32: {
+            int32_t v = (int32_t)lround(value);
+            memcpy(data, &v, sizeof(v));
+            break;
+        }
+        case CONFIG_FIELD_UINT8:
+            *data = (uint8_t)lround(value);
+            break;
+        case CONFIG_FIELD_FLOAT: {
+            float v = (float)value;
+            memcpy(data, &v, sizeof(v));
+            break;
+        }
+    }
+}
+
+// 數值在欄位範圍內 (NaN 不通過)
+static bool fieldInRange(const ConfigField& field, double value) {
+    return value >= field.minValue && value <= field.maxValue;
+}
+
+// CRC-32 (IEEE 802.3)
+static uint32_t crc32(const uint8_t* data, size_t length, uint32_t crc = 0) {
+    crc = ~crc;
+    for (size_t i = 0; i < length; i++) {
+        crc ^= data[i];
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (crc & 1) ? (crc >> 1) ^ 0xEDB88320 : crc >> 1;
+        }
+    }
+    return ~crc;
+}
+
+// 標頭的 version、size 與內容的 CRC
+static uint32_t blobCrc(const ConfigHeader& header, const uint8_t* payload) {
+    uint32_t crc = crc32((const uint8_t*)&header.version, sizeof(header.version) + sizeof(header.size));
+    return crc32(payload, header.size, crc);
+}
+
+// 建構函數
+ConfigStore::ConfigStore()
+    : source(CONFIG_SOURCE_DEFAULTS),
+      dirty(false),
+      dirtySince(0),
+      committedCrc(0),
+      commits(0),
+      commitFailures(0),
+      legacyPending(false),
+      rejectedFields(0)
+{
+    memset(&config, 0, sizeof(config));
+    memset(&defaults, 0, sizeof(defaults));
+}
+
+// 載入設定
+ConfigSource ConfigStore::begin(const RobotConfig& newDefaults) {
+    defaults = newDefaults;
+    config = defaults;
+    dirty = false;
+    committedCrc = 0;
+    legacyPending = false;
+    rejectedFields = 0;
+
+    uint8_t blob[MAX_BLOB_SIZE];
+    size_t length = 0;
+    Preferences preferences;
+    if (preferences.begin(CONFIG_NAMESPACE, true)) {
+        length = preferences.getBytes(CONFIG_KEY, blob, sizeof(blob));
+        preferences.end();
+    }
+
+    if (length == 0) {
+        source = loadLegacyImu() ? CONFIG_SOURCE_LEGACY : CONFIG_SOURCE_DEFAULTS;
+        return source;
+    }
+
+    ConfigHeader header;
+    memcpy(&header, blob, min(length, sizeof(header)));
+    const uint8_t* payload = blob + sizeof(header);
+    if (length < sizeof(header) || header.magic != CONFIG_MAGIC ||
+        length != sizeof(header) + header.size ||
+        header.crc != blobCrc(header, payload) ||
+        header.version > CONFIG_SCHEMA_VERSION) {
+        // 保留預設值；在設定被修改之前不覆寫 (可能是較新韌體寫入的)
+        source = CONFIG_SOURCE_INVALID;
+        return source;
+    }
+
+    // 舊版本只少了結尾的欄位，其餘保持預設值
+    memcpy(&config, payload, min((size_t)header.size, sizeof(config)));
+    if (header.version == CONFIG_SCHEMA_VERSION && header.size == sizeof(config)) {
+        committedCrc = header.crc;
+        source = CONFIG_SOURCE_STORED;
+    } else {
+        markDirty();
+        source = CONFIG_SOURCE_UPGRADED;
+    }
+
+    // 超出範圍的欄位 (例如舊韌體未檢查時存入的值) 恢復預設值並寫回
+    for (int i = 0; i < FIELD_COUNT; i++) {
+        if (!fieldInRange(FIELDS[i], readField(config, FIELDS[i]))) {
+            writeField(config, FIELDS[i], readField(defaults, FIELDS[i]));
+            rejectedFields++;
+        }
+    }
+    if (rejectedFields > 0) {
+        markDirty();
+    }
+    return source;
+}
+
+// 移轉舊版 IMU 校準鍵
+bool ConfigStore::loadLegacyImu() {
+    Preferences legacy;
+    if (!legacy.begin(CONFIG_LEGACY_IMU_NAMESPACE, true)) {
+        return false;
+    }
+    bool valid = legacy.getBool("cal_valid", false);
+    if (valid) {
+        ImuConfig& imu = config.imu;
+        imu.accelOffset[0] = legacy.getShort("ax_offset", 0);
+        imu.accelOffset[1] = legacy.getShort("ay_offset", 0);
+        imu.accelOffset[2] = legacy.getShort("az_offset", 0);
+        imu.gyroOffset[0] = legacy.getShort("gx_offset", 0);
+        imu.gyroOffset[1] = legacy.getShort("gy_offset", 0);
+        imu.gyroOffset[2] = legacy.getShort("gz_offset", 0);
+        imu.calibrated = 1;
+    }
+    legacy.end();
+
+    if (valid) {
+        legacyPending = true;
+        markDirty();
+    }
+    return valid;
+}
+
+// 刪除舊版 IMU 校準鍵
+void ConfigStore::removeLegacyImu() {
+    Preferences legacy;
+    if (legacy.begin(CONFIG_LEGACY_IMU_NAMESPACE, false)) {
+        legacy.clear();
+        legacy.end();
+    }
+}
+
+// 目前的設定
+const RobotConfig& ConfigStore::get() const {
+    return config;
+}
+
+// 修改設定
+RobotConfig& ConfigStore::edit() {
+    markDirty();
+    return config;
+}
+
+// 標記為待寫回
+void ConfigStore::markDirty() {
+    dirty = true;
+    dirtySince = millis();
+}
+
+// 依名稱設定欄位
+ConfigSetResult ConfigStore::set(const char* name, const char* value) {
+    for (int i = 0; i < FIELD_COUNT; i++) {
+        if (strcmp(FIELDS[i].name, name) != 0) {
+            continue;
+        }
+        char* end = nullptr;
+        double v = strtod(value, &end);
+        while (end && isspace((unsigned char)*end)) {
+            end++;
+        }
+        if (end == value || (end && *end != '\0') || !fieldInRange(FIELDS[i], v)) {
+            return CONFIG_SET_INVALID;
+        }
+        writeField(config, FIELDS[i], v);
+        markDirty();
+        return CONFIG_SET_OK;
+    }
+    return CONFIG_SET_UNKNOWN;
+}
+
+// 欄位的允許範圍
+bool ConfigStore::getRange(const char* name, float& minValue, float& maxValue) const {
+    for (int i = 0; i < FIELD_COUNT; i++) {
+        if (strcmp(FIELDS[i].name, name) == 0) {
+            minValue = FIELDS[i].minValue;
+            maxValue = FIELDS[i].maxValue;
+            return true;
+        }
+    }
+    return false;
+}
+
+// 恢復預設值
+void ConfigStore::reset() {
+    config = defaults;
+    markDirty();
+}
+
+// 延遲寫回
+bool ConfigStore::service() {
+    if (!dirty || millis() - dirtySince < CONFIG_COMMIT_DELAY_MS) {
+        return false;
+    }
+    uint32_t before = commits;
+    commit();
+    return commits != before;
+}
+
+// 立即寫回
+bool ConfigStore::commit() {
+    uint8_t blob[sizeof(ConfigHeader) + sizeof(RobotConfig)];
+    ConfigHeader header;
+    header.magic = CONFIG_MAGIC;
+    header.version = CONFIG_SCHEMA_VERSION;
+    header.size = sizeof(RobotConfig);
+    header.crc = blobCrc(header, (const uint8_t*)&config);
+
+    // 改回上次寫入的內容時不需寫入
+    if (header.crc != committedCrc) {
+        memcpy(blob, &header, sizeof(header));
+        memcpy(blob + sizeof(header), &config, sizeof(config));
+
+        Preferences preferences;
+        bool ok = preferences.begin(CONFIG_NAMESPACE, false) &&
+                  preferences.putBytes(CONFIG_KEY, blob, sizeof(blob)) == sizeof(blob);
+        preferences.end();
+        if (!ok) {
+            // 保持待寫回，延遲後再試
+            commitFailures++;
+            dirtySince = millis();
+            return false;
+        }
+        committedCrc = header.crc;
+        commits++;
+    }
+
+    dirty = false;
+    if (legacyPending) {
+        removeLegacyImu();
+        legacyPending = false;
+    }
+    return true;
+}
+
+// 是否待寫回
+bool ConfigStore::isDirty() const {
+    return dirty;
+}
+
+// 設定的來源
+ConfigSource ConfigStore::getSource() const {
+    return source;
+}
+
+// 載入時超出範圍而恢復預設值的欄位數
+int ConfigStore::getRejectedFieldCount() const {
+    return rejectedFields;
+}
+
+// 寫入次數
+uint32_t ConfigStore::getCommitCount() const {
+    return commits;
+}
+
+// 輸出設定
+void ConfigStore::print(Print& out) const {
+    static const char* sources[] = {"defaults", "stored", "upgraded", "legacy", "invalid"};
+    out.printf("# config: schema v%d, %u bytes, source %s, pending %s, commits %lu (failed %lu)\n",
+               CONFIG_SCHEMA_VERSION, (unsigned)sizeof(RobotConfig), sources[source],
+               dirty ? "yes" : "no", (unsigned long)commits, (unsigned long)commitFailures);
+    for (int i = 0; i < FIELD_COUNT; i++) {
+        const uint8_t* field = (const uint8_t*)&config + FIELDS[i].offset;
+        switch (FIELDS[i].type) {
+            case CONFIG_FIELD_INT16: {
+                int16_t v;
+                memcpy(&v, field, sizeof(v));
+                out.printf("%s=%d\n", FIELDS[i].name, v);
+                break;
+            }
+            case CONFIG_FIELD_INT32: {
+                int32_t v;
+                memcpy(&v, field, sizeof(v));
+                out.printf("%s=%ld\n", FIELDS[i].name, (long)v);
+                break;
+            }
+            case CONFIG_FIELD_UINT8:
+                out.printf("%s=%u\n", FIELDS[i].name, *field);
+                break;
+            case CONFIG_FIELD_FLOAT: {
+                float v;
+                memcpy(&v, field, sizeof(v));
+                out.printf("%s=%g\n", FIELDS[i].name, v);
+                break;
+            }
+        }
+    }
+}
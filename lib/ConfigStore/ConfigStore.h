@@ -0,0 +1,196 @@
+/**
+ * ConfigStore.h
+ * 可調參數的設定儲存：開機時一次載入到 RAM，變更後延遲寫回 NVS
+ *
+ * 功能概述:
+ * - 所有可調參數 (IMU 校準值與濾波係數、平衡控制增益與限制、編碼器 PPR 與方向) 集中在 RobotConfig
+ * - NVS 只存一個 blob (命名空間 "robot"，鍵 "cfg")：標頭含識別碼、結構版本、長度與 CRC-32，
+ *   開機只需一次 NVS 讀取；CRC 錯誤或識別碼不符時使用預設值
+ * - 結構只在結尾新增欄位並遞增 CONFIG_SCHEMA_VERSION；較舊版本的 blob 複製到預設值之上，
+ *   新增的欄位保持預設值；較新版本 (韌體降級) 的 blob 不使用，也不會被覆寫，直到設定被修改
+ * - 沒有 blob 時移轉舊版 IMU 校準 (命名空間 "imu_cal" 的七個鍵)，第一次寫回成功後刪除舊鍵
+ * - 每個欄位有允許範圍：set() 拒絕超出範圍或無法解析的數值，載入的 blob 中超出範圍的欄位恢復預設值
+ * - 修改設定只改 RAM 並標記為待寫回；主迴圈呼叫 service()，最後一次修改後經過 CONFIG_COMMIT_DELAY_MS
+ *   才寫入快閃記憶體 (連續調參只寫一次)，內容與上次寫入相同時略過
+ * - 控制迴圈等熱路徑只讀取各類別套用後的成員，不會觸及 NVS
+ *
+ * 注意：get()/edit()/service() 不加鎖，只應在同一個任務 (主迴圈) 呼叫
+ */
+
+#ifndef CONFIG_STORE_H
+#define CONFIG_STORE_H
+
+#include <Arduino.h>
+
+// 結構版本：RobotConfig 在結尾新增欄位時遞增
+#define CONFIG_SCHEMA_VERSION 1
+
+// 最後一次修改後延遲寫回的時間 (ms)
+#define CONFIG_COMMIT_DELAY_MS 2000
+
+// NVS 命名空間與鍵
+#define CONFIG_NAMESPACE "robot"
+#define CONFIG_KEY "cfg"
+
+// 舊版 IMU 校準的命名空間 (每個偏移值一個鍵)
+#define CONFIG_LEGACY_IMU_NAMESPACE "imu_cal"
+
+/**
+ * IMU 設定
+ */
+struct ImuConfig {
+    int16_t accelOffset[3];      // 加速度計偏移暫存器 (x, y, z)
+    int16_t gyroOffset[3];       // 陀螺儀偏移暫存器 (x, y, z)
+    uint8_t calibrated;          // 偏移值有效
+    uint8_t mode;                // 姿態來源 (ImuMode)
+    float filterAlpha;           // 原始數據模式的濾波係數
+    float mahonyKi;              // Mahony 積分增益 (1/s)
+};
+
+/**
+ * 平衡控制設定 (單位與 BalanceController 相同)
+ */
+struct BalanceConfig {
+    float angleKp;
+    float angleKi;
+    float angleKd;
+    float speedKp;
+    float speedKi;
+    float targetPitch;           // 平衡點俯仰角 (rad)
+    float fallAngle;             // 倒下判定門檻 (rad)
+    float velocityLimit;         // 輪速設定值上限 (RPM)
+    float trackKp;               // 直線保持增益 (1/s)
+};
+
+/**
+ * 編碼器設定
+ */
+struct EncoderConfig {
+    int32_t pulsesPerRev;
+    uint8_t inverted;
+};
+
+/**
+ * 所有可調參數 (只在結尾新增欄位)
+ */
+struct RobotConfig {
+    ImuConfig imu;
+    BalanceConfig balance;
+    EncoderConfig encoders[2];
+};
+
+/**
+ * 開機時設定的來源
+ */
+enum ConfigSource {
+    CONFIG_SOURCE_DEFAULTS,      // 沒有儲存的設定
+    CONFIG_SOURCE_STORED,        // 目前版本的 blob
+    CONFIG_SOURCE_UPGRADED,      // 較舊版本的 blob，新增欄位使用預設值
+    CONFIG_SOURCE_LEGACY,        // 由舊版 IMU 校準鍵移轉
+    CONFIG_SOURCE_INVALID        // blob 損壞或版本較新，使用預設值
+};
+
+/**
+ * set() 的結果
+ */
+enum ConfigSetResult {
+    CONFIG_SET_OK,
+    CONFIG_SET_UNKNOWN,          // 沒有這個欄位
+    CONFIG_SET_INVALID           // 無法解析或超出範圍，設定不變
+};
+
+class ConfigStore {
+private:
+    RobotConfig config;
+    RobotConfig defaults;
+    ConfigSource source;
+
+    // 寫回狀態
+    bool dirty;
+    uint32_t dirtySince;         // 最後一次修改的時間 (ms)
+    uint32_t committedCrc;       // 上次寫入 (或載入) 的內容 CRC
+    uint32_t commits;
+    uint32_t commitFailures;
+    bool legacyPending;          // 寫回成功後刪除舊版 IMU 校準鍵
+    int rejectedFields;          // 載入時超出範圍而恢復預設值的欄位數
+
+    bool loadLegacyImu();
+    void removeLegacyImu();
+
+public:
+    ConfigStore();
+
+    /**
+     * 載入設定 (一次 NVS 讀取)
+     * @param defaults 預設值 (通常取自各物件建構後的設定)
+     * @return 設定的來源
+     */
+    ConfigSource begin(const RobotConfig& defaults);
+
+    /**
+     * 目前的設定
+     */
+    const RobotConfig& get() const;
+
+    /**
+     * 修改設定：返回可寫入的設定並標記為待寫回
+     */
+    RobotConfig& edit();
+
+    /**
+     * 標記為待寫回 (重新計算延遲)
+     */
+    void markDirty();
+
+    /**
+     * 依名稱設定一個欄位 (名稱見 print())
+     * @param name 欄位名稱，例如 "bal.angle_kp"
+     * @param value 數值字串
+     * @return 設定成功返回 CONFIG_SET_OK；名稱不存在或數值無效時設定不變
+     */
+    ConfigSetResult set(const char* name, const char* value);
+
+    /**
+     * 欄位的允許範圍
+     * @return 名稱存在返回 true
+     */
+    bool getRange(const char* name, float& minValue, float& maxValue) const;
+
+    /**
+     * 恢復預設值 (標記為待寫回)
+     */
+    void reset();
+
+    /**
+     * 由主迴圈定期呼叫：最後一次修改後經過 CONFIG_COMMIT_DELAY_MS 時寫回
+     * @return 本次有寫入 NVS 返回 true
+     */
+    bool service();
+
+    /**
+     * 立即寫回 (內容與上次寫入相同時略過)
+     * @return 寫入成功或不需寫入返回 true
+     */
+    bool commit();
+
+    bool isDirty() const;
+    ConfigSource getSource() const;
+
+    /**
+     * 載入時超出範圍而恢復預設值的欄位數
+     */
+    int getRejectedFieldCount() const;
+
+    /**
+     * 已寫入 NVS 的次數
+     */
+    uint32_t getCommitCount() const;
+
+    /**
+     * 輸出來源、寫回狀態與所有欄位 (name=value)
+     * @param out 輸出目標 (例如 Serial)
+     */
+    void print(Print& out) const;
+};
+
+#endif // CONFIG_STORE_H
@@ -0,0 +1,119 @@
+/**
+ * DiffDrive.cpp
+ * 差速驅動實現
+ */
+
+#include "DiffDrive.h"
+
+// PWM 輸出範圍
+static const int OUTPUT_LIMIT = 255;
+
+// ---- DriveMixer ----
+
+// 建構函數
+DriveMixer::DriveMixer(float maxWheelSpeed)
+    : maxWheelSpeed(maxWheelSpeed > 0 ? maxWheelSpeed : 300.0f),
+      turnPriority(true)
+{
+}
+
+// 設定單輪設定值上限
+void DriveMixer::setMaxWheelSpeed(float rpm) {
+    if (rpm > 0) {
+        maxWheelSpeed = rpm;
+    }
+}
+
+// 獲取單輪設定值上限
+float DriveMixer::getMaxWheelSpeed() const {
+    return maxWheelSpeed;
+}
+
+// 設定飽和時的優先順序
+void DriveMixer::setTurnPriority(bool enable) {
+    turnPriority = enable;
+}
+
+// 混合前進與轉向命令
+WheelSetpoints DriveMixer::mix(float forward, float turn) const {
+    // 優先的一方先限制在上限內，剩下的餘量才留給另一方
+    if (turnPriority) {
+        turn = constrain(turn, -maxWheelSpeed, maxWheelSpeed);
+        float forwardLimit = maxWheelSpeed - fabs(turn);
+        forward = constrain(forward, -forwardLimit, forwardLimit);
+    } else {
+        forward = constrain(forward, -maxWheelSpeed, maxWheelSpeed);
+        float turnLimit = maxWheelSpeed - fabs(forward);
+        turn = constrain(turn, -turnLimit, turnLimit);
+    }
+
+    WheelSetpoints setpoints;
+    setpoints.left = forward + turn;
+    setpoints.right = forward - turn;
+    return setpoints;
+}
+
+// ---- WheelController ----
+
+// 建構函數
+WheelController::WheelController(Motor* motor, Encoder* encoder)
+    : motor(motor),
+      encoder(encoder),
+      pid(3.0f, 30.0f, 0.0f, PID_DIRECT),
+      setpoint(0.0f),
+      velocity(0.0f),
+      output(0)
+{
+    pid.setOutputLimits(-OUTPUT_LIMIT, OUTPUT_LIMIT);
+}
+
+// 設定增益
+void WheelController::setTunings(float kp, float ki, float kd) {
+    pid.setTunings(kp, ki, kd);
+}
+
+// 設定 PWM 輸出上限
+void WheelController::setOutputLimit(int limit) {
+    limit = constrain(limit, 1, OUTPUT_LIMIT);
+    pid.setOutputLimits(-limit, limit);
+}
+
+// 設定輪速設定值
+void WheelController::setSetpoint(float rpm) {
+    setpoint = rpm;
+}
+
+// 計算一次輸出
+int WheelController::update(float dt) {
+    velocity = encoder->getSnapshot().velocity;
+    float u = pid.compute(setpoint, velocity, dt);
+    motor->setDuty(u / OUTPUT_LIMIT);
+    output = (int)lroundf(u);
+    return output;
+}
+
+// 清除控制狀態
+void WheelController::reset() {
+    pid.reset();
+    output = 0;
+}
+
+// 停止輸出
+void WheelController::stop() {
+    pid.reset();
+    velocity = encoder->getSnapshot().velocity;
+    motor->setDuty(0.0f);
+    output = 0;
+}
+
+float WheelController::getSetpoint() const {
+    return setpoint;
+}
+
+float WheelController::getVelocity() const {
+    return velocity;
+}
+
+int WheelController::getOutput() const {
+    return output;
+}
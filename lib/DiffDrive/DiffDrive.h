@@ -0,0 +1,132 @@
+/**
+ * DiffDrive.h
+ * 差速驅動：每輪獨立的帶方向輪速控制與 (前進, 轉向) 混合器
+ *
+ * 功能概述:
+ * - WheelController：一個編碼器對應一個馬達，以 Pid<float> 將帶方向的輪速設定值 (RPM) 轉成 -255 ~ 255 的 PWM，
+ *   可正反轉，兩輪的摩擦或馬達差異由各自的積分項補償
+ * - DriveMixer：左輪 = 前進 + 轉向、右輪 = 前進 - 轉向；超過輪速上限時預設優先保留轉向量並縮減前進量，
+ *   飽和時仍能維持航向；平衡控制則應讓前進量優先 (setTurnPriority(false))
+ * - 編碼器的 update() 由呼叫端負責 (控制器只讀取快照)，以便呼叫端統一量測或共用讀取時間
+ */
+
+#ifndef DIFF_DRIVE_H
+#define DIFF_DRIVE_H
+
+#include <Arduino.h>
+#include "motor.h"
+#include "encoder.h"
+#include "Pid.h"
+
+/**
+ * 兩輪的輪速設定值 (RPM，帶方向，向前為正)
+ */
+struct WheelSetpoints {
+    float left;
+    float right;
+};
+
+/**
+ * 前進/轉向命令 → 兩輪設定值
+ */
+class DriveMixer {
+private:
+    float maxWheelSpeed;     // 單輪設定值上限 (RPM)
+    bool turnPriority;       // 飽和時優先保留轉向量
+
+public:
+    /**
+     * 建構函數
+     * @param maxWheelSpeed 單輪設定值上限 (RPM)
+     */
+    DriveMixer(float maxWheelSpeed = 300.0f);
+
+    /**
+     * 設定單輪設定值上限
+     * @param rpm 上限 (RPM)
+     */
+    void setMaxWheelSpeed(float rpm);
+
+    /**
+     * 獲取單輪設定值上限
+     */
+    float getMaxWheelSpeed() const;
+
+    /**
+     * 設定飽和時的優先順序
+     * @param enable true 表示優先保留轉向量，false 表示優先保留前進量
+     */
+    void setTurnPriority(bool enable);
+
+    /**
+     * 混合前進與轉向命令
+     * @param forward 前進速度 (RPM，向前為正)
+     * @param turn 轉向量 (RPM，正值向右轉：左輪加速、右輪減速)
+     * @return 兩輪設定值，絕對值不超過上限
+     */
+    WheelSetpoints mix(float forward, float turn) const;
+};
+
+/**
+ * 單輪帶方向的輪速控制
+ */
+class WheelController {
+private:
+    Motor* motor;
+    Encoder* encoder;
+    Pid<float> pid;
+
+    float setpoint;          // 輪速設定值 (RPM)
+    float velocity;          // 最近一次讀到的輪速 (RPM)
+    int output;              // 最近一次的 PWM 輸出 (四捨五入，馬達以浮點佔空比接收完整解析度)
+
+public:
+    /**
+     * 建構函數 (預設增益 kp=3, ki=30，輸出 -255 ~ 255)
+     * @param motor 馬達
+     * @param encoder 同一個輪子的編碼器 (方向需與馬達一致：正 PWM 時速度為正)
+     */
+    WheelController(Motor* motor, Encoder* encoder);
+
+    /**
+     * 設定增益 (不清除積分項)
+     * @param kp PWM / RPM
+     * @param ki PWM / (RPM·s)
+     * @param kd PWM / (RPM/s)
+     */
+    void setTunings(float kp, float ki, float kd = 0.0f);
+
+    /**
+     * 設定 PWM 輸出上限 (對稱，1 ~ 255)
+     */
+    void setOutputLimit(int limit);
+
+    /**
+     * 設定輪速設定值
+     * @param rpm 帶方向的輪速 (RPM)
+     */
+    void setSetpoint(float rpm);
+
+    /**
+     * 讀取編碼器快照並計算一次輸出，寫入馬達
+     * @param dt 與上次計算的間隔 (秒)
+     * @return PWM 輸出
+     */
+    int update(float dt);
+
+    /**
+     * 清除積分項與輸出記錄，不寫入馬達
+     */
+    void reset();
+
+    /**
+     * 停止輸出並清除積分項 (設定值保留)
+     */
+    void stop();
+
+    float getSetpoint() const;
+    float getVelocity() const;
+    int getOutput() const;
+};
+
+#endif // DIFF_DRIVE_H
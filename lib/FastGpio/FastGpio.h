@@ -0,0 +1,53 @@
+/**
+ * FastGpio.h
+ * 編譯期固定腳位的 GPIO 存取
+ *
+ * 功能概述:
+ * - FastPin<PIN> 以 ESP-IDF 的 gpio_ll 直接讀寫 GPIO 暫存器；腳位是常數，
+ *   write() 編譯為一次 W1TS/W1TC 寫入，read() 為一次 IN 暫存器讀取
+ * - fastRead(pin) 供腳位在執行時才決定的場合 (例如 Encoder 的中斷處理函數)
+ * - 不經過 digitalWrite()/digitalRead() 的腳位查表與檢查，可在 IRAM 中斷處理函數內使用
+ * - 腳位是否為 ESP32-S3 上存在且未被快閃記憶體佔用的 GPIO 在編譯時檢查
+ *
+ * 注意：只負責讀寫位準；腳位模式 (pinMode) 仍需在初始化時設定
+ */
+
+#ifndef FAST_GPIO_H
+#define FAST_GPIO_H
+
+#include <Arduino.h>
+#include <hal/gpio_ll.h>
+
+/**
+ * 腳位是否可作為一般 GPIO (ESP32-S3：0 ~ 48，22 ~ 25 不存在，26 ~ 32 接快閃記憶體)
+ * include/config.h 的電路板腳位檢查也使用此函數
+ */
+constexpr bool gpioUsable(int pin) {
+    return pin >= 0 && pin <= 48 && !(pin >= 22 && pin <= 32);
+}
+
+/**
+ * @tparam PIN GPIO 編號
+ */
+template <uint8_t PIN>
+struct FastPin {
+    static_assert(gpioUsable(PIN), "FastPin: not a usable GPIO on the ESP32-S3");
+
+    static inline void IRAM_ATTR write(int level) {
+        gpio_ll_set_level(&GPIO, (gpio_num_t)PIN, level ? 1 : 0);
+    }
+
+    static inline int IRAM_ATTR read() {
+        return gpio_ll_get_level(&GPIO, (gpio_num_t)PIN);
+    }
+};
+
+/**
+ * 執行時才決定腳位的讀取：同樣是一次輸入暫存器讀取，但需要依腳位計算暫存器與位元
+ * @param pin GPIO 編號 (呼叫者保證可用)
+ */
+static inline int IRAM_ATTR fastRead(uint8_t pin) {
+    return gpio_ll_get_level(&GPIO, (gpio_num_t)pin);
+}
+
+#endif // FAST_GPIO_H
@@ -0,0 +1,332 @@
+/**
+ * I2CBus.cpp
+ * I2C 匯流排管理實現
+ */
+
+#include "I2CBus.h"
+
+// 復原時 SCL 半週期 (us)，約 100 kHz
+static const uint32_t RECOVERY_HALF_PERIOD_US = 5;
+
+// 建構函數
+I2CBus::I2CBus(TwoWire& wire)
+    : wire(&wire),
+      sdaPin(-1),
+      sclPin(-1),
+      started(false),
+      clockHz(I2C_DEFAULT_CLOCK),
+      deviceCount(0),
+      lock(nullptr),
+      holderTask(nullptr),
+      holderDevice(-1),
+      holderDepth(0),
+      holdStart(0),
+      recoveries(0),
+      recoveryFailures(0)
+{
+    portMUX_TYPE unlocked = portMUX_INITIALIZER_UNLOCKED;
+    waitMux = unlocked;
+    for (int i = 0; i < I2C_PRIORITY_LEVELS; i++) {
+        waiting[i] = 0;
+    }
+    memset(devices, 0, sizeof(devices));
+}
+
+// 初始化控制器
+bool I2CBus::begin(int sda, int scl) {
+    if (started) {
+        return true;
+    }
+    if (lock == nullptr) {
+        lock = xSemaphoreCreateMutex();
+    }
+    sdaPin = sda;
+    sclPin = scl;
+
+    // 上次重開機時若正好在讀取中，從端可能仍拉住 SDA
+    pinMode(sdaPin, INPUT_PULLUP);
+    pinMode(sclPin, INPUT_PULLUP);
+    if (digitalRead(sdaPin) == LOW) {
+        clearBus();
+    }
+
+    started = wire->begin(sdaPin, sclPin, clockHz);
+    return started;
+}
+
+// 登記裝置
+int I2CBus::addDevice(const char* name, uint8_t address, I2CPriority priority, uint32_t maxClockHz) {
+    if (deviceCount >= I2C_MAX_DEVICES) {
+        return -1;
+    }
+    I2CDevice& device = devices[deviceCount];
+    memset(&device, 0, sizeof(device));
+    device.name = name;
+    device.address = address;
+    device.priority = priority;
+    device.maxClockHz = maxClockHz;
+    deviceCount++;
+
+    applyClock();
+    return deviceCount - 1;
+}
+
+// 時脈取所有裝置允許時脈的最小值
+void I2CBus::applyClock() {
+    uint32_t clock = 0;
+    for (int i = 0; i < deviceCount; i++) {
+        if (clock == 0 || devices[i].maxClockHz < clock) {
+            clock = devices[i].maxClockHz;
+        }
+    }
+    clockHz = clock ? clock : I2C_DEFAULT_CLOCK;
+    if (started) {
+        wire->setClock(clockHz);
+    }
+}
+
+// 是否有較高優先權的裝置在等待
+bool I2CBus::higherWaiting(I2CPriority priority) {
+    bool found = false;
+    portENTER_CRITICAL(&waitMux);
+    for (int level = priority + 1; level < I2C_PRIORITY_LEVELS; level++) {
+        if (waiting[level] > 0) {
+            found = true;
+            break;
+        }
+    }
+    portEXIT_CRITICAL(&waitMux);
+    return found;
+}
+
+// 取得匯流排
+bool I2CBus::acquire(int device, TickType_t timeout) {
+    if (device < 0 || device >= deviceCount || lock == nullptr) {
+        return false;
+    }
+
+    // 同一任務巢狀取得
+    TaskHandle_t self = xTaskGetCurrentTaskHandle();
+    if (holderDepth > 0 && holderTask == self) {
+        holderDepth++;
+        return true;
+    }
+
+    I2CDevice& dev = devices[device];
+    uint32_t waitStart = micros();
+    TickType_t startTick = xTaskGetTickCount();
+
+    portENTER_CRITICAL(&waitMux);
+    waiting[dev.priority]++;
+    portEXIT_CRITICAL(&waitMux);
+
+    bool taken = false;
+    for (;;) {
+        TickType_t remaining = portMAX_DELAY;
+        if (timeout != portMAX_DELAY) {
+            TickType_t elapsed = xTaskGetTickCount() - startTick;
+            remaining = elapsed < timeout ? timeout - elapsed : 0;
+        }
+        if (xSemaphoreTake(lock, remaining) != pdTRUE) {
+            break;
+        }
+        if (!higherWaiting(dev.priority)) {
+            taken = true;
+            break;
+        }
+        // 讓等待中的高優先權裝置先用 (另一核心上的任務被喚醒後會搶到鎖)
+        xSemaphoreGive(lock);
+        taskYIELD();
+    }
+
+    portENTER_CRITICAL(&waitMux);
+    waiting[dev.priority]--;
+    portEXIT_CRITICAL(&waitMux);
+
+    uint32_t waited = micros() - waitStart;
+    dev.totalWaitMicros += waited;
+    if (waited > dev.maxWaitMicros) {
+        dev.maxWaitMicros = waited;
+    }
+    if (!taken) {
+        dev.timeouts++;
+        dev.errors++;
+        return false;
+    }
+
+    holderTask = self;
+    holderDevice = device;
+    holderDepth = 1;
+    holdStart = micros();
+    return true;
+}
+
+// 釋放匯流排
+void I2CBus::release(int device, bool ok) {
+    if (device < 0 || device >= deviceCount || holderDepth == 0) {
+        return;
+    }
+
+    I2CDevice& dev = devices[device];
+    if (ok) {
+        dev.consecutiveErrors = 0;
+    } else {
+        dev.errors++;
+        if (dev.consecutiveErrors < 255) {
+            dev.consecutiveErrors++;
+        }
+        // 只有位址也沒有回應時才視為匯流排卡死
+        if (dev.consecutiveErrors >= I2C_RECOVERY_ERROR_THRESHOLD && !probeLocked(dev.address)) {
+            clearBus();
+            dev.consecutiveErrors = 0;
+        }
+    }
+
+    if (--holderDepth > 0) {
+        return;
+    }
+
+    I2CDevice& holder = devices[holderDevice];
+    uint32_t held = micros() - holdStart;
+    holder.transactions++;
+    holder.totalHoldMicros += held;
+    if (held > holder.maxHoldMicros) {
+        holder.maxHoldMicros = held;
+    }
+    holderTask = nullptr;
+    holderDevice = -1;
+    xSemaphoreGive(lock);
+}
+
+// 檢查位址是否回應 (已持有匯流排)
+bool I2CBus::probeLocked(uint8_t address) {
+    wire->beginTransmission(address);
+    return wire->endTransmission() == 0;
+}
+
+// 檢查裝置是否回應
+bool I2CBus::probe(int device) {
+    if (!acquire(device)) {
+        return false;
+    }
+    bool ack = probeLocked(devices[device].address);
+    release(device, ack);
+    return ack;
+}
+
+// 立即執行卡死復原
+bool I2CBus::recover() {
+    if (lock == nullptr) {
+        return false;
+    }
+    // 同一任務已持有匯流排 (在交易中呼叫)
+    if (holderDepth > 0 && holderTask == xTaskGetCurrentTaskHandle()) {
+        return clearBus();
+    }
+    xSemaphoreTake(lock, portMAX_DELAY);
+    bool released = clearBus();
+    xSemaphoreGive(lock);
+    return released;
+}
+
+// 送出 SCL 脈衝讓從端完成目前的位元組並釋放 SDA，再送出 STOP 並重新初始化控制器
+bool I2CBus::clearBus() {
+    if (sdaPin < 0 || sclPin < 0) {
+        return false;
+    }
+    recoveries++;
+    if (started) {
+        wire->end();
+    }
+
+    pinMode(sdaPin, INPUT_PULLUP);
+    pinMode(sclPin, OUTPUT_OPEN_DRAIN);
+    digitalWrite(sclPin, HIGH);
+    delayMicroseconds(RECOVERY_HALF_PERIOD_US);
+
+    bool released = digitalRead(sdaPin) == HIGH;
+    for (int i = 0; i < 9 && !released; i++) {
+        digitalWrite(sclPin, LOW);
+        delayMicroseconds(RECOVERY_HALF_PERIOD_US);
+        digitalWrite(sclPin, HIGH);
+        delayMicroseconds(RECOVERY_HALF_PERIOD_US);
+        released = digitalRead(sdaPin) == HIGH;
+    }
+
+    // STOP：SCL 為高時 SDA 由低變高
+    pinMode(sdaPin, OUTPUT_OPEN_DRAIN);
+    digitalWrite(sclPin, LOW);
+    digitalWrite(sdaPin, LOW);
+    delayMicroseconds(RECOVERY_HALF_PERIOD_US);
+    digitalWrite(sclPin, HIGH);
+    delayMicroseconds(RECOVERY_HALF_PERIOD_US);
+    digitalWrite(sdaPin, HIGH);
+    delayMicroseconds(RECOVERY_HALF_PERIOD_US);
+    pinMode(sdaPin, INPUT_PULLUP);
+    pinMode(sclPin, INPUT_PULLUP);
+
+    if (!released) {
+        recoveryFailures++;
+    }
+    if (started) {
+        wire->begin(sdaPin, sclPin, clockHz);
+    }
+    return released;
+}
+
+// 目前的時脈
+uint32_t I2CBus::getClock() const {
+    return clockHz;
+}
+
+// 使用的控制器
+TwoWire& I2CBus::getWire() {
+    return *wire;
+}
+
+// 登記的裝置數
+int I2CBus::getDeviceCount() const {
+    return deviceCount;
+}
+
+// 裝置資訊與統計
+const I2CDevice& I2CBus::getDevice(int device) const {
+    return devices[device];
+}
+
+// 卡死復原次數
+uint32_t I2CBus::getRecoveries() const {
+    return recoveries;
+}
+
+// 清除統計
+void I2CBus::resetStats() {
+    for (int i = 0; i < deviceCount; i++) {
+        I2CDevice& dev = devices[i];
+        dev.transactions = 0;
+        dev.errors = 0;
+        dev.timeouts = 0;
+        dev.maxWaitMicros = 0;
+        dev.totalWaitMicros = 0;
+        dev.maxHoldMicros = 0;
+        dev.totalHoldMicros = 0;
+    }
+    recoveries = 0;
+    recoveryFailures = 0;
+}
+
+// 輸出統計
+void I2CBus::printStats(Print& out) const {
+    out.printf("# i2c: %lu Hz, recoveries %lu (failed %lu)\n",
+               (unsigned long)clockHz, (unsigned long)recoveries, (unsigned long)recoveryFailures);
+    out.printf("device,addr,prio,transactions,errors,timeouts,wait_mean_us,wait_max_us,hold_mean_us,hold_max_us\n");
+    for (int i = 0; i < deviceCount; i++) {
+        const I2CDevice& dev = devices[i];
+        uint32_t waitMean = dev.transactions ? (uint32_t)(dev.totalWaitMicros / dev.transactions) : 0;
+        uint32_t holdMean = dev.transactions ? (uint32_t)(dev.totalHoldMicros / dev.transactions) : 0;
+        out.printf("%s,0x%02X,%d,%lu,%lu,%lu,%lu,%lu,%lu,%lu\n", dev.name, dev.address, (int)dev.priority,
+                   (unsigned long)dev.transactions, (unsigned long)dev.errors, (unsigned long)dev.timeouts,
+                   (unsigned long)waitMean, (unsigned long)dev.maxWaitMicros,
+                   (unsigned long)holdMean, (unsigned long)dev.maxHoldMicros);
+    }
+}
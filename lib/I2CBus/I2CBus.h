@@ -0,0 +1,218 @@
+/**
+ * I2CBus.h
+ * I2C 匯流排管理：多個裝置共用一個 I2C 控制器時的仲裁、時脈、卡死復原與統計
+ *
+ * 功能概述:
+ * - 擁有一個 TwoWire (Wire，或 ESP32-S3 的第二個控制器 Wire1)，重複呼叫 begin() 只初始化一次
+ * - 時脈取所有登記裝置允許的最高時脈中的最小值 (MPU6050 與 SH1106 都是 400 kHz；
+ *   單獨掛在 Wire1 上的顯示器可以登記更高的時脈)
+ * - 每次存取以 I2CTransaction 取得匯流排；有高優先權裝置在等待時，低優先權裝置讓它先用，
+ *   因此大量資料 (顯示器幀) 應切成小段傳送，高優先權裝置最多只等一小段
+ * - 同一個任務可以巢狀取得匯流排 (例如 IMU::setMode() 內呼叫 resetDMP())
+ * - 卡死復原：SDA 被從端拉低時，以 GPIO 送出最多 9 個 SCL 脈衝與 STOP 條件後重新初始化控制器；
+ *   begin() 時檢查一次，之後裝置連續回報錯誤且位址沒有回應時自動執行
+ * - 每個裝置統計交易數、錯誤數、逾時數、等待匯流排的時間與佔用時間
+ *
+ * 注意：MPU6050 (I2Cdevlib) 與 U8g2 直接使用 Wire/Wire1，本類別只負責仲裁，不經手資料；
+ * 不經過 I2CTransaction 的存取 (例如 IMU::getMPU()) 不受保護
+ */
+
+#ifndef I2C_BUS_H
+#define I2C_BUS_H
+
+#include <Arduino.h>
+#include <Wire.h>
+
+// 每個匯流排最多登記的裝置數
+#define I2C_MAX_DEVICES 4
+
+// 取得匯流排的預設逾時 (ms)
+#define I2C_ACQUIRE_TIMEOUT_MS 20
+
+// 連續錯誤達此次數時檢查位址是否回應，沒有回應則執行卡死復原
+#define I2C_RECOVERY_ERROR_THRESHOLD 3
+
+// 沒有登記裝置時的時脈 (標準模式)
+#define I2C_DEFAULT_CLOCK 100000
+
+/**
+ * 裝置優先權：等待中的較高優先權裝置先取得匯流排
+ */
+enum I2CPriority {
+    I2C_PRIORITY_LOW,       // 可延後的大量傳輸 (顯示器)
+    I2C_PRIORITY_NORMAL,
+    I2C_PRIORITY_HIGH,      // 控制迴圈的感測器讀取
+    I2C_PRIORITY_LEVELS
+};
+
+/**
+ * 登記的裝置與其統計
+ */
+struct I2CDevice {
+    const char* name;
+    uint8_t address;
+    I2CPriority priority;
+    uint32_t maxClockHz;         // 裝置允許的最高時脈
+
+    uint32_t transactions;       // 完成的交易數
+    uint32_t errors;             // 呼叫端回報的錯誤 (含逾時)
+    uint32_t timeouts;           // 等待匯流排逾時
+    uint32_t maxWaitMicros;      // 等待匯流排的最長時間
+    uint64_t totalWaitMicros;
+    uint32_t maxHoldMicros;      // 佔用匯流排的最長時間
+    uint64_t totalHoldMicros;
+    uint8_t consecutiveErrors;
+};
+
+class I2CBus {
+private:
+    TwoWire* wire;
+    int sdaPin;
+    int sclPin;
+    bool started;
+    uint32_t clockHz;
+
+    I2CDevice devices[I2C_MAX_DEVICES];
+    int deviceCount;
+
+    // 匯流排鎖與各優先權的等待數
+    SemaphoreHandle_t lock;
+    volatile uint8_t waiting[I2C_PRIORITY_LEVELS];
+    portMUX_TYPE waitMux;
+
+    // 目前持有者 (巢狀取得時只記錄最外層)
+    TaskHandle_t holderTask;
+    int holderDevice;
+    uint8_t holderDepth;
+    uint32_t holdStart;
+
+    // 復原統計
+    uint32_t recoveries;
+    uint32_t recoveryFailures;
+
+    bool higherWaiting(I2CPriority priority);
+    void applyClock();
+    bool probeLocked(uint8_t address);
+    bool clearBus();
+
+public:
+    /**
+     * 建構函數
+     * @param wire 使用的控制器 (Wire 或 Wire1)
+     */
+    explicit I2CBus(TwoWire& wire);
+
+    /**
+     * 初始化控制器 (先檢查 SDA 是否被拉低並嘗試復原)；已初始化時直接返回 true
+     * @param sda SDA 腳位
+     * @param scl SCL 腳位
+     * @return 初始化成功返回 true
+     */
+    bool begin(int sda, int scl);
+
+    /**
+     * 登記裝置，時脈改為所有裝置允許時脈的最小值
+     * @param name 裝置名稱 (常駐字串)
+     * @param address 7 位元位址
+     * @param priority 優先權
+     * @param maxClockHz 裝置允許的最高時脈
+     * @return 裝置編號，已滿時返回 -1
+     */
+    int addDevice(const char* name, uint8_t address, I2CPriority priority, uint32_t maxClockHz = 400000);
+
+    /**
+     * 取得匯流排；同一任務已持有時直接返回 true
+     * @param device 裝置編號
+     * @param timeout 最長等待時間 (tick)
+     * @return 取得返回 true，逾時返回 false (計入該裝置的錯誤)
+     */
+    bool acquire(int device, TickType_t timeout = pdMS_TO_TICKS(I2C_ACQUIRE_TIMEOUT_MS));
+
+    /**
+     * 釋放匯流排並記錄結果
+     * @param device 裝置編號
+     * @param ok 交易是否成功；連續失敗時檢查位址並視需要執行卡死復原
+     */
+    void release(int device, bool ok = true);
+
+    /**
+     * 檢查裝置是否回應 (經由 acquire()/release() 取得匯流排，可在同一任務的交易中呼叫)
+     * @param device 裝置編號
+     * @return 收到 ACK 返回 true；沒有回應時計入該裝置的錯誤
+     */
+    bool probe(int device);
+
+    /**
+     * 立即執行卡死復原並重新初始化控制器 (會取得匯流排)
+     * @return SDA 已釋放返回 true
+     */
+    bool recover();
+
+    /**
+     * 目前的時脈 (Hz)
+     */
+    uint32_t getClock() const;
+
+    /**
+     * 使用的控制器
+     */
+    TwoWire& getWire();
+
+    int getDeviceCount() const;
+
+    /**
+     * 裝置資訊與統計
+     * @param device 裝置編號 (0 ~ getDeviceCount()-1)
+     */
+    const I2CDevice& getDevice(int device) const;
+
+    /**
+     * 已執行的卡死復原次數 (含失敗)
+     */
+    uint32_t getRecoveries() const;
+
+    /**
+     * 清除所有裝置的統計 (保留登記)
+     */
+    void resetStats();
+
+    /**
+     * 輸出每個裝置的統計
+     * @param out 輸出目標 (例如 Serial)
+     */
+    void printStats(Print& out) const;
+};
+
+/**
+ * 範圍鎖：建構時取得匯流排，解構時釋放
+ * bus 為 nullptr 時不做任何事 (裝置未交給匯流排管理，直接存取)
+ */
+class I2CTransaction {
+private:
+    I2CBus* bus;
+    int device;
+    bool acquired;
+    bool ok;
+
+public:
+    I2CTransaction(I2CBus* bus, int device, TickType_t timeout = pdMS_TO_TICKS(I2C_ACQUIRE_TIMEOUT_MS))
+        : bus(bus), device(device), acquired(bus ? bus->acquire(device, timeout) : true), ok(true) {}
+
+    ~I2CTransaction() {
+        if (bus && acquired) {
+            bus->release(device, ok);
+        }
+    }
+
+    /**
+     * 是否可以存取匯流排
+     */
+    bool isAcquired() const { return acquired; }
+
+    /**
+     * 標記交易失敗，釋放時計入錯誤
+     */
+    void fail() { ok = false; }
+};
+
+#endif // I2C_BUS_H
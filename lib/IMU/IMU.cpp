@@ -5,37 +5,140 @@
 
 #include "IMU.h"
 
+// dmpInitialize() 將陀螺儀量程設為 ±2000 dps
+static const float DMP_GYRO_LSB_PER_DPS = 16.4f;
+
+// 原始數據模式的量程：±500 dps 足以涵蓋倒下時的角速度，±4 g 保留碰撞時的餘量
+static const float RAW_GYRO_LSB_PER_DPS = 65.5f;
+static const float RAW_ACCEL_LSB_PER_G = 8192.0f;
+
+// filterAlpha 的定義取樣週期 (s)
+static const float FILTER_REFERENCE_PERIOD = 0.01f;
+
+// 加速度大小偏離 1 g 超過此值時視為有線加速度，不用來修正姿態
+static const float ACCEL_TRUST_BAND = 0.5f;
+
+// 兩次取樣間隔超過此值 (s) 時重新由加速度計初始化濾波器
+static const float RAW_MAX_DT = 0.1f;
+
+// MPU6050 的 FIFO 大小 (位元組)
+static const uint16_t FIFO_SIZE = 1024;
+
+// dmpInitialize() 將加速度計量程設為 ±2 g (校準時讀取原始暫存器用)
+static const float DMP_ACCEL_LSB_PER_G = 16384.0f;
+
+// 偏移暫存器單位：加速度為 ±16 g 刻度 (位元 0 保留給溫度補償)，陀螺儀為 ±1000 dps 刻度
+static const float ACCEL_OFFSET_LSB_PER_G = 2048.0f;
+static const float GYRO_OFFSET_LSB_PER_DPS = 32.8f;
+
+// 靜止偵測的陀螺儀短期平均時間常數 (s)
+static const float MOTION_MEAN_TAU = 0.2f;
+
+// 零偏追蹤每次修正估計值的比例，雜訊與殘餘轉動的影響逐次衰減
+static const float BIAS_CORRECTION_GAIN = 0.5f;
+
+// 依誤差調整偏移暫存器，限制在 int16 範圍內
+static int16_t stepOffset(int16_t offset, float correction) {
+    long value = (long)offset - lrintf(correction);
+    return (int16_t)constrain(value, -32768L, 32767L);
+}
+
 // 建構函數
 IMU::IMU(unsigned long updateIntervalMs, float alpha)
     : mpu(),
       dmpReady(false),
+      dmpPeriodMicros(10000),
+      backlogCount(0),
+      calState(IMU_CAL_IDLE),
+      calRounds(0),
+      calRound(0),
+      calSamples(0),
+      calStartMillis(0),
+      motionSeeded(false),
+      motionSettle(0),
+      lastMotionMicros(0),
+      stillSinceMicros(0),
+      stationary(false),
+      biasTracking(true),
+      biasWindowStart(0),
+      biasCount(0),
+      biasUpdates(0),
+      config(nullptr),
+      calibrated(false),
       lastUpdate(0),
       updateInterval(updateIntervalMs),
       filterAlpha(alpha),
-      initialized(false)
+      mode(IMU_MODE_DMP),
+      rawRateHz(1000),
+      gyroRadPerLsb(DEG_TO_RAD / RAW_GYRO_LSB_PER_DPS),
+      accelGPerLsb(1.0f / RAW_ACCEL_LSB_PER_G),
+      filterSeeded(false),
+      mahonyKi(0.0f),
+      initialized(false),
+      updateMutex(nullptr),
+      intPin(0),
+      interruptMode(false),
+      isrMicros(0),
+      isrCount(0),
+      handledIsrCount(0),
+      dataReady(nullptr),
+      sampleMicros(0),
+      bus(nullptr),
+      busDevice(-1)
 {
     // 初始化ypr陣列
     ypr[0] = ypr[1] = ypr[2] = 0.0f;
+    pitchRate = 0.0f;
+    mahonyIntegral[0] = mahonyIntegral[1] = mahonyIntegral[2] = 0.0f;
+    memset(backlog, 0, sizeof(backlog));
+    for (int i = 0; i < 3; i++) {
+        calAccelSum[i] = calGyroSum[i] = 0.0f;
+        motionMean[i] = 0.0f;
+        biasSum[i] = 0.0f;
+    }
+    memset(&fifoStats, 0, sizeof(fifoStats));
 }
 
 // 析構函數
 IMU::~IMU() {
-    preferences.end();
+}
+
+// 交給 I2C 匯流排管理
+void IMU::setBus(I2CBus* i2cBus) {
+    bus = i2cBus;
+    busDevice = -1;
 }
 
 // 初始化IMU
 bool IMU::begin(int sda, int scl, uint8_t address) {
-    // 初始化preferences
-    preferences.begin(prefsNamespace, false);
+    if (updateMutex == nullptr) {
+        updateMutex = xSemaphoreCreateMutex();
+    }
+    
+    // MPU6050 支援 400 kHz 快速模式，縮短每次讀取 DMP 封包的匯流排時間
+    if (bus != nullptr) {
+        if (!bus->begin(sda, scl)) {
+            Serial.println("MPU6050 I2C bus init failed");
+            return false;
+        }
+        if (busDevice < 0) {
+            busDevice = bus->addDevice("mpu6050", address, I2C_PRIORITY_HIGH, 400000);
+        }
+    } else {
+        // 初始化Wire (I2C)
+        Wire.begin(sda, scl);
+        Wire.setClock(400000);
+    }
     
-    // 初始化Wire (I2C)
-    Wire.begin(sda, scl);
+    // DMP 初始化約需 0.5 秒，期間其他裝置 (顯示器) 只能在等待中逾時
+    I2CTransaction transaction(bus, busDevice, portMAX_DELAY);
     
     // 初始化MPU6050 - 注意：MPU6050類沒有setAddress方法
     mpu.initialize();
     
     // 測試連接
     if (!mpu.testConnection()) {
+        transaction.fail();
         Serial.println("MPU6050 connection failed");
         return false;
     }
@@ -45,12 +148,7 @@ bool IMU::begin(int sda, int scl, uint8_t address) {
     
     // 如果已載入校準值，則設置偏移
     if (loadCalibration()) {
-        mpu.setXAccelOffset(ax_offset);
-        mpu.setYAccelOffset(ay_offset);
-        mpu.setZAccelOffset(az_offset);
-        mpu.setXGyroOffset(gx_offset);
-        mpu.setYGyroOffset(gy_offset);
-        mpu.setZGyroOffset(gz_offset);
+        applyOffsets();
     }
     
     // 檢查初始化是否成功
@@ -58,8 +156,9 @@ bool IMU::begin(int sda, int scl, uint8_t address) {
         // 啟用DMP
         mpu.setDMPEnabled(true);
         
-        // 取得每個數據包的大小
+        // 取得每個數據包的大小與輸出週期 (DMP 在取樣率 1kHz/(1+rate) 上再除以 2)
         packetSize = mpu.dmpGetFIFOPacketSize();
+        dmpPeriodMicros = 2000UL * (1 + mpu.getRate());
         dmpReady = true;
         initialized = true;
         return true;
@@ -72,79 +171,273 @@ bool IMU::begin(int sda, int scl, uint8_t address) {
     }
 }
 
-// 校準MPU6050
-bool IMU::calibrate(uint8_t samples, std::function<void(const char*, int)> progressCallback) {
-    if (!initialized) {
+// 開始漸進式校準
+bool IMU::startCalibration(uint8_t rounds) {
+    if (!initialized || calState == IMU_CAL_RUNNING) {
         return false;
     }
     
-    // 校準加速度計
-    for (int i = 0; i < samples; i++) {
-        if (progressCallback) {
-            progressCallback("Accelerometer", (i * 100) / samples);
+    xSemaphoreTake(updateMutex, portMAX_DELAY);
+    calRounds = max(rounds, (uint8_t)1);
+    calRound = 0;
+    calSamples = 0;
+    calStartMillis = millis();
+    for (int i = 0; i < 3; i++) {
+        calAccelSum[i] = calGyroSum[i] = 0.0f;
+    }
+    calState = IMU_CAL_RUNNING;
+    xSemaphoreGive(updateMutex);
+    return true;
+}
+
+// 中止校準
+void IMU::cancelCalibration() {
+    xSemaphoreTake(updateMutex, portMAX_DELAY);
+    if (calState == IMU_CAL_RUNNING) {
+        calState = IMU_CAL_IDLE;
+    }
+    xSemaphoreGive(updateMutex);
+}
+
+// 獲取漸進式校準狀態
+ImuCalState IMU::getCalibrationState() {
+    return calState;
+}
+
+// 獲取校準進度
+int IMU::getCalibrationProgress() {
+    if (calState == IMU_CAL_DONE) {
+        return 100;
+    }
+    if (calRounds == 0) {
+        return 0;
+    }
+    int progress = (calRound * IMU_CAL_ROUND_SAMPLES + calSamples) * 100 / (calRounds * IMU_CAL_ROUND_SAMPLES);
+    return min(progress, 99);
+}
+
+// 啟用或停用線上零偏追蹤
+void IMU::setBiasTracking(bool enable) {
+    biasTracking = enable;
+    biasCount = 0;
+}
+
+// 是否判定為靜止
+bool IMU::isStationary() {
+    return stationary;
+}
+
+// 零偏追蹤的修正次數
+uint32_t IMU::getBiasUpdates() {
+    return biasUpdates;
+}
+
+// 寫入全部偏移暫存器 (呼叫端持有匯流排)
+void IMU::applyOffsets() {
+    mpu.setXAccelOffset(ax_offset);
+    mpu.setYAccelOffset(ay_offset);
+    mpu.setZAccelOffset(az_offset);
+    mpu.setXGyroOffset(gx_offset);
+    mpu.setYGyroOffset(gy_offset);
+    mpu.setZGyroOffset(gz_offset);
+}
+
+// 靜止偵測，並把這筆取樣交給校準或零偏追蹤
+void IMU::trackMotion(uint32_t timestamp) {
+    float gyroDpsPerLsb = mode == IMU_MODE_DMP ? 1.0f / DMP_GYRO_LSB_PER_DPS : gyroRadPerLsb * RAD_TO_DEG;
+    float accelGPerCount = mode == IMU_MODE_DMP ? 1.0f / DMP_ACCEL_LSB_PER_G : accelGPerLsb;
+    float g[3] = {gyro.x * gyroDpsPerLsb, gyro.y * gyroDpsPerLsb, gyro.z * gyroDpsPerLsb};
+    float a[3] = {accel.x * accelGPerCount, accel.y * accelGPerCount, accel.z * accelGPerCount};
+    
+    if (calState == IMU_CAL_RUNNING && millis() - calStartMillis > IMU_CAL_TIMEOUT_MS) {
+        calState = IMU_CAL_FAILED;
+    }
+    
+    float dt = (timestamp - lastMotionMicros) * 1e-6f;
+    lastMotionMicros = timestamp;
+    if (!motionSeeded || dt <= 0.0f || dt > RAW_MAX_DT) {
+        // 第一筆或中斷太久：重新開始判斷
+        for (int i = 0; i < 3; i++) {
+            motionMean[i] = g[i];
+        }
+        motionSeeded = true;
+        stillSinceMicros = 0;
+        stationary = false;
+        return;
+    }
+    if (motionSettle > 0) {
+        // 偏移剛改變：平均直接跟上新的讀值，靜止狀態不變
+        motionSettle--;
+        for (int i = 0; i < 3; i++) {
+            motionMean[i] = g[i];
+        }
+        return;
+    }
+    
+    bool quiet = true;
+    float k = dt / (MOTION_MEAN_TAU + dt);
+    for (int i = 0; i < 3; i++) {
+        if (fabsf(g[i] - motionMean[i]) > IMU_STILL_GYRO_DPS) {
+            quiet = false;
         }
-        mpu.CalibrateAccel(1);  // 每次迭代校準一次
-        delay(50);
+        motionMean[i] += k * (g[i] - motionMean[i]);
+    }
+    if (!quiet) {
+        stillSinceMicros = 0;
+        stationary = false;
+    } else {
+        if (stillSinceMicros == 0) {
+            stillSinceMicros = timestamp ? timestamp : 1;
+        }
+        stationary = timestamp - stillSinceMicros >= IMU_STILL_TIME_MS * 1000UL;
     }
     
-    // 校準陀螺儀
-    for (int i = 0; i < samples; i++) {
-        if (progressCallback) {
-            progressCallback("Gyroscope", (i * 100) / samples);
+    if (calState == IMU_CAL_RUNNING) {
+        calibrationStep(a, g);
+    } else if (biasTracking) {
+        biasStep(timestamp, g);
+    }
+}
+
+// 校準：靜止時累積一回合的取樣，平均後修正偏移暫存器
+void IMU::calibrationStep(const float accelG[3], const float gyroDps[3]) {
+    if (!stationary) {
+        // 移動：本回合重新累積
+        calSamples = 0;
+        for (int i = 0; i < 3; i++) {
+            calAccelSum[i] = calGyroSum[i] = 0.0f;
         }
-        mpu.CalibrateGyro(1);  // 每次迭代校準一次
-        delay(50);
+        return;
     }
     
-    // 儲存校準後的偏移值
-    ax_offset = mpu.getXAccelOffset();
-    ay_offset = mpu.getYAccelOffset();
-    az_offset = mpu.getZAccelOffset();
-    gx_offset = mpu.getXGyroOffset();
-    gy_offset = mpu.getYGyroOffset();
-    gz_offset = mpu.getZGyroOffset();
+    for (int i = 0; i < 3; i++) {
+        calAccelSum[i] += accelG[i];
+        calGyroSum[i] += gyroDps[i];
+    }
+    if (++calSamples < IMU_CAL_ROUND_SAMPLES) {
+        return;
+    }
     
-    // 儲存到Preferences
-    saveCalibration();
+    // 加速度目標：水平放置時 X/Y 為 0、Z 為 +1 g；加速度偏移的位元 0 保持原值
+    float n = calSamples;
+    const float target[3] = {0.0f, 0.0f, 1.0f};
+    int16_t* accelOffsets[3] = {&ax_offset, &ay_offset, &az_offset};
+    int16_t* gyroOffsets[3] = {&gx_offset, &gy_offset, &gz_offset};
+    for (int i = 0; i < 3; i++) {
+        int16_t value = stepOffset(*accelOffsets[i], (calAccelSum[i] / n - target[i]) * ACCEL_OFFSET_LSB_PER_G);
+        *accelOffsets[i] = (int16_t)((value & ~1) | (*accelOffsets[i] & 1));
+        *gyroOffsets[i] = stepOffset(*gyroOffsets[i], calGyroSum[i] / n * GYRO_OFFSET_LSB_PER_DPS);
+        calAccelSum[i] = calGyroSum[i] = 0.0f;
+    }
+    applyOffsets();
+    motionSettle = IMU_SETTLE_SAMPLES;
+    calSamples = 0;
+    
+    if (++calRound >= calRounds) {
+        // 原始數據模式以新的偏移重新初始化姿態
+        filterSeeded = false;
+        mahonyIntegral[0] = mahonyIntegral[1] = mahonyIntegral[2] = 0.0f;
+        biasCount = 0;
+        calState = IMU_CAL_DONE;
+    }
+}
+
+// 零偏追蹤：靜止期間平均殘餘角速度，逐次修正陀螺儀偏移暫存器
+void IMU::biasStep(uint32_t timestamp, const float gyroDps[3]) {
+    bool usable = stationary;
+    for (int i = 0; i < 3; i++) {
+        if (fabsf(gyroDps[i]) > IMU_BIAS_MAX_RATE_DPS) {
+            usable = false;
+        }
+    }
+    if (!usable) {
+        biasCount = 0;
+        return;
+    }
     
-    return true;
+    if (biasCount == 0) {
+        biasWindowStart = timestamp;
+        biasSum[0] = biasSum[1] = biasSum[2] = 0.0f;
+    }
+    for (int i = 0; i < 3; i++) {
+        biasSum[i] += gyroDps[i];
+    }
+    biasCount++;
+    if (timestamp - biasWindowStart < IMU_BIAS_WINDOW_MS * 1000UL) {
+        return;
+    }
+    
+    long steps[3];
+    bool changed = false;
+    for (int i = 0; i < 3; i++) {
+        float correction = BIAS_CORRECTION_GAIN * biasSum[i] / biasCount * GYRO_OFFSET_LSB_PER_DPS;
+        steps[i] = constrain(lrintf(correction), (long)-IMU_BIAS_MAX_STEP, (long)IMU_BIAS_MAX_STEP);
+        changed |= steps[i] != 0;
+    }
+    biasCount = 0;
+    if (!changed) {
+        return;
+    }
+    
+    gx_offset = stepOffset(gx_offset, steps[0]);
+    gy_offset = stepOffset(gy_offset, steps[1]);
+    gz_offset = stepOffset(gz_offset, steps[2]);
+    mpu.setXGyroOffset(gx_offset);
+    mpu.setYGyroOffset(gy_offset);
+    mpu.setZGyroOffset(gz_offset);
+    motionSettle = IMU_SETTLE_SAMPLES;
+    biasUpdates++;
+}
+
+// 設定校準值的儲存位置
+void IMU::setConfigStore(ConfigStore* store) {
+    config = store;
 }
 
-// 將校準值儲存到Preferences
+// 將校準值寫入設定
 bool IMU::saveCalibration() {
-    // 儲存加速度計偏移
-    preferences.putShort("ax_offset", ax_offset);
-    preferences.putShort("ay_offset", ay_offset);
-    preferences.putShort("az_offset", az_offset);
+    if (config == nullptr) {
+        return false;
+    }
+    
+    ImuConfig& imuConfig = config->edit().imu;
     
-    // 儲存陀螺儀偏移
-    preferences.putShort("gx_offset", gx_offset);
-    preferences.putShort("gy_offset", gy_offset);
-    preferences.putShort("gz_offset", gz_offset);
+    // 加速度計偏移
+    imuConfig.accelOffset[0] = ax_offset;
+    imuConfig.accelOffset[1] = ay_offset;
+    imuConfig.accelOffset[2] = az_offset;
     
-    // 儲存有效標記
-    preferences.putBool("cal_valid", true);
+    // 陀螺儀偏移
+    imuConfig.gyroOffset[0] = gx_offset;
+    imuConfig.gyroOffset[1] = gy_offset;
+    imuConfig.gyroOffset[2] = gz_offset;
+    
+    imuConfig.calibrated = 1;
+    calibrated = true;
     
     return true;
 }
 
-// 從Preferences載入校準值
+// 從設定載入校準值
 bool IMU::loadCalibration() {
     // 檢查是否有有效校準數據
-    if (!preferences.getBool("cal_valid", false)) {
+    if (config == nullptr || !config->get().imu.calibrated) {
         return false;
     }
     
-    // 讀取加速度計偏移
-    ax_offset = preferences.getShort("ax_offset", 0);
-    ay_offset = preferences.getShort("ay_offset", 0);
-    az_offset = preferences.getShort("az_offset", 0);
+    const ImuConfig& imuConfig = config->get().imu;
+    
+    // 加速度計偏移
+    ax_offset = imuConfig.accelOffset[0];
+    ay_offset = imuConfig.accelOffset[1];
+    az_offset = imuConfig.accelOffset[2];
     
-    // 讀取陀螺儀偏移
-    gx_offset = preferences.getShort("gx_offset", 0);
-    gy_offset = preferences.getShort("gy_offset", 0);
-    gz_offset = preferences.getShort("gz_offset", 0);
+    // 陀螺儀偏移
+    gx_offset = imuConfig.gyroOffset[0];
+    gy_offset = imuConfig.gyroOffset[1];
+    gz_offset = imuConfig.gyroOffset[2];
     
+    calibrated = true;
     return true;
 }
 
@@ -161,6 +454,12 @@ void IMU::getCalibrationValues(int16_t accelOffset[3], int16_t gyroOffset[3]) {
 
 // 設置校準值
 void IMU::setCalibrationValues(const int16_t accelOffset[3], const int16_t gyroOffset[3]) {
+    if (!initialized) {
+        return;
+    }
+    
+    // update() 中的陀螺儀偏差追蹤也會修改偏移值與暫存器，整段持有 updateMutex
+    xSemaphoreTake(updateMutex, portMAX_DELAY);
     ax_offset = accelOffset[0];
     ay_offset = accelOffset[1];
     az_offset = accelOffset[2];
@@ -170,42 +469,436 @@ void IMU::setCalibrationValues(const int16_t accelOffset[3], const int16_t gyroO
     gz_offset = gyroOffset[2];
     
     // 應用偏移值
-    mpu.setXAccelOffset(ax_offset);
-    mpu.setYAccelOffset(ay_offset);
-    mpu.setZAccelOffset(az_offset);
-    mpu.setXGyroOffset(gx_offset);
-    mpu.setYGyroOffset(gy_offset);
-    mpu.setZGyroOffset(gz_offset);
+    {
+        I2CTransaction transaction(bus, busDevice, portMAX_DELAY);
+        applyOffsets();
+    }
     
-    // 儲存到Preferences
+    // 儲存到設定 (與寫入暫存器的值相同)
     saveCalibration();
+    xSemaphoreGive(updateMutex);
+}
+
+// 數據就緒中斷：只記錄時間並喚醒等待的任務，FIFO 讀取留給 update()
+void IRAM_ATTR IMU::dataReadyISR(void* arg) {
+    IMU* self = static_cast<IMU*>(arg);
+    uint32_t now = micros();
+    
+    portENTER_CRITICAL_ISR(&self->isrMux);
+    self->isrMicros = now;
+    self->isrCount++;
+    portEXIT_CRITICAL_ISR(&self->isrMux);
+    
+    BaseType_t woken = pdFALSE;
+    xSemaphoreGiveFromISR(self->dataReady, &woken);
+    if (woken) {
+        portYIELD_FROM_ISR();
+    }
+}
+
+// 啟用數據就緒中斷模式
+bool IMU::enableInterrupt(uint8_t pin) {
+    if (!initialized) {
+        return false;
+    }
+    
+    if (dataReady == nullptr) {
+        dataReady = xSemaphoreCreateBinary();
+    }
+    
+    intPin = pin;
+    pinMode(intPin, INPUT);
+    
+    // 清空 FIFO，讓下一次中斷對應到下一個封包
+    xSemaphoreTake(updateMutex, portMAX_DELAY);
+    {
+        I2CTransaction transaction(bus, busDevice, portMAX_DELAY);
+        mpu.resetFIFO();
+    }
+    handledIsrCount = isrCount;
+    xSemaphoreGive(updateMutex);
+    
+    attachInterruptArg(digitalPinToInterrupt(intPin), dataReadyISR, this, RISING);
+    interruptMode = true;
+    return true;
+}
+
+// 停用數據就緒中斷
+void IMU::disableInterrupt() {
+    if (!interruptMode) {
+        return;
+    }
+    detachInterrupt(digitalPinToInterrupt(intPin));
+    interruptMode = false;
+}
+
+// 檢查是否處於中斷模式
+bool IMU::isInterruptMode() {
+    return interruptMode;
+}
+
+// 等待下一筆數據就緒
+bool IMU::waitForData(TickType_t timeout) {
+    if (!interruptMode) {
+        return false;
+    }
+    return xSemaphoreTake(dataReady, timeout) == pdTRUE;
+}
+
+// 切換姿態來源
+bool IMU::setMode(ImuMode newMode, uint16_t sampleRateHz) {
+    if (!initialized) {
+        return false;
+    }
+    
+    xSemaphoreTake(updateMutex, portMAX_DELAY);
+    
+    bool ok;
+    {
+        I2CTransaction transaction(bus, busDevice, portMAX_DELAY);
+        if (newMode == IMU_MODE_DMP) {
+            mode = IMU_MODE_DMP;
+            ok = resetDMP();
+        } else {
+            rawRateHz = constrain(sampleRateHz, (uint16_t)4, (uint16_t)1000);
+            mode = newMode;
+            ok = configureRaw();
+        }
+    }
+    
+    // 新模式的第一筆數據重新開始計時與初始化濾波器
+    filterSeeded = false;
+    ypr[0] = 0.0f;
+    mahonyIntegral[0] = mahonyIntegral[1] = mahonyIntegral[2] = 0.0f;
+    handledIsrCount = isrCount;
+    backlogCount = 0;
+    
+    // 量程改變，靜止偵測與進行中的回合重新開始
+    motionSeeded = false;
+    calSamples = 0;
+    for (int i = 0; i < 3; i++) {
+        calAccelSum[i] = calGyroSum[i] = 0.0f;
+    }
+    biasCount = 0;
+    
+    xSemaphoreGive(updateMutex);
+    return ok;
+}
+
+// 獲取目前的姿態來源
+ImuMode IMU::getMode() {
+    return mode;
+}
+
+// 設定 Mahony 積分增益
+void IMU::setMahonyIntegralGain(float ki) {
+    mahonyKi = max(ki, 0.0f);
+    mahonyIntegral[0] = mahonyIntegral[1] = mahonyIntegral[2] = 0.0f;
+}
+
+// 獲取 Mahony 積分增益
+float IMU::getMahonyIntegralGain() {
+    return mahonyKi;
+}
+
+// 停用 DMP 並設定原始數據的量程、濾波與取樣率
+bool IMU::configureRaw() {
+    mpu.setDMPEnabled(false);
+    dmpReady = false;
+    
+    mpu.setFullScaleGyroRange(MPU6050_GYRO_FS_500);
+    mpu.setFullScaleAccelRange(MPU6050_ACCEL_FS_4);
+    gyroRadPerLsb = DEG_TO_RAD / RAW_GYRO_LSB_PER_DPS;
+    accelGPerLsb = 1.0f / RAW_ACCEL_LSB_PER_G;
+    
+    // 啟用 DLPF 時內部取樣率為 1 kHz；188 Hz 頻寬的群延遲約 2 ms
+    mpu.setDLPFMode(MPU6050_DLPF_BW_188);
+    mpu.setRate(1000 / rawRateHz - 1);
+    
+    // INT 改為每個取樣觸發 (DMP 的 FIFO 中斷在此模式下不會產生)
+    mpu.setIntEnabled(1 << MPU6050_INTERRUPT_DATA_RDY_BIT);
+    return true;
+}
+
+// filterAlpha 換算的時間常數 (s)
+float IMU::filterTimeConstant() {
+    float alpha = min(filterAlpha, 0.9999f);
+    return FILTER_REFERENCE_PERIOD * alpha / (1.0f - alpha);
+}
+
+// 讀取一筆原始數據並推進濾波器
+bool IMU::updateRaw(uint32_t timestamp) {
+    int16_t rawAccel[3], rawGyro[3];
+    mpu.getMotion6(&rawAccel[0], &rawAccel[1], &rawAccel[2], &rawGyro[0], &rawGyro[1], &rawGyro[2]);
+    
+    float a[3], g[3];
+    for (int i = 0; i < 3; i++) {
+        a[i] = rawAccel[i] * accelGPerLsb;
+        g[i] = rawGyro[i] * gyroRadPerLsb;
+    }
+    gyro.x = rawGyro[0];
+    gyro.y = rawGyro[1];
+    gyro.z = rawGyro[2];
+    accel.x = rawAccel[0];
+    accel.y = rawAccel[1];
+    accel.z = rawAccel[2];
+    
+    float dt = (timestamp - sampleMicros) * 1e-6f;
+    if (dt <= 0.0f || dt > RAW_MAX_DT) {
+        filterSeeded = false;
+    }
+    sampleMicros = timestamp;
+    
+    // 與 DMP 相同的定義：重力方向即為歸一化的加速度
+    float norm = sqrtf(a[0] * a[0] + a[1] * a[1] + a[2] * a[2]);
+    bool accelValid = fabsf(norm - 1.0f) < ACCEL_TRUST_BAND;
+    float accelPitch = atan2f(a[0], sqrtf(a[1] * a[1] + a[2] * a[2]));
+    float accelRoll = atan2f(a[1], a[2]);
+    
+    // 俯仰角為繞Y軸右手旋轉的反方向，偏航角為繞Z軸的反方向
+    pitchRate = -g[1];
+    
+    if (!filterSeeded) {
+        // 由加速度計初始化俯仰與翻滾 (偏航保留)，四元數與 DMP 的定義相同
+        ypr[1] = accelPitch;
+        ypr[2] = accelRoll;
+        float cy = cosf(-ypr[0] * 0.5f), sy = sinf(-ypr[0] * 0.5f);
+        float cp = cosf(-accelPitch * 0.5f), sp = sinf(-accelPitch * 0.5f);
+        float cr = cosf(accelRoll * 0.5f), sr = sinf(accelRoll * 0.5f);
+        q = Quaternion(cr * cp * cy + sr * sp * sy,
+                       sr * cp * cy - cr * sp * sy,
+                       cr * sp * cy + sr * cp * sy,
+                       cr * cp * sy - sr * sp * cy);
+        filterSeeded = true;
+        return true;
+    }
+    
+    float tau = filterTimeConstant();
+    
+    if (mode == IMU_MODE_COMPLEMENTARY) {
+        // 陀螺儀積分，再以加速度計角度做一階低通修正 (每個取樣的權重依 dt 換算)
+        float k = accelValid ? dt / (tau + dt) : 0.0f;
+        ypr[1] += pitchRate * dt;
+        ypr[2] += g[0] * dt;
+        ypr[1] += k * (accelPitch - ypr[1]);
+        ypr[2] += k * (accelRoll - ypr[2]);
+        ypr[0] -= g[2] * dt;
+        if (ypr[0] > PI) ypr[0] -= TWO_PI;
+        if (ypr[0] < -PI) ypr[0] += TWO_PI;
+        return true;
+    }
+    
+    // Mahony：以估計的重力方向與量測的加速度方向的外積作為角速度修正
+    if (accelValid) {
+        float ax = a[0] / norm, ay = a[1] / norm, az = a[2] / norm;
+        float vx = 2.0f * (q.x * q.z - q.w * q.y);
+        float vy = 2.0f * (q.w * q.x + q.y * q.z);
+        float vz = q.w * q.w - q.x * q.x - q.y * q.y + q.z * q.z;
+        float e[3] = {ay * vz - az * vy, az * vx - ax * vz, ax * vy - ay * vx};
+        float kp = 1.0f / tau;
+        for (int i = 0; i < 3; i++) {
+            if (mahonyKi > 0.0f) {
+                mahonyIntegral[i] += mahonyKi * e[i] * dt;
+            }
+            g[i] += kp * e[i];
+        }
+    }
+    for (int i = 0; i < 3; i++) {
+        g[i] += mahonyIntegral[i];
+    }
+    
+    // q̇ = ½ q ⊗ (0, ω)
+    float hx = 0.5f * g[0] * dt, hy = 0.5f * g[1] * dt, hz = 0.5f * g[2] * dt;
+    Quaternion next(q.w - q.x * hx - q.y * hy - q.z * hz,
+                    q.x + q.w * hx + q.y * hz - q.z * hy,
+                    q.y + q.w * hy - q.x * hz + q.z * hx,
+                    q.z + q.w * hz + q.x * hy - q.y * hx);
+    float qNorm = sqrtf(next.w * next.w + next.x * next.x + next.y * next.y + next.z * next.z);
+    q = Quaternion(next.w / qNorm, next.x / qNorm, next.y / qNorm, next.z / qNorm);
+    
+    // 與 DMP 模式相同的換算
+    mpu.dmpGetGravity(&gravity, &q);
+    mpu.dmpGetYawPitchRoll(ypr, &q, &gravity);
+    return true;
 }
 
 // 更新IMU數據
 bool IMU::update() {
-    if (!dmpReady) return false;
+    if (!initialized) return false;
+    if (mode == IMU_MODE_DMP && !dmpReady) return false;
+    
+    uint32_t count = 0;
+    uint32_t timestamp = 0;
+    
+    if (interruptMode) {
+        // 沒有新的中斷就不佔用匯流排
+        portENTER_CRITICAL(&isrMux);
+        count = isrCount;
+        timestamp = isrMicros;
+        portEXIT_CRITICAL(&isrMux);
+        if (count == handledIsrCount) {
+            return false;
+        }
+    } else if (mode == IMU_MODE_DMP) {
+        unsigned long currentTime = millis();
+        if (currentTime - lastUpdate < updateInterval) {
+            return false;  // 尚未到更新時間
+        }
+    } else {
+        // 原始數據：不早於下一個取樣
+        if (filterSeeded && micros() - sampleMicros < 1000000UL / rawRateHz) {
+            return false;
+        }
+    }
     
-    unsigned long currentTime = millis();
-    if (currentTime - lastUpdate < updateInterval) {
-        return false;  // 尚未到更新時間
+    // 另一個任務正在讀取FIFO
+    if (xSemaphoreTake(updateMutex, 0) != pdTRUE) {
+        return false;
     }
     
-    lastUpdate = currentTime;
+    // 匯流排被佔用超過逾時：下一次呼叫再試 (中斷計數不標記為已處理)
+    I2CTransaction transaction(bus, busDevice);
+    if (!transaction.isAcquired()) {
+        xSemaphoreGive(updateMutex);
+        return false;
+    }
     
-    // 讀取DMP數據
-    if (mpu.dmpGetCurrentFIFOPacket(fifoBuffer)) {
-        mpu.dmpGetQuaternion(&q, fifoBuffer);
-        mpu.dmpGetGravity(&gravity, &q);
-        mpu.dmpGetYawPitchRoll(ypr, &q, &gravity);
-        return true;
+    lastUpdate = millis();
+    if (!interruptMode) {
+        timestamp = micros();
     }
     
-    return false;
+    // 讀取DMP數據 (取出 FIFO 中所有封包，最新的封包對應最近一次中斷)
+    bool updated = false;
+    if (mode != IMU_MODE_DMP) {
+        updated = updateRaw(timestamp);
+        if (updated) {
+            storeSample(0, timestamp);
+            backlogCount = 1;
+        }
+    } else {
+        // 計數錯亂也可能是讀取失敗，回報給匯流排 (位址仍有回應時不會觸發復原)
+        uint32_t overflows = fifoStats.overflows;
+        updated = drainFifo(timestamp);
+        if (fifoStats.overflows != overflows) {
+            transaction.fail();
+        }
+        
+        // 校準需要加速度：DMP 封包的加速度刻度依 MotionApps 版本而異，改讀原始暫存器
+        if (updated && calState == IMU_CAL_RUNNING) {
+            mpu.getMotion6(&accel.x, &accel.y, &accel.z, &gyro.x, &gyro.y, &gyro.z);
+        }
+    }
+    if (updated) {
+        trackMotion(timestamp);
+    }
+    if (interruptMode) {
+        handledIsrCount = count;
+    }
+    
+    xSemaphoreGive(updateMutex);
+    return updated;
+}
+
+// 讀出 FIFO 中所有完整的 DMP 封包
+bool IMU::drainFifo(uint32_t timestamp) {
+    fifoCount = mpu.getFIFOCount();
+    if (fifoCount < packetSize) {
+        fifoStats.emptyReads++;
+        return false;
+    }
+    
+    // FIFO 滿時晶片覆寫最舊的位元組，計數停在 1024 (不是封包大小的整數倍)，封包邊界已無法找回
+    if (fifoCount % packetSize != 0 || fifoCount >= FIFO_SIZE) {
+        mpuIntStatus = mpu.getIntStatus();  // 同時清除溢位旗標
+        mpu.resetFIFO();
+        fifoStats.overflows++;
+        return false;
+    }
+    
+    // 只解碼最後 IMU_BACKLOG_SIZE 個封包，更早的讀出後丟棄
+    uint16_t total = fifoCount / packetSize;
+    uint16_t first = total > IMU_BACKLOG_SIZE ? total - IMU_BACKLOG_SIZE : 0;
+    uint16_t index = 0;
+    while (index < total) {
+        uint8_t burst = min(total - index, IMU_FIFO_BURST_PACKETS);
+        mpu.getFIFOBytes(fifoBuffer, burst * packetSize);
+        for (uint8_t k = 0; k < burst; k++, index++) {
+            if (index < first) {
+                continue;
+            }
+            decodePacket(&fifoBuffer[k * packetSize]);
+            storeSample(index - first, timestamp - (uint32_t)(total - 1 - index) * dmpPeriodMicros);
+        }
+    }
+    backlogCount = total - first;
+    sampleMicros = timestamp;
+    
+    fifoStats.packets += total;
+    fifoStats.lastBacklog = total;
+    fifoStats.maxBacklog = max(fifoStats.maxBacklog, total);
+    return true;
+}
+
+// 由一個 DMP 封包更新姿態
+void IMU::decodePacket(const uint8_t* packet) {
+    mpu.dmpGetQuaternion(&q, packet);
+    mpu.dmpGetGravity(&gravity, &q);
+    mpu.dmpGetYawPitchRoll(ypr, &q, &gravity);
+    
+    // 俯仰角為繞Y軸右手旋轉的反方向，故取負號
+    mpu.dmpGetGyro(&gyro, packet);
+    pitchRate = -gyro.y / DMP_GYRO_LSB_PER_DPS * DEG_TO_RAD;
+}
+
+// 把目前的姿態存入取樣歷史
+void IMU::storeSample(uint8_t index, uint32_t timestamp) {
+    ImuSample& sample = backlog[index];
+    sample.micros = timestamp;
+    sample.yaw = ypr[0];
+    sample.pitch = ypr[1];
+    sample.roll = ypr[2];
+    sample.pitchRate = pitchRate;
+}
+
+// 獲取目前姿態數據的取樣時間
+uint32_t IMU::getSampleMicros() {
+    return sampleMicros;
+}
+
+// 獲取最近一次 update() 讀出的取樣
+uint8_t IMU::getBacklog(ImuSample* samples, uint8_t maxSamples) {
+    // 空間不足時保留最新的幾筆
+    uint8_t count = min(backlogCount, maxSamples);
+    uint8_t first = backlogCount - count;
+    for (uint8_t i = 0; i < count; i++) {
+        samples[i] = backlog[first + i];
+    }
+    return count;
+}
+
+// 獲取最新的一筆取樣
+ImuSample IMU::getLatestSample() {
+    if (backlogCount == 0) {
+        ImuSample empty = {0, 0.0f, 0.0f, 0.0f, 0.0f};
+        return empty;
+    }
+    return backlog[backlogCount - 1];
+}
+
+// 獲取 DMP FIFO 讀取統計
+ImuFifoStats IMU::getFifoStats() {
+    return fifoStats;
+}
+
+// 清除 DMP FIFO 讀取統計
+void IMU::resetFifoStats() {
+    memset(&fifoStats, 0, sizeof(fifoStats));
 }
 
 // 獲取YPR數據
 bool IMU::getYPR(float* yawPitchRoll) {
-    if (!dmpReady) return false;
+    if (!initialized) return false;
     
     // 複製到傳出參數
     if (yawPitchRoll) {
@@ -232,18 +925,26 @@ float IMU::getRoll() {
     return ypr[2];
 }
 
+// 獲取俯仰角速度
+float IMU::getPitchRate() {
+    return pitchRate;
+}
+
 // 獲取原始加速度計數據
 void IMU::getAcceleration(int16_t* ax, int16_t* ay, int16_t* az) {
+    I2CTransaction transaction(bus, busDevice);
     mpu.getAcceleration(ax, ay, az);
 }
 
 // 獲取原始陀螺儀數據
 void IMU::getRotation(int16_t* gx, int16_t* gy, int16_t* gz) {
+    I2CTransaction transaction(bus, busDevice);
     mpu.getRotation(gx, gy, gz);
 }
 
 // 獲取溫度
 float IMU::getTemperature() {
+    I2CTransaction transaction(bus, busDevice);
     return mpu.getTemperature() / 340.0 + 36.53;  // 根據MPU6050數據手冊的公式
 }
 
@@ -252,6 +953,11 @@ void IMU::setFilterAlpha(float alpha) {
     filterAlpha = constrain(alpha, 0.0f, 1.0f);
 }
 
+// 獲取濾波器係數
+float IMU::getFilterAlpha() {
+    return filterAlpha;
+}
+
 // 設置更新間隔
 void IMU::setUpdateInterval(unsigned long intervalMs) {
     updateInterval = intervalMs;
@@ -273,6 +979,8 @@ bool IMU::resetDMP() {
         return false;
     }
     
+    I2CTransaction transaction(bus, busDevice, portMAX_DELAY);
+    
     // 禁用DMP
     mpu.setDMPEnabled(false);
     
@@ -280,20 +988,16 @@ bool IMU::resetDMP() {
     devStatus = mpu.dmpInitialize();
     
     // 應用校準值
-    mpu.setXAccelOffset(ax_offset);
-    mpu.setYAccelOffset(ay_offset);
-    mpu.setZAccelOffset(az_offset);
-    mpu.setXGyroOffset(gx_offset);
-    mpu.setYGyroOffset(gy_offset);
-    mpu.setZGyroOffset(gz_offset);
+    applyOffsets();
     
     // 檢查初始化是否成功
     if (devStatus == 0) {
         // 啟用DMP
         mpu.setDMPEnabled(true);
         
-        // 取得每個數據包的大小
+        // 取得每個數據包的大小與輸出週期 (DMP 在取樣率 1kHz/(1+rate) 上再除以 2)
         packetSize = mpu.dmpGetFIFOPacketSize();
+        dmpPeriodMicros = 2000UL * (1 + mpu.getRate());
         dmpReady = true;
         return true;
     }
@@ -303,5 +1007,5 @@ bool IMU::resetDMP() {
 
 // 獲取校準狀態
 bool IMU::isCalibrated() {
-    return preferences.getBool("cal_valid", false);
+    return calibrated;
 }
\ No newline at end of file
@@ -9,7 +9,73 @@
 #include <Arduino.h>
 #include <Wire.h>
 #include <MPU6050_6Axis_MotionApps20.h>
-#include <Preferences.h>
+#include "I2CBus.h"
+#include "ConfigStore.h"
+
+/**
+ * 姿態來源
+ * 三種模式的 getYaw()/getPitch()/getRoll()/getPitchRate() 定義相同 (與 dmpGetYawPitchRoll() 一致)
+ */
+enum ImuMode {
+    IMU_MODE_DMP,            // DMP 融合 (MotionApps 2.0，100 Hz 封包)
+    IMU_MODE_COMPLEMENTARY,  // 原始數據 + 互補濾波 (俯仰/翻滾由加速度計修正，偏航只積分)
+    IMU_MODE_MAHONY          // 原始數據 + Mahony 四元數濾波 (比例增益由 filterAlpha 換算)
+};
+
+// MotionApps 2.0 的 DMP 封包大小 (位元組)
+#define IMU_DMP_PACKET_SIZE 42
+// 每次 getFIFOBytes() 突發讀取的封包數上限 (長度參數為 uint8_t：6 × 42 = 252 位元組)
+#define IMU_FIFO_BURST_PACKETS 6
+// 每次 update() 保留的最近取樣數
+#define IMU_BACKLOG_SIZE 8
+
+// 漸進式校準：每回合平均的取樣數 (每次 update() 一筆)，整個校準的逾時
+#define IMU_CAL_ROUND_SAMPLES 50
+#define IMU_CAL_TIMEOUT_MS 30000
+// 寫入偏移暫存器後略過的取樣數 (DLPF 與 FIFO 中仍是舊偏移的數據)
+#define IMU_SETTLE_SAMPLES 5
+
+// 靜止偵測：陀螺儀每軸偏離短期平均不超過 IMU_STILL_GYRO_DPS 並持續 IMU_STILL_TIME_MS
+#define IMU_STILL_GYRO_DPS 1.0f
+#define IMU_STILL_TIME_MS 500
+
+// 零偏追蹤：靜止時每 IMU_BIAS_WINDOW_MS 平均一次殘餘角速度，修正陀螺儀偏移暫存器；
+// 任一軸超過 IMU_BIAS_MAX_RATE_DPS 時視為緩慢轉動而不是零偏，每次修正最多 IMU_BIAS_MAX_STEP (1 LSB = 1/32.8 dps)
+#define IMU_BIAS_WINDOW_MS 1000
+#define IMU_BIAS_MAX_RATE_DPS 1.0f
+#define IMU_BIAS_MAX_STEP 8
+
+/**
+ * 漸進式校準狀態
+ */
+enum ImuCalState {
+    IMU_CAL_IDLE,
+    IMU_CAL_RUNNING,   // 等待靜止或累積取樣中
+    IMU_CAL_DONE,      // 偏移已寫入 (尚未儲存到設定)
+    IMU_CAL_FAILED     // 逾時 (一直沒有靜止)
+};
+
+/**
+ * 一筆姿態取樣 (單位與 getYaw()/getPitch()/getRoll()/getPitchRate() 相同)
+ */
+struct ImuSample {
+    uint32_t micros;     // 取樣時間 (us)
+    float yaw;           // 偏航角 (rad)
+    float pitch;         // 俯仰角 (rad)
+    float roll;          // 翻滾角 (rad)
+    float pitchRate;     // 俯仰角速度 (rad/s)
+};
+
+/**
+ * DMP FIFO 讀取統計
+ */
+struct ImuFifoStats {
+    uint32_t packets;        // 已讀出的封包總數
+    uint32_t overflows;      // FIFO 溢位 (封包邊界遺失) 而重置的次數
+    uint32_t emptyReads;     // 讀取時 FIFO 沒有完整封包的次數
+    uint16_t lastBacklog;    // 最近一次 update() 讀出的封包數
+    uint16_t maxBacklog;     // 單次 update() 讀出的最大封包數
+};
 
 class IMU {
 private:
@@ -20,22 +86,55 @@ private:
     uint8_t devStatus;
     uint16_t packetSize;
     uint16_t fifoCount;
-    uint8_t fifoBuffer[64];
+    uint8_t fifoBuffer[IMU_FIFO_BURST_PACKETS * IMU_DMP_PACKET_SIZE];
+    uint32_t dmpPeriodMicros;          // DMP 封包間隔，用來回推每個封包的取樣時間
+    
+    // 最近一次 update() 讀出的取樣 (舊到新) 與 FIFO 統計
+    ImuSample backlog[IMU_BACKLOG_SIZE];
+    uint8_t backlogCount;
+    ImuFifoStats fifoStats;
     
     // 方向/運動變數
     Quaternion q;
     VectorFloat gravity;
     float ypr[3];
+    VectorInt16 gyro;
+    VectorInt16 accel;   // 最近一筆原始加速度 (原始數據模式，或校準中的 DMP 模式)
+    float pitchRate;     // 俯仰角速度 (rad/s)
     
     // 校準偏移值
     int16_t ax_offset, ay_offset, az_offset;
     int16_t gx_offset, gy_offset, gz_offset;
     
-    // Preferences對象，用於存儲校準值
-    Preferences preferences;
+    // 漸進式校準：在 update() 中每筆取樣推進一步
+    volatile ImuCalState calState;
+    uint8_t calRounds;                 // 總回合數
+    volatile uint8_t calRound;         // 已完成的回合數
+    uint16_t calSamples;               // 本回合已累積的取樣數
+    unsigned long calStartMillis;
+    float calAccelSum[3];              // g
+    float calGyroSum[3];               // dps
+    
+    // 靜止偵測 (以陀螺儀偏離短期平均判斷，與零偏大小無關)
+    float motionMean[3];               // 陀螺儀短期平均 (dps)
+    bool motionSeeded;
+    uint8_t motionSettle;              // 寫入偏移後略過的取樣數
+    uint32_t lastMotionMicros;
+    uint32_t stillSinceMicros;         // 0 表示目前在移動
+    bool stationary;
     
-    // 偏好設置的命名空間
-    const char* prefsNamespace = "imu_cal";
+    // 零偏追蹤
+    bool biasTracking;
+    uint32_t biasWindowStart;
+    float biasSum[3];                  // dps
+    uint16_t biasCount;
+    uint32_t biasUpdates;
+    
+    // 校準值的儲存位置 (nullptr 時不載入也不儲存)
+    ConfigStore* config;
+    
+    // 偏移值來自設定或已儲存到設定
+    bool calibrated;
     
     // 上次更新時間
     unsigned long lastUpdate;
@@ -43,17 +142,58 @@ private:
     // 更新間隔 (ms)
     unsigned long updateInterval;
     
-    // 濾波器係數 (0-1)，越大表示原始數據權重越大
+    // 互補濾波的陀螺儀權重 (0-1)，以 100 Hz 取樣定義；越大越相信陀螺儀積分、加速度計修正越慢
     float filterAlpha;
     
+    // 姿態來源與原始數據模式的設定
+    ImuMode mode;
+    uint16_t rawRateHz;                // 原始數據取樣率
+    float gyroRadPerLsb;               // 原始陀螺儀刻度
+    float accelGPerLsb;                // 原始加速度計刻度
+    bool filterSeeded;                 // 濾波器已由加速度計初始化
+    float mahonyKi;                    // Mahony 積分增益 (1/s)
+    float mahonyIntegral[3];           // Mahony 積分項 (rad/s)
+    
     // 是否已初始化
     bool initialized;
     
+    // 保護 DMP FIFO 讀取，避免控制任務與顯示任務同時呼叫 update()
+    SemaphoreHandle_t updateMutex;
+    
+    // 中斷模式：INT 腳位的 ISR 記錄時間戳並喚醒等待數據的任務
+    uint8_t intPin;
+    bool interruptMode;
+    volatile uint32_t isrMicros;       // 最近一次 INT 上升緣時間 (us)
+    volatile uint32_t isrCount;        // INT 觸發次數
+    uint32_t handledIsrCount;          // update() 已處理到的觸發次數
+    SemaphoreHandle_t dataReady;
+    portMUX_TYPE isrMux = portMUX_INITIALIZER_UNLOCKED;
+    
+    // 目前姿態數據的取樣時間 (us)
+    uint32_t sampleMicros;
+    
+    // 共用 I2C 匯流排 (nullptr 時直接使用 Wire)
+    I2CBus* bus;
+    int busDevice;
+    
+    static void IRAM_ATTR dataReadyISR(void* arg);
+    
+    bool configureRaw();
+    bool updateRaw(uint32_t timestamp);
+    bool drainFifo(uint32_t timestamp);
+    void decodePacket(const uint8_t* packet);
+    void storeSample(uint8_t index, uint32_t timestamp);
+    float filterTimeConstant();
+    void applyOffsets();
+    void trackMotion(uint32_t timestamp);
+    void calibrationStep(const float accelG[3], const float gyroDps[3]);
+    void biasStep(uint32_t timestamp, const float gyroDps[3]);
+    
 public:
     /**
      * 建構函數
      * @param updateIntervalMs 更新間隔，單位毫秒
-     * @param alpha 濾波器係數 (0-1)，越大表示原始數據權重越大
+     * @param alpha 互補濾波的陀螺儀權重 (0-1)，以 100 Hz 取樣定義 (僅原始數據模式使用)
      */
     IMU(unsigned long updateIntervalMs = 10, float alpha = 0.98);
     
@@ -62,6 +202,14 @@ public:
      */
     ~IMU();
     
+    /**
+     * 交給 I2C 匯流排管理 (begin() 之前呼叫)
+     * 之後 begin() 由匯流排初始化 Wire 並以高優先權登記 MPU6050，每次存取都在匯流排交易內進行；
+     * 取得匯流排逾時的 update() 返回false
+     * @param i2cBus 匯流排 (使用 Wire)，nullptr 表示直接使用 Wire
+     */
+    void setBus(I2CBus* i2cBus);
+    
     /**
      * 初始化IMU
      * @param sda I2C SDA腳位
@@ -72,22 +220,65 @@ public:
     bool begin(int sda, int scl, uint8_t address = 0x68);
     
     /**
-     * 校準MPU6050
-     * @param samples 校準樣本數量，越多越精確但耗時越長
-     * @param progressCallback 進度回調函數，用於更新校準進度
-     * @return 校準成功返回true
+     * 開始漸進式校準，不會等待
+     * 之後每次 update() 讀到新數據時推進一步：靜止 IMU_STILL_TIME_MS 後開始累積取樣，
+     * 每 IMU_CAL_ROUND_SAMPLES 筆修正一次偏移暫存器 (加速度以 X/Y = 0、Z = +1 g 為目標，陀螺儀為 0)；
+     * 回合中途移動則該回合重新累積。完成後狀態為 IMU_CAL_DONE，需由呼叫端 saveCalibration()
+     * @param rounds 校準回合數
+     * @return 開始返回true (未初始化或已在校準中返回false)
+     */
+    bool startCalibration(uint8_t rounds = 6);
+    
+    /**
+     * 中止校準，保留已寫入的偏移
+     */
+    void cancelCalibration();
+    
+    /**
+     * 獲取漸進式校準狀態
+     */
+    ImuCalState getCalibrationState();
+    
+    /**
+     * 獲取校準進度
+     * @return 0-100
+     */
+    int getCalibrationProgress();
+    
+    /**
+     * 啟用或停用線上零偏追蹤 (預設啟用)
+     * 靜止時持續以殘餘角速度微調陀螺儀偏移暫存器，DMP 與原始數據模式都適用；修正結果不會自動儲存
+     * @param enable true 啟用
+     */
+    void setBiasTracking(bool enable);
+    
+    /**
+     * 目前是否判定為靜止
+     */
+    bool isStationary();
+    
+    /**
+     * 零偏追蹤已修正偏移暫存器的次數
      */
-    bool calibrate(uint8_t samples = 6, std::function<void(const char*, int)> progressCallback = nullptr);
+    uint32_t getBiasUpdates();
     
     /**
-     * 從Preferences載入儲存的校準值
+     * 設定校準值的儲存位置，begin() 之前呼叫
+     * loadCalibration()/saveCalibration() 只存取設定的 RAM 內容，寫入快閃記憶體由 ConfigStore 延後進行；
+     * 兩者都應在設定的擁有任務 (主迴圈) 呼叫
+     * @param store 設定儲存 (nullptr 表示不保存校準值)
+     */
+    void setConfigStore(ConfigStore* store);
+    
+    /**
+     * 從設定載入校準值 (不寫入偏移暫存器)
      * @return 存在有效校準數據時返回true
      */
     bool loadCalibration();
     
     /**
-     * 將校準值儲存到Preferences
-     * @return 儲存成功返回true
+     * 將校準值寫入設定並標記為待寫回
+     * @return 已設定儲存位置時返回true
      */
     bool saveCalibration();
     
@@ -99,19 +290,107 @@ public:
     void getCalibrationValues(int16_t accelOffset[3], int16_t gyroOffset[3]);
     
     /**
-     * 設置校準值
+     * 設置校準值，寫入偏移暫存器並儲存到設定 (未初始化時不動作)
+     * 與 update() 互斥，可在控制任務執行中呼叫
      * @param accelOffset 加速度計偏移值數組 [ax, ay, az]
      * @param gyroOffset 陀螺儀偏移值數組 [gx, gy, gz]
      */
     void setCalibrationValues(const int16_t accelOffset[3], const int16_t gyroOffset[3]);
     
+    /**
+     * 切換姿態來源，可在執行中呼叫 (會等待進行中的 update() 完成)
+     * 原始數據模式將陀螺儀設為 ±500 dps、加速度計 ±4 g、DLPF 188 Hz，每次 update() 以一次 14 位元組
+     * 突發讀取最新的加速度與角速度並推進濾波器；中斷模式下 INT 改為每個取樣觸發一次
+     * @param newMode 姿態來源
+     * @param sampleRateHz 原始數據取樣率 (4 ~ 1000 Hz)，DMP 模式忽略
+     * @return 切換成功返回true
+     */
+    bool setMode(ImuMode newMode, uint16_t sampleRateHz = 1000);
+    
+    /**
+     * 獲取目前的姿態來源
+     */
+    ImuMode getMode();
+    
+    /**
+     * 設定 Mahony 濾波的積分增益 (預設 0：零偏由校準處理)
+     * @param ki 積分增益 (1/s)
+     */
+    void setMahonyIntegralGain(float ki);
+    
+    /**
+     * 獲取 Mahony 濾波的積分增益 (1/s)
+     */
+    float getMahonyIntegralGain();
+    
+    /**
+     * 啟用數據就緒中斷模式
+     * DMP 每產生一個封包 MPU6050 就會拉起 INT，ISR 以 micros() 記錄時間並喚醒 waitForData()；
+     * 此模式下 update() 不再依更新間隔輪詢，只在有新中斷時才讀取 FIFO；原始數據模式下為每個取樣一次中斷
+     * @param pin 連接 MPU6050 INT 的腳位
+     * @return 啟用成功返回true
+     */
+    bool enableInterrupt(uint8_t pin);
+    
+    /**
+     * 停用數據就緒中斷，回到輪詢模式
+     */
+    void disableInterrupt();
+    
+    /**
+     * 檢查是否處於中斷模式
+     * @return 中斷模式返回true
+     */
+    bool isInterruptMode();
+    
+    /**
+     * 等待下一筆數據就緒（僅中斷模式）
+     * @param timeout 最長等待時間（tick）
+     * @return 有新數據返回true，逾時或非中斷模式返回false
+     */
+    bool waitForData(TickType_t timeout = portMAX_DELAY);
+    
     /**
      * 更新IMU數據
-     * 應在主循環中定期調用
+     * 應在主循環中定期調用；可由多個任務呼叫，另一任務正在更新時直接返回false
+     * DMP 模式讀一次 FIFO 計數後以突發讀取取出所有完整封包，姿態取最新的封包，
+     * 較舊的封包依 DMP 輸出週期回推時間後留在 getBacklog()；計數不是封包大小的整數倍時
+     * 表示 FIFO 已溢位，重置 FIFO 並計入 getFifoStats()
      * @return 如果有新數據更新則返回true
      */
     bool update();
     
+    /**
+     * 獲取目前姿態數據的取樣時間
+     * 中斷模式為 INT 觸發時的 micros()，輪詢模式為開始讀取 FIFO (或原始數據) 時的 micros()
+     * @return 取樣時間（微秒）
+     */
+    uint32_t getSampleMicros();
+    
+    /**
+     * 獲取最近一次返回 true 的 update() 讀出的取樣 (舊到新，最後一筆即目前的姿態)
+     * 應在呼叫 update() 的同一個任務中讀取；原始數據模式每次只有一筆
+     * @param samples 輸出陣列
+     * @param maxSamples 陣列大小
+     * @return 複製的筆數 (最多 IMU_BACKLOG_SIZE)
+     */
+    uint8_t getBacklog(ImuSample* samples, uint8_t maxSamples);
+    
+    /**
+     * 獲取最新的一筆取樣 (尚未有數據時全為 0)
+     */
+    ImuSample getLatestSample();
+    
+    /**
+     * 獲取 DMP FIFO 讀取統計
+     */
+    ImuFifoStats getFifoStats();
+    
+    /**
+     * 清除 DMP FIFO 讀取統計
+     */
+    void resetFifoStats();
+    
     /**
      * 獲取YPR數據
      * @param yawPitchRoll 用於儲存結果的數組，按順序為偏航、俯仰、翻滾角度（弧度）
@@ -137,6 +416,13 @@ public:
      */
     float getRoll();
     
+    /**
+     * 獲取俯仰角速度
+     * 取自與姿態同一個DMP數據包 (或同一次原始數據讀取) 的陀螺儀數據，符號與getPitch()的變化方向一致
+     * @return 俯仰角速度（弧度/秒）
+     */
+    float getPitchRate();
+    
     /**
      * 獲取原始加速度計數據
      * @param ax X軸加速度
@@ -160,11 +446,17 @@ public:
     float getTemperature();
     
     /**
-     * 設置濾波器係數
-     * @param alpha 濾波器係數 (0-1)，越大表示原始數據權重越大
+     * 設置濾波器係數 (原始數據模式)
+     * 以 100 Hz 取樣定義，其他取樣率換算為相同的時間常數 τ = 0.01s·α/(1-α)；Mahony 的比例增益為 1/τ
+     * @param alpha 陀螺儀權重 (0-1)，越大越相信陀螺儀積分
      */
     void setFilterAlpha(float alpha);
     
+    /**
+     * 獲取濾波器係數
+     */
+    float getFilterAlpha();
+    
     /**
      * 設置更新間隔
      * @param intervalMs 更新間隔，單位毫秒
@@ -178,7 +470,7 @@ public:
     bool isInitialized();
     
     /**
-     * 獲取MPU6050對象引用
+     * 獲取MPU6050對象引用 (直接存取不經過 I2C 匯流排管理)
      * @return MPU6050對象引用
      */
     MPU6050& getMPU();
@@ -191,8 +483,8 @@ public:
     bool resetDMP();
     
     /**
-     * 獲取校準狀態
-     * @return 已校準返回true
+     * 獲取校準狀態 (不讀取 NVS)
+     * @return 校準值已載入或已儲存返回true
      */
     bool isCalibrated();
 };
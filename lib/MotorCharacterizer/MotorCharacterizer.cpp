@@ -0,0 +1,212 @@
+/**
+ * MotorCharacterizer.cpp
+ * 馬達特性掃描實現
+ */
+
+#include "MotorCharacterizer.h"
+#include <string.h>
+
+// 建構函數
+MotorCharacterizer::MotorCharacterizer(Motor* motor, Encoder* encoder)
+    : motor(motor),
+      encoder(encoder),
+      steps(32),
+      settleMs(250),
+      measureMs(150),
+      breakawayRpm(2.0f),
+      state(CHARACTERIZER_IDLE),
+      direction(0),
+      step(0),
+      stepStart(0),
+      velocitySum(0.0f),
+      velocityCount(0),
+      failReason(""),
+      fullScaleRpm(0.0f)
+{
+    memset(rpm, 0, sizeof(rpm));
+    memset(&table, 0, sizeof(table));
+}
+
+// 設定掃描參數
+void MotorCharacterizer::setSweep(int newSteps, uint32_t newSettleMs, uint32_t newMeasureMs) {
+    if (state == CHARACTERIZER_RUNNING) {
+        return;
+    }
+    steps = constrain(newSteps, 4, CHARACTERIZER_MAX_STEPS);
+    settleMs = newSettleMs;
+    measureMs = newMeasureMs > 0 ? newMeasureMs : 1;
+}
+
+// 開始掃描
+void MotorCharacterizer::start() {
+    memset(rpm, 0, sizeof(rpm));
+    fullScaleRpm = 0.0f;
+    failReason = "";
+    direction = 0;
+    step = 0;
+    state = CHARACTERIZER_RUNNING;
+
+    // 量測的是未補償的特性
+    motor->setCompensationEnabled(false);
+    applyStep();
+}
+
+// 中止掃描
+void MotorCharacterizer::abort() {
+    if (state != CHARACTERIZER_RUNNING) {
+        return;
+    }
+    motor->setDuty(0.0f);
+    motor->setCompensationEnabled(true);
+    failReason = "aborted";
+    state = CHARACTERIZER_FAILED;
+}
+
+// 設定本步的佔空比並重新開始計時
+void MotorCharacterizer::applyStep() {
+    float duty = (float)step / steps;
+    motor->setDuty(direction == 0 ? duty : -duty);
+    stepStart = millis();
+    velocitySum = 0.0f;
+    velocityCount = 0;
+}
+
+// 推進掃描
+bool MotorCharacterizer::update() {
+    if (state != CHARACTERIZER_RUNNING) {
+        return false;
+    }
+
+    uint32_t elapsed = millis() - stepStart;
+    if (elapsed >= settleMs) {
+        float velocity = encoder->getVelocity();
+        velocitySum += direction == 0 ? velocity : -velocity;
+        velocityCount++;
+    }
+    if (elapsed < settleMs + measureMs) {
+        return true;
+    }
+
+    rpm[direction][step] = velocityCount > 0 ? velocitySum / velocityCount : 0.0f;
+    step++;
+    if (step > steps) {
+        // 換方向時從佔空比 0 開始，讓輪子先停下
+        direction++;
+        step = 0;
+        if (direction > 1) {
+            motor->setDuty(0.0f);
+            bool ok = buildTable();
+            motor->setCompensationEnabled(true);
+            state = ok ? CHARACTERIZER_DONE : CHARACTERIZER_FAILED;
+            return false;
+        }
+    }
+    applyStep();
+    return true;
+}
+
+// 由量測曲線建立兩個方向的補償表
+bool MotorCharacterizer::buildTable() {
+    // 滿佔空比時往命令方向轉不動：可能是 STBY、電源或編碼器方向問題
+    for (int d = 0; d < 2; d++) {
+        if (rpm[d][steps] < -breakawayRpm) {
+            failReason = "encoder direction opposite to motor";
+            return false;
+        }
+        if (rpm[d][steps] < breakawayRpm * 4) {
+            failReason = "motor did not turn";
+            return false;
+        }
+    }
+
+    // 兩個方向共用較小的滿刻度，補償後正反轉的增益相同
+    fullScaleRpm = min(rpm[0][steps], rpm[1][steps]);
+
+    table.version = MOTOR_COMP_VERSION;
+    return buildDirection(0, table.forward) && buildDirection(1, table.reverse);
+}
+
+// 單一方向：單調化量測曲線後反求每個命令點所需的佔空比
+bool MotorCharacterizer::buildDirection(int dir, uint16_t* out) {
+    float curve[CHARACTERIZER_MAX_STEPS + 1];
+    curve[0] = max(rpm[dir][0], 0.0f);
+    for (int k = 1; k <= steps; k++) {
+        curve[k] = max(rpm[dir][k], curve[k - 1]);
+    }
+
+    // 達到目標轉速所需的佔空比 (步與步之間線性內插)
+    auto dutyFor = [&](float target) -> float {
+        for (int k = 1; k <= steps; k++) {
+            if (curve[k] >= target) {
+                float span = curve[k] - curve[k - 1];
+                float fraction = span > 0 ? (target - curve[k - 1]) / span : 1.0f;
+                return (k - 1 + fraction) / steps;
+            }
+        }
+        return 1.0f;
+    };
+
+    // 第 0 點：起轉佔空比
+    out[0] = (uint16_t)lroundf(dutyFor(breakawayRpm) * 65535.0f);
+    for (int i = 1; i < MOTOR_COMP_POINTS; i++) {
+        float target = fullScaleRpm * i / (MOTOR_COMP_POINTS - 1);
+        uint16_t value = (uint16_t)lroundf(dutyFor(max(target, breakawayRpm)) * 65535.0f);
+        out[i] = max(value, out[i - 1]);
+    }
+    return true;
+}
+
+// 獲取狀態
+CharacterizerState MotorCharacterizer::getState() const {
+    return state;
+}
+
+// 掃描進度
+int MotorCharacterizer::getProgress() const {
+    if (state == CHARACTERIZER_DONE) {
+        return 100;
+    }
+    if (state != CHARACTERIZER_RUNNING) {
+        return 0;
+    }
+    int total = 2 * (steps + 1);
+    return (direction * (steps + 1) + step) * 100 / total;
+}
+
+// 失敗原因
+const char* MotorCharacterizer::getFailReason() const {
+    return failReason;
+}
+
+// 掃描結果
+const MotorCompensation& MotorCharacterizer::getTable() const {
+    return table;
+}
+
+// 滿刻度轉速
+float MotorCharacterizer::getFullScaleRpm() const {
+    return fullScaleRpm;
+}
+
+// 起轉佔空比
+float MotorCharacterizer::getBreakawayDuty(bool reverse) const {
+    return (reverse ? table.reverse[0] : table.forward[0]) / 65535.0f;
+}
+
+// 輸出量測曲線與補償表
+void MotorCharacterizer::printReport(Print& out) const {
+    out.printf("# motor characterization: %s, full scale %.1f rpm, breakaway duty fwd %.3f rev %.3f\n",
+               state == CHARACTERIZER_DONE ? "done" : (state == CHARACTERIZER_FAILED ? failReason : "incomplete"),
+               fullScaleRpm, getBreakawayDuty(false), getBreakawayDuty(true));
+    out.printf("duty,fwd_rpm,rev_rpm\n");
+    for (int k = 0; k <= steps; k++) {
+        out.printf("%.3f,%.1f,%.1f\n", (float)k / steps, rpm[0][k], rpm[1][k]);
+    }
+    if (state == CHARACTERIZER_DONE) {
+        out.printf("command,fwd_duty,rev_duty\n");
+        for (int i = 0; i < MOTOR_COMP_POINTS; i++) {
+            out.printf("%.3f,%.4f,%.4f\n", (float)i / (MOTOR_COMP_POINTS - 1),
+                       table.forward[i] / 65535.0f, table.reverse[i] / 65535.0f);
+        }
+    }
+}
@@ -0,0 +1,128 @@
+/**
+ * MotorCharacterizer.h
+ * 馬達 PWM → 轉速特性掃描，產生死區/非線性補償表
+ *
+ * 功能概述:
+ * - 正反兩個方向各由 0 逐步增加佔空比，每一步先等待轉速穩定再取平均轉速 (補償在掃描期間停用)
+ * - 以兩個方向中較小的滿佔空比轉速為滿刻度，反求「線性命令 → 所需佔空比」的查表 (MotorCompensation)，
+ *   第 0 點為起轉佔空比 (死區邊緣)，之後每點對應等間隔的轉速
+ * - 非阻塞：start() 之後由控制迴圈週期性呼叫 update()，完成後 getState() 為 DONE 或 FAILED
+ * - 編碼器的 update() 由呼叫端負責，這裡只讀取速度
+ */
+
+#ifndef MOTOR_CHARACTERIZER_H
+#define MOTOR_CHARACTERIZER_H
+
+#include <Arduino.h>
+#include "motor.h"
+#include "encoder.h"
+
+// 每個方向的掃描步數上限
+#define CHARACTERIZER_MAX_STEPS 64
+
+// 掃描狀態
+enum CharacterizerState {
+    CHARACTERIZER_IDLE,
+    CHARACTERIZER_RUNNING,
+    CHARACTERIZER_DONE,
+    CHARACTERIZER_FAILED
+};
+
+class MotorCharacterizer {
+private:
+    Motor* motor;
+    Encoder* encoder;
+
+    // 掃描設定
+    int steps;                   // 每個方向的步數 (佔空比 1/steps ... 1)
+    uint32_t settleMs;           // 每步等待穩定的時間
+    uint32_t measureMs;          // 每步取平均的時間
+    float breakawayRpm;          // 視為開始轉動的轉速
+
+    // 掃描狀態
+    CharacterizerState state;
+    int direction;               // 0 = 正轉, 1 = 反轉
+    int step;
+    uint32_t stepStart;
+    float velocitySum;
+    uint32_t velocityCount;
+    const char* failReason;
+
+    // 每個方向每一步的平均轉速 (已乘上方向，正值表示往命令方向轉)，[d][0] 為佔空比 0
+    float rpm[2][CHARACTERIZER_MAX_STEPS + 1];
+    float fullScaleRpm;
+
+    MotorCompensation table;
+
+    void applyStep();
+    bool buildTable();
+    bool buildDirection(int dir, uint16_t* out);
+
+public:
+    /**
+     * 建構函數
+     * @param motor 被量測的馬達
+     * @param encoder 同一個輪子的編碼器 (方向需與馬達一致)
+     */
+    MotorCharacterizer(Motor* motor, Encoder* encoder);
+
+    /**
+     * 設定掃描參數 (start() 之前呼叫)
+     * @param steps 每個方向的步數 (4 ~ CHARACTERIZER_MAX_STEPS)
+     * @param settleMs 每步等待穩定的時間
+     * @param measureMs 每步取平均的時間
+     */
+    void setSweep(int steps, uint32_t settleMs, uint32_t measureMs);
+
+    /**
+     * 開始掃描；馬達必須已 setRunning(true)，期間其他任務不可寫入此馬達
+     */
+    void start();
+
+    /**
+     * 中止掃描並停止馬達
+     */
+    void abort();
+
+    /**
+     * 推進掃描，由控制迴圈週期性呼叫 (建議 100 Hz 以上)
+     * @return 仍在掃描返回 true
+     */
+    bool update();
+
+    CharacterizerState getState() const;
+
+    /**
+     * 掃描進度 (0-100)
+     */
+    int getProgress() const;
+
+    /**
+     * 失敗原因，沒有失敗時為空字串
+     */
+    const char* getFailReason() const;
+
+    /**
+     * 掃描結果 (DONE 時有效)
+     */
+    const MotorCompensation& getTable() const;
+
+    /**
+     * 補償後的滿刻度轉速 (兩個方向中較小者)
+     */
+    float getFullScaleRpm() const;
+
+    /**
+     * 起轉佔空比 (0~1)
+     * @param reverse true 表示反轉方向
+     */
+    float getBreakawayDuty(bool reverse) const;
+
+    /**
+     * 輸出量測曲線與補償表
+     * @param out 輸出目標 (例如 Serial)
+     */
+    void printReport(Print& out) const;
+};
+
+#endif // MOTOR_CHARACTERIZER_H
@@ -3,13 +3,24 @@
 
 #include <U8g2lib.h>
 
+// 顯示器掛在 ESP32-S3 的第二個 I2C 控制器 (Wire1) 上時設為 1，與 MPU6050 分開
+#ifndef OLED_USE_SECOND_I2C
+#define OLED_USE_SECOND_I2C 0
+#endif
+
+#if OLED_USE_SECOND_I2C
+typedef U8G2_SH1106_128X64_NONAME_F_2ND_HW_I2C OLEDDisplay;
+#else
+typedef U8G2_SH1106_128X64_NONAME_F_HW_I2C OLEDDisplay;
+#endif
+
 class DisplayPage {
 public:
     /**
      * 繪製頁面
      * @param u8g2 U8G2 對象引用
      */
-    virtual void draw(U8G2_SH1106_128X64_NONAME_F_HW_I2C& u8g2) = 0;
+    virtual void draw(OLEDDisplay& u8g2) = 0;
     
     /**
      * 獲取頁面名稱
@@ -4,6 +4,14 @@
  */
 
 #include "OLED_Manager.h"
+#include <string.h>
+
+// 估計一個 page 內傳送 tileCount 個 tile 所需的 I2C 位元組數
+static uint32_t estimateTransferBytes(uint8_t tileCount) {
+    uint32_t dataBytes = (uint32_t)tileCount * 8;
+    uint32_t chunks = (dataBytes + OLED_I2C_CHUNK_DATA - 1) / OLED_I2C_CHUNK_DATA;
+    return OLED_I2C_ADDRESS_BYTES + dataBytes + chunks;
+}
 
 // 建構函數
 OLED_Manager::OLED_Manager()
@@ -11,8 +19,31 @@ OLED_Manager::OLED_Manager()
       currentPageIndex(0),
       pageCount(0),
       lastUpdateTime(0),
-      updateInterval(50)
+      updateInterval(50),
+      sentFrameValid(false),
+      partialUpdate(true),
+      lastFrameBytes(0),
+      lastFrameTiles(0),
+      totalBytesSent(0),
+      framesSent(0),
+      framesSkipped(0),
+      framesDropped(0),
+      backIndex(0),
+      framePending(false),
+      displayTask(nullptr),
+      notifyHead(0),
+      notifyCount(0),
+      notificationVisible(false),
+      holdUntil(0),
+      bus(nullptr),
+      busDevice(-1),
+      busMaxClock(OLED_I2C_MAX_CLOCK),
+      transmitFailed(false)
 {
+    portMUX_TYPE unlocked = portMUX_INITIALIZER_UNLOCKED;
+    frameMux = unlocked;
+    notifyMux = unlocked;
+
     // 初始化頁面數組
     for (int i = 0; i < MAX_PAGES; i++) {
         pages[i] = nullptr;
@@ -24,22 +55,46 @@ OLED_Manager::~OLED_Manager() {
     // 注意：不刪除頁面對象，因為它們可能是在外部創建的
 }
 
+// 交給 I2C 匯流排管理
+void OLED_Manager::setBus(I2CBus* i2cBus, uint32_t maxClockHz) {
+    bus = i2cBus;
+    busDevice = -1;
+    busMaxClock = maxClockHz;
+}
+
 // 初始化 OLED 顯示器
 bool OLED_Manager::begin(int sda, int scl, bool showSplash) {
-    // 初始化 I2C
-    Wire.begin(sda, scl);
-    
-    // 初始化 U8G2
-    u8g2.begin();
+    if (bus != nullptr) {
+        if (!bus->begin(sda, scl)) {
+            return false;
+        }
+        if (busDevice < 0) {
+            busDevice = bus->addDevice("sh1106", OLED_I2C_ADDRESS, I2C_PRIORITY_LOW, busMaxClock);
+        }
+        // U8g2 每次傳輸開始時都會把控制器時脈設為 bus clock，需與匯流排一致
+        u8g2.setBusClock(bus->getClock());
+        
+        // 初始化指令序列 (u8g2.begin() 也會初始化 Wire，已初始化時沿用原本的腳位)
+        I2CTransaction transaction(bus, busDevice, portMAX_DELAY);
+        u8g2.begin();
+    } else {
+        // 初始化 I2C
+        Wire.begin(sda, scl);
+        
+        // 初始化 U8G2
+        u8g2.begin();
+    }
     
-    // 清空顯示
+    // 清空顯示 (整幀送出，建立影子副本)
     u8g2.clearBuffer();
-    u8g2.sendBuffer();
+    invalidate();
+    submitFrame();
     
     // 顯示啟動畫面
     if (showSplash) {
+        // 保留 1 秒，期間的通知排隊等候，不阻塞呼叫端
         drawSplashScreen("Balance Bot", "OLED Manager");
-        delay(1000);
+        holdUntil = millis() + 1000;
     }
     
     return true;
@@ -54,8 +109,68 @@ bool OLED_Manager::addPage(DisplayPage* page) {
     pages[pageCount] = page;
     pageCount++;
     return true;
+}
+
+// 啟動顯示傳輸任務
+bool OLED_Manager::startTask(UBaseType_t priority, BaseType_t core) {
+    if (displayTask) {
+        return true;
     }
-    
+
+    if (xTaskCreatePinnedToCore(displayTaskEntry, "Display", OLED_TASK_STACK_SIZE, this, priority,
+                                &displayTask, core) != pdPASS) {
+        displayTask = nullptr;
+        return false;
+    }
+    return true;
+}
+
+// 傳輸任務是否已啟動
+bool OLED_Manager::isAsync() const {
+    return displayTask != nullptr;
+}
+
+// 傳輸任務：等待新幀，交換前後緩衝區後傳送
+void OLED_Manager::displayTaskEntry(void* arg) {
+    OLED_Manager* self = static_cast<OLED_Manager*>(arg);
+
+    for (;;) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+        portENTER_CRITICAL(&self->frameMux);
+        bool pending = self->framePending;
+        uint8_t frontIndex = self->backIndex;
+        if (pending) {
+            self->backIndex ^= 1;
+            self->framePending = false;
+        }
+        portEXIT_CRITICAL(&self->frameMux);
+
+        if (pending) {
+            self->transmitFrame(self->frames[frontIndex]);
+        }
+    }
+}
+
+// 交出繪製完成的幀
+void OLED_Manager::submitFrame() {
+    if (!displayTask) {
+        transmitFrame(u8g2.getBufferPtr());
+        return;
+    }
+
+    // 只在複製 1 KB 期間持有鎖，任務交換索引時最多等待這段時間
+    portENTER_CRITICAL(&frameMux);
+    if (framePending) {
+        framesDropped++;
+    }
+    memcpy(frames[backIndex], u8g2.getBufferPtr(), OLED_FRAME_SIZE);
+    framePending = true;
+    portEXIT_CRITICAL(&frameMux);
+
+    xTaskNotifyGive(displayTask);
+}
+
 // 設置當前頁面
 void OLED_Manager::setPage(int index) {
     if (index >= 0 && index < pageCount) {
@@ -87,44 +202,119 @@ void OLED_Manager::prevPage() {
     currentPageIndex = (currentPageIndex + pageCount - 1) % pageCount;
 }
 
+// 加入通知
+void OLED_Manager::notify(const char* line1, const char* line2, unsigned long duration_ms) {
+    enqueueNotification(line1, line2, -1, duration_ms);
+}
+
 // 顯示訊息
-void OLED_Manager::displayMessage(const char* line1, const char* line2, unsigned long delay_ms) {
-            u8g2.clearBuffer();
-            
-    u8g2.setFont(u8g2_font_ncenB10_tr);
-    if (line1) {
-        u8g2.drawStr((128 - u8g2.getStrWidth(line1)) / 2, 24, line1);
+void OLED_Manager::displayMessage(const char* line1, const char* line2, unsigned long duration_ms) {
+    enqueueNotification(line1, line2, -1, duration_ms);
+    renderFrame();
+}
+
+// 顯示進度條
+void OLED_Manager::displayProgress(const char* message, int progress) {
+    if (progress < 0) progress = 0;
+    if (progress > 100) progress = 100;
+    enqueueNotification(message, nullptr, progress, 0);
+    renderFrame();
+}
+
+// 清除所有通知
+void OLED_Manager::clearNotifications() {
+    portENTER_CRITICAL(&notifyMux);
+    notifyCount = 0;
+    portEXIT_CRITICAL(&notifyMux);
+}
+
+// 加入通知
+void OLED_Manager::enqueueNotification(const char* line1, const char* line2, int progress,
+                                       unsigned long duration) {
+    portENTER_CRITICAL(&notifyMux);
+
+    OLEDNotification* note = nullptr;
+    if (notifyCount > 0 && progress >= 0) {
+        // 連續的進度更新沿用同一則通知，不重新排隊
+        OLEDNotification& last = notifications[(notifyHead + notifyCount - 1) % OLED_NOTIFY_QUEUE_SIZE];
+        if (last.progress >= 0) {
+            note = &last;
+        }
     }
-    
-    if (line2) {
-        u8g2.drawStr((128 - u8g2.getStrWidth(line2)) / 2, 44, line2);
+
+    if (!note) {
+        if (notifyCount == OLED_NOTIFY_QUEUE_SIZE) {
+            notifyHead = (notifyHead + 1) % OLED_NOTIFY_QUEUE_SIZE;
+            notifyCount--;
+        }
+        note = &notifications[(notifyHead + notifyCount) % OLED_NOTIFY_QUEUE_SIZE];
+        notifyCount++;
+        note->shown = false;
+        note->shownAt = 0;
     }
-    
-    u8g2.sendBuffer();
-    
-    if (delay_ms > 0) {
-        delay(delay_ms);
+
+    strncpy(note->line1, line1 ? line1 : "", OLED_NOTIFY_TEXT_LEN - 1);
+    note->line1[OLED_NOTIFY_TEXT_LEN - 1] = '\0';
+    strncpy(note->line2, line2 ? line2 : "", OLED_NOTIFY_TEXT_LEN - 1);
+    note->line2[OLED_NOTIFY_TEXT_LEN - 1] = '\0';
+    note->progress = progress;
+    note->duration = duration;
+
+    portEXIT_CRITICAL(&notifyMux);
 }
+
+// 移除已過期的通知，取得目前要顯示的一則
+bool OLED_Manager::activeNotification(OLEDNotification& out, unsigned long now) {
+    bool found = false;
+    portENTER_CRITICAL(&notifyMux);
+
+    while (notifyCount > 0) {
+        OLEDNotification& head = notifications[notifyHead];
+        bool expired = head.duration == 0 ? notifyCount > 1
+                                          : head.shown && now - head.shownAt >= head.duration;
+        if (!expired) {
+            if (!head.shown) {
+                head.shown = true;
+                head.shownAt = now;
+            }
+            out = head;
+            found = true;
+            break;
+        }
+        notifyHead = (notifyHead + 1) % OLED_NOTIFY_QUEUE_SIZE;
+        notifyCount--;
+    }
+
+    portEXIT_CRITICAL(&notifyMux);
+    return found;
 }
 
-// 顯示進度條
-void OLED_Manager::displayProgress(const char* message, int progress) {
-    u8g2.clearBuffer();
-    
-    u8g2.setFont(u8g2_font_ncenB08_tr);
-    if (message) {
-        u8g2.drawStr((128 - u8g2.getStrWidth(message)) / 2, 20, message);
+// 繪製通知框
+void OLED_Manager::drawNotification(const OLEDNotification& note) {
+    // 清出通知區域並畫外框，頁面內容保留在框外
+    u8g2.setDrawColor(0);
+    u8g2.drawBox(4, 8, 120, 48);
+    u8g2.setDrawColor(1);
+    u8g2.drawFrame(4, 8, 120, 48);
+
+    if (note.progress < 0) {
+        u8g2.setFont(u8g2_font_ncenB10_tr);
+        u8g2.drawStr((128 - u8g2.getStrWidth(note.line1)) / 2, 28, note.line1);
+
+        u8g2.setFont(u8g2_font_ncenB08_tr);
+        u8g2.drawStr((128 - u8g2.getStrWidth(note.line2)) / 2, 46, note.line2);
+    } else {
+        u8g2.setFont(u8g2_font_ncenB08_tr);
+        u8g2.drawStr((128 - u8g2.getStrWidth(note.line1)) / 2, 22, note.line1);
+
+        // 繪製進度條
+        drawProgressBar(14, 28, 100, 10, note.progress);
+
+        // 顯示百分比
+        char percentText[5];
+        snprintf(percentText, sizeof(percentText), "%d%%", note.progress);
+        u8g2.drawStr((128 - u8g2.getStrWidth(percentText)) / 2, 51, percentText);
     }
-    
-    // 繪製進度條
-    drawProgressBar(14, 30, 100, 10, progress);
-    
-    // 顯示百分比
-    char percentText[5];
-    sprintf(percentText, "%d%%", progress);
-    u8g2.drawStr((128 - u8g2.getStrWidth(percentText)) / 2, 55, percentText);
-    
-    u8g2.sendBuffer();
 }
 
 // 更新顯示
@@ -137,27 +327,172 @@ void OLED_Manager::update() {
     }
     
     lastUpdateTime = currentMillis;
-    
-    // 確保有頁面可顯示
-    if (pageCount > 0 && currentPageIndex >= 0 && currentPageIndex < pageCount) {
-        // 更新當前頁面數據
+    renderFrame();
+}
+
+// 繪製目前頁面與通知並交出幀
+void OLED_Manager::renderFrame() {
+    unsigned long currentMillis = millis();
+
+    // 啟動畫面顯示中
+    if ((long)(currentMillis - holdUntil) < 0) {
+        return;
+    }
+
+    OLEDNotification note;
+    bool hasNote = activeNotification(note, currentMillis);
+    bool hasPage = pageCount > 0 && currentPageIndex >= 0 && currentPageIndex < pageCount;
+
+    // 沒有頁面也沒有通知時保留原畫面；通知剛消失時清除一次
+    if (!hasPage && !hasNote && !notificationVisible) {
+        return;
+    }
+    notificationVisible = hasNote;
+
+    // 更新當前頁面數據
+    if (hasPage) {
         pages[currentPageIndex]->update();
-        
-        // 清除緩衝區
-        u8g2.clearBuffer();
-        
-        // 繪製當前頁面
+    }
+    
+    // 清除緩衝區
+    u8g2.clearBuffer();
+    
+    // 繪製當前頁面，通知疊加在最上層
+    if (hasPage) {
         pages[currentPageIndex]->draw(u8g2);
-        
-        // 發送緩衝區到顯示器
-        u8g2.sendBuffer();
     }
+    if (hasNote) {
+        drawNotification(note);
+    }
+    
+    // 交給傳輸端，只傳送有變化的 tile
+    submitFrame();
 }
+
 // 設置更新間隔
 void OLED_Manager::setUpdateInterval(unsigned long interval) {
     updateInterval = interval;
 }
 
+// 設置局部更新
+void OLED_Manager::setPartialUpdate(bool enable) {
+    partialUpdate = enable;
+}
+
+// 使影子副本失效
+void OLED_Manager::invalidate() {
+    sentFrameValid = false;
+}
+
+// 比對緩衝區與上次送出的幀，只傳送有變化的 tile
+void OLED_Manager::transmitFrame(uint8_t* frame) {
+    uint8_t tileWidth = u8g2.getBufferTileWidth();
+    uint8_t tileHeight = u8g2.getBufferTileHeight();
+    uint32_t bytes = 0;
+    uint16_t tiles = 0;
+
+    transmitFailed = false;
+    if (!partialUpdate || !sentFrameValid) {
+        for (uint8_t ty = 0; ty < tileHeight; ty++) {
+            bytes += transmitTiles(0, ty, tileWidth, frame + (size_t)ty * tileWidth * 8);
+        }
+        tiles = tileWidth * tileHeight;
+    } else {
+        for (uint8_t ty = 0; ty < tileHeight; ty++) {
+            // 每個 page 的 tile 在緩衝區中連續排列，每個 tile 8 位元組
+            uint8_t* row = frame + (size_t)ty * tileWidth * 8;
+            const uint8_t* sentRow = sentFrame + (size_t)ty * tileWidth * 8;
+            uint8_t tx = 0;
+
+            while (tx < tileWidth) {
+                if (memcmp(row + tx * 8, sentRow + tx * 8, 8) == 0) {
+                    tx++;
+                    continue;
+                }
+
+                // 相鄰的變化 tile 合併成一次傳輸，省下重複的定址指令
+                uint8_t start = tx;
+                while (tx < tileWidth && memcmp(row + tx * 8, sentRow + tx * 8, 8) != 0) {
+                    tx++;
+                }
+                bytes += transmitTiles(start, ty, tx - start, row + start * 8);
+                tiles += tx - start;
+            }
+        }
+    }
+
+    // 有一段沒有送出時顯示器內容已與影子副本不一致
+    memcpy(sentFrame, frame, OLED_FRAME_SIZE);
+    sentFrameValid = !transmitFailed;
+
+    lastFrameBytes = bytes;
+    lastFrameTiles = (uint8_t)tiles;
+    totalBytesSent += bytes;
+    if (bytes > 0) {
+        framesSent++;
+    } else {
+        framesSkipped++;
+    }
+}
+
+// 傳送一個 page 內連續的 tile (直接從幀資料傳送，不經過 U8g2 的繪圖緩衝區)
+uint32_t OLED_Manager::transmitTiles(uint8_t tx, uint8_t ty, uint8_t tw, uint8_t* tiles) {
+    if (bus == nullptr) {
+        u8x8_DrawTile(u8g2.getU8x8(), tx, ty, tw, tiles);
+        return estimateTransferBytes(tw);
+    }
+
+    // 分段取得匯流排，段與段之間讓等待中的 IMU 先讀取
+    uint32_t bytes = 0;
+    while (tw > 0) {
+        uint8_t count = min(tw, (uint8_t)OLED_I2C_BURST_TILES);
+        {
+            I2CTransaction transaction(bus, busDevice);
+            if (!transaction.isAcquired()) {
+                transmitFailed = true;
+                return bytes;
+            }
+            u8g2.setBusClock(bus->getClock());
+            u8x8_DrawTile(u8g2.getU8x8(), tx, ty, count, tiles);
+        }
+        bytes += estimateTransferBytes(count);
+        tx += count;
+        tw -= count;
+        tiles += count * 8;
+    }
+    return bytes;
+}
+
+// 獲取上一幀傳送的位元組數
+uint32_t OLED_Manager::getLastFrameBytes() const {
+    return lastFrameBytes;
+}
+
+// 獲取上一幀傳送的 tile 數
+uint8_t OLED_Manager::getLastFrameTiles() const {
+    return lastFrameTiles;
+}
+
+// 獲取累計傳送的位元組數
+uint32_t OLED_Manager::getTotalBytesSent() const {
+    return totalBytesSent;
+}
+
+// 獲取有傳送資料的幀數
+uint32_t OLED_Manager::getFramesSent() const {
+    return framesSent;
+}
+
+// 獲取略過傳送的幀數
+uint32_t OLED_Manager::getFramesSkipped() const {
+    return framesSkipped;
+}
+
+// 獲取被覆蓋的幀數
+uint32_t OLED_Manager::getFramesDropped() const {
+    return framesDropped;
+}
+
 // 繪製進度條
 void OLED_Manager::drawProgressBar(uint8_t x, uint8_t y, uint8_t width, uint8_t height, uint8_t progress) {
     // 邊框
@@ -193,10 +528,10 @@ void OLED_Manager::drawSplashScreen(const char* title, const char* subtitle) {
     // pages[currentPageIndex]->draw(u8g2);
     
     // 發送緩衝區到顯示器
-    u8g2.sendBuffer();
+    submitFrame();
 }
 
 // 獲取 U8G2 對象引用
-U8G2_SH1106_128X64_NONAME_F_HW_I2C& OLED_Manager::getU8G2() {
+OLEDDisplay& OLED_Manager::getU8G2() {
     return u8g2;
 }
\ No newline at end of file
@@ -7,6 +7,13 @@
  * - 支持多頁面系統，可以輕鬆添加和切換不同的顯示頁面
  * - 提供簡單的 API 用於顯示文本、圖形和自定義數據
  * - 可擴展設計，允許添加特定模組的顯示頁面
+ * - 局部更新：保留上次送出的幀，逐 tile (8x8 像素) 比對，只傳送有變化的 tile，
+ *   減少與 MPU6050 共用的 I2C 匯流排佔用
+ * - 非同步傳輸：startTask() 後繪製仍在呼叫端進行，完成的幀複製到後緩衝區交給低優先權任務傳送，
+ *   呼叫端不會等待 I2C 傳輸；傳送期間又完成的幀會覆蓋尚未送出的舊幀 (只送最新一幀)
+ * - 定時通知：訊息與進度條放入佇列，依序疊加在目前頁面上，時間到自動消失，呼叫端不需要延遲等待
+ * - 共用匯流排：setBus() 後以低優先權登記在 I2CBus，每段最多 OLED_I2C_BURST_TILES 個 tile
+ *   各自取得一次匯流排，MPU6050 的讀取最多等待一段的傳輸時間
  */
 
 #ifndef OLED_MANAGER_H
@@ -16,14 +23,48 @@
 #include <U8g2lib.h>
 #include <Wire.h>
 #include "DisplayPage.h"
+#include "I2CBus.h"
 
 // 最大頁面數量
 #define MAX_PAGES 8
 
+// 幀緩衝區大小 (128x64 單色，每個 tile 8 位元組)
+#define OLED_FRAME_SIZE (128 * 64 / 8)
+
+// 傳輸位元組估計：每段資料最多 31 位元組 + 1 個控制位元組，每個 page 另需 4 位元組定址
+#define OLED_I2C_CHUNK_DATA 31
+#define OLED_I2C_ADDRESS_BYTES 4
+
+// 共用匯流排時每次取得匯流排傳送的 tile 數 (400 kHz 下 4 個 tile 約 1 ms)
+#define OLED_I2C_BURST_TILES 4
+
+// SH1106 的 I2C 位址與允許的最高時脈
+#define OLED_I2C_ADDRESS 0x3C
+#define OLED_I2C_MAX_CLOCK 400000
+
+// 顯示傳輸任務的堆疊大小
+#define OLED_TASK_STACK_SIZE 3072
+
+// 通知佇列長度與每行文字長度 (含結尾 '\0')
+#define OLED_NOTIFY_QUEUE_SIZE 4
+#define OLED_NOTIFY_TEXT_LEN 24
+
+/**
+ * 定時通知：疊加在目前頁面上，時間到自動消失
+ */
+struct OLEDNotification {
+    char line1[OLED_NOTIFY_TEXT_LEN];
+    char line2[OLED_NOTIFY_TEXT_LEN];
+    int progress;             // 進度 (0-100)，-1 表示純文字
+    unsigned long duration;   // 顯示時間 (ms)，0 表示顯示到有較新的通知為止
+    unsigned long shownAt;    // 第一次繪出的時間，顯示時間從此開始計算
+    bool shown;
+};
+
 class OLED_Manager {
 private:
     // U8G2 顯示器對象
-    U8G2_SH1106_128X64_NONAME_F_HW_I2C u8g2;
+    OLEDDisplay u8g2;
     
     // 頁面數組
     DisplayPage* pages[MAX_PAGES];
@@ -40,6 +81,76 @@ private:
     // 更新間隔 (ms)
     unsigned long updateInterval;
 
+    // 上次傳送到顯示器的幀 (顯示器 RAM 的影子副本)
+    uint8_t sentFrame[OLED_FRAME_SIZE];
+
+    // 影子副本是否與顯示器一致；false 時下次送出整幀
+    bool sentFrameValid;
+
+    // 是否啟用局部更新
+    bool partialUpdate;
+
+    // 傳輸統計
+    uint32_t lastFrameBytes;
+    uint8_t lastFrameTiles;
+    uint32_t totalBytesSent;
+    uint32_t framesSent;
+    uint32_t framesSkipped;
+    uint32_t framesDropped;
+
+    // 雙緩衝：呼叫端寫入 frames[backIndex]，傳輸任務交換後傳送另一個
+    uint8_t frames[2][OLED_FRAME_SIZE];
+    uint8_t backIndex;
+    volatile bool framePending;
+    portMUX_TYPE frameMux;
+
+    // 傳輸任務，未啟動時在呼叫端同步傳送
+    TaskHandle_t displayTask;
+
+    // 通知佇列 (環形)，可由其他任務寫入
+    OLEDNotification notifications[OLED_NOTIFY_QUEUE_SIZE];
+    uint8_t notifyHead;
+    uint8_t notifyCount;
+    portMUX_TYPE notifyMux;
+
+    // 上一幀是否繪有通知 (沒有頁面時，通知消失後需要清除畫面)
+    bool notificationVisible;
+
+    // 啟動畫面保留到此時間 (ms)，期間不繪製新幀
+    unsigned long holdUntil;
+
+    // 共用 I2C 匯流排 (nullptr 時直接使用 Wire)
+    I2CBus* bus;
+    int busDevice;
+    uint32_t busMaxClock;
+
+    // 目前這一幀是否有一段因匯流排逾時而沒有送出
+    bool transmitFailed;
+
+    // 繪製目前頁面與通知並交出幀
+    void renderFrame();
+
+    // 加入通知；佇列滿時丟棄最舊的一則
+    void enqueueNotification(const char* line1, const char* line2, int progress, unsigned long duration);
+
+    // 移除已過期的通知，取得目前要顯示的一則
+    bool activeNotification(OLEDNotification& out, unsigned long now);
+
+    // 繪製通知框
+    void drawNotification(const OLEDNotification& note);
+
+    // 交出繪製完成的幀：同步模式立即傳送，非同步模式複製到後緩衝區並通知任務
+    void submitFrame();
+
+    // 比對幀與影子副本，只傳送有變化的 tile
+    void transmitFrame(uint8_t* frame);
+    
+    // 傳送一個 page 內連續的 tile，返回估計的 I2C 位元組數
+    uint32_t transmitTiles(uint8_t tx, uint8_t ty, uint8_t tw, uint8_t* tiles);
+
+    // 傳輸任務入口
+    static void displayTaskEntry(void* arg);
+
     // 繪製進度條
     void drawProgressBar(uint8_t x, uint8_t y, uint8_t width, uint8_t height, uint8_t progress);
     
@@ -57,6 +168,15 @@ public:
      */
     ~OLED_Manager();
     
+    /**
+     * 交給 I2C 匯流排管理 (begin() 之前呼叫)
+     * 之後 begin() 由匯流排初始化控制器並以低優先權登記顯示器，幀資料分段傳送；
+     * 某段取得匯流排逾時時，下一幀改為整幀送出
+     * @param i2cBus 匯流排，nullptr 表示直接使用 Wire
+     * @param maxClockHz 顯示器允許的最高時脈 (單獨掛在 Wire1 上時可以提高)
+     */
+    void setBus(I2CBus* i2cBus, uint32_t maxClockHz = OLED_I2C_MAX_CLOCK);
+    
     /**
      * 初始化 OLED 顯示器
      * @param sda I2C SDA 引腳
@@ -66,6 +186,20 @@ public:
      */
     bool begin(int sda, int scl, bool showSplash = true);
     
+    /**
+     * 啟動顯示傳輸任務，之後的 update()/displayMessage()/displayProgress() 不再等待 I2C 傳輸
+     * 應在 begin() 之後呼叫；重複呼叫無作用
+     * @param priority 任務優先權 (應低於控制任務)
+     * @param core 執行核心
+     * @return 任務建立成功返回 true
+     */
+    bool startTask(UBaseType_t priority = 1, BaseType_t core = 0);
+    
+    /**
+     * 傳輸任務是否已啟動
+     */
+    bool isAsync() const;
+    
     /**
      * 添加頁面
      * @param page 頁面指針
@@ -108,31 +242,89 @@ public:
     void update();
     
     /**
-     * 顯示訊息
+     * 加入通知 (只放入佇列，由下一次 update() 繪出)
+     * 可由任何任務呼叫；通知依序顯示，每則從第一次繪出起計時
      * @param line1 第一行文字
      * @param line2 第二行文字
-     * @param delay_ms 顯示時間 (ms)，0 表示不自動清除
+     * @param duration_ms 顯示時間 (ms)，0 表示顯示到有較新的通知為止
      */
-    void displayMessage(const char* line1, const char* line2 = nullptr, unsigned long delay_ms = 0);
+    void notify(const char* line1, const char* line2 = nullptr, unsigned long duration_ms = 1000);
     
     /**
-     * 顯示進度條
+     * 顯示訊息：加入通知並立即繪製，不會等待
+     * 只能由呼叫 update() 的任務使用，其他任務請用 notify()
+     * @param line1 第一行文字
+     * @param line2 第二行文字
+     * @param duration_ms 顯示時間 (ms)，0 表示顯示到有較新的通知為止
+     */
+    void displayMessage(const char* line1, const char* line2 = nullptr, unsigned long duration_ms = 0);
+    
+    /**
+     * 顯示進度條並立即繪製
+     * 連續呼叫時更新同一則進度通知；有較新的通知時進度條自動消失
      * @param message 顯示訊息
      * @param progress 進度值 (0-100)
      */
     void displayProgress(const char* message, int progress);
     
+    /**
+     * 清除所有通知
+     */
+    void clearNotifications();
+    
     /**
      * 設置更新間隔
      * @param interval 更新間隔 (ms)
      */
     void setUpdateInterval(unsigned long interval);
     
+    /**
+     * 啟用或停用局部更新
+     * @param enable true 只傳送變化的 tile，false 每次送出整幀
+     */
+    void setPartialUpdate(bool enable);
+    
+    /**
+     * 使影子副本失效，下次更新送出整幀
+     * 直接透過 getU8G2() 呼叫 sendBuffer() 或顯示器重新上電後應呼叫
+     */
+    void invalidate();
+    
+    /**
+     * 上一幀傳送的 I2C 位元組數 (估計值，未變化的幀為 0)
+     */
+    uint32_t getLastFrameBytes() const;
+    
+    /**
+     * 上一幀傳送的 tile 數 (整幀為 128)
+     */
+    uint8_t getLastFrameTiles() const;
+    
+    /**
+     * 累計傳送的 I2C 位元組數 (估計值)
+     */
+    uint32_t getTotalBytesSent() const;
+    
+    /**
+     * 有傳送資料的幀數
+     */
+    uint32_t getFramesSent() const;
+    
+    /**
+     * 內容未變化而略過傳送的幀數
+     */
+    uint32_t getFramesSkipped() const;
+    
+    /**
+     * 非同步模式下，尚未送出就被較新幀覆蓋的幀數
+     */
+    uint32_t getFramesDropped() const;
+    
     /**
      * 獲取 U8G2 對象引用
      * @return U8G2 對象引用
      */
-    U8G2_SH1106_128X64_NONAME_F_HW_I2C& getU8G2();
+    OLEDDisplay& getU8G2();
 };
 
 #endif // OLED_MANAGER_H
\ No newline at end of file
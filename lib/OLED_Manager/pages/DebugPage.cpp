@@ -19,7 +19,7 @@ DebugPage::DebugPage(double* targetRPM, double* currentRPM, double* kp, double*
 {
 }
 
-void DebugPage::draw(U8G2_SH1106_128X64_NONAME_F_HW_I2C& u8g2) {
+void DebugPage::draw(OLEDDisplay& u8g2) {
     // 設置字體
     u8g2.setFont(u8g2_font_ncenB08_tr);
     
@@ -38,7 +38,7 @@ void DebugPage::draw(U8G2_SH1106_128X64_NONAME_F_HW_I2C& u8g2) {
     drawParams(u8g2);
 }
 
-void DebugPage::drawRPMGraph(U8G2_SH1106_128X64_NONAME_F_HW_I2C& u8g2) {
+void DebugPage::drawRPMGraph(OLEDDisplay& u8g2) {
     // 繪製示波器框架
     u8g2.drawFrame(0, 22, 128, 30);
     
@@ -63,7 +63,7 @@ void DebugPage::drawRPMGraph(U8G2_SH1106_128X64_NONAME_F_HW_I2C& u8g2) {
     }
 }
 
-void DebugPage::drawParams(U8G2_SH1106_128X64_NONAME_F_HW_I2C& u8g2) {
+void DebugPage::drawParams(OLEDDisplay& u8g2) {
     char buffer[32];
     
     // 顯示參數值
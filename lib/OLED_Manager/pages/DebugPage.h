@@ -29,10 +29,10 @@ private:
     ParamMode currentParamMode;  // 當前參數調整模式
     
     // 繪製RPM示波器
-    void drawRPMGraph(U8G2_SH1106_128X64_NONAME_F_HW_I2C& u8g2);
+    void drawRPMGraph(OLEDDisplay& u8g2);
     
     // 繪製參數顯示
-    void drawParams(U8G2_SH1106_128X64_NONAME_F_HW_I2C& u8g2);
+    void drawParams(OLEDDisplay& u8g2);
 
 public:
     /**
@@ -49,7 +49,7 @@ public:
      * 繪製頁面
      * @param u8g2 U8G2對象
      */
-    virtual void draw(U8G2_SH1106_128X64_NONAME_F_HW_I2C& u8g2) override;
+    virtual void draw(OLEDDisplay& u8g2) override;
     
     /**
      * 獲取頁面名稱
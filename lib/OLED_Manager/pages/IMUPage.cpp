@@ -22,7 +22,7 @@ IMUPage::IMUPage(IMU* imuPtr) : imu(imuPtr), currentMode(IMU_MODE_YPR) {
      nextDisplayMode();
  }
  
- void IMUPage::draw(U8G2_SH1106_128X64_NONAME_F_HW_I2C& u8g2) {
+ void IMUPage::draw(OLEDDisplay& u8g2) {
     // 根據當前模式繪製不同的頁面
      switch (currentMode) {
          case IMU_MODE_YPR:
@@ -40,7 +40,7 @@ IMUPage::IMUPage(IMU* imuPtr) : imu(imuPtr), currentMode(IMU_MODE_YPR) {
      }
  }
  
- void IMUPage::drawYPR(U8G2_SH1106_128X64_NONAME_F_HW_I2C& u8g2) {
+ void IMUPage::drawYPR(OLEDDisplay& u8g2) {
     u8g2.clearBuffer();
     
      // 設置字體
@@ -73,9 +73,9 @@ IMUPage::IMUPage(IMU* imuPtr) : imu(imuPtr), currentMode(IMU_MODE_YPR) {
     // 顯示模式指示器
     u8g2.drawStr(110, 12, "YPR");
     
-    u8g2.sendBuffer();
+    // 緩衝區由 OLED_Manager 比對後只傳送變化的部分
 }
- void IMUPage::drawAccelGyro(U8G2_SH1106_128X64_NONAME_F_HW_I2C& u8g2) {
+ void IMUPage::drawAccelGyro(OLEDDisplay& u8g2) {
     u8g2.clearBuffer();
      // 設置字體
      u8g2.setFont(u8g2_font_ncenB08_tr);
@@ -114,10 +114,10 @@ IMUPage::IMUPage(IMU* imuPtr) : imu(imuPtr), currentMode(IMU_MODE_YPR) {
     // 顯示模式指示器
     u8g2.drawStr(110, 10, "A/G");
     
-    u8g2.sendBuffer();
+    // 緩衝區由 OLED_Manager 比對後只傳送變化的部分
  }
 
-void IMUPage::drawCalibrationValues(U8G2_SH1106_128X64_NONAME_F_HW_I2C& u8g2) {
+void IMUPage::drawCalibrationValues(OLEDDisplay& u8g2) {
     u8g2.clearBuffer();
     
     // 設置字體
@@ -152,7 +152,7 @@ void IMUPage::drawCalibrationValues(U8G2_SH1106_128X64_NONAME_F_HW_I2C& u8g2) {
     // 顯示模式指示器
     u8g2.drawStr(110, 10, "CAL");
     
-    u8g2.sendBuffer();
+    // 緩衝區由 OLED_Manager 比對後只傳送變化的部分
 }
 
 const char* IMUPage::getName() {
@@ -26,9 +26,9 @@ private:
     IMUDisplayMode currentMode;
     
     // 繪製不同模式的頁面
-    void drawYPR(U8G2_SH1106_128X64_NONAME_F_HW_I2C& u8g2);
-    void drawAccelGyro(U8G2_SH1106_128X64_NONAME_F_HW_I2C& u8g2);
-    void drawCalibrationValues(U8G2_SH1106_128X64_NONAME_F_HW_I2C& u8g2);
+    void drawYPR(OLEDDisplay& u8g2);
+    void drawAccelGyro(OLEDDisplay& u8g2);
+    void drawCalibrationValues(OLEDDisplay& u8g2);
     
 public:
     /**
@@ -63,7 +63,7 @@ public:
      * 繪製頁面
      * @param u8g2 U8G2 對象引用
      */
-    virtual void draw(U8G2_SH1106_128X64_NONAME_F_HW_I2C& u8g2) override;
+    virtual void draw(OLEDDisplay& u8g2) override;
     
     /**
      * 獲取頁面名稱
@@ -14,7 +14,7 @@ MotorPage::MotorPage(Motor* m1, Motor* m2, Encoder* e1, Encoder* e2)
 {
 }
 
-void MotorPage::draw(U8G2_SH1106_128X64_NONAME_F_HW_I2C& u8g2) {
+void MotorPage::draw(OLEDDisplay& u8g2) {
     // 設置字體
     u8g2.setFont(u8g2_font_ncenB10_tr);
     u8g2.drawStr(0, 12, "Motor Status");
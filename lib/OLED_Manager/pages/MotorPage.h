@@ -39,7 +39,7 @@ public:
      * 繪製頁面
      * @param u8g2 U8G2 對象引用
      */
-    virtual void draw(U8G2_SH1106_128X64_NONAME_F_HW_I2C& u8g2) override;
+    virtual void draw(OLEDDisplay& u8g2) override;
     
     /**
      * 獲取頁面名稱
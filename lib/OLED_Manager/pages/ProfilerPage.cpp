@@ -0,0 +1,57 @@
+/**
+ * ProfilerPage.cpp
+ * 效能量測顯示頁面實現
+ */
+
+#include "ProfilerPage.h"
+
+// 建構函數
+ProfilerPage::ProfilerPage(Profiler* profiler)
+    : profiler(profiler),
+      rowCount(0)
+{
+}
+
+void ProfilerPage::draw(OLEDDisplay& u8g2) {
+    // 小字體，每行 25 個字元
+    u8g2.setFont(u8g2_font_5x7_tr);
+    u8g2.drawStr(0, 7, "Stage       mean/max us");
+    u8g2.drawHLine(0, 9, 128);
+    
+    if (rowCount == 0) {
+        u8g2.drawStr(0, 24, "No samples");
+        return;
+    }
+    
+    char buffer[32];
+    for (int i = 0; i < rowCount; i++) {
+        snprintf(buffer, sizeof(buffer), "%-11.11s%6.0f%7.0f", rowNames[i], rowMean[i], rowMax[i]);
+        u8g2.drawStr(0, 19 + i * 10, buffer);
+    }
+}
+
+// 獲取頁面名稱
+const char* ProfilerPage::getName() {
+    return "Profiler";
+}
+
+// 更新頁面數據
+void ProfilerPage::update() {
+    rowCount = 0;
+    if (!profiler) {
+        return;
+    }
+    
+    int ids[PROFILER_PAGE_ROWS];
+    int count = profiler->getTopStages(ids, PROFILER_PAGE_ROWS);
+    for (int i = 0; i < count; i++) {
+        const ProfilerStage& stage = profiler->getStage(ids[i]);
+        if (stage.count == 0) {
+            continue;
+        }
+        rowNames[rowCount] = stage.name;
+        rowMean[rowCount] = profiler->getMeanMicros(ids[i]);
+        rowMax[rowCount] = profiler->cyclesToMicros(stage.maxCycles);
+        rowCount++;
+    }
+}
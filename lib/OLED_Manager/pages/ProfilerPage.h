@@ -0,0 +1,50 @@
+/**
+ * ProfilerPage.h
+ * 效能量測顯示頁面：列出總耗時最高的幾個階段
+ */
+
+#ifndef PROFILER_PAGE_H
+#define PROFILER_PAGE_H
+
+#include "OLED_Manager.h"
+#include "Profiler.h"
+
+// 顯示的階段數
+#define PROFILER_PAGE_ROWS 5
+
+class ProfilerPage : public DisplayPage {
+private:
+    Profiler* profiler;
+    
+    // 顯示數據 (update() 時複製，繪製期間不受量測更新影響)
+    int rowCount;
+    const char* rowNames[PROFILER_PAGE_ROWS];
+    float rowMean[PROFILER_PAGE_ROWS];
+    float rowMax[PROFILER_PAGE_ROWS];
+    
+public:
+    /**
+     * 建構函數
+     * @param profiler 量測器指針
+     */
+    ProfilerPage(Profiler* profiler);
+    
+    /**
+     * 繪製頁面
+     * @param u8g2 U8G2 對象引用
+     */
+    virtual void draw(OLEDDisplay& u8g2) override;
+    
+    /**
+     * 獲取頁面名稱
+     * @return 頁面名稱
+     */
+    virtual const char* getName() override;
+    
+    /**
+     * 更新頁面數據
+     */
+    virtual void update() override;
+};
+
+#endif // PROFILER_PAGE_H
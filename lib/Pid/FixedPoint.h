@@ -0,0 +1,85 @@
+/**
+ * FixedPoint.h
+ * 有號定點數 (32 位元，FRAC 個小數位元)
+ *
+ * 功能概述:
+ * - 只用整數運算，可在沒有浮點單元或需要確定性結果的地方代替 float
+ * - 乘除以 64 位元中間值計算，溢位時飽和到最大/最小值而不是繞回
+ * - Q16 (16 位元小數) 的範圍約 ±32767，解析度約 1.5e-5
+ */
+
+#ifndef FIXED_POINT_H
+#define FIXED_POINT_H
+
+#include <stdint.h>
+
+template <int FRAC>
+class Fixed {
+    static_assert(FRAC > 0 && FRAC < 31, "Fixed needs 1..30 fractional bits");
+
+private:
+    int32_t raw;
+
+    static int32_t saturate(int64_t value) {
+        if (value > INT32_MAX) return INT32_MAX;
+        if (value < INT32_MIN) return INT32_MIN;
+        return (int32_t)value;
+    }
+
+    static int32_t fromFloating(double value) {
+        double scaled = value * (double)ONE;
+        if (scaled >= (double)INT32_MAX) return INT32_MAX;
+        if (scaled <= (double)INT32_MIN) return INT32_MIN;
+        return (int32_t)(scaled < 0 ? scaled - 0.5 : scaled + 0.5);
+    }
+
+public:
+    static const int32_t ONE = (int32_t)1 << FRAC;
+
+    Fixed() : raw(0) {}
+    Fixed(int value) : raw(saturate((int64_t)value * ONE)) {}
+    Fixed(float value) : raw(fromFloating(value)) {}
+    Fixed(double value) : raw(fromFloating(value)) {}
+
+    /**
+     * 由原始整數值建立 (raw = 實際值 * 2^FRAC)
+     */
+    static Fixed fromRaw(int32_t value) {
+        Fixed f;
+        f.raw = value;
+        return f;
+    }
+
+    int32_t getRaw() const { return raw; }
+    float toFloat() const { return (float)raw / ONE; }
+    explicit operator float() const { return toFloat(); }
+
+    Fixed operator-() const { return fromRaw(saturate(-(int64_t)raw)); }
+    Fixed operator+(Fixed other) const { return fromRaw(saturate((int64_t)raw + other.raw)); }
+    Fixed operator-(Fixed other) const { return fromRaw(saturate((int64_t)raw - other.raw)); }
+    Fixed operator*(Fixed other) const { return fromRaw(saturate(((int64_t)raw * other.raw) >> FRAC)); }
+
+    Fixed operator/(Fixed other) const {
+        if (other.raw == 0) {
+            return fromRaw(raw >= 0 ? INT32_MAX : INT32_MIN);
+        }
+        return fromRaw(saturate(((int64_t)raw * ONE) / other.raw));
+    }
+
+    Fixed& operator+=(Fixed other) { return *this = *this + other; }
+    Fixed& operator-=(Fixed other) { return *this = *this - other; }
+    Fixed& operator*=(Fixed other) { return *this = *this * other; }
+    Fixed& operator/=(Fixed other) { return *this = *this / other; }
+
+    bool operator<(Fixed other) const { return raw < other.raw; }
+    bool operator>(Fixed other) const { return raw > other.raw; }
+    bool operator<=(Fixed other) const { return raw <= other.raw; }
+    bool operator>=(Fixed other) const { return raw >= other.raw; }
+    bool operator==(Fixed other) const { return raw == other.raw; }
+    bool operator!=(Fixed other) const { return raw != other.raw; }
+};
+
+// 16 位元整數 + 16 位元小數
+typedef Fixed<16> Q16;
+
+#endif // FIXED_POINT_H
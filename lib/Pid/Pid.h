@@ -0,0 +1,249 @@
+/**
+ * Pid.h
+ * PID 控制器模板 (單精度浮點或定點數)
+ *
+ * 功能概述:
+ * - 呼叫端提供 dt，控制器本身不讀時鐘，由控制任務的週期決定取樣時間
+ * - 微分項作用在量測值上 (設定值跳變不會產生微分衝擊)，並經一階低通濾波；
+ *   也可由 computeWithRate() 直接提供量測值的變化率 (例如陀螺儀角速度)
+ * - 條件積分防飽和：輸出飽和且誤差會使其更飽和時停止累積
+ * - 輸出限幅、前饋輸入、手動/自動切換時無擾動 (積分項接續目前輸出)
+ * - 積分項以「已乘上 Ki」的形式保存，執行中修改增益不會造成輸出跳動
+ *
+ * ESP32-S3 的 FPU 只支援單精度，應使用 Pid<float> 而不是 double；
+ * Pid<Q16> 使用 FixedPoint.h 的定點數，數值範圍約 ±32767，增益與 dt 的乘積需留意解析度。
+ */
+
+#ifndef PID_H
+#define PID_H
+
+#include "FixedPoint.h"
+
+// 控制模式
+enum PidMode {
+    PID_MANUAL,      // 輸出由呼叫端設定，compute() 只追蹤量測值
+    PID_AUTOMATIC    // 正常閉迴路計算
+};
+
+// 控制方向
+enum PidDirection {
+    PID_DIRECT,      // 輸出增加使量測值增加
+    PID_REVERSE      // 輸出增加使量測值減少
+};
+
+template <typename T>
+class Pid {
+private:
+    // 增益 (已依方向調整正負號)
+    T kp;
+    T ki;
+    T kd;
+    PidDirection direction;
+    PidMode mode;
+
+    T outMin;
+    T outMax;
+    T derivativeAlpha;       // 微分低通係數 (0, 1]，1 表示不濾波
+
+    // 狀態
+    T proportionalTerm;
+    T integralTerm;          // 已乘上 Ki 的積分項
+    T derivativeTerm;        // 濾波後的微分項
+    T output;
+    T lastMeasurement;
+    bool hasLastMeasurement; // 第一次計算沒有前一筆量測值，不求微分
+
+    static T clamp(T value, T low, T high) {
+        return value < low ? low : (value > high ? high : value);
+    }
+
+    // 共用的計算：rate 為量測值的變化率
+    T update(T setpoint, T measurement, T rate, T dt, T feedforward) {
+        T error = setpoint - measurement;
+        proportionalTerm = kp * error;
+
+        // 微分項作用在量測值上，一階低通濾波
+        T rawDerivative = -(kd * rate);
+        derivativeTerm = derivativeTerm + derivativeAlpha * (rawDerivative - derivativeTerm);
+
+        lastMeasurement = measurement;
+        hasLastMeasurement = true;
+
+        // 條件積分：輸出飽和且本次積分量會使其更飽和時不累積
+        T increment = ki * error * dt;
+        T base = proportionalTerm + derivativeTerm + feedforward;
+        T unclamped = base + integralTerm + increment;
+        if (unclamped > outMax) {
+            if (increment < T(0)) integralTerm = integralTerm + increment;
+        } else if (unclamped < outMin) {
+            if (increment > T(0)) integralTerm = integralTerm + increment;
+        } else {
+            integralTerm = integralTerm + increment;
+        }
+        integralTerm = clamp(integralTerm, outMin, outMax);
+
+        output = clamp(base + integralTerm, outMin, outMax);
+        return output;
+    }
+
+    void applyTunings(T p, T i, T d) {
+        if (direction == PID_REVERSE) {
+            kp = -p;
+            ki = -i;
+            kd = -d;
+        } else {
+            kp = p;
+            ki = i;
+            kd = d;
+        }
+    }
+
+public:
+    /**
+     * 建構函數 (輸出範圍預設為 -255 ~ 255，自動模式)
+     * @param p 比例增益
+     * @param i 積分增益 (每秒)
+     * @param d 微分增益 (秒)
+     * @param dir 控制方向
+     */
+    Pid(T p = T(0), T i = T(0), T d = T(0), PidDirection dir = PID_DIRECT)
+        : direction(dir),
+          mode(PID_AUTOMATIC),
+          outMin(T(-255)),
+          outMax(T(255)),
+          derivativeAlpha(T(1)),
+          proportionalTerm(T(0)),
+          integralTerm(T(0)),
+          derivativeTerm(T(0)),
+          output(T(0)),
+          lastMeasurement(T(0)),
+          hasLastMeasurement(false)
+    {
+        applyTunings(p, i, d);
+    }
+
+    /**
+     * 設定增益 (不清除積分項)
+     */
+    void setTunings(T p, T i, T d) {
+        applyTunings(p, i, d);
+    }
+
+    /**
+     * 設定控制方向
+     */
+    void setDirection(PidDirection dir) {
+        if (dir != direction) {
+            kp = -kp;
+            ki = -ki;
+            kd = -kd;
+            direction = dir;
+        }
+    }
+
+    /**
+     * 設定輸出範圍，目前的輸出與積分項會被限制在新範圍內
+     */
+    void setOutputLimits(T low, T high) {
+        if (!(low < high)) {
+            return;
+        }
+        outMin = low;
+        outMax = high;
+        integralTerm = clamp(integralTerm, outMin, outMax);
+        output = clamp(output, outMin, outMax);
+    }
+
+    /**
+     * 設定微分項低通係數
+     * @param alpha (0, 1]，每次計算向新值移動的比例；1 表示不濾波
+     *              對應時間常數 tau 時 alpha = dt / (tau + dt)
+     */
+    void setDerivativeFilter(T alpha) {
+        if (alpha > T(0) && !(alpha > T(1))) {
+            derivativeAlpha = alpha;
+        }
+    }
+
+    /**
+     * 切換模式；由手動切到自動時積分項接續目前輸出，不產生跳動
+     * @param newMode 新模式
+     * @param measurement 目前量測值 (作為下一次微分的起點)
+     * @param currentOutput 目前實際送出的輸出
+     */
+    void setMode(PidMode newMode, T measurement, T currentOutput) {
+        if (newMode == PID_AUTOMATIC && mode == PID_MANUAL) {
+            integralTerm = clamp(currentOutput, outMin, outMax);
+            derivativeTerm = T(0);
+            lastMeasurement = measurement;
+            hasLastMeasurement = true;
+            output = clamp(currentOutput, outMin, outMax);
+        }
+        mode = newMode;
+    }
+
+    /**
+     * 獲取目前模式
+     */
+    PidMode getMode() const {
+        return mode;
+    }
+
+    /**
+     * 手動模式下設定輸出
+     */
+    void setManualOutput(T value) {
+        if (mode == PID_MANUAL) {
+            output = clamp(value, outMin, outMax);
+        }
+    }
+
+    /**
+     * 清除積分、微分與輸出，下一次計算重新開始
+     */
+    void reset() {
+        proportionalTerm = T(0);
+        integralTerm = T(0);
+        derivativeTerm = T(0);
+        output = T(0);
+        hasLastMeasurement = false;
+    }
+
+    /**
+     * 計算一次輸出，微分由相鄰兩次量測值求得
+     * @param setpoint 設定值
+     * @param measurement 量測值
+     * @param dt 與上次計算的間隔 (秒)，非正值時不計算
+     * @param feedforward 前饋量，直接加到輸出 (限幅前)
+     * @return 限幅後的輸出；手動模式下返回手動設定的輸出
+     */
+    T compute(T setpoint, T measurement, T dt, T feedforward = T(0)) {
+        if (mode == PID_MANUAL || !(dt > T(0))) {
+            lastMeasurement = measurement;
+            hasLastMeasurement = true;
+            return output;
+        }
+        T rate = hasLastMeasurement ? (measurement - lastMeasurement) / dt : T(0);
+        return update(setpoint, measurement, rate, dt, feedforward);
+    }
+
+    /**
+     * 計算一次輸出，由呼叫端提供量測值的變化率 (例如陀螺儀角速度)
+     * @param measurementRate 量測值的變化率 (每秒)
+     */
+    T computeWithRate(T setpoint, T measurement, T measurementRate, T dt, T feedforward = T(0)) {
+        if (mode == PID_MANUAL || !(dt > T(0))) {
+            lastMeasurement = measurement;
+            hasLastMeasurement = true;
+            return output;
+        }
+        return update(setpoint, measurement, measurementRate, dt, feedforward);
+    }
+
+    T getOutput() const { return output; }
+    T getProportional() const { return proportionalTerm; }
+    T getIntegral() const { return integralTerm; }
+    T getDerivative() const { return derivativeTerm; }
+};
+
+#endif // PID_H
@@ -0,0 +1,185 @@
+/**
+ * Profiler.cpp
+ * 熱路徑效能量測實現
+ */
+
+#include "Profiler.h"
+#include <string.h>
+
+// 建構函數
+Profiler::Profiler()
+    : stageCount(0),
+      enabled(true),
+      cyclesPerMicro(ESP.getCpuFreqMHz())
+{
+    portMUX_TYPE unlocked = portMUX_INITIALIZER_UNLOCKED;
+    registerMux = unlocked;
+
+    if (cyclesPerMicro == 0) {
+        cyclesPerMicro = 240;
+    }
+}
+
+// 登記階段
+int Profiler::registerStage(const char* name) {
+    int id = -1;
+    portENTER_CRITICAL(&registerMux);
+
+    for (int i = 0; i < stageCount; i++) {
+        if (strcmp(stages[i].name, name) == 0) {
+            id = i;
+            break;
+        }
+    }
+
+    if (id < 0 && stageCount < PROFILER_MAX_STAGES) {
+        id = stageCount;
+        ProfilerStage& stage = stages[id];
+        memset(&stage, 0, sizeof(stage));
+        stage.name = name;
+        stage.minCycles = UINT32_MAX;
+        stageCount = id + 1;  // 內容寫好後才讓 record() 看見
+    }
+
+    portEXIT_CRITICAL(&registerMux);
+    return id;
+}
+
+// 清除統計
+void Profiler::reset() {
+    for (int i = 0; i < stageCount; i++) {
+        ProfilerStage& stage = stages[i];
+        stage.count = 0;
+        stage.totalCycles = 0;
+        stage.minCycles = UINT32_MAX;
+        stage.maxCycles = 0;
+        memset(stage.histogram, 0, sizeof(stage.histogram));
+    }
+}
+
+// 啟用或暫停記錄
+void Profiler::setEnabled(bool enable) {
+    enabled = enable;
+}
+
+// 是否正在記錄
+bool Profiler::isEnabled() const {
+    return enabled;
+}
+
+// 已登記的階段數
+int Profiler::getStageCount() const {
+    return stageCount;
+}
+
+// 取得階段統計
+const ProfilerStage& Profiler::getStage(int id) const {
+    return stages[id];
+}
+
+// 週期數換算為微秒
+float Profiler::cyclesToMicros(uint64_t cycles) const {
+    return (float)cycles / cyclesPerMicro;
+}
+
+// 平均執行時間
+float Profiler::getMeanMicros(int id) const {
+    const ProfilerStage& stage = stages[id];
+    if (stage.count == 0) {
+        return 0.0f;
+    }
+    return cyclesToMicros(stage.totalCycles / stage.count);
+}
+
+// 由直方圖估計百分位數
+float Profiler::getPercentileMicros(int id, float percentile) const {
+    const ProfilerStage& stage = stages[id];
+    if (stage.count == 0) {
+        return 0.0f;
+    }
+
+    uint32_t target = (uint32_t)(stage.count * (percentile / 100.0f));
+    uint32_t seen = 0;
+    for (int bin = 0; bin < PROFILER_HISTOGRAM_BINS; bin++) {
+        seen += stage.histogram[bin];
+        if (seen > target || seen == stage.count) {
+            // 最後一箱沒有上界，以最大值代替
+            if (bin == PROFILER_HISTOGRAM_BINS - 1) {
+                return cyclesToMicros(stage.maxCycles);
+            }
+            uint64_t upper = 1ULL << (bin + PROFILER_HISTOGRAM_SHIFT);
+            return cyclesToMicros(upper < stage.maxCycles ? upper : stage.maxCycles);
+        }
+    }
+    return cyclesToMicros(stage.maxCycles);
+}
+
+// 依總耗時排序
+int Profiler::getTopStages(int* ids, int maxCount) const {
+    int count = 0;
+    int total = stageCount;
+
+    // 插入排序，階段數很少
+    for (int i = 0; i < total; i++) {
+        uint64_t cycles = stages[i].totalCycles;
+        int pos = count < maxCount ? count : maxCount;
+        while (pos > 0 && stages[ids[pos - 1]].totalCycles < cycles) {
+            if (pos < maxCount) {
+                ids[pos] = ids[pos - 1];
+            }
+            pos--;
+        }
+        if (pos < maxCount) {
+            ids[pos] = i;
+            if (count < maxCount) {
+                count++;
+            }
+        }
+    }
+    return count;
+}
+
+// 輸出統計表與直方圖
+void Profiler::printTable(Print& out) const {
+    int ids[PROFILER_MAX_STAGES];
+    int count = getTopStages(ids, PROFILER_MAX_STAGES);
+
+    out.printf("# profiler: %d stages, %lu MHz, %s\n", count, (unsigned long)cyclesPerMicro,
+               enabled ? "enabled" : "paused");
+    out.printf("%-18s %9s %9s %9s %9s %9s %10s\n",
+               "stage", "count", "min_us", "mean_us", "p99_us", "max_us", "total_ms");
+
+    for (int i = 0; i < count; i++) {
+        const ProfilerStage& stage = stages[ids[i]];
+        if (stage.count == 0) {
+            out.printf("%-18s %9lu %9s %9s %9s %9s %10s\n", stage.name, 0UL, "-", "-", "-", "-", "-");
+            continue;
+        }
+        out.printf("%-18s %9lu %9.1f %9.1f %9.1f %9.1f %10.1f\n",
+                   stage.name, (unsigned long)stage.count,
+                   cyclesToMicros(stage.minCycles), getMeanMicros(ids[i]),
+                   getPercentileMicros(ids[i], 99.0f), cyclesToMicros(stage.maxCycles),
+                   cyclesToMicros(stage.totalCycles) / 1000.0f);
+    }
+
+    // 直方圖：只列出非零的分箱，格式為 <上界us>:<次數>
+    for (int i = 0; i < count; i++) {
+        const ProfilerStage& stage = stages[ids[i]];
+        if (stage.count == 0) {
+            continue;
+        }
+        out.printf("# hist %s", stage.name);
+        for (int bin = 0; bin < PROFILER_HISTOGRAM_BINS; bin++) {
+            if (stage.histogram[bin] == 0) {
+                continue;
+            }
+            if (bin == PROFILER_HISTOGRAM_BINS - 1) {
+                out.printf(" inf:%lu", (unsigned long)stage.histogram[bin]);
+            } else {
+                out.printf(" %g:%lu", cyclesToMicros(1ULL << (bin + PROFILER_HISTOGRAM_SHIFT)),
+                           (unsigned long)stage.histogram[bin]);
+            }
+        }
+        out.printf("\n");
+    }
+}
@@ -0,0 +1,186 @@
+/**
+ * Profiler.h
+ * 熱路徑效能量測：以 CPU 週期計數器量測各階段的執行時間
+ *
+ * 功能概述:
+ * - 每個具名階段統計次數、最小/最大/平均週期數，以及以 2 的冪次分箱的直方圖
+ * - ProfilerScope / PROFILE_SCOPE 在建構與解構時各讀一次週期計數器，記錄成本只有數十個週期，
+ *   可以在正式版本中保持開啟；編譯時定義 PROFILER_ENABLED=0 則 PROFILE_SCOPE 完全移除
+ * - 同一個階段只能由一個任務記錄 (不同階段可在不同任務)；讀取端得到的是當下的近似快照
+ * - 週期計數器是每個核心各自的，量測區間內任務不可換核心 (釘選核心的任務沒有這個問題)
+ */
+
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <Arduino.h>
+
+#ifndef PROFILER_ENABLED
+#define PROFILER_ENABLED 1
+#endif
+
+// 最多可登記的階段數
+#define PROFILER_MAX_STAGES 16
+
+// 直方圖：第 0 箱 < 128 週期，第 i 箱為 [2^(i+6), 2^(i+7)) 週期，最後一箱不設上限
+#define PROFILER_HISTOGRAM_BINS 24
+#define PROFILER_HISTOGRAM_SHIFT 7
+
+/**
+ * 單一階段的統計
+ */
+struct ProfilerStage {
+    const char* name;
+    uint32_t count;
+    uint32_t minCycles;
+    uint32_t maxCycles;
+    uint64_t totalCycles;
+    uint32_t histogram[PROFILER_HISTOGRAM_BINS];
+};
+
+class Profiler {
+private:
+    ProfilerStage stages[PROFILER_MAX_STAGES];
+    volatile int stageCount;
+    volatile bool enabled;
+    uint32_t cyclesPerMicro;
+    portMUX_TYPE registerMux;
+
+    // 週期數 → 直方圖箱號
+    static int binFor(uint32_t cycles) {
+        if (cycles < (1UL << PROFILER_HISTOGRAM_SHIFT)) {
+            return 0;
+        }
+        int bin = 31 - __builtin_clz(cycles) - (PROFILER_HISTOGRAM_SHIFT - 1);
+        return bin < PROFILER_HISTOGRAM_BINS ? bin : PROFILER_HISTOGRAM_BINS - 1;
+    }
+
+public:
+    /**
+     * 建構函數
+     */
+    Profiler();
+
+    /**
+     * 讀取目前核心的週期計數器
+     */
+    static inline uint32_t now() {
+        return ESP.getCycleCount();
+    }
+
+    /**
+     * 登記階段 (同名階段返回相同的編號)
+     * @param name 階段名稱，必須是常駐字串
+     * @return 階段編號，已滿時返回 -1
+     */
+    int registerStage(const char* name);
+
+    /**
+     * 記錄一次執行
+     * @param id 階段編號
+     * @param cycles 經過的週期數
+     */
+    inline void record(int id, uint32_t cycles) {
+        if (!enabled || id < 0 || id >= stageCount) {
+            return;
+        }
+        ProfilerStage& stage = stages[id];
+        stage.count++;
+        stage.totalCycles += cycles;
+        if (cycles < stage.minCycles) stage.minCycles = cycles;
+        if (cycles > stage.maxCycles) stage.maxCycles = cycles;
+        stage.histogram[binFor(cycles)]++;
+    }
+
+    /**
+     * 清除所有階段的統計 (保留登記)
+     */
+    void reset();
+
+    /**
+     * 啟用或暫停記錄
+     */
+    void setEnabled(bool enable);
+
+    /**
+     * 是否正在記錄
+     */
+    bool isEnabled() const;
+
+    /**
+     * 已登記的階段數
+     */
+    int getStageCount() const;
+
+    /**
+     * 取得階段統計
+     * @param id 階段編號 (0 ~ getStageCount()-1)
+     */
+    const ProfilerStage& getStage(int id) const;
+
+    /**
+     * 週期數換算為微秒
+     */
+    float cyclesToMicros(uint64_t cycles) const;
+
+    /**
+     * 平均執行時間 (us)
+     */
+    float getMeanMicros(int id) const;
+
+    /**
+     * 由直方圖估計百分位數 (us)，返回所在分箱的上界
+     * @param percentile 0-100
+     */
+    float getPercentileMicros(int id, float percentile) const;
+
+    /**
+     * 依總耗時由高到低排序的階段編號
+     * @param ids 輸出陣列
+     * @param maxCount 陣列大小
+     * @return 實際筆數
+     */
+    int getTopStages(int* ids, int maxCount) const;
+
+    /**
+     * 輸出統計表與直方圖
+     * @param out 輸出目標 (例如 Serial)
+     */
+    void printTable(Print& out) const;
+};
+
+/**
+ * 範圍量測：建構時開始計時，解構時記錄
+ */
+class ProfilerScope {
+private:
+    Profiler* profiler;
+    int id;
+    uint32_t start;
+
+public:
+    ProfilerScope(Profiler* profiler, int id) : profiler(profiler), id(id), start(Profiler::now()) {}
+
+    ~ProfilerScope() {
+        if (profiler) {
+            profiler->record(id, Profiler::now() - start);
+        }
+    }
+};
+
+#define PROFILER_CONCAT_INNER(a, b) a##b
+#define PROFILER_CONCAT(a, b) PROFILER_CONCAT_INNER(a, b)
+
+/**
+ * 量測目前範圍到結尾的執行時間；階段在第一次執行時登記
+ * 例: { PROFILE_SCOPE(profiler, "oled.update"); oled.update(); }
+ */
+#if PROFILER_ENABLED
+#define PROFILE_SCOPE(profiler, name) \
+    static const int PROFILER_CONCAT(profilerStage_, __LINE__) = (profiler).registerStage(name); \
+    ProfilerScope PROFILER_CONCAT(profilerScope_, __LINE__)(&(profiler), PROFILER_CONCAT(profilerStage_, __LINE__))
+#else
+#define PROFILE_SCOPE(profiler, name) ((void)0)
+#endif
+
+#endif // PROFILER_H
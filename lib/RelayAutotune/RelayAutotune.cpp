@@ -0,0 +1,265 @@
+/**
+ * RelayAutotune.cpp
+ * 繼電器回授自動調參實現
+ */
+
+#include "RelayAutotune.h"
+
+// PWM 輸出範圍 (與 WheelController 相同)
+static const float PWM_RANGE = 255.0f;
+// 停在同一側超過這個時間 (秒) 表示偏置 ± 幅度到不了設定值，偏置往該側移動半個幅度
+static const float STALL_TIME = 1.0f;
+
+// 建構函數
+RelayAutotuner::RelayAutotuner(Motor* motor, Encoder* encoder)
+    : motor(motor),
+      encoder(encoder),
+      setpoint(100.0f),
+      bias(0.3f),
+      amplitude(0.15f),
+      hysteresis(2.0f),
+      timeout(20.0f),
+      settleCycles(2),
+      measureCycles(4),
+      state(AUTOTUNE_IDLE),
+      failReason(""),
+      elapsed(0.0f),
+      relayHigh(true),
+      lastSwitch(0.0f),
+      lastBiasStep(0.0f),
+      lastRise(-1.0f),
+      highTime(0.0f),
+      peakMax(0.0f),
+      peakMin(0.0f),
+      cycles(0),
+      ultimateGain(0.0f),
+      ultimatePeriod(0.0f)
+{
+    for (int i = 0; i < AUTOTUNE_MAX_CYCLES; i++) {
+        periods[i] = 0.0f;
+        amplitudes[i] = 0.0f;
+    }
+}
+
+// 設定繼電器
+void RelayAutotuner::setRelay(float newSetpoint, float newBias, float newAmplitude, float newHysteresis) {
+    if (state == AUTOTUNE_RUNNING) {
+        return;
+    }
+    setpoint = fabs(newSetpoint);
+    amplitude = constrain(fabs(newAmplitude), 0.01f, 0.5f);
+    bias = constrain(newBias, amplitude, 1.0f - amplitude);
+    hysteresis = max(newHysteresis, 0.0f);
+}
+
+// 設定逾時與週期數
+void RelayAutotuner::setLimits(float newTimeout, int newSettleCycles, int newMeasureCycles) {
+    if (state == AUTOTUNE_RUNNING) {
+        return;
+    }
+    timeout = newTimeout > 0 ? newTimeout : 20.0f;
+    settleCycles = max(newSettleCycles, 0);
+    measureCycles = constrain(newMeasureCycles, 1, AUTOTUNE_MAX_CYCLES);
+}
+
+// 開始調參
+void RelayAutotuner::start() {
+    failReason = "";
+    elapsed = 0.0f;
+    relayHigh = true;
+    lastSwitch = 0.0f;
+    lastBiasStep = 0.0f;
+    lastRise = -1.0f;
+    highTime = 0.0f;
+    peakMax = -1e9f;
+    peakMin = 1e9f;
+    cycles = 0;
+    ultimateGain = 0.0f;
+    ultimatePeriod = 0.0f;
+    state = AUTOTUNE_RUNNING;
+    motor->setDuty(bias + amplitude);
+}
+
+// 中止調參
+void RelayAutotuner::abort() {
+    if (state != AUTOTUNE_RUNNING) {
+        return;
+    }
+    motor->setDuty(0.0f);
+    failReason = "aborted";
+    state = AUTOTUNE_FAILED;
+}
+
+// 一個完整週期結束 (低 → 高)
+void RelayAutotuner::finishCycle(float lowTime) {
+    // 調整偏置讓高/低半週等長：高半週較長表示偏置不足
+    float period = highTime + lowTime;
+    if (period > 0) {
+        bias += 0.5f * amplitude * (highTime - lowTime) / period;
+        bias = constrain(bias, amplitude, 1.0f - amplitude);
+    }
+
+    int index = cycles - settleCycles;
+    if (index >= 0 && index < AUTOTUNE_MAX_CYCLES) {
+        periods[index] = elapsed - lastRise;
+        amplitudes[index] = (peakMax - peakMin) / 2.0f;
+    }
+    cycles++;
+}
+
+// 由量測的週期計算 Ku、Pu
+void RelayAutotuner::finish() {
+    motor->setDuty(0.0f);
+
+    float period = 0.0f;
+    float a = 0.0f;
+    for (int i = 0; i < measureCycles; i++) {
+        period += periods[i];
+        a += amplitudes[i];
+    }
+    period /= measureCycles;
+    a /= measureCycles;
+
+    if (a <= hysteresis) {
+        failReason = "oscillation smaller than hysteresis";
+        state = AUTOTUNE_FAILED;
+        return;
+    }
+
+    // 帶遲滯的描述函數
+    ultimateGain = 4.0f * amplitude * PWM_RANGE / (PI * sqrtf(a * a - hysteresis * hysteresis));
+    ultimatePeriod = period;
+    state = AUTOTUNE_DONE;
+}
+
+// 推進一個控制週期
+bool RelayAutotuner::update(float dt) {
+    if (state != AUTOTUNE_RUNNING) {
+        return false;
+    }
+
+    elapsed += dt;
+    if (elapsed > timeout) {
+        motor->setDuty(0.0f);
+        failReason = cycles > 0 ? "timeout" : "no oscillation (check encoder direction)";
+        state = AUTOTUNE_FAILED;
+        return false;
+    }
+
+    // 長時間沒有切換：偏置不足以跨越設定值
+    if (elapsed - lastBiasStep > STALL_TIME) {
+        bias += relayHigh ? 0.5f * amplitude : -0.5f * amplitude;
+        bias = constrain(bias, amplitude, 1.0f - amplitude);
+        lastBiasStep = elapsed;
+    }
+
+    float velocity = encoder->getVelocity();
+    peakMax = max(peakMax, velocity);
+    peakMin = min(peakMin, velocity);
+
+    float error = setpoint - velocity;
+    if (relayHigh && error < -hysteresis) {
+        // 高 → 低
+        highTime = elapsed - lastSwitch;
+        lastSwitch = elapsed;
+        lastBiasStep = elapsed;
+        relayHigh = false;
+    } else if (!relayHigh && error > hysteresis) {
+        // 低 → 高：週期邊界
+        float lowTime = elapsed - lastSwitch;
+        lastSwitch = elapsed;
+        lastBiasStep = elapsed;
+        relayHigh = true;
+        if (lastRise >= 0) {
+            finishCycle(lowTime);
+        }
+        lastRise = elapsed;
+        peakMax = velocity;
+        peakMin = velocity;
+
+        if (cycles >= settleCycles + measureCycles) {
+            finish();
+            return false;
+        }
+    }
+
+    motor->setDuty(relayHigh ? bias + amplitude : bias - amplitude);
+    return true;
+}
+
+// 獲取狀態
+AutotuneState RelayAutotuner::getState() const {
+    return state;
+}
+
+// 失敗原因
+const char* RelayAutotuner::getFailReason() const {
+    return failReason;
+}
+
+// 臨界增益
+float RelayAutotuner::getUltimateGain() const {
+    return ultimateGain;
+}
+
+// 臨界週期
+float RelayAutotuner::getUltimatePeriod() const {
+    return ultimatePeriod;
+}
+
+// 依調參法則計算增益
+AutotuneGains RelayAutotuner::getGains(AutotuneRule rule) const {
+    AutotuneGains gains = {0.0f, 0.0f, 0.0f};
+    if (state != AUTOTUNE_DONE) {
+        return gains;
+    }
+
+    float ku = ultimateGain;
+    float pu = ultimatePeriod;
+    float ti = 0.0f;
+    float td = 0.0f;
+    switch (rule) {
+        case AUTOTUNE_ZIEGLER_NICHOLS_PI:
+            gains.kp = 0.45f * ku;
+            ti = pu / 1.2f;
+            break;
+        case AUTOTUNE_ZIEGLER_NICHOLS_PID:
+            gains.kp = 0.6f * ku;
+            ti = pu / 2.0f;
+            td = pu / 8.0f;
+            break;
+        case AUTOTUNE_TYREUS_LUYBEN:
+            gains.kp = ku / 3.2f;
+            ti = 2.2f * pu;
+            break;
+        case AUTOTUNE_SOME_OVERSHOOT:
+            gains.kp = 0.33f * ku;
+            ti = pu / 2.0f;
+            td = pu / 3.0f;
+            break;
+        case AUTOTUNE_NO_OVERSHOOT:
+            gains.kp = 0.2f * ku;
+            ti = pu / 2.0f;
+            td = pu / 3.0f;
+            break;
+    }
+    gains.ki = ti > 0 ? gains.kp / ti : 0.0f;
+    gains.kd = gains.kp * td;
+    return gains;
+}
+
+// 輸出結果
+void RelayAutotuner::printReport(Print& out) const {
+    if (state != AUTOTUNE_DONE) {
+        out.printf("# relay autotune: %s\n", state == AUTOTUNE_FAILED ? failReason : "incomplete");
+        return;
+    }
+
+    static const char* names[] = {"zn_pi", "zn_pid", "tyreus_luyben", "some_overshoot", "no_overshoot"};
+    out.printf("# relay autotune: Ku=%.3f Pu=%.3f s bias=%.3f\n", ultimateGain, ultimatePeriod, bias);
+    out.printf("rule,kp,ki,kd\n");
+    for (int rule = AUTOTUNE_ZIEGLER_NICHOLS_PI; rule <= AUTOTUNE_NO_OVERSHOOT; rule++) {
+        AutotuneGains gains = getGains((AutotuneRule)rule);
+        out.printf("%s,%.3f,%.3f,%.4f\n", names[rule], gains.kp, gains.ki, gains.kd);
+    }
+}
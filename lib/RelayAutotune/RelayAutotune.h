@@ -0,0 +1,158 @@
+/**
+ * RelayAutotune.h
+ * 輪速迴路的繼電器回授自動調參 (Åström–Hägglund)
+ *
+ * 功能概述:
+ * - 以繼電器 (偏置 ± 幅度的佔空比，帶遲滯) 取代 PID，使輪速在設定值附近產生極限環振盪
+ * - 每個週期依高/低半週的時間差調整偏置，讓振盪對稱地落在設定值上 (不需預先知道靜態增益)；
+ *   停在同一側超過 1 秒時偏置往該側移動，初始偏置不準也能開始振盪
+ * - 穩定數個週期後量測振幅 a 與週期 Pu，臨界增益 Ku = 4d / (π·√(a² - ε²))
+ * - 依選擇的調參法則由 Ku、Pu 算出 PID 增益，單位與 WheelController 相同 (PWM / RPM)
+ * - 超過時間或振盪不成立時中止並停止馬達
+ * - 非阻塞：start() 之後由控制迴圈以固定週期呼叫 update()，編碼器的 update() 由呼叫端負責
+ */
+
+#ifndef RELAY_AUTOTUNE_H
+#define RELAY_AUTOTUNE_H
+
+#include <Arduino.h>
+#include "motor.h"
+#include "encoder.h"
+
+// 量測用的週期數上限
+#define AUTOTUNE_MAX_CYCLES 8
+
+// 調參法則
+enum AutotuneRule {
+    AUTOTUNE_ZIEGLER_NICHOLS_PI,   // Kp = 0.45·Ku, Ti = Pu / 1.2
+    AUTOTUNE_ZIEGLER_NICHOLS_PID,  // Kp = 0.6·Ku,  Ti = Pu / 2,   Td = Pu / 8
+    AUTOTUNE_TYREUS_LUYBEN,        // Kp = Ku / 3.2, Ti = 2.2·Pu (PI，較保守)
+    AUTOTUNE_SOME_OVERSHOOT,       // Kp = 0.33·Ku, Ti = Pu / 2,   Td = Pu / 3
+    AUTOTUNE_NO_OVERSHOOT          // Kp = 0.2·Ku,  Ti = Pu / 2,   Td = Pu / 3
+};
+
+// 調參狀態
+enum AutotuneState {
+    AUTOTUNE_IDLE,
+    AUTOTUNE_RUNNING,
+    AUTOTUNE_DONE,
+    AUTOTUNE_FAILED
+};
+
+/**
+ * PID 增益 (PWM / RPM、PWM / (RPM·s)、PWM / (RPM/s))
+ */
+struct AutotuneGains {
+    float kp;
+    float ki;
+    float kd;
+};
+
+class RelayAutotuner {
+private:
+    Motor* motor;
+    Encoder* encoder;
+
+    // 設定
+    float setpoint;              // 輪速設定值 (RPM)
+    float bias;                  // 繼電器偏置佔空比 (執行中會調整)
+    float amplitude;             // 繼電器幅度 d (佔空比)
+    float hysteresis;            // 遲滯 ε (RPM)
+    float timeout;               // 逾時 (秒)
+    int settleCycles;            // 開始量測前略過的週期數
+    int measureCycles;           // 量測的週期數
+
+    // 執行狀態
+    AutotuneState state;
+    const char* failReason;
+    float elapsed;
+    bool relayHigh;
+    float lastSwitch;            // 上次切換的時間
+    float lastBiasStep;          // 上次切換或因停滯調整偏置的時間
+    float lastRise;              // 上次切換到高的時間，< 0 表示尚未發生
+    float highTime;              // 最近一個高半週的長度
+    float peakMax;               // 本週期的最大輪速
+    float peakMin;               // 本週期的最小輪速
+    int cycles;                  // 已完成的週期數
+    float periods[AUTOTUNE_MAX_CYCLES];
+    float amplitudes[AUTOTUNE_MAX_CYCLES];
+
+    // 結果
+    float ultimateGain;          // Ku (PWM / RPM)
+    float ultimatePeriod;        // Pu (秒)
+
+    void finishCycle(float lowTime);
+    void finish();
+
+public:
+    /**
+     * 建構函數 (預設設定值 100 RPM、偏置 0.3、幅度 0.15、遲滯 2 RPM、逾時 20 秒)
+     * @param motor 被調參的馬達
+     * @param encoder 同一個輪子的編碼器 (方向需與馬達一致)
+     */
+    RelayAutotuner(Motor* motor, Encoder* encoder);
+
+    /**
+     * 設定繼電器 (start() 之前呼叫)
+     * @param setpoint 輪速設定值 (RPM，正值)
+     * @param bias 初始偏置佔空比，接近設定值所需的佔空比可縮短收斂時間
+     * @param amplitude 繼電器幅度 (佔空比)，愈大振幅愈大、雜訊影響愈小
+     * @param hysteresis 遲滯 (RPM)，應大於輪速量測雜訊
+     */
+    void setRelay(float setpoint, float bias, float amplitude, float hysteresis);
+
+    /**
+     * 設定逾時與週期數 (start() 之前呼叫)
+     * @param timeout 逾時 (秒)
+     * @param settleCycles 略過的週期數
+     * @param measureCycles 量測的週期數 (1 ~ AUTOTUNE_MAX_CYCLES)
+     */
+    void setLimits(float timeout, int settleCycles, int measureCycles);
+
+    /**
+     * 開始調參；馬達必須已 setRunning(true)，期間其他任務不可寫入此馬達
+     */
+    void start();
+
+    /**
+     * 中止調參並停止馬達
+     */
+    void abort();
+
+    /**
+     * 推進一個控制週期
+     * @param dt 呼叫週期 (秒)
+     * @return 仍在調參返回 true
+     */
+    bool update(float dt);
+
+    AutotuneState getState() const;
+
+    /**
+     * 失敗原因，沒有失敗時為空字串
+     */
+    const char* getFailReason() const;
+
+    /**
+     * 臨界增益 Ku (PWM / RPM，DONE 時有效)
+     */
+    float getUltimateGain() const;
+
+    /**
+     * 臨界週期 Pu (秒，DONE 時有效)
+     */
+    float getUltimatePeriod() const;
+
+    /**
+     * 依調參法則計算 PID 增益 (DONE 以外返回全 0)
+     */
+    AutotuneGains getGains(AutotuneRule rule) const;
+
+    /**
+     * 輸出量測結果與各法則的增益
+     * @param out 輸出目標 (例如 Serial)
+     */
+    void printReport(Print& out) const;
+};
+
+#endif // RELAY_AUTOTUNE_H
@@ -0,0 +1,122 @@
+/**
+ * SpscRing.h
+ * 單一生產者 / 單一消費者無鎖環形緩衝區
+ *
+ * 功能概述:
+ * - 控制任務 (核心 1) 寫入固定大小的取樣記錄，遙測任務 (核心 0) 讀出，兩端都不需要互斥鎖
+ * - 生產者只寫 head、消費者只寫 tail，以 acquire/release 順序保證記錄內容先於索引可見
+ * - 緩衝區滿時 push() 立即返回 false 並累計丟棄數，不會阻塞控制迴路
+ * - 只允許一個任務呼叫 push()、一個任務呼叫 pop()/popLatest()；不可在 ISR 與任務之間共用同一端
+ */
+
+#ifndef SPSC_RING_H
+#define SPSC_RING_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @tparam T 記錄型別 (需可複製，建議為 POD 結構)
+ * @tparam N 容量，必須是 2 的冪次；實際可存放 N 筆
+ */
+template <typename T, size_t N>
+class SpscRing {
+    static_assert(N >= 2 && (N & (N - 1)) == 0, "SpscRing capacity must be a power of two");
+
+private:
+    T items[N];
+    std::atomic<uint32_t> head;      // 下一筆寫入位置 (只由生產者寫)
+    std::atomic<uint32_t> tail;      // 下一筆讀取位置 (只由消費者寫)
+    std::atomic<uint32_t> dropped;   // 緩衝區滿而丟棄的記錄數
+
+public:
+    SpscRing() : head(0), tail(0), dropped(0) {}
+
+    /**
+     * 寫入一筆記錄 (生產者端)
+     * @param item 記錄
+     * @return 成功返回true，緩衝區滿時返回false 並累計丟棄數
+     */
+    bool push(const T& item) {
+        uint32_t h = head.load(std::memory_order_relaxed);
+        if (h - tail.load(std::memory_order_acquire) >= N) {
+            dropped.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        items[h & (N - 1)] = item;
+        head.store(h + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * 讀出最舊的一筆記錄 (消費者端)
+     * @param item 輸出記錄
+     * @return 有數據返回true
+     */
+    bool pop(T& item) {
+        uint32_t t = tail.load(std::memory_order_relaxed);
+        if (t == head.load(std::memory_order_acquire)) {
+            return false;
+        }
+        item = items[t & (N - 1)];
+        tail.store(t + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * 讀出最多 maxCount 筆記錄 (消費者端)
+     * @param out 輸出陣列
+     * @param maxCount 陣列大小
+     * @return 實際讀出的筆數
+     */
+    size_t popBatch(T* out, size_t maxCount) {
+        uint32_t t = tail.load(std::memory_order_relaxed);
+        uint32_t count = head.load(std::memory_order_acquire) - t;
+        if (count > maxCount) count = maxCount;
+        for (uint32_t i = 0; i < count; i++) {
+            out[i] = items[(t + i) & (N - 1)];
+        }
+        tail.store(t + count, std::memory_order_release);
+        return count;
+    }
+
+    /**
+     * 丟棄較舊的記錄，只讀出最新一筆 (消費者端，用於降頻輸出)
+     * @param item 輸出記錄
+     * @return 有數據返回true
+     */
+    bool popLatest(T& item) {
+        uint32_t h = head.load(std::memory_order_acquire);
+        uint32_t t = tail.load(std::memory_order_relaxed);
+        if (t == h) {
+            return false;
+        }
+        item = items[(h - 1) & (N - 1)];
+        tail.store(h, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * 目前可讀的記錄數 (兩端皆可呼叫，結果僅為當下快照)
+     */
+    size_t available() const {
+        return head.load(std::memory_order_acquire) - tail.load(std::memory_order_acquire);
+    }
+
+    /**
+     * 緩衝區容量
+     */
+    static constexpr size_t capacity() {
+        return N;
+    }
+
+    /**
+     * 因緩衝區滿而丟棄的記錄數
+     */
+    uint32_t getDropped() const {
+        return dropped.load(std::memory_order_relaxed);
+    }
+};
+
+#endif // SPSC_RING_H
@@ -0,0 +1,286 @@
+/**
+ * SystemId.cpp
+ * 系統識別實現
+ */
+
+#include "SystemId.h"
+#include <string.h>
+
+// PWM 輸出範圍 (與 WheelController 相同)
+static const float PWM_RANGE = 255.0f;
+
+// 建構函數
+SystemIdentifier::SystemIdentifier(Motor* motor, Encoder* encoder)
+    : motor(motor),
+      encoder(encoder),
+      excitation(SYSID_STEP),
+      offset(0.3f),
+      amplitude(0.3f),
+      duration(3.0f),
+      prbsHold(5),
+      chirpStart(0.2f),
+      chirpEnd(10.0f),
+      sampleCount(0),
+      sampleLimit(SYSID_MAX_SAMPLES),
+      sampleTime(0.0f),
+      elapsed(0.0f),
+      state(SYSID_IDLE),
+      lfsr(0x7F),
+      failReason("")
+{
+    memset(input, 0, sizeof(input));
+    memset(output, 0, sizeof(output));
+    memset(&model, 0, sizeof(model));
+}
+
+// 設定激勵
+void SystemIdentifier::setExcitation(SysIdExcitation newExcitation, float newOffset, float newAmplitude, float newDuration) {
+    if (state == SYSID_RUNNING) {
+        return;
+    }
+    excitation = newExcitation;
+    offset = constrain(newOffset, -1.0f, 1.0f);
+    amplitude = constrain(fabs(newAmplitude), 0.0f, 1.0f - fabs(offset));
+    duration = newDuration > 0 ? newDuration : 1.0f;
+}
+
+// 設定 PRBS 位元長度
+void SystemIdentifier::setPrbsHold(int samples) {
+    if (state != SYSID_RUNNING) {
+        prbsHold = max(samples, 1);
+    }
+}
+
+// 設定掃頻範圍
+void SystemIdentifier::setChirpRange(float startHz, float endHz) {
+    if (state != SYSID_RUNNING && startHz > 0 && endHz > startHz) {
+        chirpStart = startHz;
+        chirpEnd = endHz;
+    }
+}
+
+// 開始識別
+void SystemIdentifier::start() {
+    sampleCount = 0;
+    sampleLimit = SYSID_MAX_SAMPLES;
+    sampleTime = 0.0f;
+    elapsed = 0.0f;
+    lfsr = 0x7F;
+    failReason = "";
+    memset(&model, 0, sizeof(model));
+    state = SYSID_RUNNING;
+}
+
+// 中止識別
+void SystemIdentifier::abort() {
+    if (state != SYSID_RUNNING) {
+        return;
+    }
+    motor->setDuty(0.0f);
+    failReason = "aborted";
+    state = SYSID_FAILED;
+}
+
+// 時間 t 的激勵值
+float SystemIdentifier::excitationAt(float t) {
+    switch (excitation) {
+        case SYSID_PRBS:
+            // x^7 + x^6 + 1，週期 127 位元
+            if (sampleCount > 0 && sampleCount % prbsHold == 0) {
+                uint8_t bit = ((lfsr >> 6) ^ (lfsr >> 5)) & 1;
+                lfsr = ((lfsr << 1) | bit) & 0x7F;
+            }
+            return offset + ((lfsr & 1) ? amplitude : -amplitude);
+
+        case SYSID_CHIRP: {
+            // 線性掃頻：瞬時頻率由 chirpStart 線性增加到 chirpEnd
+            float rate = (chirpEnd - chirpStart) / duration;
+            float phase = 2.0f * PI * (chirpStart * t + 0.5f * rate * t * t);
+            return offset + amplitude * sinf(phase);
+        }
+
+        case SYSID_STEP:
+        default:
+            // 前 20% 維持偏置，讓輪速先穩定
+            return t < duration * 0.2f ? offset : offset + amplitude;
+    }
+}
+
+// 記錄並輸出下一個激勵值
+bool SystemIdentifier::update(float dt) {
+    if (state != SYSID_RUNNING) {
+        return false;
+    }
+
+    if (sampleCount == 0) {
+        sampleTime = dt > 0 ? dt : 0.01f;
+        sampleLimit = min((int)ceilf(duration / sampleTime), SYSID_MAX_SAMPLES);
+    }
+
+    // y[k] 是施加 u[k] 之前的量測值，模型中 y[k+1] 才會反應 u[k]
+    float u = excitationAt(elapsed);
+    input[sampleCount] = u;
+    output[sampleCount] = encoder->getVelocity();
+    sampleCount++;
+    elapsed += sampleTime;
+
+    if (sampleCount >= sampleLimit) {
+        motor->setDuty(0.0f);
+        state = fit() ? SYSID_DONE : SYSID_FAILED;
+        return false;
+    }
+
+    motor->setDuty(u);
+    return true;
+}
+
+// 以模型模擬輸出，返回誤差平方和
+float SystemIdentifier::simulate(float a, float b, float c, int d) const {
+    float predicted = output[SYSID_MAX_DELAY];
+    float error = 0.0f;
+    for (int k = SYSID_MAX_DELAY; k < sampleCount - 1; k++) {
+        predicted = a * predicted + b * input[k - d] + c;
+        float e = output[k + 1] - predicted;
+        error += e * e;
+    }
+    return error;
+}
+
+// 擬合 FOPDT 模型
+bool SystemIdentifier::fit() {
+    // 所有候選延遲使用同一段資料 (從 SYSID_MAX_DELAY 開始)，誤差才能互相比較
+    int first = SYSID_MAX_DELAY;
+    if (sampleCount < first + 20) {
+        failReason = "too few samples";
+        return false;
+    }
+
+    double mean = 0.0;
+    for (int k = first + 1; k < sampleCount; k++) {
+        mean += output[k];
+    }
+    mean /= sampleCount - first - 1;
+    double total = 0.0;
+    for (int k = first + 1; k < sampleCount; k++) {
+        total += (output[k] - mean) * (output[k] - mean);
+    }
+    if (total < 1.0) {
+        failReason = "wheel did not move";
+        return false;
+    }
+
+    float bestError = -1.0f;
+    bool negativeGain = false;
+    for (int d = 0; d <= SYSID_MAX_DELAY; d++) {
+        // 正規方程式 A·[a b c] = r，迴歸向量為 [y[k], u[k-d], 1]
+        double A[3][3] = {{0}};
+        double r[3] = {0};
+        for (int k = first; k < sampleCount - 1; k++) {
+            double phi[3] = {output[k], input[k - d], 1.0};
+            for (int i = 0; i < 3; i++) {
+                for (int j = 0; j < 3; j++) {
+                    A[i][j] += phi[i] * phi[j];
+                }
+                r[i] += phi[i] * output[k + 1];
+            }
+        }
+
+        // Cramer 法則
+        auto det3 = [](double m[3][3]) {
+            return m[0][0] * (m[1][1] * m[2][2] - m[1][2] * m[2][1])
+                 - m[0][1] * (m[1][0] * m[2][2] - m[1][2] * m[2][0])
+                 + m[0][2] * (m[1][0] * m[2][1] - m[1][1] * m[2][0]);
+        };
+        double det = det3(A);
+        if (fabs(det) < 1e-9) {
+            continue;
+        }
+        double x[3];
+        for (int col = 0; col < 3; col++) {
+            double M[3][3];
+            memcpy(M, A, sizeof(M));
+            for (int i = 0; i < 3; i++) {
+                M[i][col] = r[i];
+            }
+            x[col] = det3(M) / det;
+        }
+
+        float a = (float)x[0];
+        float b = (float)x[1];
+        float c = (float)x[2];
+        if (a <= 0.0f || a >= 1.0f) {
+            continue;  // 非一階穩定系統
+        }
+        if (b <= 0.0f) {
+            negativeGain = true;
+            continue;
+        }
+
+        float error = simulate(a, b, c, d);
+        if (bestError < 0 || error < bestError) {
+            bestError = error;
+            model.gain = b / (1.0f - a);
+            model.timeConstant = -sampleTime / logf(a);
+            model.delay = d * sampleTime;
+        }
+    }
+
+    if (bestError < 0) {
+        failReason = negativeGain ? "encoder direction opposite to motor" : "no stable first-order fit";
+        return false;
+    }
+    model.fit = 100.0f * (1.0f - sqrtf(bestError / (float)total));
+    return true;
+}
+
+// 獲取狀態
+SysIdState SystemIdentifier::getState() const {
+    return state;
+}
+
+// 失敗原因
+const char* SystemIdentifier::getFailReason() const {
+    return failReason;
+}
+
+// 識別結果
+const FopdtModel& SystemIdentifier::getModel() const {
+    return model;
+}
+
+// SIMC PI 增益
+PiGains SystemIdentifier::suggestPi(float closedLoopTime) const {
+    PiGains gains = {0.0f, 0.0f};
+    if (state != SYSID_DONE || model.gain <= 0) {
+        return gains;
+    }
+
+    // 模型增益換算為 RPM / PWM
+    float k = model.gain / PWM_RANGE;
+    float tauC = closedLoopTime > 0 ? closedLoopTime : max(model.delay, 2.0f * sampleTime);
+    float ti = min(model.timeConstant, 4.0f * (tauC + model.delay));
+    gains.kp = model.timeConstant / (k * (tauC + model.delay));
+    gains.ki = ti > 0 ? gains.kp / ti : 0.0f;
+    return gains;
+}
+
+// 輸出結果
+void SystemIdentifier::printReport(Print& out, bool includeSamples) const {
+    static const char* names[] = {"step", "prbs", "chirp"};
+    if (state == SYSID_DONE) {
+        PiGains gains = suggestPi();
+        out.printf("# system identification (%s): K=%.1f rpm/duty tau=%.3f s theta=%.3f s fit=%.1f%%\n",
+                   names[excitation], model.gain, model.timeConstant, model.delay, model.fit);
+        out.printf("# suggested PI: kp=%.3f ki=%.3f\n", gains.kp, gains.ki);
+    } else {
+        out.printf("# system identification (%s): %s\n", names[excitation],
+                   state == SYSID_FAILED ? failReason : "incomplete");
+    }
+
+    if (includeSamples) {
+        out.printf("t,duty,rpm\n");
+        for (int k = 0; k < sampleCount; k++) {
+            out.printf("%.3f,%.4f,%.1f\n", k * sampleTime, input[k], output[k]);
+        }
+    }
+}
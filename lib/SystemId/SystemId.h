@@ -0,0 +1,162 @@
+/**
+ * SystemId.h
+ * 馬達/輪子的線上系統識別：注入激勵、記錄響應、擬合一階加延遲 (FOPDT) 模型並建議 PI 增益
+ *
+ * 功能概述:
+ * - 激勵：步階 (STEP)、偽隨機二元序列 (PRBS，7 位元 LFSR) 或線性掃頻正弦 (CHIRP)，
+ *   都疊加在一個偏置佔空比上，讓輪子在量測期間不穿越死區
+ * - 以控制迴圈的週期記錄 (佔空比, 輪速) 到 RAM 緩衝區，不做任何動態配置
+ * - 擬合 y[k+1] = a·y[k] + b·u[k-d] + c (最小平方法)，對每個候選延遲 d 模擬輸出，
+ *   取模擬誤差最小者，換算為增益 K (RPM / 佔空比)、時間常數 τ 與延遲 θ
+ * - 以 SIMC 法則由模型算出 PI 增益，單位與 WheelController 相同 (PWM / RPM)
+ * - 非阻塞：start() 之後由控制迴圈週期性呼叫 update()，編碼器的 update() 由呼叫端負責
+ */
+
+#ifndef SYSTEM_ID_H
+#define SYSTEM_ID_H
+
+#include <Arduino.h>
+#include "motor.h"
+#include "encoder.h"
+
+// 記錄緩衝區大小 (100Hz 時約 10 秒)
+#define SYSID_MAX_SAMPLES 1000
+// 搜尋的最大延遲 (取樣數)
+#define SYSID_MAX_DELAY 20
+
+// 激勵訊號
+enum SysIdExcitation {
+    SYSID_STEP,
+    SYSID_PRBS,
+    SYSID_CHIRP
+};
+
+// 識別狀態
+enum SysIdState {
+    SYSID_IDLE,
+    SYSID_RUNNING,
+    SYSID_DONE,
+    SYSID_FAILED
+};
+
+/**
+ * 一階加延遲模型：G(s) = K·e^(-θs) / (τs + 1)
+ */
+struct FopdtModel {
+    float gain;          // 穩態增益 K (RPM / 佔空比)
+    float timeConstant;  // 時間常數 τ (秒)
+    float delay;         // 延遲 θ (秒)
+    float fit;           // 模擬輸出的擬合度 (%)，100 表示完全吻合
+};
+
+/**
+ * 建議的 PI 增益 (PWM / RPM 與 PWM / (RPM·s)，可直接用於 WheelController::setTunings)
+ */
+struct PiGains {
+    float kp;
+    float ki;
+};
+
+class SystemIdentifier {
+private:
+    Motor* motor;
+    Encoder* encoder;
+
+    // 激勵設定
+    SysIdExcitation excitation;
+    float offset;                // 偏置佔空比
+    float amplitude;             // 激勵幅度 (佔空比)
+    float duration;              // 總時間 (秒)
+    int prbsHold;                // PRBS 每個位元維持的取樣數
+    float chirpStart;            // 掃頻起始頻率 (Hz)
+    float chirpEnd;              // 掃頻結束頻率 (Hz)
+
+    // 記錄
+    float input[SYSID_MAX_SAMPLES];   // 施加的佔空比
+    float output[SYSID_MAX_SAMPLES];  // 施加前讀到的輪速 (RPM)
+    int sampleCount;
+    int sampleLimit;
+    float sampleTime;            // 第一次 update() 的 dt，之後視為固定
+    float elapsed;
+
+    // 狀態
+    SysIdState state;
+    uint8_t lfsr;
+    const char* failReason;
+    FopdtModel model;
+
+    float excitationAt(float t);
+    bool fit();
+    float simulate(float a, float b, float c, int d) const;
+
+public:
+    /**
+     * 建構函數 (預設步階，偏置 0.3，幅度 0.3，3 秒)
+     * @param motor 被識別的馬達
+     * @param encoder 同一個輪子的編碼器 (方向需與馬達一致)
+     */
+    SystemIdentifier(Motor* motor, Encoder* encoder);
+
+    /**
+     * 設定激勵 (start() 之前呼叫)
+     * @param excitation 激勵訊號
+     * @param offset 偏置佔空比
+     * @param amplitude 激勵幅度 (佔空比)；偏置 ± 幅度須落在 -1 ~ 1
+     * @param duration 總時間 (秒)，受 SYSID_MAX_SAMPLES 限制
+     */
+    void setExcitation(SysIdExcitation excitation, float offset, float amplitude, float duration);
+
+    /**
+     * 設定 PRBS 每個位元維持的取樣數 (預設 5)，應接近受控體時間常數的 1/2
+     */
+    void setPrbsHold(int samples);
+
+    /**
+     * 設定掃頻範圍 (預設 0.2 ~ 10 Hz)
+     */
+    void setChirpRange(float startHz, float endHz);
+
+    /**
+     * 開始識別；馬達必須已 setRunning(true)，期間其他任務不可寫入此馬達
+     */
+    void start();
+
+    /**
+     * 中止識別並停止馬達
+     */
+    void abort();
+
+    /**
+     * 記錄一個取樣並輸出下一個激勵值，由控制迴圈以固定週期呼叫
+     * @param dt 呼叫週期 (秒)
+     * @return 仍在識別返回 true
+     */
+    bool update(float dt);
+
+    SysIdState getState() const;
+
+    /**
+     * 失敗原因，沒有失敗時為空字串
+     */
+    const char* getFailReason() const;
+
+    /**
+     * 識別結果 (DONE 時有效)
+     */
+    const FopdtModel& getModel() const;
+
+    /**
+     * 由模型計算 SIMC PI 增益
+     * @param closedLoopTime 期望的閉迴路時間常數 (秒)，0 表示取 max(θ, 2·取樣週期)
+     */
+    PiGains suggestPi(float closedLoopTime = 0.0f) const;
+
+    /**
+     * 輸出模型、建議增益與記錄的資料
+     * @param out 輸出目標 (例如 Serial)
+     * @param includeSamples 是否輸出每個取樣 (CSV)
+     */
+    void printReport(Print& out, bool includeSamples = false) const;
+};
+
+#endif // SYSTEM_ID_H
@@ -0,0 +1,195 @@
+/**
+ * TelemetryProtocol.cpp
+ * 二進位遙測協定實現
+ */
+
+#include "TelemetryProtocol.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+const TelemetryField TELEMETRY_BALANCE_FIELDS[TELEMETRY_BALANCE_FIELD_COUNT] = {
+    {"target_rpm", 0.1f},
+    {"current_rpm", 0.1f},
+    {"output", 1.0f},
+    {"pitch_deg", 0.01f},
+};
+
+namespace {
+
+void putU16(uint8_t* p, uint16_t v) {
+    p[0] = v & 0xFF;
+    p[1] = v >> 8;
+}
+
+void putU32(uint8_t* p, uint32_t v) {
+    for (int i = 0; i < 4; i++) p[i] = (v >> (8 * i)) & 0xFF;
+}
+
+uint16_t getU16(const uint8_t* p) {
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+uint32_t getU32(const uint8_t* p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+// 依比例量化並限幅到 int16
+int16_t quantize(float value, float scale) {
+    float raw = roundf(value / scale);
+    if (!(raw == raw)) return 0;  // NaN
+    if (raw > 32767.0f) return 32767;
+    if (raw < -32768.0f) return -32768;
+    return (int16_t)raw;
+}
+
+} // namespace
+
+// CRC-16/CCITT-FALSE
+uint16_t TelemetryProtocol::crc16(const uint8_t* data, size_t length, uint16_t crc) {
+    for (size_t i = 0; i < length; i++) {
+        crc ^= (uint16_t)data[i] << 8;
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (crc & 0x8000) ? (uint16_t)((crc << 1) ^ 0x1021) : (uint16_t)(crc << 1);
+        }
+    }
+    return crc;
+}
+
+// COBS 編碼：每段以「到下一個 0 的距離」開頭，最長 254 個非零位元組
+size_t TelemetryProtocol::cobsEncode(const uint8_t* in, size_t length, uint8_t* out) {
+    size_t codeIndex = 0;
+    size_t outIndex = 1;
+    uint8_t code = 1;
+
+    for (size_t i = 0; i < length; i++) {
+        if (in[i] == 0) {
+            out[codeIndex] = code;
+            codeIndex = outIndex++;
+            code = 1;
+        } else {
+            out[outIndex++] = in[i];
+            if (++code == 0xFF) {
+                out[codeIndex] = code;
+                codeIndex = outIndex++;
+                code = 1;
+            }
+        }
+    }
+    out[codeIndex] = code;
+    return outIndex;
+}
+
+// COBS 解碼
+size_t TelemetryProtocol::cobsDecode(const uint8_t* in, size_t length, uint8_t* out) {
+    size_t inIndex = 0;
+    size_t outIndex = 0;
+
+    while (inIndex < length) {
+        uint8_t code = in[inIndex++];
+        if (code == 0 || inIndex + code - 1 > length) {
+            return 0;
+        }
+        for (uint8_t i = 1; i < code; i++) {
+            out[outIndex++] = in[inIndex++];
+        }
+        // 不足 254 的段落代表原本有一個 0，最後一段除外
+        if (code != 0xFF && inIndex < length) {
+            out[outIndex++] = 0;
+        }
+    }
+    return outIndex;
+}
+
+// 組成並編碼一個幀
+size_t TelemetryProtocol::buildFrame(const TelemetryHeader& header, const uint8_t* payload,
+                                     size_t payloadLength, uint8_t* out) {
+    if (payloadLength > TELEMETRY_MAX_PAYLOAD) {
+        return 0;
+    }
+
+    uint8_t frame[TELEMETRY_MAX_FRAME];
+    frame[0] = header.version;
+    frame[1] = header.schema;
+    frame[2] = header.recordSize;
+    frame[3] = header.count;
+    putU32(frame + 4, header.firstSeq);
+    putU32(frame + 8, header.timestamp);
+    putU16(frame + 12, header.period);
+    memcpy(frame + TELEMETRY_HEADER_SIZE, payload, payloadLength);
+
+    size_t length = TELEMETRY_HEADER_SIZE + payloadLength;
+    putU16(frame + length, crc16(frame, length));
+    length += TELEMETRY_CRC_SIZE;
+
+    out[0] = 0;
+    size_t encoded = cobsEncode(frame, length, out + 1);
+    out[encoded + 1] = 0;
+    return encoded + 2;
+}
+
+// 解析已解碼的幀
+bool TelemetryProtocol::parseFrame(const uint8_t* frame, size_t length, TelemetryHeader& header,
+                                   const uint8_t*& payload, size_t& payloadLength) {
+    if (length < TELEMETRY_HEADER_SIZE + TELEMETRY_CRC_SIZE) {
+        return false;
+    }
+
+    size_t dataLength = length - TELEMETRY_CRC_SIZE;
+    if (crc16(frame, dataLength) != getU16(frame + dataLength)) {
+        return false;
+    }
+
+    header.version = frame[0];
+    header.schema = frame[1];
+    header.recordSize = frame[2];
+    header.count = frame[3];
+    header.firstSeq = getU32(frame + 4);
+    header.timestamp = getU32(frame + 8);
+    header.period = getU16(frame + 12);
+
+    payload = frame + TELEMETRY_HEADER_SIZE;
+    payloadLength = dataLength - TELEMETRY_HEADER_SIZE;
+
+    // 資料幀的長度必須與標頭一致；描述幀為純文字
+    if (header.schema != TELEMETRY_SCHEMA_DESCRIPTOR &&
+        payloadLength != (size_t)header.recordSize * header.count) {
+        return false;
+    }
+    return true;
+}
+
+// 取樣 → 線上記錄
+void TelemetryProtocol::packBalanceRecord(const TelemetrySample& sample, uint8_t* out) {
+    const float values[TELEMETRY_BALANCE_FIELD_COUNT] = {
+        sample.targetRpm, sample.currentRpm, (float)sample.output, sample.pitch
+    };
+    for (int i = 0; i < TELEMETRY_BALANCE_FIELD_COUNT; i++) {
+        putU16(out + 2 * i, (uint16_t)quantize(values[i], TELEMETRY_BALANCE_FIELDS[i].scale));
+    }
+}
+
+// 線上記錄 → 實際值
+void TelemetryProtocol::unpackBalanceRecord(const uint8_t* in, float* values) {
+    for (int i = 0; i < TELEMETRY_BALANCE_FIELD_COUNT; i++) {
+        values[i] = (int16_t)getU16(in + 2 * i) * TELEMETRY_BALANCE_FIELDS[i].scale;
+    }
+}
+
+// 格式描述文字
+size_t TelemetryProtocol::describeBalanceSchema(char* out, size_t size) {
+    if (size == 0) {
+        return 0;
+    }
+
+    int length = snprintf(out, size, "%d:", TELEMETRY_SCHEMA_BALANCE);
+    for (int i = 0; i < TELEMETRY_BALANCE_FIELD_COUNT && length > 0 && (size_t)length < size; i++) {
+        length += snprintf(out + length, size - length, "%s%s/i16/%g", i ? "," : "",
+                           TELEMETRY_BALANCE_FIELDS[i].name, TELEMETRY_BALANCE_FIELDS[i].scale);
+    }
+    if (length < 0) {
+        return 0;
+    }
+    return (size_t)length < size ? (size_t)length : size - 1;
+}
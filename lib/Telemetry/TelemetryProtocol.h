@@ -0,0 +1,137 @@
+/**
+ * TelemetryProtocol.h
+ * 二進位遙測協定：固定格式取樣記錄 + CRC-16 + COBS 分幀
+ *
+ * 幀格式 (COBS 編碼前，多位元組欄位皆為小端序):
+ *   [0]     version      協定版本 (TELEMETRY_VERSION)
+ *   [1]     schema       記錄格式 ID；0 為格式描述幀
+ *   [2]     recordSize   每筆記錄的位元組數
+ *   [3]     count        本幀的記錄數
+ *   [4..7]  firstSeq     第一筆記錄的序號，序號不連續代表中間有取樣被丟棄
+ *   [8..11] timestamp    第一筆記錄的取樣時間 (us)
+ *   [12..13] period      相鄰記錄的取樣間隔 (us)
+ *   [14..]  records      count * recordSize
+ *   [末 2]  crc          CRC-16/CCITT-FALSE，涵蓋標頭與記錄
+ * 編碼後的幀前後各有一個 0x00 分隔符，夾雜在串流中的文字輸出只會造成單幀 CRC 錯誤。
+ *
+ * 格式描述幀 (schema 0) 的內容為 ASCII 文字 "<schema>:<欄位>/<型別>/<比例>,..."，
+ * 例如 "1:target_rpm/i16/0.1,..."，解碼端可據此檢查自己的欄位表。
+ *
+ * 本檔只使用標準 C++，同時供韌體與主機端解碼器 (tools/telemetry_decode.cpp) 使用。
+ */
+
+#ifndef TELEMETRY_PROTOCOL_H
+#define TELEMETRY_PROTOCOL_H
+
+#include <cstddef>
+#include <cstdint>
+
+#define TELEMETRY_VERSION 1
+#define TELEMETRY_SCHEMA_DESCRIPTOR 0
+#define TELEMETRY_SCHEMA_BALANCE 1
+
+#define TELEMETRY_HEADER_SIZE 14
+#define TELEMETRY_CRC_SIZE 2
+#define TELEMETRY_MAX_RECORDS 16
+#define TELEMETRY_MAX_PAYLOAD 256
+
+// 未編碼幀的最大長度，以及 COBS 編碼後 (含兩個分隔符) 的最大長度
+#define TELEMETRY_MAX_FRAME (TELEMETRY_HEADER_SIZE + TELEMETRY_MAX_PAYLOAD + TELEMETRY_CRC_SIZE)
+#define TELEMETRY_MAX_ENCODED (TELEMETRY_MAX_FRAME + TELEMETRY_MAX_FRAME / 254 + 3)
+
+/**
+ * 平衡控制取樣 (韌體內部使用的完整數值)
+ */
+struct TelemetrySample {
+    uint32_t seq;          // 取樣序號
+    uint32_t timestamp;    // 取樣時間 (us)
+    float targetRpm;       // 輪速設定值
+    float currentRpm;      // 實際輪速
+    int16_t output;        // 馬達輸出
+    float pitch;           // 俯仰角 (度)
+};
+
+/**
+ * 記錄欄位描述：線上格式皆為 int16，實際值 = 原始值 * scale
+ */
+struct TelemetryField {
+    const char* name;
+    float scale;
+};
+
+// schema 1 的欄位順序與比例
+#define TELEMETRY_BALANCE_FIELD_COUNT 4
+#define TELEMETRY_BALANCE_RECORD_SIZE (TELEMETRY_BALANCE_FIELD_COUNT * 2)
+extern const TelemetryField TELEMETRY_BALANCE_FIELDS[TELEMETRY_BALANCE_FIELD_COUNT];
+
+/**
+ * 幀標頭
+ */
+struct TelemetryHeader {
+    uint8_t version;
+    uint8_t schema;
+    uint8_t recordSize;
+    uint8_t count;
+    uint32_t firstSeq;
+    uint32_t timestamp;
+    uint16_t period;
+};
+
+class TelemetryProtocol {
+public:
+    /**
+     * CRC-16/CCITT-FALSE (多項式 0x1021，初值 0xFFFF)
+     */
+    static uint16_t crc16(const uint8_t* data, size_t length, uint16_t crc = 0xFFFF);
+
+    /**
+     * COBS 編碼，輸出不含 0x00
+     * @param out 緩衝區大小至少 length + length / 254 + 1
+     * @return 編碼後長度
+     */
+    static size_t cobsEncode(const uint8_t* in, size_t length, uint8_t* out);
+
+    /**
+     * COBS 解碼 (輸入不含分隔符)
+     * @param out 緩衝區大小至少 length
+     * @return 解碼後長度，格式錯誤時返回 0
+     */
+    static size_t cobsDecode(const uint8_t* in, size_t length, uint8_t* out);
+
+    /**
+     * 組成一個完整幀 (標頭 + 內容 + CRC)，COBS 編碼並加上前後分隔符
+     * @param out 緩衝區大小至少 TELEMETRY_MAX_ENCODED
+     * @return 輸出長度，內容過長時返回 0
+     */
+    static size_t buildFrame(const TelemetryHeader& header, const uint8_t* payload,
+                             size_t payloadLength, uint8_t* out);
+
+    /**
+     * 解析一個已 COBS 解碼的幀並檢查 CRC 與長度
+     * @param payload 輸出：指向幀內的記錄資料
+     * @param payloadLength 輸出：記錄資料長度
+     * @return 幀有效返回true
+     */
+    static bool parseFrame(const uint8_t* frame, size_t length, TelemetryHeader& header,
+                           const uint8_t*& payload, size_t& payloadLength);
+
+    /**
+     * 將取樣轉為 schema 1 的線上記錄 (超出範圍的值會被限幅)
+     * @param out 至少 TELEMETRY_BALANCE_RECORD_SIZE 位元組
+     */
+    static void packBalanceRecord(const TelemetrySample& sample, uint8_t* out);
+
+    /**
+     * 將 schema 1 的線上記錄還原為實際值
+     * @param values 至少 TELEMETRY_BALANCE_FIELD_COUNT 個元素
+     */
+    static void unpackBalanceRecord(const uint8_t* in, float* values);
+
+    /**
+     * 產生 schema 1 的格式描述文字
+     * @return 文字長度 (不含結尾 '\0')
+     */
+    static size_t describeBalanceSchema(char* out, size_t size);
+};
+
+#endif // TELEMETRY_PROTOCOL_H
@@ -0,0 +1,117 @@
+/**
+ * TelemetryWriter.cpp
+ * 二進位遙測輸出實現
+ */
+
+#include "TelemetryWriter.h"
+
+TelemetryWriter::TelemetryWriter(Print* out, uint32_t samplePeriodMicros)
+    : out(out),
+      pendingCount(0),
+      samplePeriod(samplePeriodMicros > 0xFFFF ? 0xFFFF : samplePeriodMicros),
+      lastDescriptorTime(0),
+      descriptorInterval(1000),
+      framesSent(0),
+      samplesSent(0),
+      bytesSent(0)
+{
+}
+
+void TelemetryWriter::begin() {
+    pendingCount = 0;
+    writeDescriptor();
+}
+
+void TelemetryWriter::setSamplePeriod(uint32_t samplePeriodMicros) {
+    flush();
+    samplePeriod = samplePeriodMicros > 0xFFFF ? 0xFFFF : samplePeriodMicros;
+}
+
+void TelemetryWriter::setDescriptorInterval(unsigned long intervalMs) {
+    descriptorInterval = intervalMs;
+}
+
+// 送出格式描述幀
+void TelemetryWriter::writeDescriptor() {
+    char text[TELEMETRY_MAX_PAYLOAD];
+    size_t length = TelemetryProtocol::describeBalanceSchema(text, sizeof(text));
+
+    TelemetryHeader header = {};
+    header.version = TELEMETRY_VERSION;
+    header.schema = TELEMETRY_SCHEMA_DESCRIPTOR;
+
+    uint8_t encoded[TELEMETRY_MAX_ENCODED];
+    size_t size = TelemetryProtocol::buildFrame(header, (const uint8_t*)text, length, encoded);
+    bytesSent += out->write(encoded, size);
+    lastDescriptorTime = millis();
+}
+
+void TelemetryWriter::write(const TelemetrySample& sample) {
+    // 序號不連續 (中間有取樣被丟棄) 時先送出目前的幀，時間軸才能由標頭還原
+    if (pendingCount > 0 && sample.seq != pending[pendingCount - 1].seq + 1) {
+        flush();
+    }
+
+    pending[pendingCount++] = sample;
+    if (pendingCount == TELEMETRY_MAX_RECORDS) {
+        flush();
+    }
+}
+
+void TelemetryWriter::flush() {
+    if (descriptorInterval > 0 && millis() - lastDescriptorTime >= descriptorInterval) {
+        writeDescriptor();
+    }
+    if (pendingCount == 0) {
+        return;
+    }
+
+    uint8_t payload[TELEMETRY_MAX_RECORDS * TELEMETRY_BALANCE_RECORD_SIZE];
+    for (uint8_t i = 0; i < pendingCount; i++) {
+        TelemetryProtocol::packBalanceRecord(pending[i], payload + i * TELEMETRY_BALANCE_RECORD_SIZE);
+    }
+
+    TelemetryHeader header;
+    header.version = TELEMETRY_VERSION;
+    header.schema = TELEMETRY_SCHEMA_BALANCE;
+    header.recordSize = TELEMETRY_BALANCE_RECORD_SIZE;
+    header.count = pendingCount;
+    header.firstSeq = pending[0].seq;
+    header.timestamp = pending[0].timestamp;
+    header.period = samplePeriod;
+
+    uint8_t encoded[TELEMETRY_MAX_ENCODED];
+    size_t size = TelemetryProtocol::buildFrame(header, payload,
+                                                pendingCount * TELEMETRY_BALANCE_RECORD_SIZE, encoded);
+    bytesSent += out->write(encoded, size);
+    framesSent++;
+    samplesSent += pendingCount;
+    pendingCount = 0;
+}
+
+size_t TelemetryWriter::poll(TelemetryRing& ring) {
+    TelemetrySample batch[TELEMETRY_MAX_RECORDS];
+    size_t total = 0;
+    size_t count;
+
+    while ((count = ring.popBatch(batch, TELEMETRY_MAX_RECORDS)) > 0) {
+        for (size_t i = 0; i < count; i++) {
+            write(batch[i]);
+        }
+        total += count;
+    }
+    flush();
+    return total;
+}
+
+uint32_t TelemetryWriter::getFramesSent() const {
+    return framesSent;
+}
+
+uint32_t TelemetryWriter::getSamplesSent() const {
+    return samplesSent;
+}
+
+uint32_t TelemetryWriter::getBytesSent() const {
+    return bytesSent;
+}
@@ -0,0 +1,87 @@
+/**
+ * TelemetryWriter.h
+ * 將控制迴路的取樣打包成二進位遙測幀並寫到串口
+ *
+ * 功能概述:
+ * - 控制任務把 TelemetrySample 推入 TelemetryRing，遙測任務定期呼叫 poll() 讀出並送出
+ * - 連續序號的取樣合併成一幀 (最多 TELEMETRY_MAX_RECORDS 筆)，序號中斷時另起新幀
+ * - 啟動時與每隔一段時間送出格式描述幀，中途開始擷取的解碼端也能確認格式
+ * - 每筆記錄 8 位元組，16 筆一幀約 146 位元組；1 kHz 取樣約 9.2 KB/s，115200 baud 可以承載
+ */
+
+#ifndef TELEMETRY_WRITER_H
+#define TELEMETRY_WRITER_H
+
+#include <Arduino.h>
+#include "TelemetryProtocol.h"
+#include "SpscRing.h"
+
+// 控制核心 → 遙測核心的取樣緩衝區 (1 kHz 時可緩衝 256 ms)
+typedef SpscRing<TelemetrySample, 256> TelemetryRing;
+
+class TelemetryWriter {
+private:
+    Print* out;
+
+    TelemetrySample pending[TELEMETRY_MAX_RECORDS];
+    uint8_t pendingCount;
+    uint16_t samplePeriod;           // 標稱取樣間隔 (us)
+
+    unsigned long lastDescriptorTime;
+    unsigned long descriptorInterval;
+
+    uint32_t framesSent;
+    uint32_t samplesSent;
+    uint32_t bytesSent;
+
+    void writeDescriptor();
+
+public:
+    /**
+     * 建構函數
+     * @param out 輸出 (通常為 Serial)
+     * @param samplePeriodMicros 取樣間隔，寫入幀標頭供解碼端還原時間軸
+     */
+    TelemetryWriter(Print* out, uint32_t samplePeriodMicros);
+
+    /**
+     * 送出格式描述幀，切換到二進位模式時呼叫
+     */
+    void begin();
+
+    /**
+     * 設定取樣間隔
+     * @param samplePeriodMicros 取樣間隔 (us)
+     */
+    void setSamplePeriod(uint32_t samplePeriodMicros);
+
+    /**
+     * 設定格式描述幀的重送間隔
+     * @param intervalMs 間隔 (ms)，0 表示只在 begin() 時送出
+     */
+    void setDescriptorInterval(unsigned long intervalMs);
+
+    /**
+     * 加入一筆取樣，湊滿一幀或序號中斷時自動送出
+     * @param sample 取樣
+     */
+    void write(const TelemetrySample& sample);
+
+    /**
+     * 送出尚未成幀的取樣，並在到期時重送格式描述幀
+     */
+    void flush();
+
+    /**
+     * 讀出緩衝區中所有取樣並送出
+     * @param ring 取樣緩衝區 (此任務為唯一的消費者)
+     * @return 本次送出的取樣數
+     */
+    size_t poll(TelemetryRing& ring);
+
+    uint32_t getFramesSent() const;
+    uint32_t getSamplesSent() const;
+    uint32_t getBytesSent() const;
+};
+
+#endif // TELEMETRY_WRITER_H
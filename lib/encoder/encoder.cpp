@@ -1,7 +1,19 @@
 #include "encoder.h"
 
 // Initialize static member
-Encoder* Encoder::instances[2] = {nullptr, nullptr};
+Encoder* Encoder::_instances[ENCODER_MAX_INSTANCES] = {};
+int Encoder::_instanceCount = 0;
+bool Encoder::_pcntServiceInstalled = false;
+
+// Index: previous (A << 1 | B) << 2 | new (A << 1 | B). Same sign convention as the PCNT
+// channel modes: A changing to a level different from B counts up, B changing to the same
+// level as A counts up. Both channels changing at once means an edge was missed.
+DRAM_ATTR const int8_t Encoder::TRANSITIONS[16] = {
+     0, -1, +1, ENCODER_ILLEGAL,    // from 00
+    +1,  0, ENCODER_ILLEGAL, -1,    // from 01
+    -1, ENCODER_ILLEGAL,  0, +1,    // from 10
+    ENCODER_ILLEGAL, +1, -1,  0     // from 11
+};
 
 Encoder::Encoder(uint8_t pinA, uint8_t pinB, String name, int pulsesPerRev) {
     _pinA = pinA;
@@ -10,48 +22,232 @@ Encoder::Encoder(uint8_t pinA, uint8_t pinB, String name, int pulsesPerRev) {
     _pulsesPerRev = pulsesPerRev;
     
     _pulseCount = 0;
+    _lastCount = 0;
+    _positionOffset = 0;
     _rpm = 0.0;
-    _lastTime = 0;
-    _lastStateA = false;
-    _lastStateB = false;
+    _lastState = 0;
+    _illegalTransitions = 0;
     _direction = STOPPED;
     _inverted = false;
+    _debugOutput = false;
+    
+    _backend = ENCODER_BACKEND_ISR;
+    _pcntUnit = PCNT_UNIT_0;
+    _filterCycles = 800; // 10us at the 80MHz APB clock
+    _pcntWraps = 0;
+    _pcntSeenCount = 0;
+    _pcntLastWraps = 0;
+    _pcntLastRaw = 0;
     
-    // Add low-pass filter for RPM smoothing
-    _lastRPM = 0.0;
-    _filterCoef = 0.8; // Adjust this value between 0-1 (lower = more filtering)
+    _lastEdgeMicros = 0;
+    _refCount = 0;
+    _refEdgeMicros = 0;
+    _measuredRate = 0.0;
+    _countsPerSec = 0.0;
+    _measuredConfidence = 0.0;
+    _confidence = 0.0;
+    _velocityAge = 0;
+    _quietSinceMicros = 0;
+    _lastUpdateMicros = 0;
+    _minWindowMicros = 2000;
+    _stopTimeoutMicros = 200000;  // Below one count per 200ms (~0.7 RPM at 440 PPR) reads as stopped
+    
+    _snapshot = EncoderSnapshot();
+}
+
+void Encoder::begin(int encoderIndex, EncoderBackend backend) {
+    beginCounter(encoderIndex, backend);
+    
+    // Both channels share one handler that gets this encoder as its argument
+    if (_backend == ENCODER_BACKEND_ISR) {
+        attachInterruptArg(digitalPinToInterrupt(_pinA), encoderISR, this, CHANGE);
+        attachInterruptArg(digitalPinToInterrupt(_pinB), encoderISR, this, CHANGE);
+    }
 }
 
-void Encoder::begin(int encoderIndex) {
+void Encoder::beginCounter(int pcntUnit, EncoderBackend backend) {
     // Setup encoder pins as inputs with pull-up resistors
     pinMode(_pinA, INPUT_PULLUP);
     pinMode(_pinB, INPUT_PULLUP);
     
-    // Initialize last states
-    _lastStateA = digitalRead(_pinA);
-    _lastStateB = digitalRead(_pinB);
+    // Initialize last state
+    _lastState = (digitalRead(_pinA) << 1) | digitalRead(_pinB);
+    _illegalTransitions = 0;
+    
+    // Register once, repeated begin() calls keep the slot
+    bool registered = false;
+    for (int i = 0; i < _instanceCount; i++) {
+        registered = registered || _instances[i] == this;
+    }
+    if (!registered && _instanceCount < ENCODER_MAX_INSTANCES) {
+        _instances[_instanceCount++] = this;
+    }
+    
+    _backend = ENCODER_BACKEND_ISR;
+    if (backend == ENCODER_BACKEND_PCNT) {
+        if (beginPcnt(pcntUnit)) {
+            _backend = ENCODER_BACKEND_PCNT;
+        } else {
+            Serial.print(_name);
+            Serial.println(": PCNT setup failed, falling back to GPIO interrupts");
+        }
+    }
+    
+    _lastUpdateMicros = micros();
+    _lastEdgeMicros = _lastUpdateMicros;
+    _refEdgeMicros = _lastUpdateMicros;
+    _quietSinceMicros = _lastUpdateMicros;
+}
+
+bool Encoder::beginPcnt(int encoderIndex) {
+    if (encoderIndex < 0 || encoderIndex >= PCNT_UNIT_MAX) {
+        return false;
+    }
+    _pcntUnit = static_cast<pcnt_unit_t>(encoderIndex);
+    
+    // Channel 0 counts both edges of A, level of B decides the direction.
+    // Modes match TRANSITIONS: A changing to a level different from B counts up.
+    pcnt_config_t config = {};
+    config.unit = _pcntUnit;
+    config.channel = PCNT_CHANNEL_0;
+    config.pulse_gpio_num = _pinA;
+    config.ctrl_gpio_num = _pinB;
+    config.pos_mode = PCNT_COUNT_INC;
+    config.neg_mode = PCNT_COUNT_DEC;
+    config.lctrl_mode = PCNT_MODE_KEEP;
+    config.hctrl_mode = PCNT_MODE_REVERSE;
+    config.counter_h_lim = PCNT_COUNT_LIMIT;
+    config.counter_l_lim = -PCNT_COUNT_LIMIT;
+    if (pcnt_unit_config(&config) != ESP_OK) {
+        return false;
+    }
+    
+    // Channel 1 counts both edges of B, level of A decides the direction.
+    // B changing to the same level as A counts up.
+    config.channel = PCNT_CHANNEL_1;
+    config.pulse_gpio_num = _pinB;
+    config.ctrl_gpio_num = _pinA;
+    config.pos_mode = PCNT_COUNT_DEC;
+    config.neg_mode = PCNT_COUNT_INC;
+    if (pcnt_unit_config(&config) != ESP_OK) {
+        return false;
+    }
+    
+    pcnt_set_filter_value(_pcntUnit, _filterCycles);
+    pcnt_filter_enable(_pcntUnit);
+    
+    // The counter resets to 0 at either limit; the ISR carries the wrapped counts over
+    pcnt_event_enable(_pcntUnit, PCNT_EVT_H_LIM);
+    pcnt_event_enable(_pcntUnit, PCNT_EVT_L_LIM);
+    
+    pcnt_counter_pause(_pcntUnit);
+    pcnt_counter_clear(_pcntUnit);
+    _pcntWraps = 0;
+    _pcntSeenCount = 0;
+    _pcntLastWraps = 0;
+    _pcntLastRaw = 0;
+    
+    if (!_pcntServiceInstalled) {
+        esp_err_t err = pcnt_isr_service_install(0);
+        if (err != ESP_OK && err != ESP_ERR_INVALID_STATE) {
+            return false;
+        }
+        _pcntServiceInstalled = true;
+    }
+    if (pcnt_isr_handler_add(_pcntUnit, pcntOverflowISR, this) != ESP_OK) {
+        return false;
+    }
+    
+    pcnt_counter_resume(_pcntUnit);
+    return true;
+}
+
+int64_t Encoder::readPcntCount() const {
+    int32_t wraps;
+    int16_t count;
     
-    // Register this encoder instance for interrupt handling
-    if (encoderIndex >= 0 && encoderIndex < 2) {
-        instances[encoderIndex] = this;
+    for (int attempt = 0; attempt < 4; attempt++) {
+        // Retry if a limit event was carried over between the two reads
+        do {
+            wraps = _pcntWraps;
+            pcnt_get_counter_value(_pcntUnit, &count);
+        } while (wraps != _pcntWraps);
         
-        // Attach interrupts for encoder pins
-        if (encoderIndex == 0) {
-            attachInterrupt(digitalPinToInterrupt(_pinA), encoderISR0, CHANGE);
-            attachInterrupt(digitalPinToInterrupt(_pinB), encoderISR0, CHANGE);
-        } else if (encoderIndex == 1) {
-            attachInterrupt(digitalPinToInterrupt(_pinA), encoderISR1, CHANGE);
-            attachInterrupt(digitalPinToInterrupt(_pinB), encoderISR1, CHANGE);
+        // The counter resets at the limit before pcntOverflowISR() runs: in that gap the raw
+        // count jumps by about one limit while the wrap count has not changed yet. Re-read to
+        // give the interrupt time to land (assumes fewer than half a limit of counts between reads)
+        portENTER_CRITICAL(&_isrMux);
+        int32_t jump = (int32_t)count - _pcntLastRaw;
+        bool pending = wraps == _pcntLastWraps && abs(jump) > PCNT_COUNT_LIMIT / 2;
+        if (!pending) {
+            _pcntLastWraps = wraps;
+            _pcntLastRaw = count;
+        }
+        portEXIT_CRITICAL(&_isrMux);
+        
+        if (!pending) {
+            break;
+        }
+        if (attempt == 3) {
+            // Interrupt still held off (e.g. read from a critical section): count the wrap here
+            wraps += count < _pcntLastRaw ? 1 : -1;
         }
     }
     
-    _lastTime = millis();
+    return (int64_t)wraps * PCNT_COUNT_LIMIT + count;
+}
+
+int64_t Encoder::readCount() const {
+    if (_backend == ENCODER_BACKEND_PCNT) {
+        return readPcntCount();
+    }
+    
+    // 64-bit reads are not atomic on the ESP32
+    portENTER_CRITICAL(&_isrMux);
+    int64_t count = _pulseCount;
+    portEXIT_CRITICAL(&_isrMux);
+    return count;
+}
+
+void IRAM_ATTR Encoder::pcntOverflowISR(void* arg) {
+    Encoder* encoder = static_cast<Encoder*>(arg);
+    uint32_t status = 0;
+    pcnt_get_event_status(encoder->_pcntUnit, &status);
+    
+    if (status & PCNT_EVT_H_LIM) {
+        encoder->_pcntWraps++;
+    } else if (status & PCNT_EVT_L_LIM) {
+        encoder->_pcntWraps--;
+    }
+}
+
+void Encoder::setGlitchFilter(uint32_t nanoseconds) {
+    // Filter width is a 10-bit count of 80MHz APB cycles
+    uint32_t cycles = nanoseconds * 80 / 1000;
+    _filterCycles = cycles > 1023 ? 1023 : cycles;
+    
+    if (_backend == ENCODER_BACKEND_PCNT) {
+        pcnt_set_filter_value(_pcntUnit, _filterCycles);
+    }
+}
+
+EncoderBackend Encoder::getBackend() const {
+    return _backend;
+}
+
+void Encoder::setVelocityWindow(uint32_t minWindowMicros, uint32_t stopTimeoutMicros) {
+    _minWindowMicros = minWindowMicros;
+    _stopTimeoutMicros = stopTimeoutMicros;
 }
 
 void Encoder::setPulsesPerRev(int pulsesPerRev) {
     _pulsesPerRev = pulsesPerRev;
 }
 
+int Encoder::getPulsesPerRev() const {
+    return _pulsesPerRev;
+}
+
 void Encoder::setInverted(bool inverted) {
     _inverted = inverted;
 }
@@ -64,62 +260,180 @@ float Encoder::getRPM() const {
     return _rpm;
 }
 
+float Encoder::getVelocity() const {
+    return _rpm * static_cast<int>(_direction);
+}
+
 long Encoder::getPulseCount() const {
-    return _pulseCount;
+    return (long)(readCount() - _lastCount);
 }
 
 EncoderDirection Encoder::getDirection() const {
     return _direction;
 }
 
+float Encoder::getVelocityConfidence() const {
+    return _confidence;
+}
+
+uint32_t Encoder::getVelocityAge() const {
+    return _velocityAge;
+}
+
+uint32_t Encoder::getIllegalTransitions() const {
+    return _illegalTransitions;
+}
+
+int Encoder::getInstanceCount() {
+    return _instanceCount;
+}
+
+Encoder* Encoder::getInstance(int index) {
+    return (index >= 0 && index < _instanceCount) ? _instances[index] : nullptr;
+}
+
 String Encoder::getName() const {
     return _name;
 }
 
 void Encoder::resetPulseCount() {
-    _pulseCount = 0;
+    _lastCount = readCount();
+}
+
+int64_t Encoder::getPosition() const {
+    int64_t position = readCount() - _positionOffset;
+    return _inverted ? -position : position;
+}
+
+double Encoder::getPositionRadians() const {
+    return getPosition() * TWO_PI / _pulsesPerRev;
+}
+
+void Encoder::resetPosition() {
+    _positionOffset = readCount();
+}
+
+EncoderSnapshot Encoder::getSnapshot() const {
+    portENTER_CRITICAL(&_isrMux);
+    EncoderSnapshot snapshot = _snapshot;
+    portEXIT_CRITICAL(&_isrMux);
+    return snapshot;
 }
 
 void Encoder::update() {
-    // Calculate RPM based on pulse count
-    unsigned long currentTime = millis();
-    unsigned long timeElapsed = currentTime - _lastTime;
-    
-    // Only update if enough time has passed (at least 50ms for better accuracy)
-    if (timeElapsed >= 10) {
-        // Save the current pulse count to a local variable
-        volatile long currentPulseCount = _pulseCount;
-        
-        // Calculate RPM: (pulses / pulses_per_rev) * (60000 / timeElapsed)
-        // For high-resolution encoders, this formula needs to be precise
-        float instantRPM = (float)(abs(currentPulseCount) * 60000.0) / (_pulsesPerRev * timeElapsed);
-        
-        // Apply low-pass filter for smoothing
-        _rpm = _filterCoef * instantRPM + (1.0 - _filterCoef) * _lastRPM;
-        _lastRPM = _rpm;
-        
-        // Set direction based on pulse count, considering inversion
-        if (currentPulseCount == 0) {
-            _direction = STOPPED;
-        } else {
-            // Apply inversion if needed
-            bool isForward = (currentPulseCount > 0);
-            if (_inverted) {
-                isForward = !isForward;
+    uint32_t now = micros();
+    uint32_t interval = now - _lastUpdateMicros;
+    _lastUpdateMicros = now;
+    
+    // Take a coherent (count, newest edge time) pair
+    int64_t count;
+    uint32_t edgeMicros;
+    uint32_t timeResolution;
+    if (_backend == ENCODER_BACKEND_PCNT) {
+        // The counter has no edge timestamps: edges seen now happened since the previous
+        // update(), so stamp them at the middle of that interval
+        count = readPcntCount();
+        if (count != _pcntSeenCount) {
+            _lastEdgeMicros = now - interval / 2;
+            _quietSinceMicros = now;
+            _pcntSeenCount = count;
+        }
+        edgeMicros = _lastEdgeMicros;
+        timeResolution = interval;
+    } else {
+        portENTER_CRITICAL(&_isrMux);
+        count = _pulseCount;
+        edgeMicros = _lastEdgeMicros;
+        portEXIT_CRITICAL(&_isrMux);
+        timeResolution = 0;
+        _quietSinceMicros = edgeMicros;
     }
+    
+    long pulses = (long)(count - _lastCount);
+    _lastCount = count;
+    
+    // New estimate once the edges since the previous one span a full quadrature cycle
+    // (A/B duty and phase errors cancel) or the minimum window; with PCNT the span must
+    // also be long compared to the timestamp resolution
+    long edges = (long)(count - _refCount);
+    uint32_t span = edgeMicros - _refEdgeMicros;
+    bool ready;
+    if (timeResolution > 0) {
+        ready = span >= max(_minWindowMicros, 8 * timeResolution);
+    } else {
+        ready = span >= _minWindowMicros || labs(edges) >= 4;
+    }
+    
+    if (edgeMicros != _refEdgeMicros && ready) {
+        if (span > _stopTimeoutMicros) {
+            // First edge after standing still: only anchors the next estimate
+            _measuredRate = 0.0;
+            _measuredConfidence = 0.0;
+        } else {
+            // Zero when the edges cancelled out (direction reversal inside the span)
+            _measuredRate = edges * 1000000.0f / span;
             
-            _direction = isForward ? FORWARD : BACKWARD;
-}
-
-        // Reset the pulse count and update the last time
-        _pulseCount = 0;
-        _lastTime = currentTime;
-        
-        // Debug output for troubleshooting
+            // Edges covered relative to one quadrature cycle, reduced by the
+            // timestamp uncertainty relative to the span
+            _measuredConfidence = min(1.0f, labs(edges) / 4.0f) *
+                                  max(0.0f, 1.0f - (float)timeResolution / span);
+        }
+        _refCount = count;
+        _refEdgeMicros = edgeMicros;
+    }
+    
+    // Decay: if no edge arrived within one period of the last estimate, the wheel is
+    // slower than 1 count per elapsed time. The quiet time starts at the latest moment
+    // the newest edge can have happened, not at its mid-interval PCNT stamp, or every
+    // PCNT reading would be capped at 2 counts per update interval
+    _velocityAge = now - edgeMicros;
+    uint32_t quietTime = now - _quietSinceMicros;
+    _countsPerSec = _measuredRate;
+    float confidence = _measuredConfidence;
+    if (_velocityAge >= _stopTimeoutMicros) {
+        _countsPerSec = 0.0;
+        confidence = 0.0;
+    } else if (_measuredRate != 0.0f) {
+        float bound = 1000000.0f / max(quietTime, (uint32_t)1);
+        if (bound < fabsf(_measuredRate)) {
+            _countsPerSec = _measuredRate > 0 ? bound : -bound;
+            confidence *= bound / fabsf(_measuredRate);
+        }
+    }
+    _confidence = confidence;
+    
+    _rpm = fabsf(_countsPerSec) * 60.0f / _pulsesPerRev;
+    
+    // Set direction based on the estimate, considering inversion
+    if (_countsPerSec == 0.0f) {
+        _direction = STOPPED;
+    } else {
+        bool isForward = (_countsPerSec > 0);
+        if (_inverted) {
+            isForward = !isForward;
+        }
+        _direction = isForward ? FORWARD : BACKWARD;
+    }
+    
+    // Publish position and velocity from the same count read
+    int sign = _inverted ? -1 : 1;
+    EncoderSnapshot snapshot;
+    snapshot.position = sign * (count - _positionOffset);
+    snapshot.positionRad = snapshot.position * TWO_PI / _pulsesPerRev;
+    snapshot.velocity = sign * _countsPerSec * 60.0f / _pulsesPerRev;
+    snapshot.velocityRadPerSec = sign * _countsPerSec * (float)TWO_PI / _pulsesPerRev;
+    snapshot.confidence = _confidence;
+    snapshot.timestamp = now;
+    portENTER_CRITICAL(&_isrMux);
+    _snapshot = snapshot;
+    portEXIT_CRITICAL(&_isrMux);
+    
+    // Debug output for troubleshooting (off by default: update() runs in the control loop)
+    if (_debugOutput) {
         Serial.print(">"); Serial.print(_name); Serial.print("_pulses:");
-        Serial.println(currentPulseCount);
-        Serial.print(">"); Serial.print(_name); Serial.print("_timeElapsed:");
-        Serial.println(timeElapsed);
+        Serial.println(pulses);
+        Serial.print(">"); Serial.print(_name); Serial.print("_velocity_age:");
+        Serial.println(_velocityAge);
     }
 }
 
@@ -129,43 +443,45 @@ void Encoder::teleplotOutput() const {
     
     Serial.print(">"); Serial.print(_name); Serial.print("_direction:");
     Serial.println(static_cast<int>(_direction));
+    
+    Serial.print(">"); Serial.print(_name); Serial.print("_confidence:");
+    Serial.println(_confidence);
+    
+    if (_backend == ENCODER_BACKEND_ISR) {
+        Serial.print(">"); Serial.print(_name); Serial.print("_illegal:");
+        Serial.println(_illegalTransitions);
     }
+}
 
-void Encoder::handleEncoderInterrupt() {
-    // Read current states
-    bool stateA = digitalRead(_pinA);
-    bool stateB = digitalRead(_pinB);
-    
-    // Quadrature decoding logic
-    if (stateA != _lastStateA || stateB != _lastStateB) {
-        // Determine direction based on the sequence of signals
-        if (stateA != _lastStateA) {
-            if (stateA == stateB) {
-                _pulseCount--;
-            } else {
-                _pulseCount++;
-}
-        } else { // stateB changed
-            if (stateA == stateB) {
-                _pulseCount++;
-            } else {
-                _pulseCount--;
-            }
-        }
-        
-        _lastStateA = stateA;
-        _lastStateB = stateB;
-    }
+void Encoder::setDebugOutput(bool enabled) {
+    _debugOutput = enabled;
 }
 
-void Encoder::encoderISR0() {
-    if (instances[0] != nullptr) {
-        instances[0]->handleEncoderInterrupt();
-    }
+void IRAM_ATTR Encoder::handleEncoderInterrupt() {
+    uint32_t now = micros();
+    recordEdge(fastRead(_pinA), fastRead(_pinB), now);
 }
 
-void Encoder::encoderISR1() {
-    if (instances[1] != nullptr) {
-        instances[1]->handleEncoderInterrupt();
+void IRAM_ATTR Encoder::recordEdge(bool stateA, bool stateB, uint32_t now) {
+    uint8_t state = (stateA << 1) | stateB;
+    int8_t step = TRANSITIONS[(_lastState << 2) | state];
+    if (step == 0) {
+        return;  // Glitch that settled before the read, or the other channel's interrupt already handled it
+    }
+    _lastState = state;
+    
+    if (step == ENCODER_ILLEGAL) {
+        // The direction of the missed edge is unknown: resynchronise without counting
+        _illegalTransitions++;
+        return;
     }
-}
\ No newline at end of file
+    
+    portENTER_CRITICAL_ISR(&_isrMux);
+    _pulseCount += step;
+    _lastEdgeMicros = now;
+    portEXIT_CRITICAL_ISR(&_isrMux);
+}
+
+void IRAM_ATTR Encoder::encoderISR(void* arg) {
+    static_cast<Encoder*>(arg)->handleEncoderInterrupt();
+}
@@ -2,6 +2,8 @@
 #define ENCODER_H
 
 #include <Arduino.h>
+#include <driver/pcnt.h>
+#include "FastGpio.h"
 
 // Direction enum for standardized direction values
 enum EncoderDirection {
@@ -10,59 +12,181 @@ enum EncoderDirection {
     FORWARD = 1
 };
 
+// Coherent encoder state captured by one update()
+struct EncoderSnapshot {
+    int64_t position;         // Accumulated counts since begin(), inversion applied
+    double positionRad;       // Same position in wheel radians
+    float velocity;           // Signed speed (RPM), inversion applied
+    float velocityRadPerSec;  // Same speed in rad/s
+    float confidence;         // See getVelocityConfidence()
+    uint32_t timestamp;       // micros() at the count read
+};
+
+// Maximum number of encoders that can be begun at the same time
+#ifndef ENCODER_MAX_INSTANCES
+#define ENCODER_MAX_INSTANCES 8
+#endif
+
+// Counting backend, selected per instance in begin()
+enum EncoderBackend {
+    ENCODER_BACKEND_ISR = 0,   // GPIO CHANGE interrupt on both channels, CPU cost per edge
+    ENCODER_BACKEND_PCNT = 1   // ESP32 pulse counter peripheral in x4 quadrature mode, CPU cost per read
+};
+
 class Encoder {
 private:
     uint8_t _pinA;        // Encoder channel A pin
     uint8_t _pinB;        // Encoder channel B pin
     String _name;         // Encoder name for identification
     
-    volatile long _pulseCount;    // Encoder pulse count
+    volatile int64_t _pulseCount; // Running pulse count (ISR backend)
+    int64_t _lastCount;   // Running count at the previous update()
+    int64_t _positionOffset;      // Count that resetPosition() made position zero
     int _pulsesPerRev;    // Pulses per revolution for encoder
     float _rpm;           // Calculated RPM
-    float _lastRPM;       // Previous RPM for filtering
-    float _filterCoef;    // Low-pass filter coefficient
-    unsigned long _lastTime;      // Last time speed was calculated
     
-    // For direction detection
-    volatile bool _lastStateA;
-    volatile bool _lastStateB;
+    // M/T velocity estimation: edge count divided by the time between the first and last edge
+    volatile uint32_t _lastEdgeMicros;   // Timestamp of the most recent edge
+    mutable portMUX_TYPE _isrMux = portMUX_INITIALIZER_UNLOCKED;
+    int64_t _refCount;              // Count at the last edge of the previous estimate
+    uint32_t _refEdgeMicros;      // Timestamp of that edge
+    float _measuredRate;          // Signed counts/s from the last estimate, before decay
+    float _countsPerSec;          // Signed counts/s reported by update()
+    float _measuredConfidence;    // Confidence of the last estimate, before decay
+    float _confidence;            // 0..1, see getVelocityConfidence()
+    uint32_t _velocityAge;        // Time from the newest edge to the last update() (us)
+    uint32_t _quietSinceMicros;   // Latest time the newest edge can have happened (PCNT: the update that saw it)
+    uint32_t _lastUpdateMicros;   // Time of the previous update()
+    uint32_t _minWindowMicros;    // Minimum edge-to-edge span of one estimate
+    uint32_t _stopTimeoutMicros;  // Report zero after this long without edges
+    
+    EncoderSnapshot _snapshot;    // Written by update() under _isrMux
+    
+    // Quadrature state (A << 1 | B) at the previous edge (ISR backend)
+    volatile uint8_t _lastState;
+    volatile uint32_t _illegalTransitions;  // Edges where both channels changed at once
     EncoderDirection _direction;  // Direction using the enum
     
     bool _inverted;       // Whether to invert the direction reading
+    bool _debugOutput;    // Print raw pulse/window values on every update
+    
+    // PCNT backend
+    EncoderBackend _backend;      // Active counting backend
+    pcnt_unit_t _pcntUnit;        // Pulse counter unit used by this encoder
+    uint16_t _filterCycles;       // Glitch filter width in APB clock cycles
+    volatile int32_t _pcntWraps;  // Net counter limit events (+1 at the high limit, -1 at the low)
+    int64_t _pcntSeenCount;         // Count seen by the previous update(), for edge timestamps
+    mutable int32_t _pcntLastWraps; // _pcntWraps and raw counter at the previous consistent read,
+    mutable int16_t _pcntLastRaw;   // to spot a limit reset whose interrupt has not run yet
+    
+    static const int16_t PCNT_COUNT_LIMIT = 30000;  // Hardware counter wraps to 0 at +/- this value
+    static bool _pcntServiceInstalled;
+    
+    // Count change for each (previous state << 2 | new state), ENCODER_ILLEGAL when both channels changed.
+    // Read on every edge by the ISR, so it lives in DRAM rather than flash
+    static const int8_t ENCODER_ILLEGAL = 2;
+    static const int8_t TRANSITIONS[16];
+    
+    // Every begun encoder, in begin() order
+    static Encoder* _instances[ENCODER_MAX_INSTANCES];
+    static int _instanceCount;
+    
+    bool beginPcnt(int encoderIndex);
+    int64_t readPcntCount() const;
+    int64_t readCount() const;
+    static void IRAM_ATTR pcntOverflowISR(void* arg);
+    
+protected:
+    // Pins, backend selection and counter setup shared by begin() and PinnedEncoder::begin();
+    // the caller attaches the GPIO interrupts if the ISR backend is active afterwards
+    void beginCounter(int pcntUnit, EncoderBackend backend);
+    
+    // Quadrature decoding of one GPIO interrupt (ISR backend): full x4, one table lookup per edge
+    void IRAM_ATTR recordEdge(bool stateA, bool stateB, uint32_t now);
+    
+    // GPIO interrupt handler, arg is the Encoder (attachInterruptArg)
+    static void IRAM_ATTR encoderISR(void* arg);
     
 public:
     Encoder(uint8_t pinA, uint8_t pinB, String name, int pulsesPerRev = 11);
     
     // Setup functions
-    void begin(int encoderIndex);
+    // ISR backend: encoderIndex is not used, any number of encoders can share the GPIO interrupt
+    // PCNT backend: encoderIndex selects the pulse counter unit (0 to PCNT_UNIT_MAX - 1);
+    // falls back to the ISR backend if the unit cannot be configured
+    void begin(int encoderIndex, EncoderBackend backend = ENCODER_BACKEND_ISR);
     void setPulsesPerRev(int pulsesPerRev);
+    int getPulsesPerRev() const;
+    
+    // PCNT glitch filter: pulses shorter than this are ignored (max ~12.7us, call before begin)
+    void setGlitchFilter(uint32_t nanoseconds);
+    EncoderBackend getBackend() const;
     
     // Direction control
     void setInverted(bool inverted);
     bool isInverted() const;
     
+    // Velocity estimator tuning: an estimate spans at least one quadrature cycle (4 edges)
+    // or minWindowMicros, and the speed reads 0 after stopTimeoutMicros without edges
+    void setVelocityWindow(uint32_t minWindowMicros, uint32_t stopTimeoutMicros);
+    
     // Status functions
-    float getRPM() const;
-    long getPulseCount() const;
+    float getRPM() const;                  // Speed magnitude, sign in getDirection()
+    float getVelocity() const;             // Signed speed (RPM), inversion applied
+    long getPulseCount() const;            // Pulses since the last update()
     EncoderDirection getDirection() const;
+    float getVelocityConfidence() const;   // 1 = full quadrature cycle with exact edge times, 0 = stopped/unknown
+    uint32_t getVelocityAge() const;       // us between the newest edge and the last update()
+    uint32_t getIllegalTransitions() const; // ISR backend: edges missed because both channels changed (not counted)
     void resetPulseCount();
+    
+    // Position: accumulated live from the counter, never reset by update()
+    int64_t getPosition() const;           // Counts, inversion applied
+    double getPositionRadians() const;
+    void resetPosition();
+    
+    // Position, velocity and timestamp from the last update(), copied atomically
+    EncoderSnapshot getSnapshot() const;
     String getName() const;
     
-    // Update function to be called in the loop
+    // Update function to be called from the control loop (no minimum interval)
     void update();
     
     // Utility functions
     void teleplotOutput() const;
+    void setDebugOutput(bool enabled);
     
-    // Encoder interrupt handlers
-    void handleEncoderInterrupt();
+    // Encoder interrupt handler
+    void IRAM_ATTR handleEncoderInterrupt();
     
-    // Static function to handle encoder interrupts
-    static void encoderISR0();
-    static void encoderISR1();
+    // Registered encoders (every instance that called begin())
+    static int getInstanceCount();
+    static Encoder* getInstance(int index);
+};
+
+// Encoder with its pins fixed at compile time. The pins are checked by static_assert, and the
+// ISR backend reads both channels with constant register masks instead of the per-instance pins.
+template <uint8_t PIN_A, uint8_t PIN_B>
+class PinnedEncoder : public Encoder {
+    static_assert(PIN_A != PIN_B, "PinnedEncoder: channels A and B must be different pins");
+    
+private:
+    static void IRAM_ATTR isr(void* arg) {
+        uint32_t now = micros();
+        static_cast<PinnedEncoder*>(arg)->recordEdge(FastPin<PIN_A>::read(), FastPin<PIN_B>::read(), now);
+    }
+    
+public:
+    PinnedEncoder(String name, int pulsesPerRev = 11) : Encoder(PIN_A, PIN_B, name, pulsesPerRev) {}
     
-    // Pointer to encoder instances for ISR
-    static Encoder* instances[2];
+    // PCNT backend: pcntUnit selects the pulse counter unit, not used by the ISR backend
+    void begin(int pcntUnit, EncoderBackend backend = ENCODER_BACKEND_ISR) {
+        beginCounter(pcntUnit, backend);
+        if (getBackend() == ENCODER_BACKEND_ISR) {
+            attachInterruptArg(digitalPinToInterrupt(PIN_A), isr, this, CHANGE);
+            attachInterruptArg(digitalPinToInterrupt(PIN_B), isr, this, CHANGE);
+        }
+    }
 };
 
 #endif // ENCODER_H
\ No newline at end of file
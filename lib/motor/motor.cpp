@@ -8,75 +8,287 @@ Motor::Motor(uint8_t pwmPin, uint8_t ain1Pin, uint8_t ain2Pin, uint8_t stbyPin,
     _name = name;
     
     _speed = 0;
+    _duty = 0.0;
     _isRunning = false;
+    
+    _backend = MOTOR_PWM_ANALOG;
+    _ledcChannel = 0;
+    _frequency = MOTOR_PWM_FREQUENCY;
+    _resolutionBits = MOTOR_PWM_RESOLUTION;
+    _maxDuty = 255;
+    _dither = false;
+    _ditherError = 0.0;
+    
+    memset(&_compensation, 0, sizeof(_compensation));
+    _compensationEnabled = false;
+    
+    _writtenDuty = 0;
+    _writtenAin1 = LOW;
+    _writtenAin2 = LOW;
+    _directionWriter = nullptr;
 }
 
-void Motor::begin() {
+void Motor::begin(MotorPwmBackend backend, uint8_t ledcChannel) {
     // Setup TB6612 control pins
     pinMode(_pwmPin, OUTPUT);
     pinMode(_ain1Pin, OUTPUT);
     pinMode(_ain2Pin, OUTPUT);
     pinMode(_stbyPin, OUTPUT);
     
-    // Set initial state
+    _backend = MOTOR_PWM_ANALOG;
+    _maxDuty = 255;
+    if (backend == MOTOR_PWM_LEDC) {
+        // ledcSetup returns 0 when the clock cannot reach this frequency at this resolution
+        if (ledcSetup(ledcChannel, _frequency, _resolutionBits) != 0) {
+            ledcAttachPin(_pwmPin, ledcChannel);
+            _backend = MOTOR_PWM_LEDC;
+            _ledcChannel = ledcChannel;
+            _maxDuty = 1UL << _resolutionBits;
+        } else {
+            Serial.print(_name);
+            Serial.println(": LEDC setup failed, falling back to analogWrite");
+        }
+    }
+    
+    // Set initial state (written unconditionally, the pin cache starts from here)
     digitalWrite(_stbyPin, HIGH);  // Disable standby
-    analogWrite(_pwmPin, 0);       // Set speed to 0
+    if (_backend == MOTOR_PWM_LEDC) {
+        ledcWrite(_ledcChannel, 0);
+    } else {
+        analogWrite(_pwmPin, 0);   // Set speed to 0
+    }
     digitalWrite(_ain1Pin, LOW);   // Set direction
     digitalWrite(_ain2Pin, LOW);   // Set direction
+    _writtenDuty = 0;
+    _writtenAin1 = LOW;
+    _writtenAin2 = LOW;
+    _ditherError = 0.0;
+    
+    loadCompensation();
+}
+
+void Motor::setPwmConfig(uint32_t frequency, uint8_t resolutionBits) {
+    if (frequency > 0) {
+        _frequency = frequency;
+    }
+    if (resolutionBits >= 1 && resolutionBits <= 14) {
+        _resolutionBits = resolutionBits;
+    }
+}
+
+MotorPwmBackend Motor::getBackend() const {
+    return _backend;
+}
+
+uint32_t Motor::getMaxDuty() const {
+    return _maxDuty;
+}
+
+void Motor::setDither(bool enabled) {
+    _dither = enabled;
+    _ditherError = 0.0;
 }
 
 void Motor::setSpeed(int speed) {
     // Constrain speed to valid range
     speed = constrain(speed, -255, 255);
-    _speed = speed;
+    setDuty(speed / 255.0f);
+}
+
+void Motor::setDuty(float duty) {
+    _duty = constrain(duty, -1.0f, 1.0f);
+    _speed = (int)lroundf(_duty * 255.0f);
     
     if (!_isRunning) {
         return;
     }
     
+    applyDuty();
+}
+
+void Motor::applyDuty() {
+    float magnitude = fabsf(_duty);
+    if (_compensationEnabled) {
+        magnitude = compensate(magnitude, _duty < 0);
+    }
+    magnitude *= _maxDuty;
+    uint32_t raw;
+    if (_duty == 0.0f) {
+        raw = 0;
+        _ditherError = 0.0;
+    } else if (_dither) {
+        // Error diffusion: the truncated remainder accumulates until it is worth one LSB
+        raw = (uint32_t)magnitude;
+        _ditherError += magnitude - raw;
+        if (_ditherError >= 1.0f) {
+            raw++;
+            _ditherError -= 1.0f;
+        }
+    } else {
+        raw = (uint32_t)lroundf(magnitude);
+    }
+    if (raw > _maxDuty) {
+        raw = _maxDuty;
+    }
+    
     // Set direction based on speed sign
-    if (speed > 0) {
+    if (_duty > 0) {
         // 正向旋轉
-        digitalWrite(_ain1Pin, HIGH);
-        digitalWrite(_ain2Pin, LOW);
-        analogWrite(_pwmPin, speed);
-    } else if (speed < 0) {
+        writeDirection(HIGH, LOW);
+    } else if (_duty < 0) {
         // 反向旋轉
-        digitalWrite(_ain1Pin, LOW);
-        digitalWrite(_ain2Pin, HIGH);
-        analogWrite(_pwmPin, -speed);
+        writeDirection(LOW, HIGH);
     } else {
         // 速度為0時，將兩個方向引腳都設為低電平，實現滑行停止
-        digitalWrite(_ain1Pin, LOW);
-        digitalWrite(_ain2Pin, LOW);
-        analogWrite(_pwmPin, 0);
+        writeDirection(LOW, LOW);
+    }
+    writeDuty(raw);
+}
+
+// Linear command magnitude (0..1) -> duty magnitude through the direction's table
+float Motor::compensate(float magnitude, bool reverse) const {
+    if (magnitude < MOTOR_COMP_ZERO) {
+        return 0.0;
+    }
+    const uint16_t* table = reverse ? _compensation.reverse : _compensation.forward;
+    float position = magnitude * (MOTOR_COMP_POINTS - 1);
+    int index = (int)position;
+    if (index >= MOTOR_COMP_POINTS - 1) {
+        return table[MOTOR_COMP_POINTS - 1] / 65535.0f;
+    }
+    float fraction = position - index;
+    return (table[index] + (table[index + 1] - table[index]) * fraction) / 65535.0f;
+}
+
+bool Motor::setCompensation(const MotorCompensation& table) {
+    if (table.version != MOTOR_COMP_VERSION) {
+        return false;
+    }
+    // Tables must be non-decreasing, otherwise the inverse is not a function
+    for (int i = 1; i < MOTOR_COMP_POINTS; i++) {
+        if (table.forward[i] < table.forward[i - 1] || table.reverse[i] < table.reverse[i - 1]) {
+            return false;
+        }
     }
+    _compensation = table;
+    _compensationEnabled = true;
+    if (_isRunning) {
+        applyDuty();
+    }
+    return true;
+}
+
+void Motor::clearCompensation() {
+    memset(&_compensation, 0, sizeof(_compensation));
+    _compensationEnabled = false;
+    if (_isRunning) {
+        applyDuty();
+    }
+}
+
+void Motor::setCompensationEnabled(bool enabled) {
+    _compensationEnabled = enabled && _compensation.version == MOTOR_COMP_VERSION;
+    if (_isRunning) {
+        applyDuty();
+    }
+}
+
+bool Motor::hasCompensation() const {
+    return _compensation.version == MOTOR_COMP_VERSION;
 }
+
+const MotorCompensation& Motor::getCompensation() const {
+    return _compensation;
+}
+
+String Motor::compensationKey() const {
+    // NVS keys are limited to 15 characters
+    String key = "comp_" + _name;
+    return key.substring(0, 15);
+}
+
+bool Motor::loadCompensation() {
+    Preferences preferences;
+    if (!preferences.begin("motor", true)) {
+        return false;
+    }
+    MotorCompensation table;
+    String key = compensationKey();
+    bool ok = preferences.getBytesLength(key.c_str()) == sizeof(table) &&
+              preferences.getBytes(key.c_str(), &table, sizeof(table)) == sizeof(table);
+    preferences.end();
+    return ok && setCompensation(table);
+}
+
+bool Motor::saveCompensation() const {
+    if (!hasCompensation()) {
+        return false;
+    }
+    Preferences preferences;
+    if (!preferences.begin("motor", false)) {
+        return false;
+    }
+    String key = compensationKey();
+    bool ok = preferences.putBytes(key.c_str(), &_compensation, sizeof(_compensation)) == sizeof(_compensation);
+    preferences.end();
+    return ok;
+}
+
+// Pin writes go through these two, skipping values already on the pins
+void Motor::writeDuty(uint32_t raw) {
+    if (raw == _writtenDuty) {
+        return;
+    }
+    if (_backend == MOTOR_PWM_LEDC) {
+        ledcWrite(_ledcChannel, raw);
+    } else {
+        analogWrite(_pwmPin, raw);
+    }
+    _writtenDuty = raw;
+}
+
+void Motor::writeDirection(int ain1, int ain2) {
+    if (_directionWriter != nullptr) {
+        if (ain1 != _writtenAin1 || ain2 != _writtenAin2) {
+            _directionWriter(ain1, ain2);
+            _writtenAin1 = ain1;
+            _writtenAin2 = ain2;
+        }
+        return;
+    }
+    if (ain1 != _writtenAin1) {
+        digitalWrite(_ain1Pin, ain1);
+        _writtenAin1 = ain1;
+    }
+    if (ain2 != _writtenAin2) {
+        digitalWrite(_ain2Pin, ain2);
+        _writtenAin2 = ain2;
+    }
+}
+
 void Motor::setRunning(bool isRunning) {
     _isRunning = isRunning;
     
     if (isRunning) {
         digitalWrite(_stbyPin, HIGH);  // Disable standby
-        setSpeed(_speed);              // Apply current speed
+        applyDuty();                   // Apply current speed
     } else {
         stop();
     }
 }
 
 void Motor::stop() {
-    analogWrite(_pwmPin, 0);
-    digitalWrite(_ain1Pin, LOW);
-    digitalWrite(_ain2Pin, LOW);
+    writeDuty(0);
+    writeDirection(LOW, LOW);
 }
 
 void Motor::brake() {
-    analogWrite(_pwmPin, 255);
-    digitalWrite(_ain1Pin, LOW);
-    digitalWrite(_ain2Pin, LOW);
+    writeDuty(_maxDuty);
+    writeDirection(LOW, LOW);
 }
 
 void Motor::coast() {
-    analogWrite(_pwmPin, 0);
+    writeDuty(0);
     digitalWrite(_stbyPin, LOW);  // Enable standby
 }
 
@@ -84,6 +296,10 @@ int Motor::getSpeed() const {
     return _speed;
 }
 
+float Motor::getDuty() const {
+    return _duty;
+}
+
 String Motor::getName() const {
     return _name;
 }
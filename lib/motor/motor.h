@@ -2,6 +2,31 @@
 #define MOTOR_H
 
 #include <Arduino.h>
+#include <Preferences.h>
+#include "FastGpio.h"
+
+// PWM backend, selected in begin()
+enum MotorPwmBackend {
+    MOTOR_PWM_ANALOG = 0,   // analogWrite: 8-bit, core default frequency (audible on the TB6612)
+    MOTOR_PWM_LEDC = 1      // LEDC channel driven directly at the configured frequency and resolution
+};
+
+// LEDC defaults: 20 kHz is above hearing, and 10 bits is the finest resolution
+// that leaves margin at that frequency (bits <= log2(80 MHz / frequency))
+#define MOTOR_PWM_FREQUENCY 20000
+#define MOTOR_PWM_RESOLUTION 10
+
+// Deadband/nonlinearity compensation: inverse lookup table from a linear command to the duty
+// that produces it, one table per direction, interpolated linearly between points
+#define MOTOR_COMP_POINTS 17
+#define MOTOR_COMP_VERSION 1
+#define MOTOR_COMP_ZERO 0.002f    // Commands below this magnitude output 0 instead of the breakaway duty
+
+struct MotorCompensation {
+    uint16_t version;                       // MOTOR_COMP_VERSION, other values are rejected
+    uint16_t forward[MOTOR_COMP_POINTS];    // Duty x 65535 for command i / (MOTOR_COMP_POINTS - 1)
+    uint16_t reverse[MOTOR_COMP_POINTS];    // Point 0 is the breakaway duty (deadband edge)
+};
 
 class Motor {
 private:
@@ -10,32 +35,106 @@ private:
     uint8_t _ain1Pin;     // Direction control 1
     uint8_t _ain2Pin;     // Direction control 2
     uint8_t _stbyPin;     // Standby pin
-    
+
     // Motor properties
     String _name;         // Motor name for identification
-    int _speed;           // Current speed setting (-255 to 255)
+    int _speed;           // Current speed setting (-255 to 255), rounded from _duty
+    float _duty;          // Current duty command (-1.0 to 1.0)
     bool _isRunning;      // Motor running state
-    
+
+    // PWM backend
+    MotorPwmBackend _backend;     // Active PWM backend
+    uint8_t _ledcChannel;         // LEDC channel used by this motor
+    uint32_t _frequency;          // LEDC frequency (Hz)
+    uint8_t _resolutionBits;      // LEDC resolution
+    uint32_t _maxDuty;            // Raw duty for 100% (255 for analogWrite, 2^bits for LEDC)
+    bool _dither;                 // Carry the sub-LSB remainder into later writes
+    float _ditherError;           // Accumulated remainder, in raw duty units
+
+    // Compensation (see MotorCompensation), applied to the command before the duty is computed
+    MotorCompensation _compensation;
+    bool _compensationEnabled;
+
+    // Last values written to the pins, so unchanged commands skip the writes
+    uint32_t _writtenDuty;
+    int _writtenAin1;
+    int _writtenAin2;
+
+    void writeDuty(uint32_t raw);
+    void writeDirection(int ain1, int ain2);
+    void applyDuty();
+    float compensate(float magnitude, bool reverse) const;
+    String compensationKey() const;
+
+protected:
+    // Writes both direction pins at once; PinnedMotor sets it to direct register writes,
+    // nullptr uses digitalWrite() on the pins given to the constructor
+    void (*_directionWriter)(int ain1, int ain2);
+
 public:
     Motor(uint8_t pwmPin, uint8_t ain1Pin, uint8_t ain2Pin, uint8_t stbyPin, String name);
-    
+
     // Setup functions
-    void begin();
-    
+    // LEDC backend: ledcChannel selects the channel (one per motor);
+    // falls back to analogWrite if the frequency/resolution pair cannot be configured.
+    // Loads a stored compensation table for this motor's name if one exists
+    void begin(MotorPwmBackend backend = MOTOR_PWM_ANALOG, uint8_t ledcChannel = 0);
+
+    // LEDC frequency and resolution (call before begin)
+    void setPwmConfig(uint32_t frequency, uint8_t resolutionBits);
+    MotorPwmBackend getBackend() const;
+    uint32_t getMaxDuty() const;
+
+    // Error-diffusion dithering of the part of the duty below one LSB; the average
+    // over consecutive setDuty() calls matches the float command
+    void setDither(bool enabled);
+
+    // Compensation table: set/clear, enable, and persist in NVS (namespace "motor", key per motor name)
+    bool setCompensation(const MotorCompensation& table);
+    void clearCompensation();
+    void setCompensationEnabled(bool enabled);  // Keeps the table; used while characterizing
+    bool hasCompensation() const;
+    const MotorCompensation& getCompensation() const;
+    bool loadCompensation();
+    bool saveCompensation() const;
+
     // Control functions
-    void setSpeed(int speed);
+    void setSpeed(int speed);       // -255 to 255
+    void setDuty(float duty);       // -1.0 to 1.0, full resolution of the backend, compensated if enabled
     void setRunning(bool isRunning);
     void stop();
     void brake();
     void coast();
-    
+
     // Status functions
     int getSpeed() const;
+    float getDuty() const;
     String getName() const;
-    
+
     // Utility functions
     void teleplotOutput() const;
     static void waitForBootButton();
 };
 
-#endif // MOTOR_H
\ No newline at end of file
+// Motor with its pins fixed at compile time. The pins are checked by static_assert, and direction
+// changes go straight to the GPIO set/clear registers instead of two digitalWrite() calls.
+// The duty still goes through LEDC (or analogWrite) on PWM.
+template <uint8_t PWM, uint8_t AIN1, uint8_t AIN2, uint8_t STBY>
+class PinnedMotor : public Motor {
+    static_assert(PWM != AIN1 && PWM != AIN2 && AIN1 != AIN2, "PinnedMotor: PWM, AIN1 and AIN2 must be different pins");
+    static_assert(STBY != PWM && STBY != AIN1 && STBY != AIN2, "PinnedMotor: STBY must not share a pin with PWM, AIN1 or AIN2");
+    static_assert(gpioUsable(PWM) && gpioUsable(STBY), "PinnedMotor: not a usable GPIO on the ESP32-S3");
+    
+private:
+    static void writePins(int ain1, int ain2) {
+        FastPin<AIN1>::write(ain1);
+        FastPin<AIN2>::write(ain2);
+    }
+    
+public:
+    explicit PinnedMotor(String name) : Motor(PWM, AIN1, AIN2, STBY, name) {
+        _directionWriter = writePins;
+    }
+};
+
+#endif // MOTOR_H
@@ -2,26 +2,81 @@
 #include "motor.h"
 #include "encoder.h"
 #include "IMU.h"
+#include "I2CBus.h"
+#include "ConfigStore.h"
+#include "BalanceController.h"
+#include "TelemetryWriter.h"
 #include "OLED_Manager.h"
 #include "pages/MotorPage.h"
 #include "pages/IMUPage.h"
+#include "pages/ProfilerPage.h"
+#include "Profiler.h"
 #include "config.h"
 
 // 調試控制標誌
 #define DEBUG_LEVEL 1  // 0: 無調試輸出, 1: 基本調試, 2: 詳細調試, 3: 所有數據
 #define ENABLE_MOTORS true  // 設置為 false 可以在測試時禁用馬達
 
-// 創建馬達對象
-Motor motor1(MOTOR1_PWM, MOTOR1_AIN1, MOTOR1_AIN2, MOTOR_STBY, "motor1");
-Motor motor2(MOTOR2_PWM, MOTOR2_AIN1, MOTOR2_AIN2, MOTOR_STBY, "motor2");
+// 平衡控制任務設定 (外環任務優先權為內環減一)
+#define BALANCE_TASK_PRIORITY 5
+#define BALANCE_TASK_CORE 1
+#define BALANCE_OUTER_RATE_HZ 100   // 角度環，與 DMP 輸出頻率相同
+#define BALANCE_INNER_RATE_HZ 1000  // 輪速環
 
-// 創建編碼器對象
-Encoder encoder1(MOTOR1_ENA, MOTOR1_ENB, "encoder1", 440);
-Encoder encoder2(MOTOR2_ENA, MOTOR2_ENB, "encoder2", 440);
+// IMU 數據就緒中斷：啟用後角度環由 MPU6050 的 INT 觸發，取樣時間戳由 ISR 記錄
+// 需要 INT 有接線的腳位配置 (BOARD_REV_A 的 INT 與馬達 2 的 IN1 同為 GPIO18，只能輪詢)
+#define IMU_USE_INTERRUPT false
+static_assert(!IMU_USE_INTERRUPT || BOARD.mpuInt != PIN_NONE,
+              "IMU_USE_INTERRUPT needs a board profile with the MPU6050 INT wired (e.g. BOARD_REV_A_INT4)");
+
+// 姿態來源：IMU_MODE_DMP (100 Hz) 或原始感測器 + 互補/Mahony 濾波 (IMU_RAW_RATE_HZ)
+// 原始模式下角度環跟著取樣頻率執行；串口命令 "IMU:DMP"、"IMU:COMP"、"IMU:MAHONY" 可在執行中切換 (會保存到設定)
+// IMU_FILTER_MODE 只是沒有儲存設定時的預設值
+#define IMU_FILTER_MODE IMU_MODE_DMP
+#define IMU_RAW_RATE_HZ 1000
+
+// 二進位遙測：內環每週期一筆 (設定值、輪速、輸出、俯仰角)，由核心 0 的遙測任務打包送出
+// 串口命令 "TEL:BIN" 切換為二進位輸出 (同時停止文字調試輸出)，"TEL:TEXT" 切回文字
+// 擷取的資料以 tools/telemetry_decode 轉成 CSV
+#define TELEMETRY_BINARY_DEFAULT false
+#define TELEMETRY_TASK_PRIORITY 1
+#define TELEMETRY_TASK_CORE 0
+#define TELEMETRY_POLL_MS 10
+
+// OLED 傳輸任務：主迴圈只繪製幀，I2C 傳輸在核心 0 的低優先權任務進行
+#define OLED_TASK_PRIORITY 1
+#define OLED_TASK_CORE 0
+
+// 創建馬達對象 (腳位在編譯時固定，方向腳位直接寫入 GPIO 暫存器)
+PinnedMotor<BOARD.wheels[0].pwm, BOARD.wheels[0].in1, BOARD.wheels[0].in2, BOARD.motorStby> motor1("motor1");
+PinnedMotor<BOARD.wheels[1].pwm, BOARD.wheels[1].in1, BOARD.wheels[1].in2, BOARD.motorStby> motor2("motor2");
+
+// 創建編碼器對象 (PCNT 無法使用而改用 GPIO 中斷時，每對腳位有自己的中斷處理函數)
+PinnedEncoder<BOARD.wheels[0].encoderA, BOARD.wheels[0].encoderB> encoder1("encoder1", 440);
+PinnedEncoder<BOARD.wheels[1].encoderA, BOARD.wheels[1].encoderB> encoder2("encoder2", 440);
+
+// I2C 匯流排：MPU6050 (高優先權) 與 OLED (低優先權，分段傳送) 共用 Wire 時由匯流排仲裁
+// 串口命令 "I2C" 輸出各裝置的交易數、錯誤與等待時間，"I2C:RESET" 清除統計
+I2CBus i2cBus(Wire);
+#if OLED_USE_SECOND_I2C
+I2CBus oledBus(Wire1);
+#endif
 
 // 創建 IMU 對象
 IMU imu;
 
+// 可調參數：開機時一次載入，修改後由主迴圈延遲寫回 NVS
+// 串口命令 "CFG" 輸出所有欄位，"CFG:<名稱>=<數值>" 修改並套用，"CFG:SAVE" 立即寫回，"CFG:RESET" 恢復預設值
+ConfigStore config;
+
+// 創建平衡控制器
+BalanceController balance(&imu, &motor1, &motor2, &encoder1, &encoder2);
+
+// 遙測緩衝區與輸出
+TelemetryRing telemetryRing;
+TelemetryWriter telemetry(&Serial, 1000000UL / BALANCE_INNER_RATE_HZ);
+volatile bool telemetryBinary = TELEMETRY_BINARY_DEFAULT;
+
 // 創建 OLED 管理器
 OLED_Manager oled;
 
@@ -31,9 +86,13 @@ MotorPage motorPage(&motor1, &motor2, &encoder1, &encoder2);
 // 創建 IMU 頁面
 IMUPage imuPage(&imu);
 
-// 按鈕定義
-#define BUTTON_PIN 0  // BOOT 按鈕
-#define CALIBRATE_BUTTON_PIN 1  // 假設校準按鈕連接到 GPIO1
+// 效能量測：主迴圈各階段與平衡控制任務，串口命令 "PROF" 輸出統計表
+// "PROF:RESET" 清除統計，"PROF:PAGE" 切換到量測頁面
+Profiler profiler;
+ProfilerPage profilerPage(&profiler);
+#define PROFILER_PAGE_INDEX 2
+
+// 按鈕腳位見 BoardProfile：BOOT 按鈕換頁；校準按鈕未接線時以串口命令 "IMU:CAL" 開始校準
 
 // 按鈕狀態
 bool lastButtonState = HIGH;
@@ -42,23 +101,200 @@ unsigned long lastDebounceTime = 0;
 unsigned long lastCalDebounceTime = 0;
 unsigned long debounceDelay = 50;
 
+// IMU 校準：由控制任務的 imu.update() 逐筆推進，靜止後才開始累積，主迴圈只顯示進度
+#define CALIBRATION_ROUNDS 6
+bool calibrationActive = false;
+bool calibrationWasEnabled = false;
+int calibrationProgress = -1;
+
 // 調試變量
 unsigned long lastDebugTime = 0;
 const unsigned long DEBUG_INTERVAL = 1000;  // 每秒輸出一次調試信息
 
+/**
+ * 遙測任務：二進位模式下定期讀出緩衝區並送出
+ * 模式切換也在這裡處理，讓本任務維持為緩衝區唯一的消費者
+ */
+void telemetryTask(void *pvParameters) {
+  TickType_t lastWakeTime = xTaskGetTickCount();
+  bool active = false;
+  TelemetrySample stale;
+  
+  while (1) {
+    vTaskDelayUntil(&lastWakeTime, pdMS_TO_TICKS(TELEMETRY_POLL_MS));
+    
+    if (telemetryBinary != active) {
+      active = telemetryBinary;
+      if (active) {
+        telemetryRing.popLatest(stale);  // 丟棄切換前殘留的取樣
+        telemetry.begin();
+        balance.setTelemetry(&telemetryRing);
+      } else {
+        balance.setTelemetry(nullptr);
+        telemetry.flush();
+      }
+    }
+    
+    if (active) {
+      telemetry.poll(telemetryRing);
+    }
+  }
+}
+
+/**
+ * 切換姿態來源，並讓角度環的頻率跟上新的輸出頻率
+ */
+void applyImuMode(ImuMode mode) {
+  if (!imu.setMode(mode, IMU_RAW_RATE_HZ)) {
+    Serial.println("IMU 模式切換失敗");
+    return;
+  }
+  balance.setRates(mode == IMU_MODE_DMP ? BALANCE_OUTER_RATE_HZ : IMU_RAW_RATE_HZ, BALANCE_INNER_RATE_HZ);
+  if (config.get().imu.mode != mode) {
+    config.edit().imu.mode = mode;
+  }
+}
+
+/**
+ * 開始 IMU 校準：放手後裝置靜止即開始累積，期間停止平衡控制，進度與結果由主迴圈處理
+ */
+void startImuCalibration() {
+  if (calibrationActive) {
+    return;
+  }
+  calibrationWasEnabled = balance.isEnabled();
+  balance.setEnabled(false);
+  if (imu.startCalibration(CALIBRATION_ROUNDS)) {
+    oled.notify("Calibrating", "Keep Device Still", 0);
+    calibrationActive = true;
+    calibrationProgress = -1;
+  } else {
+    balance.setEnabled(calibrationWasEnabled);
+  }
+}
+
+/**
+ * 預設設定：取自各物件建構後的設定，只有編碼器方向依接線指定
+ */
+RobotConfig defaultConfig() {
+  RobotConfig defaults;
+  memset(&defaults, 0, sizeof(defaults));
+  
+  defaults.imu.mode = IMU_FILTER_MODE;
+  defaults.imu.filterAlpha = imu.getFilterAlpha();
+  defaults.imu.mahonyKi = imu.getMahonyIntegralGain();
+  
+  BalanceGains gains = balance.getGains();
+  defaults.balance.angleKp = gains.angleKp;
+  defaults.balance.angleKi = gains.angleKi;
+  defaults.balance.angleKd = gains.angleKd;
+  defaults.balance.speedKp = gains.speedKp;
+  defaults.balance.speedKi = gains.speedKi;
+  defaults.balance.targetPitch = balance.getTargetPitch();
+  defaults.balance.fallAngle = balance.getFallAngle();
+  defaults.balance.velocityLimit = balance.getVelocityLimit();
+  defaults.balance.trackKp = balance.getTrackGain();
+  
+  defaults.encoders[0].pulsesPerRev = encoder1.getPulsesPerRev();
+  defaults.encoders[0].inverted = false;
+  defaults.encoders[1].pulsesPerRev = encoder2.getPulsesPerRev();
+  defaults.encoders[1].inverted = true;  // 反轉 encoder2 的方向讀數
+  return defaults;
+}
+
+/**
+ * 將設定套用到各物件 (IMU 校準值與姿態來源另外處理)
+ * @param live 控制任務執行中：增益只在改變時交給控制任務套用 (不清除積分項)
+ */
+void applyConfig(const RobotConfig& cfg, bool live = false) {
+  imu.setFilterAlpha(cfg.imu.filterAlpha);
+  imu.setMahonyIntegralGain(cfg.imu.mahonyKi);
+  
+  BalanceGains gains;
+  gains.angleKp = cfg.balance.angleKp;
+  gains.angleKi = cfg.balance.angleKi;
+  gains.angleKd = cfg.balance.angleKd;
+  gains.speedKp = cfg.balance.speedKp;
+  gains.speedKi = cfg.balance.speedKi;
+  if (!live) {
+    balance.setGains(gains);
+  } else {
+    BalanceGains current = balance.getGains();
+    if (memcmp(&gains, &current, sizeof(gains)) != 0) {
+      balance.retune(gains);
+    }
+  }
+  balance.setTargetPitch(cfg.balance.targetPitch);
+  balance.setFallAngle(cfg.balance.fallAngle);
+  if (!live || cfg.balance.velocityLimit != balance.getVelocityLimit()) {
+    balance.setVelocityLimit(cfg.balance.velocityLimit);
+  }
+  balance.setTrackGain(cfg.balance.trackKp);
+  
+  encoder1.setPulsesPerRev(cfg.encoders[0].pulsesPerRev);
+  encoder1.setInverted(cfg.encoders[0].inverted);
+  encoder2.setPulsesPerRev(cfg.encoders[1].pulsesPerRev);
+  encoder2.setInverted(cfg.encoders[1].inverted);
+}
+
+/**
+ * 串口修改設定後套用：姿態來源或 IMU 偏移值不同時一併更新
+ */
+void applyConfigChange() {
+  applyConfig(config.get(), true);
+  if (!imu.isInitialized()) {
+    return;
+  }
+  
+  const ImuConfig& imuConfig = config.get().imu;
+  if (imuConfig.mode != imu.getMode()) {
+    applyImuMode((ImuMode)imuConfig.mode);
+  }
+  
+  int16_t accelOffset[3], gyroOffset[3];
+  imu.getCalibrationValues(accelOffset, gyroOffset);
+  if (imuConfig.calibrated &&
+      (memcmp(accelOffset, imuConfig.accelOffset, sizeof(accelOffset)) != 0 ||
+       memcmp(gyroOffset, imuConfig.gyroOffset, sizeof(gyroOffset)) != 0)) {
+    imu.setCalibrationValues(imuConfig.accelOffset, imuConfig.gyroOffset);
+  }
+}
+
 void setup() {
   Serial.begin(115200);
   delay(1000);  // 給串口一些時間初始化
   Serial.println("\n=== ESPArduinoBalanceBot 啟動 ===");
   
+  // 載入設定 (一次 NVS 讀取)，之後的存取都在 RAM
+  static const char* configSources[] = {"預設值", "已儲存", "舊版本升級", "舊版 IMU 校準移轉", "無效，使用預設值"};
+  ConfigSource configSource = config.begin(defaultConfig());
+  if (DEBUG_LEVEL >= 1) {
+    Serial.print("設定來源: ");
+    Serial.println(configSources[configSource]);
+  }
+  if (config.getRejectedFieldCount() > 0) {
+    Serial.print("設定中超出範圍的欄位已恢復預設值: ");
+    Serial.println(config.getRejectedFieldCount());
+  }
+  applyConfig(config.get());
+  
   // 初始化 OLED
   if (DEBUG_LEVEL >= 1) Serial.println("初始化 OLED 顯示器...");
-  if (!oled.begin(I2C_SDA, I2C_SCL)) {
+#if OLED_USE_SECOND_I2C
+  oled.setBus(&oledBus);
+  if (!oled.begin(BOARD.i2c2Sda, BOARD.i2c2Scl)) {
+#else
+  oled.setBus(&i2cBus);
+  if (!oled.begin(BOARD.i2cSda, BOARD.i2cScl)) {
+#endif
     Serial.println("OLED 初始化失敗!");
     while (1) {
       delay(1000);  // 如果 OLED 初始化失敗，停止執行
     }
   }
+  if (!oled.startTask(OLED_TASK_PRIORITY, OLED_TASK_CORE)) {
+    Serial.println("OLED 傳輸任務建立失敗，改為同步傳輸");
+  }
   
   // 顯示歡迎訊息
   oled.displayMessage("Balance Bot", "Starting...", 1000);
@@ -66,15 +302,25 @@ void setup() {
   // 初始化 IMU
   if (DEBUG_LEVEL >= 1) Serial.println("初始化 MPU6050...");
   oled.displayMessage("Initializing", "MPU6050...");
-  if (!imu.begin(I2C_SDA, I2C_SCL)) {
+  imu.setBus(&i2cBus);
+  imu.setConfigStore(&config);
+  if (!imu.begin(BOARD.i2cSda, BOARD.i2cScl, I2C_MPU_ADDR)) {
     Serial.println("MPU6050 初始化失敗!");
-    oled.displayMessage("MPU6050 Init", "Failed!");
-    delay(2000);
+    oled.displayMessage("MPU6050 Init", "Failed!", 2000);
   } else {
     if (DEBUG_LEVEL >= 1) Serial.println("MPU6050 初始化成功!");
     
-    // 嘗試載入校準值
-    if (imu.loadCalibration()) {
+    if (IMU_USE_INTERRUPT && imu.enableInterrupt(BOARD.mpuInt)) {
+      if (DEBUG_LEVEL >= 1) Serial.println("IMU 使用數據就緒中斷模式");
+    }
+    
+    ImuMode imuMode = (ImuMode)config.get().imu.mode;
+    if (imuMode != IMU_MODE_DMP && !imu.setMode(imuMode, IMU_RAW_RATE_HZ)) {
+      Serial.println("IMU 原始感測器模式設定失敗，維持 DMP");
+    }
+    
+    // 校準值已在 begin() 由設定載入並寫入偏移暫存器
+    if (imu.isCalibrated()) {
       if (DEBUG_LEVEL >= 1) Serial.println("已載入 IMU 校準數據");
       oled.displayMessage("IMU Calibration", "Loaded!", 1000);
     } else {
@@ -91,6 +337,9 @@ void setup() {
   if (!oled.addPage(&imuPage)) {
     Serial.println("添加 IMU 頁面失敗!");
   }
+  if (!oled.addPage(&profilerPage)) {
+    Serial.println("添加量測頁面失敗!");
+  }
   
   if (DEBUG_LEVEL >= 1) {
     Serial.println("已添加頁面:");
@@ -98,28 +347,46 @@ void setup() {
     Serial.println(motorPage.getName());
     Serial.print("1: ");
     Serial.println(imuPage.getName());
+    Serial.print("2: ");
+    Serial.println(profilerPage.getName());
     Serial.print("頁面總數: ");
     Serial.println(oled.getPageCount());
   }
   
   // 初始化馬達
   if (DEBUG_LEVEL >= 1) Serial.println("初始化馬達...");
-  motor1.begin();
-  motor2.begin();
+  // LEDC 20 kHz / 10 位元 (不可聽見)，平衡點附近以抖動補足 1 LSB 以下的佔空比
+  motor1.begin(MOTOR_PWM_LEDC, 0);
+  motor2.begin(MOTOR_PWM_LEDC, 1);
+  motor1.setDither(true);
+  motor2.setDither(true);
   
   // 初始化編碼器
   if (DEBUG_LEVEL >= 1) Serial.println("初始化編碼器...");
-  encoder1.begin(0);
-  encoder2.begin(1);
+  // 使用 PCNT 硬體計數，CPU 只在讀取時介入，不再每個邊緣進一次中斷
+  // PPR 與方向反轉已由設定套用 (見 defaultConfig())
+  encoder1.begin(0, ENCODER_BACKEND_PCNT);
+  encoder2.begin(1, ENCODER_BACKEND_PCNT);
+  
+  // 啟動平衡控制任務 (馬達輸出在啟用前保持為 0)
+  if (DEBUG_LEVEL >= 1) Serial.println("啟動平衡控制任務...");
+  balance.setRates(imu.getMode() == IMU_MODE_DMP ? BALANCE_OUTER_RATE_HZ : IMU_RAW_RATE_HZ,
+                   BALANCE_INNER_RATE_HZ);
+  balance.setProfiler(&profiler);
+  if (!balance.start(BALANCE_TASK_PRIORITY, BALANCE_TASK_CORE)) {
+    Serial.println("平衡控制任務啟動失敗!");
+  }
   
-  // 設定編碼器方向反轉（如果需要）
-  encoder1.setInverted(false);
-  encoder2.setInverted(true);  // 反轉 encoder2 的方向讀數
+  // 啟動遙測任務
+  xTaskCreatePinnedToCore(telemetryTask, "Telemetry", 4096, NULL,
+                          TELEMETRY_TASK_PRIORITY, NULL, TELEMETRY_TASK_CORE);
   
   // 設置按鈕引腳
   if (DEBUG_LEVEL >= 1) Serial.println("設置按鈕引腳...");
-  pinMode(BUTTON_PIN, INPUT_PULLUP);
-  pinMode(CALIBRATE_BUTTON_PIN, INPUT_PULLUP);
+  pinMode(BOARD.bootButton, INPUT_PULLUP);
+  if (BOARD.calibrateButton != PIN_NONE) {
+    pinMode(BOARD.calibrateButton, INPUT_PULLUP);
+  }
   
   // 設置初始頁面為馬達頁面（索引 0）
   if (DEBUG_LEVEL >= 1) Serial.println("設置初始頁面為馬達頁面");
@@ -134,8 +401,9 @@ void setup() {
     if (DEBUG_LEVEL >= 1) Serial.println("等待 BOOT 按鈕按下...");
     oled.displayMessage("Press BOOT", "to start motors");
     
-    // 等待按鈕按下
-    while (digitalRead(BUTTON_PIN) == HIGH) {
+    // 等待按鈕按下 (期間持續更新顯示，讓排隊的通知依序出現)
+    while (digitalRead(BOARD.bootButton) == HIGH) {
+      oled.update();
       delay(10);
     }
     delay(100);  // 防抖動
@@ -144,6 +412,7 @@ void setup() {
     // 啟動馬達
     motor1.setRunning(true);
     motor2.setRunning(true);
+    balance.setEnabled(true);
     
     if (DEBUG_LEVEL >= 1) Serial.println(">status:馬達已啟動運行");
     oled.displayMessage("Motors", "Started!", 1000);
@@ -156,11 +425,79 @@ void setup() {
 }
 
 void loop() {
-  // 更新 IMU 數據
-  imu.update();
+  // IMU、編碼器與馬達由平衡控制任務更新，這裡只處理按鈕、顯示與調試輸出
+  
+  static const int loopStage = profiler.registerStage("loop");
+  uint32_t loopStart = Profiler::now();
+  
+  // 串口命令：切換遙測模式、效能量測、轉向、姿態來源與校準、設定
+  if (Serial.available() > 0) {
+    PROFILE_SCOPE(profiler, "serial.command");
+    String input = Serial.readStringUntil('\n');
+    input.trim();
+    if (input == "TEL:BIN") {
+      telemetryBinary = true;
+    } else if (input == "TEL:TEXT") {
+      telemetryBinary = false;
+    } else if (input == "PROF") {
+      profiler.printTable(Serial);
+    } else if (input == "PROF:RESET") {
+      profiler.reset();
+    } else if (input == "PROF:PAGE") {
+      oled.setPage(PROFILER_PAGE_INDEX);
+    } else if (input.startsWith("TURN:")) {
+      balance.setTurnSetpoint(input.substring(5).toFloat());
+    } else if (input == "IMU:DMP") {
+      applyImuMode(IMU_MODE_DMP);
+    } else if (input == "IMU:COMP") {
+      applyImuMode(IMU_MODE_COMPLEMENTARY);
+    } else if (input == "IMU:MAHONY") {
+      applyImuMode(IMU_MODE_MAHONY);
+    } else if (input == "IMU:CAL") {
+      startImuCalibration();
+    } else if (input == "I2C") {
+      i2cBus.printStats(Serial);
+#if OLED_USE_SECOND_I2C
+      oledBus.printStats(Serial);
+#endif
+    } else if (input == "I2C:RESET") {
+      i2cBus.resetStats();
+#if OLED_USE_SECOND_I2C
+      oledBus.resetStats();
+#endif
+    } else if (input == "CFG") {
+      config.print(Serial);
+    } else if (input == "CFG:SAVE") {
+      Serial.println(config.commit() ? "設定已寫入" : "設定寫入失敗");
+    } else if (input == "CFG:RESET") {
+      // IMU 校準值保留
+      config.reset();
+      if (imu.isCalibrated()) {
+        imu.saveCalibration();
+      }
+      applyConfigChange();
+    } else if (input.startsWith("CFG:") && input.indexOf('=') > 4) {
+      int eq = input.indexOf('=');
+      String name = input.substring(4, eq);
+      String value = input.substring(eq + 1);
+      ConfigSetResult result = config.set(name.c_str(), value.c_str());
+      float minValue, maxValue;
+      if (result == CONFIG_SET_OK) {
+        applyConfigChange();
+      } else if (result == CONFIG_SET_INVALID && config.getRange(name.c_str(), minValue, maxValue)) {
+        Serial.printf("數值無效: %s 的範圍為 %g ~ %g\n", name.c_str(), minValue, maxValue);
+      } else {
+        Serial.print("未知的設定: ");
+        Serial.println(name);
+      }
+    }
+  }
+  
+  // 設定修改後延遲寫回 (連續調參只寫一次)
+  config.service();
   
   // 讀取頁面切換按鈕狀態
-  bool buttonState = digitalRead(BUTTON_PIN);
+  bool buttonState = digitalRead(BOARD.bootButton);
   
   // 按鈕防抖動
   if (buttonState != lastButtonState) {
@@ -195,57 +532,64 @@ void loop() {
   
   lastButtonState = buttonState;
   
-  // 讀取校準按鈕狀態
-  bool calButtonState = digitalRead(CALIBRATE_BUTTON_PIN);
-  
-  // 校準按鈕防抖動
-  if (calButtonState != lastCalButtonState) {
-    lastCalDebounceTime = millis();
+  // 讀取校準按鈕狀態 (腳位配置沒有校準按鈕時略過)
+  if (BOARD.calibrateButton != PIN_NONE) {
+    bool calButtonState = digitalRead(BOARD.calibrateButton);
+    
+    // 校準按鈕防抖動
+    if (calButtonState != lastCalButtonState) {
+      lastCalDebounceTime = millis();
+    }
+    
+    // 如果校準按鈕狀態穩定且為按下狀態
+    if ((millis() - lastCalDebounceTime) > debounceDelay) {
+      if (calButtonState == LOW && lastCalButtonState == HIGH) {
+        if (DEBUG_LEVEL >= 1) Serial.println("校準按鈕被按下，開始 IMU 校準");
+        startImuCalibration();
+      }
+    }
+    
+    lastCalButtonState = calButtonState;
   }
   
-  // 如果校準按鈕狀態穩定且為按下狀態
-  if ((millis() - lastCalDebounceTime) > debounceDelay) {
-    if (calButtonState == LOW && lastCalButtonState == HIGH) {
-      // 校準按鈕被按下，執行 IMU 校準
-      if (DEBUG_LEVEL >= 1) Serial.println("校準按鈕被按下，開始 IMU 校準");
-      oled.displayMessage("Calibrating", "Keep Device Still");
-      delay(2000);
-      
-      // 執行校準，並使用 lambda 函數顯示進度
-      imu.calibrate(6, [&](const char* message, int progress) {
-        // 使用 OLED 顯示校準進度
+  // 校準進度與結果
+  if (calibrationActive) {
+    ImuCalState state = imu.getCalibrationState();
+    if (state == IMU_CAL_RUNNING) {
+      int progress = imu.getCalibrationProgress();
+      if (progress != calibrationProgress && progress > 0) {
+        calibrationProgress = progress;
         if (DEBUG_LEVEL >= 1) {
-          Serial.print(message);
-          Serial.print(": ");
+          Serial.print("IMU 校準: ");
           Serial.print(progress);
           Serial.println("%");
         }
-        oled.displayProgress(message, progress);
-      });
-      
-      if (DEBUG_LEVEL >= 1) Serial.println("IMU 校準完成");
-      oled.displayMessage("Calibration", "Complete!", 1000);
+        oled.displayProgress("Calibrating", progress);
+      }
+    } else {
+      calibrationActive = false;
+      if (state == IMU_CAL_DONE) {
+        imu.saveCalibration();
+        if (DEBUG_LEVEL >= 1) Serial.println("IMU 校準完成");
+        oled.notify("Calibration", "Complete!", 1000);
+      } else {
+        if (DEBUG_LEVEL >= 1) Serial.println("IMU 校準失敗 (裝置沒有靜止)");
+        oled.notify("Calibration", "Failed!", 2000);
+      }
+      balance.setEnabled(calibrationWasEnabled);
     }
   }
   
-  lastCalButtonState = calButtonState;
-  
-  if (ENABLE_MOTORS) {
-    // 設定馬達速度 (-255 到 255)
-    motor1.setSpeed(150);
-    motor2.setSpeed(150);
-  }
-  
-  // 更新編碼器狀態
-  encoder1.update();
-  encoder2.update();
-  
   // 更新 OLED 顯示
-  oled.update();
+  {
+    PROFILE_SCOPE(profiler, "oled.update");
+    oled.update();
+  }
   
   // 定期輸出調試信息
   unsigned long currentTime = millis();
-  if (currentTime - lastDebugTime >= DEBUG_INTERVAL && DEBUG_LEVEL >= 1) {
+  if (currentTime - lastDebugTime >= DEBUG_INTERVAL && DEBUG_LEVEL >= 1 && !telemetryBinary) {
+    PROFILE_SCOPE(profiler, "debug.serial");
     lastDebugTime = currentTime;
     
     // 輸出當前頁面信息
@@ -262,9 +606,37 @@ void loop() {
       Serial.print(imuPage.getName());
       Serial.print(", 模式: ");
       Serial.print(imuPage.getDisplayMode());
+    } else if (oled.getCurrentPageIndex() == PROFILER_PAGE_INDEX) {
+      Serial.print(profilerPage.getName());
     }
     Serial.println(")");
     
+    // 平衡控制器執行統計
+    BalanceStats stats = balance.getStats();
+    Serial.print("平衡控制: ");
+    Serial.print(balance.isFallen() ? "已倒下" : (balance.isEnabled() ? "運行中" : "停用"));
+    Serial.print(", 內環 ");
+    Serial.print(stats.inner.maxExecMicros);
+    Serial.print("/");
+    Serial.print(stats.inner.maxJitterMicros);
+    Serial.print(" us (執行/抖動), 外環 ");
+    Serial.print(stats.outer.maxExecMicros);
+    Serial.print(" us, 延遲 ");
+    Serial.print(stats.maxLatencyMicros);
+    Serial.print(" us, 漏拍 ");
+    Serial.println(stats.inner.missed + stats.outer.missed);
+    
+    // DMP FIFO：積壓代表讀取跟不上封包輸出，溢位代表已遺失數據
+    if (imu.getMode() == IMU_MODE_DMP) {
+      ImuFifoStats fifo = imu.getFifoStats();
+      Serial.print("IMU FIFO: 封包 ");
+      Serial.print(fifo.packets);
+      Serial.print(", 最大積壓 ");
+      Serial.print(fifo.maxBacklog);
+      Serial.print(", 溢位 ");
+      Serial.println(fifo.overflows);
+    }
+    
     // 只在詳細調試模式下輸出更多信息
     if (DEBUG_LEVEL >= 2) {
       // 輸出 IMU 數據
@@ -299,12 +671,14 @@ void loop() {
   }
   
   // 只在最高調試級別輸出 Teleplot 數據
-  if (DEBUG_LEVEL >= 3) {
+  if (DEBUG_LEVEL >= 3 && !telemetryBinary) {
+    PROFILE_SCOPE(profiler, "teleplot");
     // 使用 Teleplot 格式輸出數據
     motor1.teleplotOutput();
     motor2.teleplotOutput();
     encoder1.teleplotOutput();
     encoder2.teleplotOutput();
+    balance.teleplotOutput();
     
     // 輸出兩個馬達的平均 RPM
     float avgRPM = (encoder1.getRPM() + encoder2.getRPM()) / 2.0;
@@ -318,5 +692,6 @@ void loop() {
     Serial.println(imu.getRoll() * 180 / M_PI);
   }
   
-  delay(10);  // 更新頻率限制
+  profiler.record(loopStage, Profiler::now() - loopStart);
+  delay(10);  // 只限制顯示與按鈕的更新頻率，控制迴圈在獨立任務中執行
 }
\ No newline at end of file
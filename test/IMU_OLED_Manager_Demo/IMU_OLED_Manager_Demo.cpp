@@ -37,7 +37,7 @@
    pinMode(MODE_BUTTON_PIN, INPUT_PULLUP);
    
    // 初始化感測器與顯示器
-   if (!imuDisplay.begin(I2C_SDA, I2C_SCL)) {
+   if (!imuDisplay.begin(BOARD.i2cSda, BOARD.i2cScl)) {
      Serial.println("初始化失敗！請檢查連接。");
      while (1) {
        delay(100);  // 無限循環
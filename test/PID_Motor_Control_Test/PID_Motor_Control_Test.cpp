@@ -9,6 +9,23 @@
  * 4. 可以調整PID參數
  * 5. 使用RTOS確保任務準時執行
  * 6. 使用JSON格式進行串口通信
+ * 7. PID任務將每個週期的取樣寫入無鎖環形緩衝區，串口任務在核心0讀出，
+ *    JSON 編碼與串口輸出不再佔用 dataMutex，控制週期不受串口速度影響
+ * 8. 遙測可在執行中切換為二進位幀 (COBS + CRC)，輸出每一筆 100Hz 取樣：
+ *    {"command":"set_telemetry","mode":"binary"} 或 "TEL:BIN"，切回 JSON 用 "json" 或 "TEL:JSON"；
+ *    擷取的資料以 tools/telemetry_decode 轉成 CSV
+ * 9. 兩輪各自以帶方向的輪速環控制 (可反轉)，目標RPM為前進速度，另可設定轉向量，
+ *    由 DriveMixer 混合成兩輪設定值：{"command":"set_turn","value":30} 或 "TURN:30"
+ * 10. 馬達特性掃描：{"command":"characterize"} 或 "CHAR" 讓兩輪正反轉掃描 PWM (約 30 秒)，
+ *    建立死區/非線性補償表並存入 NVS，之後開機時 Motor::begin() 自動載入並套用
+ * 11. 系統識別：{"command":"identify","mode":"prbs","offset":0.4,"amplitude":0.15,"duration":8}
+ *    或 "SYSID:STEP" / "SYSID:PRBS" / "SYSID:CHIRP"，注入激勵並擬合兩輪的一階加延遲模型，
+ *    回報模型與建議的 PI 增益 (可直接用 set_pid 套用)
+ * 12. 繼電器自動調參：{"command":"autotune","setpoint":100,"rule":"zn_pi"} 或 "TUNE" / "TUNE:100"，
+ *    兩輪在設定值附近振盪以量測 Ku、Pu，完成後依法則 (zn_pi, zn_pid, tyreus_luyben, some_overshoot,
+ *    no_overshoot) 算出的增益直接寫入目前的 PID 參數
+ * 13. {"command":"abort"} 或 "ABORT" 中止特性掃描、系統識別或自動調參並停止馬達
+ * 14. 調試頁面的參數調整模式以 "PARAM" 切換；腳位配置有校準按鈕 (BOARD.calibrateButton) 時也可用該按鈕
  */
 
  #include <Arduino.h>
@@ -18,7 +35,12 @@
  #include "OLED_Manager.h"
  #include "pages/DebugPage.h"
  #include "config.h"
- #include "PID_v1.h"
+ #include "DiffDrive.h"
+ #include "MotorCharacterizer.h"
+ #include "SystemId.h"
+ #include "RelayAutotune.h"
+ #include "SpscRing.h"
+ #include "TelemetryWriter.h"
  
  // RTOS相關定義
  #define STACK_SIZE 4096
@@ -38,36 +60,84 @@
  // 互斥鎖，用於保護共享資源
  SemaphoreHandle_t dataMutex;
  
+ // 遙測取樣記錄 (PID 任務寫入，串口任務讀出)
+ struct PidSample {
+   uint32_t seq;
+   uint32_t timestamp;   // us
+   float targetRPM;
+   float turnRPM;
+   float currentRPM;
+   float motorOutput;
+   float leftRPM;
+   float rightRPM;
+   int16_t leftOutput;
+   int16_t rightOutput;
+   float kp;
+   float ki;
+   float kd;
+ };
+ 
+ // PID 任務 (核心1) → 串口任務 (核心0)，可緩衝 640ms 的取樣
+ SpscRing<PidSample, 64> telemetryRing;
+ 
+ // 二進位遙測輸出 (取樣間隔 10ms)
+ TelemetryWriter binaryTelemetry(&Serial, 10000);
+ bool binaryMode = false;  // 只由串口任務讀寫
+ 
  // 創建馬達對象
- Motor motor1(MOTOR1_PWM, MOTOR1_AIN1, MOTOR1_AIN2, MOTOR_STBY, "motor1");
- Motor motor2(MOTOR2_PWM, MOTOR2_AIN1, MOTOR2_AIN2, MOTOR_STBY, "motor2");
+ Motor motor1(BOARD.wheels[0].pwm, BOARD.wheels[0].in1, BOARD.wheels[0].in2, BOARD.motorStby, "motor1");
+ Motor motor2(BOARD.wheels[1].pwm, BOARD.wheels[1].in1, BOARD.wheels[1].in2, BOARD.motorStby, "motor2");
  
  // 創建編碼器對象
- Encoder encoder1(MOTOR1_ENA, MOTOR1_ENB, "encoder1", 440);
- Encoder encoder2(MOTOR2_ENA, MOTOR2_ENB, "encoder2", 440);
+ Encoder encoder1(BOARD.wheels[0].encoderA, BOARD.wheels[0].encoderB, "encoder1", 440);
+ Encoder encoder2(BOARD.wheels[1].encoderA, BOARD.wheels[1].encoderB, "encoder2", 440);
  
  // 創建 OLED 管理器
  OLED_Manager oled;
  
  // PID 變量
- double targetRPM = 0;    // 目標RPM
- double currentRPM = 0;   // 當前RPM
- double motorOutput = 0;  // 馬達輸出 (0-255)
+ double targetRPM = 0;    // 目標RPM (前進速度，帶方向)
+ double turnRPM = 0;      // 轉向量 (RPM，正值向右轉)
+ double currentRPM = 0;   // 當前RPM (兩輪平均，帶方向)
+ double motorOutput = 0;  // 馬達輸出 (兩輪平均，-255 到 255)
  
  // PID 參數 - 這些是初始值，可以根據實際情況調整
  double Kp = 1.0;
  double Ki = 0.2;
  double Kd = 0;
  
- // 創建 PID 控制器
- PID motorPID(&currentRPM, &motorOutput, &targetRPM, Kp, Ki, Kd, DIRECT);
+ // 每輪一個帶方向的輪速控制器 (單精度，ESP32-S3 的 FPU 不支援 double)
+ WheelController wheel1(&motor1, &encoder1);
+ WheelController wheel2(&motor2, &encoder2);
+ DriveMixer mixer(300.0f);        // 單輪設定值上限 300 RPM
+ #define PID_SAMPLE_TIME 0.01f    // 與 PID 任務週期相同 (秒)
+ 
+ // 馬達特性掃描 (在 PID 任務中推進，期間不計算 PID)
+ MotorCharacterizer characterizer1(&motor1, &encoder1);
+ MotorCharacterizer characterizer2(&motor2, &encoder2);
+ volatile bool characterizing = false;      // 掃描進行中
+ volatile bool characterizeFinished = false; // 掃描結束，等待串口任務輸出結果並存檔
+ 
+ // 系統識別 (在 PID 任務中以控制週期記錄，期間不計算 PID)
+ SystemIdentifier identifier1(&motor1, &encoder1);
+ SystemIdentifier identifier2(&motor2, &encoder2);
+ volatile bool identifying = false;         // 識別進行中
+ volatile bool identifyFinished = false;    // 識別結束，等待串口任務輸出結果
+ 
+ // 繼電器自動調參 (在 PID 任務中推進，完成後直接更新 PID 參數)
+ RelayAutotuner autotuner1(&motor1, &encoder1);
+ RelayAutotuner autotuner2(&motor2, &encoder2);
+ AutotuneRule autotuneRule = AUTOTUNE_ZIEGLER_NICHOLS_PI;
+ volatile bool autotuning = false;          // 調參進行中
+ volatile bool autotuneFinished = false;    // 調參結束，等待串口任務輸出結果
  
  // 創建調試頁面
  DebugPage debugPage(&targetRPM, &currentRPM, &Kp, &Ki, &Kd);
  
- // 按鈕定義
- #define BUTTON_PIN 0  // BOOT 按鈕
- #define PARAM_BUTTON_PIN 1  // 參數調整按鈕
+ // 按鈕定義：BOOT 按鈕，參數調整沿用校準按鈕的腳位 (原本的 GPIO1 是馬達 2 的編碼器 B，
+ // BOARD_REV_A 沒有這個按鈕，只能以串口命令 "PARAM" 切換)
+ #define BUTTON_PIN BOARD.bootButton
+ #define PARAM_BUTTON_PIN BOARD.calibrateButton
  
  // 按鈕狀態
  bool lastButtonState = HIGH;
@@ -89,13 +159,22 @@
  volatile bool motorsEnabled = false;
  
  // JSON緩衝區
- StaticJsonDocument<256> jsonDoc;
- char jsonBuffer[256];
+ StaticJsonDocument<384> jsonDoc;
+ char jsonBuffer[384];  // 含兩輪速度與輸出的數據約 300 字元
  
  // 函數聲明
  void updateRPMHistory(double rpm);
  void processSerialCommands();
- void sendJsonData();
+ void sendJsonData(const PidSample& sample);
+ void sendBinaryData();
+ void setBinaryMode(bool enable);
+ void startCharacterization();
+ void reportCharacterization();
+ void startIdentification(SysIdExcitation excitation, float offset, float amplitude, float duration);
+ void reportIdentification();
+ void startAutotune(float setpoint, AutotuneRule rule);
+ void reportAutotune();
+ void abortTests();
  
  /**
   * PID控制任務 - 計算PID並設置馬達輸出
@@ -108,34 +187,101 @@
   // 初始化xLastWakeTime變數
   xLastWakeTime = xTaskGetTickCount();
   
+  PidSample sample;
+  uint32_t seq = 0;
+  
   while (1) {
     // 等待下一個週期
     vTaskDelayUntil(&xLastWakeTime, xFrequency);
     
     // 獲取互斥鎖
     if (xSemaphoreTake(dataMutex, pdMS_TO_TICKS(5)) == pdTRUE) {
-      // 特殊處理目標RPM為0的情況 - 快速停止
-      if (targetRPM == 0 && motorsEnabled) {
-        // 直接設置輸出為0，繞過PID控制器
+      if (characterizing) {
+        // 特性掃描：兩輪同時推進，結束後套用新的補償表
+        bool running1 = characterizer1.update();
+        bool running2 = characterizer2.update();
+        if (!running1 && !running2) {
+          if (characterizer1.getState() == CHARACTERIZER_DONE && characterizer2.getState() == CHARACTERIZER_DONE) {
+            motor1.setCompensation(characterizer1.getTable());
+            motor2.setCompensation(characterizer2.getTable());
+          }
+          characterizing = false;
+          characterizeFinished = true;
+        }
+        motorOutput = (motor1.getSpeed() + motor2.getSpeed()) / 2.0;
+      }
+      else if (autotuning) {
+        // 自動調參：任一輪失敗時兩輪一起中止
+        autotuner1.update(PID_SAMPLE_TIME);
+        autotuner2.update(PID_SAMPLE_TIME);
+        if (autotuner1.getState() == AUTOTUNE_FAILED || autotuner2.getState() == AUTOTUNE_FAILED) {
+          autotuner1.abort();
+          autotuner2.abort();
+        }
+        if (autotuner1.getState() != AUTOTUNE_RUNNING && autotuner2.getState() != AUTOTUNE_RUNNING) {
+          if (autotuner1.getState() == AUTOTUNE_DONE && autotuner2.getState() == AUTOTUNE_DONE) {
+            // 兩輪共用一組參數 (與 set_pid 相同)，取兩輪結果的平均
+            AutotuneGains gains1 = autotuner1.getGains(autotuneRule);
+            AutotuneGains gains2 = autotuner2.getGains(autotuneRule);
+            Kp = (gains1.kp + gains2.kp) / 2;
+            Ki = (gains1.ki + gains2.ki) / 2;
+            Kd = (gains1.kd + gains2.kd) / 2;
+            wheel1.setTunings(Kp, Ki, Kd);
+            wheel2.setTunings(Kp, Ki, Kd);
+          }
+          wheel1.stop();
+          wheel2.stop();
+          autotuning = false;
+          autotuneFinished = true;
+        }
+        motorOutput = (motor1.getSpeed() + motor2.getSpeed()) / 2.0;
+      }
+      else if (identifying) {
+        // 系統識別：兩輪同時注入激勵並記錄響應
+        bool running1 = identifier1.update(PID_SAMPLE_TIME);
+        bool running2 = identifier2.update(PID_SAMPLE_TIME);
+        if (!running1 && !running2) {
+          identifying = false;
+          identifyFinished = true;
+        }
+        motorOutput = (motor1.getSpeed() + motor2.getSpeed()) / 2.0;
+      }
+      // 特殊處理目標RPM與轉向量皆為0的情況 - 快速停止
+      else if ((targetRPM == 0 && turnRPM == 0) || !motorsEnabled) {
+        // 直接設置輸出為0並重置積分項，繞過PID控制器
+        wheel1.stop();
+        wheel2.stop();
         motorOutput = 0;
-        motor1.setSpeed(0);
-        motor2.setSpeed(0);
-        // 重置PID控制器，避免積分項累積
-        motorPID.SetMode(MANUAL);
-        motorPID.SetMode(AUTOMATIC);
       } else {
-        // 正常情況下計算PID
-        motorPID.Compute();
-        
-        // 如果馬達已啟用，設置馬達輸出
-        if (motorsEnabled) {
-          motor1.setSpeed(motorOutput);
-          motor2.setSpeed(motorOutput);
-        }
+        // 混合前進與轉向，兩輪各自計算PID並設置馬達輸出
+        WheelSetpoints setpoints = mixer.mix(targetRPM, turnRPM);
+        wheel1.setSetpoint(setpoints.left);
+        wheel2.setSetpoint(setpoints.right);
+        int output1 = wheel1.update(PID_SAMPLE_TIME);
+        int output2 = wheel2.update(PID_SAMPLE_TIME);
+        motorOutput = (output1 + output2) / 2.0;
       }
       
+      // 在鎖內複製本週期的數據
+      sample.seq = seq++;
+      sample.timestamp = micros();
+      sample.targetRPM = targetRPM;
+      sample.turnRPM = turnRPM;
+      sample.currentRPM = currentRPM;
+      sample.motorOutput = motorOutput;
+      sample.leftRPM = wheel1.getVelocity();
+      sample.rightRPM = wheel2.getVelocity();
+      sample.leftOutput = wheel1.getOutput();
+      sample.rightOutput = wheel2.getOutput();
+      sample.kp = Kp;
+      sample.ki = Ki;
+      sample.kd = Kd;
+      
       // 釋放互斥鎖
       xSemaphoreGive(dataMutex);
+      
+      // 寫入環形緩衝區不需要鎖；緩衝區滿時丟棄取樣，不等待串口
+      telemetryRing.push(sample);
     }
   }
 }
@@ -158,8 +304,8 @@
      
      // 獲取互斥鎖
      if (xSemaphoreTake(dataMutex, pdMS_TO_TICKS(5)) == pdTRUE) {
-       // 計算當前 RPM (兩個馬達的平均值)
-       currentRPM = (encoder1.getRPM() + encoder2.getRPM()) / 2.0;
+       // 計算當前 RPM (兩個馬達帶方向速度的平均值)
+       currentRPM = (encoder1.getVelocity() + encoder2.getVelocity()) / 2.0;
        
        // 更新RPM歷史記錄
        updateRPMHistory(currentRPM);
@@ -196,6 +342,7 @@
    TickType_t xLastWakeTime;
    const TickType_t xFrequency = pdMS_TO_TICKS(20); // 50Hz
    unsigned long currentTime;
+   PidSample sample;
    
    xLastWakeTime = xTaskGetTickCount();
    
@@ -205,11 +352,37 @@
      // 處理串口命令
      processSerialCommands();
      
-     // 定期輸出PID數據
+     // 特性掃描結束：輸出結果並存入 NVS (不在 PID 任務中寫快閃記憶體)
+     if (characterizeFinished) {
+       characterizeFinished = false;
+       reportCharacterization();
+     }
+     
+     // 系統識別結束：輸出模型與建議增益
+     if (identifyFinished) {
+       identifyFinished = false;
+       reportIdentification();
+     }
+     
+     // 自動調參結束：輸出結果
+     if (autotuneFinished) {
+       autotuneFinished = false;
+       reportAutotune();
+     }
+     
+     // 二進位模式：每個週期送出所有取樣
+     if (binaryMode) {
+       sendBinaryData();
+       continue;
+     }
+     
+     // 定期輸出PID數據：只輸出最新一筆，較舊的取樣直接丟棄
      currentTime = millis();
      if (currentTime - lastDebugTime >= DEBUG_INTERVAL) {
        lastDebugTime = currentTime;
-       sendJsonData();
+       if (telemetryRing.popLatest(sample)) {
+         sendJsonData(sample);
+       }
      }
    }
  }
@@ -230,7 +403,7 @@
      
      // 讀取按鈕狀態
      buttonState = digitalRead(BUTTON_PIN);
-     paramButtonState = digitalRead(PARAM_BUTTON_PIN);
+     paramButtonState = PARAM_BUTTON_PIN != PIN_NONE ? digitalRead(PARAM_BUTTON_PIN) : HIGH;
      
      // BOOT按鈕處理 (用於增加目標RPM)
      if (buttonState != lastButtonState) {
@@ -253,7 +426,7 @@
            // 顯示新的目標RPM
            char buffer[20];
            sprintf(buffer, "Target: %d RPM", (int)targetRPM);
-           oled.displayMessage("RPM Changed", buffer, 1000);
+           oled.notify("RPM Changed", buffer, 1000);
          }
        }
      }
@@ -286,33 +459,337 @@
  
  /**
   * 發送JSON格式的數據
+  * 只使用取樣記錄中的副本，不需要互斥鎖
+  */
+ void sendJsonData(const PidSample& sample) {
+   // 清除之前的文檔內容
+   jsonDoc.clear();
+   
+   // 添加數據
+   jsonDoc["type"] = "data";
+   jsonDoc["timestamp"] = sample.timestamp / 1000;
+   jsonDoc["target_rpm"] = sample.targetRPM;
+   jsonDoc["current_rpm"] = sample.currentRPM;
+   jsonDoc["error"] = sample.targetRPM - sample.currentRPM;
+   jsonDoc["motor_output"] = sample.motorOutput;
+   jsonDoc["turn_rpm"] = sample.turnRPM;
+   jsonDoc["left_rpm"] = sample.leftRPM;
+   jsonDoc["right_rpm"] = sample.rightRPM;
+   jsonDoc["left_output"] = sample.leftOutput;
+   jsonDoc["right_output"] = sample.rightOutput;
+   jsonDoc["kp"] = sample.kp;
+   jsonDoc["ki"] = sample.ki;
+   jsonDoc["kd"] = sample.kd;
+   jsonDoc["dropped"] = telemetryRing.getDropped();
+   
+   // 序列化並發送
+   serializeJson(jsonDoc, jsonBuffer);
+   Serial.println(jsonBuffer);
+ }
+ 
+ /**
+  * 以二進位幀送出緩衝區中所有取樣 (此測試沒有 IMU，俯仰角固定為 0)
+  */
+ void sendBinaryData() {
+   PidSample batch[TELEMETRY_MAX_RECORDS];
+   size_t count;
+   
+   while ((count = telemetryRing.popBatch(batch, TELEMETRY_MAX_RECORDS)) > 0) {
+     for (size_t i = 0; i < count; i++) {
+       TelemetrySample sample;
+       sample.seq = batch[i].seq;
+       sample.timestamp = batch[i].timestamp;
+       sample.targetRpm = batch[i].targetRPM;
+       sample.currentRpm = batch[i].currentRPM;
+       sample.output = (int16_t)batch[i].motorOutput;
+       sample.pitch = 0.0f;
+       binaryTelemetry.write(sample);
+     }
+   }
+   binaryTelemetry.flush();
+ }
+ 
+ /**
+  * 切換遙測模式
+  */
+ void setBinaryMode(bool enable) {
+   if (enable && !binaryMode) {
+     PidSample stale;
+     telemetryRing.popLatest(stale);  // 丟棄切換前殘留的取樣
+     binaryTelemetry.begin();
+   } else if (!enable && binaryMode) {
+     binaryTelemetry.flush();
+   }
+   binaryMode = enable;
+ }
+ 
+ /**
+  * 開始兩輪的特性掃描
+  */
+ void startCharacterization() {
+   if (!motorsEnabled || characterizing || identifying || autotuning) {
+     jsonDoc.clear();
+     jsonDoc["type"] = "response";
+     jsonDoc["status"] = "error";
+     jsonDoc["message"] = motorsEnabled ? "特性掃描、系統識別或自動調參進行中" : "馬達尚未啟動";
+     serializeJson(jsonDoc, jsonBuffer);
+     Serial.println(jsonBuffer);
+     return;
+   }
+   
+   // 獲取互斥鎖
+   if (xSemaphoreTake(dataMutex, pdMS_TO_TICKS(10)) == pdTRUE) {
+     wheel1.stop();
+     wheel2.stop();
+     characterizer1.start();
+     characterizer2.start();
+     characterizing = true;
+     
+     // 釋放互斥鎖
+     xSemaphoreGive(dataMutex);
+     
+     oled.notify("Motor sweep", "running...", 0);
+     
+     jsonDoc.clear();
+     jsonDoc["type"] = "response";
+     jsonDoc["status"] = "success";
+     jsonDoc["message"] = "特性掃描已開始";
+     serializeJson(jsonDoc, jsonBuffer);
+     Serial.println(jsonBuffer);
+   }
+ }
+ 
+ /**
+  * 輸出特性掃描結果，成功時存入 NVS
+  */
+ void reportCharacterization() {
+   characterizer1.printReport(Serial);
+   characterizer2.printReport(Serial);
+   
+   bool ok = characterizer1.getState() == CHARACTERIZER_DONE && characterizer2.getState() == CHARACTERIZER_DONE;
+   if (ok) {
+     ok = motor1.saveCompensation() && motor2.saveCompensation();
+   }
+   
+   jsonDoc.clear();
+   jsonDoc["type"] = "response";
+   jsonDoc["status"] = ok ? "success" : "error";
+   jsonDoc["message"] = ok ? "補償表已更新" : "特性掃描失敗";
+   jsonDoc["full_scale_rpm"] = min(characterizer1.getFullScaleRpm(), characterizer2.getFullScaleRpm());
+   jsonDoc["breakaway1"] = characterizer1.getBreakawayDuty(false);
+   jsonDoc["breakaway2"] = characterizer2.getBreakawayDuty(false);
+   serializeJson(jsonDoc, jsonBuffer);
+   Serial.println(jsonBuffer);
+   
+   oled.notify("Motor sweep", ok ? "saved" : "failed", 2000);
+ }
+ 
+ /**
+  * 開始兩輪的系統識別
+  * @param excitation 激勵訊號
+  * @param offset 偏置佔空比
+  * @param amplitude 激勵幅度 (佔空比)
+  * @param duration 總時間 (秒)
   */
- void sendJsonData() {
+ void startIdentification(SysIdExcitation excitation, float offset, float amplitude, float duration) {
+   if (!motorsEnabled || characterizing || identifying || autotuning) {
+     jsonDoc.clear();
+     jsonDoc["type"] = "response";
+     jsonDoc["status"] = "error";
+     jsonDoc["message"] = motorsEnabled ? "特性掃描、系統識別或自動調參進行中" : "馬達尚未啟動";
+     serializeJson(jsonDoc, jsonBuffer);
+     Serial.println(jsonBuffer);
+     return;
+   }
+   
    // 獲取互斥鎖
-   if (xSemaphoreTake(dataMutex, pdMS_TO_TICKS(5)) == pdTRUE) {
-     // 清除之前的文檔內容
+   if (xSemaphoreTake(dataMutex, pdMS_TO_TICKS(10)) == pdTRUE) {
+     wheel1.stop();
+     wheel2.stop();
+     identifier1.setExcitation(excitation, offset, amplitude, duration);
+     identifier2.setExcitation(excitation, offset, amplitude, duration);
+     identifier1.start();
+     identifier2.start();
+     identifying = true;
+     
+     // 釋放互斥鎖
+     xSemaphoreGive(dataMutex);
+     
+     oled.notify("System ID", "running...", 0);
+     
+     jsonDoc.clear();
+     jsonDoc["type"] = "response";
+     jsonDoc["status"] = "success";
+     jsonDoc["message"] = "系統識別已開始";
+     serializeJson(jsonDoc, jsonBuffer);
+     Serial.println(jsonBuffer);
+   }
+ }
+ 
+ /**
+  * 輸出兩輪的識別模型與建議的 PI 增益
+  */
+ void reportIdentification() {
+   identifier1.printReport(Serial);
+   identifier2.printReport(Serial);
+   
+   bool ok = identifier1.getState() == SYSID_DONE && identifier2.getState() == SYSID_DONE;
+   const FopdtModel& model1 = identifier1.getModel();
+   const FopdtModel& model2 = identifier2.getModel();
+   PiGains gains1 = identifier1.suggestPi();
+   PiGains gains2 = identifier2.suggestPi();
+   
+   jsonDoc.clear();
+   jsonDoc["type"] = "response";
+   jsonDoc["status"] = ok ? "success" : "error";
+   jsonDoc["message"] = ok ? "系統識別完成" : "系統識別失敗";
+   jsonDoc["gain1"] = model1.gain;
+   jsonDoc["tau1"] = model1.timeConstant;
+   jsonDoc["delay1"] = model1.delay;
+   jsonDoc["kp1"] = gains1.kp;
+   jsonDoc["ki1"] = gains1.ki;
+   jsonDoc["gain2"] = model2.gain;
+   jsonDoc["tau2"] = model2.timeConstant;
+   jsonDoc["delay2"] = model2.delay;
+   jsonDoc["kp2"] = gains2.kp;
+   jsonDoc["ki2"] = gains2.ki;
+   serializeJson(jsonDoc, jsonBuffer);
+   Serial.println(jsonBuffer);
+   
+   if (ok) {
+     char line[24];
+     snprintf(line, sizeof(line), "P%.2f I%.1f", (gains1.kp + gains2.kp) / 2, (gains1.ki + gains2.ki) / 2);
+     oled.notify("System ID", line, 3000);
+   } else {
+     oled.notify("System ID", "failed", 2000);
+   }
+ }
+ 
+ /**
+  * 開始兩輪的繼電器自動調參
+  * @param setpoint 振盪中心的輪速 (RPM)
+  * @param rule 完成後套用的調參法則
+  */
+ void startAutotune(float setpoint, AutotuneRule rule) {
+   if (!motorsEnabled || characterizing || identifying || autotuning) {
      jsonDoc.clear();
+     jsonDoc["type"] = "response";
+     jsonDoc["status"] = "error";
+     jsonDoc["message"] = motorsEnabled ? "特性掃描、系統識別或自動調參進行中" : "馬達尚未啟動";
+     serializeJson(jsonDoc, jsonBuffer);
+     Serial.println(jsonBuffer);
+     return;
+   }
+   
+   // 獲取互斥鎖
+   if (xSemaphoreTake(dataMutex, pdMS_TO_TICKS(10)) == pdTRUE) {
+     wheel1.stop();
+     wheel2.stop();
+     autotuneRule = rule;
+     autotuner1.setRelay(setpoint, 0.3f, 0.15f, 2.0f);
+     autotuner2.setRelay(setpoint, 0.3f, 0.15f, 2.0f);
+     autotuner1.start();
+     autotuner2.start();
+     autotuning = true;
      
-     // 添加數據
-     jsonDoc["type"] = "data";
-     jsonDoc["timestamp"] = millis();
-     jsonDoc["target_rpm"] = targetRPM;
-     jsonDoc["current_rpm"] = currentRPM;
-     jsonDoc["error"] = targetRPM - currentRPM;
-     jsonDoc["motor_output"] = motorOutput;
-     jsonDoc["kp"] = Kp;
-     jsonDoc["ki"] = Ki;
-     jsonDoc["kd"] = Kd;
+     // 釋放互斥鎖
+     xSemaphoreGive(dataMutex);
      
-     // 序列化並發送
+     oled.notify("Autotune", "running...", 0);
+     
+     jsonDoc.clear();
+     jsonDoc["type"] = "response";
+     jsonDoc["status"] = "success";
+     jsonDoc["message"] = "自動調參已開始";
      serializeJson(jsonDoc, jsonBuffer);
      Serial.println(jsonBuffer);
+   }
+ }
+ 
+ /**
+  * 輸出自動調參的量測結果與套用的增益
+  */
+ void reportAutotune() {
+   autotuner1.printReport(Serial);
+   autotuner2.printReport(Serial);
+   
+   bool ok = autotuner1.getState() == AUTOTUNE_DONE && autotuner2.getState() == AUTOTUNE_DONE;
+   
+   jsonDoc.clear();
+   jsonDoc["type"] = "response";
+   jsonDoc["status"] = ok ? "success" : "error";
+   jsonDoc["message"] = ok ? "自動調參完成，PID參數已更新" : "自動調參失敗";
+   jsonDoc["ku1"] = autotuner1.getUltimateGain();
+   jsonDoc["pu1"] = autotuner1.getUltimatePeriod();
+   jsonDoc["ku2"] = autotuner2.getUltimateGain();
+   jsonDoc["pu2"] = autotuner2.getUltimatePeriod();
+   jsonDoc["kp"] = Kp;
+   jsonDoc["ki"] = Ki;
+   jsonDoc["kd"] = Kd;
+   serializeJson(jsonDoc, jsonBuffer);
+   Serial.println(jsonBuffer);
+   
+   if (ok) {
+     char line[24];
+     snprintf(line, sizeof(line), "P%.2f I%.1f", Kp, Ki);
+     oled.notify("Autotune", line, 3000);
+   } else {
+     oled.notify("Autotune", "failed", 2000);
+   }
+ }
+ 
+ /**
+  * 中止特性掃描、系統識別與自動調參；PID 任務在下一個週期看到狀態改變後收尾並回報
+  */
+ void abortTests() {
+   // 獲取互斥鎖
+   if (xSemaphoreTake(dataMutex, pdMS_TO_TICKS(10)) == pdTRUE) {
+     characterizer1.abort();
+     characterizer2.abort();
+     identifier1.abort();
+     identifier2.abort();
+     autotuner1.abort();
+     autotuner2.abort();
      
      // 釋放互斥鎖
      xSemaphoreGive(dataMutex);
    }
  }
  
+ /**
+  * 由名稱解析調參法則 (預設 zn_pi)
+  */
+ AutotuneRule parseAutotuneRule(String name) {
+   name.toLowerCase();
+   if (name == "zn_pid") {
+     return AUTOTUNE_ZIEGLER_NICHOLS_PID;
+   }
+   if (name == "tyreus_luyben") {
+     return AUTOTUNE_TYREUS_LUYBEN;
+   }
+   if (name == "some_overshoot") {
+     return AUTOTUNE_SOME_OVERSHOOT;
+   }
+   if (name == "no_overshoot") {
+     return AUTOTUNE_NO_OVERSHOOT;
+   }
+   return AUTOTUNE_ZIEGLER_NICHOLS_PI;
+ }
+ 
+ /**
+  * 由名稱解析激勵訊號 ("step" / "prbs" / "chirp"，不分大小寫)
+  */
+ SysIdExcitation parseExcitation(String name) {
+   name.toLowerCase();
+   if (name == "prbs") {
+     return SYSID_PRBS;
+   }
+   if (name == "chirp") {
+     return SYSID_CHIRP;
+   }
+   return SYSID_STEP;
+ }
+ 
  /**
   * 處理串口命令
   */
@@ -337,7 +814,8 @@
          // 獲取互斥鎖
          if (xSemaphoreTake(dataMutex, pdMS_TO_TICKS(10)) == pdTRUE) {
            // 更新PID參數
-           motorPID.SetTunings(newKp, newKi, newKd);
+           wheel1.setTunings(newKp, newKi, newKd);
+           wheel2.setTunings(newKp, newKi, newKd);
            Kp = newKp;
            Ki = newKi;
            Kd = newKd;
@@ -378,6 +856,63 @@
            Serial.println(jsonBuffer);
          }
        }
+       else if (commandType == "set_turn") {
+         // 設置轉向量
+         int newTurn = jsonDoc["value"].as<int>();
+         
+         // 獲取互斥鎖
+         if (xSemaphoreTake(dataMutex, pdMS_TO_TICKS(10)) == pdTRUE) {
+           turnRPM = newTurn;
+           
+           // 釋放互斥鎖
+           xSemaphoreGive(dataMutex);
+           
+           // 發送確認
+           jsonDoc.clear();
+           jsonDoc["type"] = "response";
+           jsonDoc["status"] = "success";
+           jsonDoc["message"] = "轉向量已設置";
+           jsonDoc["turn_rpm"] = newTurn;
+           serializeJson(jsonDoc, jsonBuffer);
+           Serial.println(jsonBuffer);
+         }
+       }
+       else if (commandType == "characterize") {
+         // 馬達特性掃描
+         startCharacterization();
+       }
+       else if (commandType == "identify") {
+         // 系統識別；步階預設從低速跳到中速，PRBS/掃頻預設在中速附近小幅擾動
+         SysIdExcitation excitation = parseExcitation(jsonDoc["mode"].as<String>());
+         bool step = excitation == SYSID_STEP;
+         float offset = jsonDoc["offset"] | (step ? 0.2f : 0.4f);
+         float amplitude = jsonDoc["amplitude"] | (step ? 0.3f : 0.15f);
+         float duration = jsonDoc["duration"] | (step ? 3.0f : 8.0f);
+         startIdentification(excitation, offset, amplitude, duration);
+       }
+       else if (commandType == "autotune") {
+         // 繼電器自動調參
+         float setpoint = jsonDoc["setpoint"] | 100.0f;
+         startAutotune(setpoint, parseAutotuneRule(jsonDoc["rule"].as<String>()));
+       }
+       else if (commandType == "abort") {
+         // 中止測試模式
+         abortTests();
+       }
+       else if (commandType == "set_telemetry") {
+         // 切換遙測模式
+         String mode = jsonDoc["mode"].as<String>();
+         setBinaryMode(mode == "binary");
+         
+         // 發送確認
+         jsonDoc.clear();
+         jsonDoc["type"] = "response";
+         jsonDoc["status"] = "success";
+         jsonDoc["message"] = "遙測模式已切換";
+         jsonDoc["mode"] = binaryMode ? "binary" : "json";
+         serializeJson(jsonDoc, jsonBuffer);
+         Serial.println(jsonBuffer);
+       }
        else {
          // 未知命令
          jsonDoc.clear();
@@ -404,7 +939,8 @@
            // 獲取互斥鎖
            if (xSemaphoreTake(dataMutex, pdMS_TO_TICKS(10)) == pdTRUE) {
              // 更新PID參數
-             motorPID.SetTunings(newKp, newKi, newKd);
+             wheel1.setTunings(newKp, newKi, newKd);
+             wheel2.setTunings(newKp, newKi, newKd);
              Kp = newKp;
              Ki = newKi;
              Kd = newKd;
@@ -446,6 +982,57 @@
            Serial.println(jsonBuffer);
          }
        }
+       else if (input.startsWith("TURN:")) {
+         // 設置轉向量
+         int newTurn = input.substring(5).toInt();
+         
+         // 獲取互斥鎖
+         if (xSemaphoreTake(dataMutex, pdMS_TO_TICKS(10)) == pdTRUE) {
+           turnRPM = newTurn;
+           
+           // 釋放互斥鎖
+           xSemaphoreGive(dataMutex);
+           
+           // 發送確認
+           jsonDoc.clear();
+           jsonDoc["type"] = "response";
+           jsonDoc["status"] = "success";
+           jsonDoc["message"] = "轉向量已設置";
+           jsonDoc["turn_rpm"] = newTurn;
+           serializeJson(jsonDoc, jsonBuffer);
+           Serial.println(jsonBuffer);
+         }
+       }
+       else if (input == "CHAR") {
+         // 馬達特性掃描
+         startCharacterization();
+       }
+       else if (input.startsWith("SYSID:")) {
+         // 系統識別 (預設參數)
+         SysIdExcitation excitation = parseExcitation(input.substring(6));
+         if (excitation == SYSID_STEP) {
+           startIdentification(excitation, 0.2f, 0.3f, 3.0f);
+         } else {
+           startIdentification(excitation, 0.4f, 0.15f, 8.0f);
+         }
+       }
+       else if (input == "TUNE" || input.startsWith("TUNE:")) {
+         // 繼電器自動調參 (ZN PI)
+         float setpoint = input.length() > 5 ? input.substring(5).toFloat() : 100.0f;
+         startAutotune(setpoint, AUTOTUNE_ZIEGLER_NICHOLS_PI);
+       }
+       else if (input == "ABORT") {
+         // 中止測試模式
+         abortTests();
+       }
+       else if (input == "TEL:BIN" || input == "TEL:JSON") {
+         // 切換遙測模式
+         setBinaryMode(input == "TEL:BIN");
+       }
+       else if (input == "PARAM") {
+         // 切換調試頁面的參數調整模式 (取代參數按鈕)
+         debugPage.nextParamMode();
+       }
        else {
          // 未知命令
          jsonDoc.clear();
@@ -471,7 +1058,7 @@
    }
    
    // 初始化 OLED
-   if (!oled.begin(I2C_SDA, I2C_SCL)) {
+   if (!oled.begin(BOARD.i2cSda, BOARD.i2cScl)) {
      while (1) {
        delay(1000);  // 如果OLED初始化失敗，停止執行
      }
@@ -486,8 +1073,8 @@
    }
    
    // 初始化馬達
-   motor1.begin();
-   motor2.begin();
+   motor1.begin(MOTOR_PWM_LEDC, 0);
+   motor2.begin(MOTOR_PWM_LEDC, 1);
    
    // 初始化編碼器
    encoder1.begin(0);
@@ -499,18 +1086,20 @@
    
    // 設置按鈕引腳
    pinMode(BUTTON_PIN, INPUT_PULLUP);
-   pinMode(PARAM_BUTTON_PIN, INPUT_PULLUP);
+   if (PARAM_BUTTON_PIN != PIN_NONE) {
+     pinMode(PARAM_BUTTON_PIN, INPUT_PULLUP);
+   }
    
-   // 初始化PID
-   motorPID.SetMode(AUTOMATIC);
-   motorPID.SetOutputLimits(0, 255);  // 輸出限制在0-255之間
-   motorPID.SetSampleTime(10);  // 設置PID計算間隔為10ms
+   // 初始化PID (兩輪輸出皆為 -255 到 255，可反轉)
+   wheel1.setTunings(Kp, Ki, Kd);
+   wheel2.setTunings(Kp, Ki, Kd);
    
    // 等待BOOT按鈕按下後才開始
    oled.displayMessage("Press BOOT", "to start motors");
    
-   // 等待按鈕按下
+   // 等待按鈕按下 (期間持續更新顯示，讓排隊的通知依序出現)
    while (digitalRead(BUTTON_PIN) == HIGH) {
+     oled.update();
      delay(10);
    }
    delay(100);  // 防抖動
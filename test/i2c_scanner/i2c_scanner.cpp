@@ -11,7 +11,7 @@ void setup() {
   Serial.println("\nI2C Scanner");
   
   // Initialize I2C with pins defined in config.h
-  Wire.begin(I2C_SDA, I2C_SCL);
+  Wire.begin(BOARD.i2cSda, BOARD.i2cScl);
   
   Serial.println("Scanning I2C bus...");
 }
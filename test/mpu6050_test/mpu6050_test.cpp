@@ -39,7 +39,7 @@ void dmpDataReady() {
 
 void setup() {
   // Initialize I2C
-  Wire.begin(I2C_SDA, I2C_SCL, 400000);  // Set I2C clock to 400kHz
+  Wire.begin(BOARD.i2cSda, BOARD.i2cScl, 400000);  // Set I2C clock to 400kHz
 
 
   // Initialize serial communication
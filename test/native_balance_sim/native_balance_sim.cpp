@@ -0,0 +1,189 @@
+/**
+ * native_balance_sim.cpp
+ *
+ * 在 Linux 主機上以倒單擺模型驗證串級平衡控制器 (env:native_balance_sim)
+ * 功能：
+ * 1. 一階馬達模型依 PWM 佔空比與方向腳位推動輪子，並產生正交編碼器邊緣
+ * 2. 車身視為倒單擺，輪子加速度回饋到俯仰角，透過 NativeSim 提供給 MPU6050 替身
+ * 3. 編碼器與 main.cpp 相同使用 PCNT 後端，以 esp_timer + 控制任務執行 1 kHz 內環，外環由 MPU6050 INT 的數據就緒中斷觸發 (100 Hz)，初始傾角 5 度
+ *    以 -DSIM_IMU_MODE=IMU_MODE_COMPLEMENTARY 或 IMU_MODE_MAHONY 編譯時改用原始感測器濾波，外環隨 1 kHz 取樣執行
+ * 4. 右輪馬達比左輪弱 10%，驗證每輪獨立的輪速環能讓車身直線前進 (輸出兩輪位置差換算的航向偏差)
+ * 5. 每秒輸出姿態、輪速與控制器的執行時間、抖動、延遲統計；
+ *    執行 10 秒後若車身仍維持平衡則返回 0，否則返回 1
+ *
+ * 執行：.pio/build/native_balance_sim/program
+ */
+
+#include <Arduino.h>
+#include "NativeSim.h"
+#include "motor.h"
+#include "encoder.h"
+#include "IMU.h"
+#include "BalanceController.h"
+#include "config.h"
+
+// 模型參數
+#define SIM_MAX_RPM 300.0       // 滿佔空比時的空載轉速
+#define SIM_MOTOR_TAU 0.05      // 馬達時間常數 (s)
+#define SIM_WHEEL_RADIUS 0.0325 // 輪半徑 (m)
+#define SIM_PENDULUM_LENGTH 0.08 // 轉軸到重心距離 (m)
+#define SIM_STEP_US 200         // 模型積分步長
+#define PULSES_PER_REV 440
+#define SIM_TRACK_WIDTH 0.15    // 輪距 (m)
+#define SIM_WHEEL2_GAIN 0.9     // 右輪馬達相對於左輪的力矩
+
+// BOARD_REV_A 的 INT 未連接，模擬 BOARD_REV_A_INT4 的接法 (INT 接到空閒的 GPIO4)
+#define SIM_IMU_INT_PIN BOARD_REV_A_INT4.mpuInt
+
+// 姿態來源 (IMU_MODE_DMP / IMU_MODE_COMPLEMENTARY / IMU_MODE_MAHONY)
+#ifndef SIM_IMU_MODE
+#define SIM_IMU_MODE IMU_MODE_DMP
+#endif
+#define SIM_RAW_RATE_HZ 1000
+
+PinnedMotor<BOARD.wheels[0].pwm, BOARD.wheels[0].in1, BOARD.wheels[0].in2, BOARD.motorStby> motor1("motor1");
+PinnedMotor<BOARD.wheels[1].pwm, BOARD.wheels[1].in1, BOARD.wheels[1].in2, BOARD.motorStby> motor2("motor2");
+
+PinnedEncoder<BOARD.wheels[0].encoderA, BOARD.wheels[0].encoderB> encoder1("encoder1", PULSES_PER_REV);
+PinnedEncoder<BOARD.wheels[1].encoderA, BOARD.wheels[1].encoderB> encoder2("encoder2", PULSES_PER_REV);
+
+IMU imu;
+
+BalanceController balance(&imu, &motor1, &motor2, &encoder1, &encoder2);
+
+// 每個輪子的模擬狀態
+struct WheelSim {
+    uint8_t pwmPin, in1Pin, in2Pin;
+    uint8_t pinA, pinB;
+    int sign;           // 編碼器安裝方向
+    double gain;        // 馬達強度 (1 = SIM_MAX_RPM)
+    double rpm;         // 目前轉速
+    double phase;       // 累積的正交相位 (邊緣數)
+    long edges;         // 已輸出的邊緣數
+};
+
+WheelSim wheel1 = {BOARD.wheels[0].pwm, BOARD.wheels[0].in1, BOARD.wheels[0].in2, BOARD.wheels[0].encoderA, BOARD.wheels[0].encoderB, 1, 1.0, 0, 0, 0};
+WheelSim wheel2 = {BOARD.wheels[1].pwm, BOARD.wheels[1].in1, BOARD.wheels[1].in2, BOARD.wheels[1].encoderA, BOARD.wheels[1].encoderB, -1, SIM_WHEEL2_GAIN, 0, 0, 0};
+
+// 車身狀態：俯仰角 (前傾為正) 與角速度
+double theta = 5.0 * DEG_TO_RAD;
+double thetaRate = 0;
+
+unsigned long lastReport = 0;
+double maxAbsTheta = 0;
+
+// 輪子行進距離 (m，向前為正)
+double wheelDistance(const WheelSim& w) {
+    return w.sign * w.phase / PULSES_PER_REV * TWO_PI * SIM_WHEEL_RADIUS;
+}
+
+// 推進輪子並產生正交邊緣，返回輪子角加速度 (rad/s^2)
+double simulateWheel(WheelSim& w, double dt) {
+    double duty = NativeSim::pinDutyFraction(w.pwmPin);
+    int dir = 0;
+    if (NativeSim::pinLevel(w.in1Pin) == HIGH && NativeSim::pinLevel(w.in2Pin) == LOW) dir = 1;
+    if (NativeSim::pinLevel(w.in1Pin) == LOW && NativeSim::pinLevel(w.in2Pin) == HIGH) dir = -1;
+
+    double target = dir * duty * SIM_MAX_RPM * w.gain;
+    double accelRpm = (target - w.rpm) / SIM_MOTOR_TAU;
+    w.rpm += accelRpm * dt;
+    w.phase += w.sign * w.rpm / 60.0 * PULSES_PER_REV * dt;
+
+    long edge = (long)floor(w.phase);
+    while (w.edges != edge) {
+        w.edges += (edge > w.edges) ? 1 : -1;
+        // 格雷碼序列 00 -> 10 -> 11 -> 01
+        long state = ((w.edges % 4) + 4) % 4;
+        int a = (state == 1 || state == 2) ? HIGH : LOW;
+        int b = (state == 2 || state == 3) ? HIGH : LOW;
+        if (NativeSim::pinLevel(w.pinA) != a) NativeSim::setInputLevel(w.pinA, a);
+        if (NativeSim::pinLevel(w.pinB) != b) NativeSim::setInputLevel(w.pinB, b);
+    }
+
+    return accelRpm * TWO_PI / 60.0;
+}
+
+void setup() {
+    Serial.begin(115200);
+    Serial.println("=== native balance sim ===");
+
+    NativeSim::setImuModel([](uint64_t, NativeSim::ImuState& s) {
+        s.pitch = (float)theta;
+        s.pitchRate = (float)thetaRate;
+    });
+
+    NativeSim::setImuIntPin(SIM_IMU_INT_PIN);
+    if (!imu.begin(BOARD.i2cSda, BOARD.i2cScl)) {
+        Serial.println("IMU 初始化失敗");
+        NativeSim::requestExit(1);
+        return;
+    }
+    imu.enableInterrupt(SIM_IMU_INT_PIN);
+    if (SIM_IMU_MODE != IMU_MODE_DMP) {
+        imu.setMode(SIM_IMU_MODE, SIM_RAW_RATE_HZ);
+    }
+
+    motor1.begin(MOTOR_PWM_LEDC, 0);
+    motor2.begin(MOTOR_PWM_LEDC, 1);
+    motor1.setDither(true);
+    motor2.setDither(true);
+    encoder1.begin(0, ENCODER_BACKEND_PCNT);
+    encoder2.begin(1, ENCODER_BACKEND_PCNT);
+    encoder2.setInverted(true);
+    motor1.setRunning(true);
+    motor2.setRunning(true);
+
+    balance.setRates(SIM_IMU_MODE == IMU_MODE_DMP ? 100 : SIM_RAW_RATE_HZ, 1000);
+    balance.start(5, 1);
+    balance.setEnabled(true);
+}
+
+void loop() {
+    double dt = SIM_STEP_US / 1e6;
+    double alpha1 = simulateWheel(wheel1, dt);
+    double alpha2 = simulateWheel(wheel2, dt);
+
+    // 倒單擺：輪子向前加速使車身後仰
+    double accel = (alpha1 + alpha2) * 0.5 * SIM_WHEEL_RADIUS;
+    double thetaAccel = (9.81 * sin(theta) - accel * cos(theta)) / SIM_PENDULUM_LENGTH;
+    thetaRate += thetaAccel * dt;
+    theta += thetaRate * dt;
+    if (fabs(theta) > HALF_PI) {
+        theta = theta > 0 ? HALF_PI : -HALF_PI;
+        thetaRate = 0;
+    }
+    if (millis() > 2000) {
+        maxAbsTheta = max(maxAbsTheta, fabs(theta));
+    }
+
+    if (millis() - lastReport >= 1000) {
+        lastReport = millis();
+        BalanceStats stats = balance.getStats();
+        double heading = (wheelDistance(wheel1) - wheelDistance(wheel2)) / SIM_TRACK_WIDTH;
+        Serial.printf("t=%lus pitch=%.2fdeg wheel=%.1frpm set=%.1frpm out=%d/%d heading=%.1fdeg%s\n",
+                      millis() / 1000, theta * RAD_TO_DEG, balance.getWheelVelocity(),
+                      balance.getVelocitySetpoint(), balance.getLeftWheel().getOutput(),
+                      balance.getRightWheel().getOutput(), heading * RAD_TO_DEG,
+                      balance.isFallen() ? " FALLEN" : "");
+        Serial.printf("  inner: %u ticks, exec max %uus, jitter max %uus, missed %u | "
+                      "outer: %u ticks, exec max %uus, jitter max %uus, missed %u | latency %u/%uus\n",
+                      (unsigned)stats.inner.ticks, (unsigned)stats.inner.maxExecMicros,
+                      (unsigned)stats.inner.maxJitterMicros, (unsigned)stats.inner.missed,
+                      (unsigned)stats.outer.ticks, (unsigned)stats.outer.maxExecMicros,
+                      (unsigned)stats.outer.maxJitterMicros, (unsigned)stats.outer.missed,
+                      (unsigned)stats.lastLatencyMicros, (unsigned)stats.maxLatencyMicros);
+
+        if (balance.isFallen()) {
+            NativeSim::requestExit(1);
+        } else if (millis() >= 10000) {
+            // 2 秒後的最大傾角超過 3 度視為未收斂
+            Serial.printf("max |pitch| after 2s: %.2fdeg\n", maxAbsTheta * RAD_TO_DEG);
+            ImuFifoStats fifo = imu.getFifoStats();
+            Serial.printf("imu fifo: %u packets, max backlog %u, overflows %u\n",
+                          (unsigned)fifo.packets, (unsigned)fifo.maxBacklog, (unsigned)fifo.overflows);
+            NativeSim::requestExit(maxAbsTheta > 3.0 * DEG_TO_RAD ? 1 : 0);
+        }
+    }
+
+    NativeSim::sleepMicros(SIM_STEP_US);
+}
@@ -0,0 +1,217 @@
+/**
+ * native_host_demo.cpp
+ *
+ * 在 Linux 主機上執行整個 lib/ 堆疊的示範程式 (env:native)
+ * 功能：
+ * 1. 以簡單的馬達模型依 PWM 佔空比產生兩輪的正交編碼器邊緣
+ * 2. 以 NativeSim 設定 MPU6050 的擺動姿態，驗證 IMU/DMP 路徑
+ * 3. 依序顯示 MotorPage、IMUPage、DebugPage，並統計 OLED 的 I2C 傳輸量 (傳輸在背景任務進行)
+ * 4. 輸出每個模組 update() 的主機端平均耗時與模擬時間 (含 I2C 阻塞)，作為迴圈成本的基準
+ * 5. 馬達以 LEDC 後端 (20 kHz / 10 位元) 驅動，輸出馬達腳位的實際寫入次數
+ * 6. IMU 與 OLED 經由 I2CBus 共用 Wire，輸出每個裝置等待與佔用匯流排的時間
+ *
+ * 執行：.pio/build/native/program --seconds 5
+ */
+
+#include <Arduino.h>
+#include <chrono>
+#include "NativeSim.h"
+#include "motor.h"
+#include "encoder.h"
+#include "IMU.h"
+#include "I2CBus.h"
+#include "OLED_Manager.h"
+#include "pages/MotorPage.h"
+#include "pages/IMUPage.h"
+#include "pages/DebugPage.h"
+#include "config.h"
+
+// 馬達模型：滿佔空比時的空載轉速
+#define SIM_MAX_RPM 300.0
+#define PULSES_PER_REV 440
+
+Motor motor1(BOARD.wheels[0].pwm, BOARD.wheels[0].in1, BOARD.wheels[0].in2, BOARD.motorStby, "motor1");
+Motor motor2(BOARD.wheels[1].pwm, BOARD.wheels[1].in1, BOARD.wheels[1].in2, BOARD.motorStby, "motor2");
+
+Encoder encoder1(BOARD.wheels[0].encoderA, BOARD.wheels[0].encoderB, "encoder1", PULSES_PER_REV);
+Encoder encoder2(BOARD.wheels[1].encoderA, BOARD.wheels[1].encoderB, "encoder2", PULSES_PER_REV);
+
+I2CBus i2cBus(Wire);
+IMU imu;
+OLED_Manager oled;
+
+// DebugPage 需要的共享數據 (在 PID 測試中由主程式定義)
+double targetRPM = 120;
+double currentRPM = 0;
+double Kp = 1.0, Ki = 0.2, Kd = 0.0;
+double rpmHistory[64] = {0};
+int historyIndex = 0;
+
+MotorPage motorPage(&motor1, &motor2, &encoder1, &encoder2);
+IMUPage imuPage(&imu);
+DebugPage debugPage(&targetRPM, &currentRPM, &Kp, &Ki, &Kd);
+
+// 每個輪子的模擬狀態
+struct WheelSim {
+    uint8_t pwmPin, in1Pin, in2Pin;
+    uint8_t pinA, pinB;
+    double phase;       // 累積的正交相位 (邊緣數)
+    long edges;         // 已輸出的邊緣數
+};
+
+WheelSim wheel1 = {BOARD.wheels[0].pwm, BOARD.wheels[0].in1, BOARD.wheels[0].in2, BOARD.wheels[0].encoderA, BOARD.wheels[0].encoderB, 0, 0};
+WheelSim wheel2 = {BOARD.wheels[1].pwm, BOARD.wheels[1].in1, BOARD.wheels[1].in2, BOARD.wheels[1].encoderA, BOARD.wheels[1].encoderB, 0, 0};
+
+// 主機端耗時統計
+struct StageCost {
+    const char* name;
+    double totalUs;
+    unsigned long simUs;    // 模擬時間 (含呼叫端被 I2C 傳輸阻塞的時間)
+    unsigned long calls;
+};
+
+StageCost costs[] = {
+    {"imu.update", 0, 0, 0},
+    {"motor.setSpeed", 0, 0, 0},
+    {"encoder.update", 0, 0, 0},
+    {"oled.update", 0, 0, 0},
+};
+
+unsigned long lastSimMicros = 0;
+unsigned long lastPageSwitch = 0;
+unsigned long lastReport = 0;
+int speedCommand = 150;
+
+template <typename F>
+void measure(StageCost& cost, F fn) {
+    unsigned long simStart = micros();
+    auto start = std::chrono::steady_clock::now();
+    fn();
+    auto end = std::chrono::steady_clock::now();
+    cost.totalUs += std::chrono::duration<double, std::micro>(end - start).count();
+    cost.simUs += micros() - simStart;
+    cost.calls++;
+}
+
+// 依佔空比推進輪子並產生正交邊緣 (A 領先 B 為正轉)
+void simulateWheel(WheelSim& w, double dtSeconds) {
+    double duty = NativeSim::pinDutyFraction(w.pwmPin);
+    int dir = 0;
+    if (NativeSim::pinLevel(w.in1Pin) == HIGH && NativeSim::pinLevel(w.in2Pin) == LOW) dir = 1;
+    if (NativeSim::pinLevel(w.in1Pin) == LOW && NativeSim::pinLevel(w.in2Pin) == HIGH) dir = -1;
+
+    double rpm = dir * duty * SIM_MAX_RPM;
+    w.phase += rpm / 60.0 * PULSES_PER_REV * dtSeconds;
+
+    long target = (long)floor(w.phase);
+    while (w.edges != target) {
+        w.edges += (target > w.edges) ? 1 : -1;
+        // 格雷碼序列 00 -> 10 -> 11 -> 01
+        long state = ((w.edges % 4) + 4) % 4;
+        int a = (state == 1 || state == 2) ? HIGH : LOW;
+        int b = (state == 2 || state == 3) ? HIGH : LOW;
+        if (NativeSim::pinLevel(w.pinA) != a) NativeSim::setInputLevel(w.pinA, a);
+        if (NativeSim::pinLevel(w.pinB) != b) NativeSim::setInputLevel(w.pinB, b);
+    }
+}
+
+void setup() {
+    Serial.begin(115200);
+    Serial.println("=== native host demo ===");
+
+    // 模擬機器人前後擺動 (±10 度, 0.5 Hz)
+    NativeSim::setImuModel([](uint64_t nowUs, NativeSim::ImuState& s) {
+        double t = nowUs / 1e6;
+        double w = 2 * M_PI * 0.5;
+        s.pitch = (float)(10.0 * DEG_TO_RAD * sin(w * t));
+        s.pitchRate = (float)(10.0 * DEG_TO_RAD * w * cos(w * t));
+    });
+
+    oled.setBus(&i2cBus);
+    imu.setBus(&i2cBus);
+    oled.begin(BOARD.i2cSda, BOARD.i2cScl, false);
+    oled.startTask(1, 0);
+    if (!imu.begin(BOARD.i2cSda, BOARD.i2cScl, I2C_MPU_ADDR)) {
+        Serial.println("IMU 初始化失敗");
+        NativeSim::requestExit(1);
+        return;
+    }
+
+    oled.addPage(&motorPage);
+    oled.addPage(&imuPage);
+    oled.addPage(&debugPage);
+    oled.setPage(0);
+
+    motor1.begin(MOTOR_PWM_LEDC, 0);
+    motor2.begin(MOTOR_PWM_LEDC, 1);
+    encoder1.begin(0);
+    encoder2.begin(1);
+    encoder2.setInverted(true);
+    motor1.setRunning(true);
+    motor2.setRunning(true);
+
+    // 只統計穩態：DMP 初始化與顯示器初始化各佔用匯流排數十 ms
+    i2cBus.resetStats();
+
+    lastSimMicros = micros();
+}
+
+void loop() {
+    unsigned long now = micros();
+    double dt = (now - lastSimMicros) / 1e6;
+    lastSimMicros = now;
+    simulateWheel(wheel1, dt);
+    simulateWheel(wheel2, dt);
+
+    measure(costs[0], [] { imu.update(); });
+    measure(costs[1], [] {
+        motor1.setSpeed(speedCommand);
+        motor2.setSpeed(-speedCommand);
+    });
+    measure(costs[2], [] {
+        encoder1.update();
+        encoder2.update();
+    });
+
+    currentRPM = encoder1.getRPM();
+    rpmHistory[historyIndex] = currentRPM;
+    historyIndex = (historyIndex + 1) % 64;
+
+    measure(costs[3], [] { oled.update(); });
+
+    // 每 2 秒切換頁面並改變速度命令
+    if (millis() - lastPageSwitch >= 2000) {
+        lastPageSwitch = millis();
+        oled.nextPage();
+        speedCommand = (speedCommand == 150) ? 60 : 150;
+    }
+
+    if (millis() - lastReport >= 1000) {
+        lastReport = millis();
+        Serial.printf("t=%lus page=%s M1=%d E1=%.1frpm E2=%.1frpm pitch=%.1fdeg oled_bytes=%u (est %u, last frame %u B/%u tiles, skipped %u, dropped %u)\n",
+                      millis() / 1000,
+                      oled.getCurrentPageIndex() == 0 ? motorPage.getName()
+                          : (oled.getCurrentPageIndex() == 1 ? imuPage.getName() : debugPage.getName()),
+                      motor1.getSpeed(), encoder1.getRPM(), encoder2.getRPM(),
+                      imu.getPitch() * RAD_TO_DEG,
+                      (unsigned)oled.getU8G2().hostBytesSent(), (unsigned)oled.getTotalBytesSent(),
+                      (unsigned)oled.getLastFrameBytes(), (unsigned)oled.getLastFrameTiles(),
+                      (unsigned)oled.getFramesSkipped(), (unsigned)oled.getFramesDropped());
+
+        // 馬達以 LEDC 驅動，命令不變時不寫腳位；速度命令每 2 秒才改變，寫入次數應遠少於呼叫次數
+        Serial.printf("  motor1 pin writes: %u (pwm %u, ain1 %u, ain2 %u) for %lu setSpeed calls, %u-bit @ %u Hz\n",
+                      (unsigned)(NativeSim::pinWriteCount(BOARD.wheels[0].pwm) + NativeSim::pinWriteCount(BOARD.wheels[0].in1) +
+                                 NativeSim::pinWriteCount(BOARD.wheels[0].in2)),
+                      (unsigned)NativeSim::pinWriteCount(BOARD.wheels[0].pwm), (unsigned)NativeSim::pinWriteCount(BOARD.wheels[0].in1),
+                      (unsigned)NativeSim::pinWriteCount(BOARD.wheels[0].in2), costs[1].calls,
+                      (unsigned)NativeSim::pinDutyBits(BOARD.wheels[0].pwm), (unsigned)NativeSim::ledcFrequency(0));
+
+        for (const StageCost& c : costs) {
+            Serial.printf("  %-16s %8.2f us/call (host) %8.1f us/call (sim)\n", c.name,
+                          c.calls ? c.totalUs / c.calls : 0.0, c.calls ? (double)c.simUs / c.calls : 0.0);
+        }
+        i2cBus.printStats(Serial);
+    }
+
+    delay(10);
+}
@@ -0,0 +1,226 @@
+/**
+ * native_pid_benchmark.cpp
+ *
+ * 在 Linux 主機上比較 Pid<T> 與原本 br3ttb PID 函式庫的計算成本與響應 (env:native_pid_benchmark)
+ * 功能：
+ * 1. PidV1Reference 逐行複製 PID_v1 的 Compute() 計算 (double，P 作用在誤差上，積分直接限幅)，
+ *    省略 millis() 取樣判斷，只比較數值計算本身
+ * 2. 以一階馬達模型 (與 PID 測試程式相同的 10ms 週期、0-255 輸出) 閉迴路執行
+ *    PidV1Reference、Pid<float>、Pid<double>、Pid<Q16>，每 BENCH_BATCH 次計算以 Profiler 記錄一次
+ * 3. 輸出每次計算的平均週期數，以及各控制器與 PID_v1 的步階響應差異 (上升時間、超越量、穩態誤差)
+ *
+ * 主機上 double 與 float 成本相近；ESP32-S3 的 FPU 只支援單精度，double 會以軟體模擬，
+ * 這裡的週期數只適合比較相對成本
+ *
+ * 執行：.pio/build/native_pid_benchmark/program
+ */
+
+#include <Arduino.h>
+#include "NativeSim.h"
+#include "Profiler.h"
+#include "Pid.h"
+
+// 模型參數
+#define SIM_MAX_RPM 300.0f      // 滿佔空比時的空載轉速
+#define SIM_MOTOR_TAU 0.05f     // 馬達時間常數 (s)
+#define SIM_DT 0.01f            // 控制週期 (s)，與 PID 測試程式相同
+#define SIM_STEPS 200           // 步階響應長度 (2 秒)
+#define SIM_TARGET_RPM 150.0f
+
+// 增益
+#define BENCH_KP 0.4f
+#define BENCH_KI 4.0f
+#define BENCH_KD 0.005f
+
+// 每次記錄包含的計算次數 (單次計算遠小於讀取週期計數器的成本)
+#define BENCH_BATCH 1000
+#define BENCH_ROUNDS 200
+
+/**
+ * PID_v1 (br3ttb/PID 1.2.1) 的 Compute() 計算，固定取樣時間
+ */
+class PidV1Reference {
+private:
+    double kp;
+    double ki;       // 已乘上取樣時間
+    double kd;       // 已除以取樣時間
+    double outMin;
+    double outMax;
+    double outputSum;
+    double lastInput;
+
+public:
+    PidV1Reference(double p, double i, double d, double sampleTime)
+        : kp(p), ki(i * sampleTime), kd(d / sampleTime),
+          outMin(0), outMax(255), outputSum(0), lastInput(0) {}
+
+    void setOutputLimits(double low, double high) {
+        outMin = low;
+        outMax = high;
+    }
+
+    // 對應 SetMode(AUTOMATIC) 時的 Initialize()
+    void initialize(double input, double output) {
+        outputSum = output;
+        lastInput = input;
+        if (outputSum > outMax) outputSum = outMax;
+        else if (outputSum < outMin) outputSum = outMin;
+    }
+
+    double compute(double setpoint, double input) {
+        double error = setpoint - input;
+        double dInput = input - lastInput;
+        outputSum += ki * error;
+
+        if (outputSum > outMax) outputSum = outMax;
+        else if (outputSum < outMin) outputSum = outMin;
+
+        double output = kp * error;
+        output += outputSum - kd * dInput;
+
+        if (output > outMax) output = outMax;
+        else if (output < outMin) output = outMin;
+
+        lastInput = input;
+        return output;
+    }
+};
+
+// 一階馬達模型
+struct MotorModel {
+    float rpm;
+
+    void reset() {
+        rpm = 0.0f;
+    }
+
+    void step(float output) {
+        float target = SIM_MAX_RPM * output / 255.0f;
+        rpm += (target - rpm) * (SIM_DT / SIM_MOTOR_TAU);
+    }
+};
+
+// 步階響應統計
+struct StepResult {
+    float riseTime;      // 首次達到 90% 目標的時間 (s)
+    float overshoot;     // 最大超越量 (rpm)
+    float finalError;    // 最後一個週期的誤差 (rpm)
+    float maxDeviation;  // 與 PID_v1 輸出的最大差異
+};
+
+Profiler profiler;
+float referenceOutput[SIM_STEPS];
+
+// 每個控制器的介面：給定設定值與量測值，返回輸出
+struct ReferenceAdapter {
+    PidV1Reference pid;
+    ReferenceAdapter() : pid(BENCH_KP, BENCH_KI, BENCH_KD, SIM_DT) {
+        pid.initialize(0, 0);
+    }
+    float compute(float setpoint, float rpm) {
+        return (float)pid.compute(setpoint, rpm);
+    }
+};
+
+template <typename T>
+struct PidAdapter {
+    Pid<T> pid;
+    PidAdapter() : pid(T(BENCH_KP), T(BENCH_KI), T(BENCH_KD), PID_DIRECT) {
+        pid.setOutputLimits(T(0), T(255));
+    }
+    float compute(float setpoint, float rpm) {
+        return (float)pid.compute(T(setpoint), T(rpm), T(SIM_DT));
+    }
+};
+
+/**
+ * 閉迴路計時：每輪重新開始步階響應，避免量測值停在穩態使分支預測過於理想
+ */
+template <typename Adapter>
+float benchmark(const char* name) {
+    int stage = profiler.registerStage(name);
+    float checksum = 0.0f;
+
+    for (int round = 0; round < BENCH_ROUNDS; round++) {
+        Adapter controller;
+        MotorModel motor;
+        motor.reset();
+
+        ProfilerScope span(&profiler, stage);
+        for (int i = 0; i < BENCH_BATCH; i++) {
+            float output = controller.compute(SIM_TARGET_RPM, motor.rpm);
+            motor.step(output);
+        }
+        checksum += motor.rpm;
+    }
+    return checksum;
+}
+
+/**
+ * 步階響應：記錄輸出並與 PID_v1 比較
+ */
+template <typename Adapter>
+StepResult stepResponse(bool isReference) {
+    Adapter controller;
+    MotorModel motor;
+    motor.reset();
+
+    StepResult result = {-1.0f, 0.0f, 0.0f, 0.0f};
+    for (int i = 0; i < SIM_STEPS; i++) {
+        float output = controller.compute(SIM_TARGET_RPM, motor.rpm);
+        if (isReference) {
+            referenceOutput[i] = output;
+        } else {
+            result.maxDeviation = max(result.maxDeviation, fabsf(output - referenceOutput[i]));
+        }
+        motor.step(output);
+
+        if (result.riseTime < 0 && motor.rpm >= SIM_TARGET_RPM * 0.9f) {
+            result.riseTime = (i + 1) * SIM_DT;
+        }
+        result.overshoot = max(result.overshoot, motor.rpm - SIM_TARGET_RPM);
+    }
+    result.finalError = SIM_TARGET_RPM - motor.rpm;
+    return result;
+}
+
+void printStep(const char* name, const StepResult& r) {
+    Serial.printf("%-14s %8.2f %10.2f %11.3f %13.3f\n",
+                  name, r.riseTime, r.overshoot, r.finalError, r.maxDeviation);
+}
+
+void setup() {
+    Serial.begin(115200);
+    Serial.println("=== PID benchmark ===");
+    Serial.printf("plant: first-order motor, tau=%.2fs, dt=%.3fs, target=%.0f rpm, Kp=%.3f Ki=%.3f Kd=%.4f\n",
+                  SIM_MOTOR_TAU, SIM_DT, SIM_TARGET_RPM, BENCH_KP, BENCH_KI, BENCH_KD);
+
+    // 步階響應
+    StepResult reference = stepResponse<ReferenceAdapter>(true);
+    Serial.printf("\n%-14s %8s %10s %11s %13s\n", "controller", "rise_s", "overshoot", "final_err", "max_out_diff");
+    printStep("PID_v1 double", reference);
+    printStep("Pid<float>", stepResponse<PidAdapter<float> >(false));
+    printStep("Pid<double>", stepResponse<PidAdapter<double> >(false));
+    printStep("Pid<Q16>", stepResponse<PidAdapter<Q16> >(false));
+
+    // 計算成本
+    float checksum = 0.0f;
+    checksum += benchmark<ReferenceAdapter>("pid_v1.double");
+    checksum += benchmark<PidAdapter<float> >("pid.float");
+    checksum += benchmark<PidAdapter<double> >("pid.double");
+    checksum += benchmark<PidAdapter<Q16> >("pid.q16");
+
+    Serial.printf("\n%-14s %14s %14s\n", "controller", "cycles/call", "ns/call");
+    for (int id = 0; id < profiler.getStageCount(); id++) {
+        const ProfilerStage& stage = profiler.getStage(id);
+        double cycles = (double)stage.totalCycles / stage.count / BENCH_BATCH;
+        Serial.printf("%-14s %14.1f %14.1f\n", stage.name, cycles, cycles * 1000.0 / ESP.getCpuFreqMHz());
+    }
+    Serial.printf("(includes motor model step; checksum %.1f)\n", checksum);
+
+    NativeSim::requestExit(0);
+}
+
+void loop() {
+    delay(1000);
+}
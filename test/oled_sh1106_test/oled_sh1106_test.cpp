@@ -17,7 +17,7 @@ void setup() {
   Serial.println("\nSH1106 OLED Display Test with U8g2");
   
   // 初始化I2C，使用config.h中定义的引脚
-  Wire.begin(I2C_SDA, I2C_SCL);
+  Wire.begin(BOARD.i2cSda, BOARD.i2cScl);
   
   // 初始化U8g2
   u8g2.begin();
@@ -201,6 +201,10 @@ class PIDTuner:
         clear_button = ttk.Button(btn_container, text="清除數據", command=self.clear_data)
         clear_button.pack(side=tk.LEFT, padx=5, expand=True, fill=tk.X)
         
+        # 自動調參按鈕 (在目標RPM附近做繼電器調參，結果直接寫入韌體並回填到介面)
+        autotune_button = ttk.Button(btn_container, text="自動調參", command=self.send_autotune)
+        autotune_button.pack(side=tk.LEFT, padx=5, expand=True, fill=tk.X)
+        
         # 測試模式框架
         test_frame = ttk.LabelFrame(control_frame, text="測試模式")
         test_frame.pack(fill=tk.X, padx=5, pady=5)
@@ -481,6 +485,13 @@ class PIDTuner:
                 
                 self.add_log(f"[響應] {message}")
                 
+                # 自動調參完成：韌體已套用新參數，回填到介面
+                if status == "success" and "ku1" in data:
+                    kp = data.get("kp", 0)
+                    ki = data.get("ki", 0)
+                    kd = data.get("kd", 0)
+                    self.root.after(0, self.apply_tuned_params, kp, ki, kd)
+                
             elif data_type == "log" or data_type == "status":
                 # 處理日誌和狀態信息
                 message = data.get("message", "")
@@ -644,6 +655,39 @@ class PIDTuner:
         except Exception as e:
             self.status_var.set(f"發送錯誤: {str(e)}")
     
+    def send_autotune(self):
+        """發送繼電器自動調參命令（以目前的目標RPM為振盪中心）"""
+        if not self.connected or not self.serial_port:
+            self.status_var.set("未連接，無法自動調參")
+            return
+            
+        try:
+            rpm = float(self.target_rpm_var.get())
+            command = {
+                "command": "autotune",
+                "setpoint": rpm if rpm > 0 else 100,
+                "rule": "zn_pi"
+            }
+            
+            json_str = json.dumps(command) + "\n"
+            self.serial_port.write(json_str.encode())
+            self.status_var.set("已發送自動調參命令")
+            self.add_log(f"已發送自動調參命令: 設定值={command['setpoint']}")
+        except ValueError:
+            self.status_var.set("目標RPM格式錯誤")
+        except Exception as e:
+            self.status_var.set(f"發送錯誤: {str(e)}")
+    
+    def apply_tuned_params(self, kp, ki, kd):
+        """將自動調參結果回填到介面（滑桿超出範圍時停在端點，輸入框顯示實際值）"""
+        self.kp_scale.set(kp)
+        self.ki_scale.set(ki)
+        self.kd_scale.set(kd)
+        self.kp_var.set(f"{kp:.2f}")
+        self.ki_var.set(f"{ki:.2f}")
+        self.kd_var.set(f"{kd:.2f}")
+        self.add_log(f"自動調參結果: Kp={kp:.3f}, Ki={ki:.3f}, Kd={kd:.3f}")
+    
     def toggle_test_mode(self):
         """切換測試模式"""
         if not self.test_running:
@@ -0,0 +1,128 @@
+/**
+ * telemetry_decode.cpp
+ *
+ * 主機端二進位遙測解碼器：把擷取的串口資料轉成 CSV
+ * 功能：
+ * 1. 以 0x00 分隔幀，COBS 解碼並檢查 CRC，損壞或夾雜文字的片段直接略過
+ * 2. 依幀標頭的起始時間與取樣間隔還原每筆記錄的時間 (us)
+ * 3. 檢查格式描述幀是否與本程式的欄位表一致，並由序號統計遺失的取樣
+ * 4. CSV 輸出到 stdout，統計輸出到 stderr
+ *
+ * 建置：g++ -std=c++17 -O2 -I lib/Telemetry tools/telemetry_decode.cpp lib/Telemetry/TelemetryProtocol.cpp -o telemetry_decode
+ * 使用：./telemetry_decode capture.bin > samples.csv  (省略檔名時讀取 stdin)
+ */
+
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#include "TelemetryProtocol.h"
+
+struct DecodeStats {
+    unsigned long frames = 0;
+    unsigned long records = 0;
+    unsigned long badFrames = 0;
+    unsigned long skippedFrames = 0;
+    unsigned long lostSamples = 0;
+};
+
+static bool haveSeq = false;
+static uint32_t nextSeq = 0;
+static bool schemaWarned = false;
+
+static void handleFrame(const std::vector<uint8_t>& chunk, DecodeStats& stats) {
+    std::vector<uint8_t> frame(chunk.size());
+    size_t length = TelemetryProtocol::cobsDecode(chunk.data(), chunk.size(), frame.data());
+
+    TelemetryHeader header;
+    const uint8_t* payload;
+    size_t payloadLength;
+    if (length == 0 || !TelemetryProtocol::parseFrame(frame.data(), length, header, payload, payloadLength)) {
+        stats.badFrames++;
+        return;
+    }
+    if (header.version != TELEMETRY_VERSION) {
+        stats.skippedFrames++;
+        return;
+    }
+
+    if (header.schema == TELEMETRY_SCHEMA_DESCRIPTOR) {
+        char expected[TELEMETRY_MAX_PAYLOAD];
+        size_t expectedLength = TelemetryProtocol::describeBalanceSchema(expected, sizeof(expected));
+        if ((payloadLength != expectedLength || memcmp(payload, expected, expectedLength) != 0) && !schemaWarned) {
+            fprintf(stderr, "warning: descriptor \"%.*s\" differs from \"%s\"\n",
+                    (int)payloadLength, (const char*)payload, expected);
+            schemaWarned = true;
+        }
+        return;
+    }
+    if (header.schema != TELEMETRY_SCHEMA_BALANCE || header.recordSize != TELEMETRY_BALANCE_RECORD_SIZE) {
+        stats.skippedFrames++;
+        return;
+    }
+
+    // 序號往回跳代表韌體重新開始，不計為遺失
+    if (haveSeq && (int32_t)(header.firstSeq - nextSeq) > 0) {
+        stats.lostSamples += header.firstSeq - nextSeq;
+    }
+    haveSeq = true;
+    nextSeq = header.firstSeq + header.count;
+
+    for (uint8_t i = 0; i < header.count; i++) {
+        float values[TELEMETRY_BALANCE_FIELD_COUNT];
+        TelemetryProtocol::unpackBalanceRecord(payload + i * header.recordSize, values);
+        printf("%u,%u", (unsigned)(header.firstSeq + i),
+               (unsigned)(header.timestamp + (uint32_t)i * header.period));
+        for (int f = 0; f < TELEMETRY_BALANCE_FIELD_COUNT; f++) {
+            printf(",%g", values[f]);
+        }
+        printf("\n");
+    }
+    stats.frames++;
+    stats.records += header.count;
+}
+
+int main(int argc, char** argv) {
+    FILE* in = stdin;
+    if (argc > 1) {
+        in = fopen(argv[1], "rb");
+        if (!in) {
+            perror(argv[1]);
+            return 1;
+        }
+    }
+
+    printf("seq,time_us");
+    for (int f = 0; f < TELEMETRY_BALANCE_FIELD_COUNT; f++) {
+        printf(",%s", TELEMETRY_BALANCE_FIELDS[f].name);
+    }
+    printf("\n");
+
+    DecodeStats stats;
+    std::vector<uint8_t> chunk;
+    bool overflow = false;
+    int c;
+    while ((c = fgetc(in)) != EOF) {
+        if (c != 0) {
+            // 超過最大幀長度的片段不可能是有效幀，丟棄到下一個分隔符
+            if (chunk.size() < TELEMETRY_MAX_ENCODED) {
+                chunk.push_back((uint8_t)c);
+            } else {
+                overflow = true;
+            }
+            continue;
+        }
+        if (overflow) {
+            stats.badFrames++;
+        } else if (!chunk.empty()) {
+            handleFrame(chunk, stats);
+        }
+        chunk.clear();
+        overflow = false;
+    }
+    if (in != stdin) fclose(in);
+
+    fprintf(stderr, "frames %lu, records %lu, bad %lu, skipped %lu, lost samples %lu\n",
+            stats.frames, stats.records, stats.badFrames, stats.skippedFrames, stats.lostSamples);
+    return 0;
+}